@@ -137,6 +137,7 @@ class JOBTYPE( object ):
     COMMFLAG     = 0x0002
     METADATA     = 0x0004
     PREVIEW      = 0x0008
+    TRICKPLAY    = 0x0010
     USERJOB      = 0xff00
     USERJOB1     = 0x0100
     USERJOB2     = 0x0200
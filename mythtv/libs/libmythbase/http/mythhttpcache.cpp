@@ -79,14 +79,16 @@ void MythHTTPCache::PreConditionCheck(const HTTPResponse& Response)
     if ((cache & HTTPETag) == HTTPETag)
     {
         QByteArray& etag = data ? (*data)->m_etag : (*file)->m_etag;
-        if (file)
+        // Content that already has one (e.g. serialised results that are
+        // cached or were spooled to disk) keeps it
+        if (data && etag.isEmpty())
         {
-            QByteArray hashdata = ((*file)->fileName() + lastmodified.toString("ddMMyyyyhhmmsszzz")).toLocal8Bit().constData();
-            etag = QCryptographicHash::hash(hashdata, QCryptographicHash::Sha224).toHex();
+            etag = QCryptographicHash::hash((*data)->constData(), QCryptographicHash::Sha224).toHex();
         }
-        else
+        else if (etag.isEmpty())
         {
-            etag = QCryptographicHash::hash((*data)->constData(), QCryptographicHash::Sha224).toHex();
+            QByteArray hashdata = ((*file)->fileName() + lastmodified.toString("ddMMyyyyhhmmsszzz")).toLocal8Bit().constData();
+            etag = QCryptographicHash::hash(hashdata, QCryptographicHash::Sha224).toHex();
         }
 
         // This assumes only one or other is present...
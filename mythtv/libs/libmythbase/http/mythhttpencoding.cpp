@@ -333,7 +333,7 @@ MythHTTPEncode MythHTTPEncoding::Compress(MythHTTPResponse* Response, int64_t& S
     bool allowchunk = ! MythHTTP::GetHeader(Response->m_requestHeaders, "accept-encoding").toLower().contains("identity");
 
     // and restrict to 'chunky' files
-    bool chunky = Size > 102400; // 100KB
+    bool chunky = Size > kMaxCompressSize;
 
     // Don't compress anything that is too large. Under normal circumstances this
     // should not be a problem as we only compress text based data - but avoid
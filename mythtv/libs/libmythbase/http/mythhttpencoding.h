@@ -7,6 +7,9 @@
 class MythHTTPEncoding
 {
   public:
+    /// Larger content is chunked instead of being compressed
+    static constexpr int64_t kMaxCompressSize { 102400 }; // 100KB
+
     static QStringList    GetMimeTypes(const QString& Accept);
     static void           GetContentType(MythHTTPRequest* Request);
     static MythMimeType   GetMimeType(HTTPVariant Content);
@@ -16,6 +16,18 @@ HTTPFile MythHTTPFile::Create(const QString &ShortName, const QString& FullName)
     return std::shared_ptr<MythHTTPFile>(new MythHTTPFile(ShortName, FullName));
 }
 
+/*! \brief Wrap a file that is deleted once it has been sent.
+ *
+ * The file is closed before it is removed, as an open file cannot be removed
+ * on every platform.
+*/
+HTTPFile MythHTTPFile::CreateTemporary(const QString& FullName)
+{
+    auto result = std::shared_ptr<MythHTTPFile>(new MythHTTPFile("", FullName));
+    result->m_temporary = true;
+    return result;
+}
+
 /*! \class MythHTTPfile
  * \brief A simple wrapper around QFile
 */
@@ -32,6 +44,16 @@ MythHTTPFile::MythHTTPFile(const QString& ShortName, const QString& FullName)
 {
 }
 
+MythHTTPFile::~MythHTTPFile()
+{
+    if (m_temporary)
+    {
+        close();
+        if (!remove())
+            LOG(VB_GENERAL, LOG_WARNING, LOC + QString("Failed to remove '%1'").arg(fileName()));
+    }
+}
+
 HTTPResponse MythHTTPFile::ProcessFile(const HTTPRequest2& Request)
 {
     // Build full path
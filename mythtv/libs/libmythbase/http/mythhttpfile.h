@@ -11,13 +11,16 @@ class MythHTTPFile : public QFile, public MythHTTPContent
 {
   public:
     static HTTPFile     Create      (const QString& ShortName, const QString& FullName);
+    static HTTPFile     CreateTemporary(const QString& FullName);
     static HTTPResponse ProcessFile (const HTTPRequest2& Request);
+   ~MythHTTPFile() override;
 
   protected:
     MythHTTPFile(const QString& ShortName, const QString& FullName);
 
   private:
     Q_DISABLE_COPY(MythHTTPFile)
+    bool m_temporary { false };
 };
 
 #endif
@@ -2,10 +2,18 @@
 #define MYTHHTTPMETAMETHOD_H
 
 // Std
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // Qt
 #include <QMetaMethod>
+#include <QObject>
+#include <QVariant>
 
 // MythTV
 #include "libmythbase/http/mythhttptypes.h"
@@ -15,6 +23,20 @@ using HTTPMethodPtr  = std::shared_ptr<MythHTTPMetaMethod>;
 using HTTPMethods    = std::map<QString,HTTPMethodPtr>;
 using HTTPProperties = std::map<int,int>;
 
+/*! \brief A compiled call to a service method.
+ *
+ * Services may register these for methods that are called often, to avoid
+ * QMetaObject based invocation and the heap allocated, QMetaType constructed
+ * parameters it requires.
+*/
+struct HTTPInvoker
+{
+    using Call = std::function<QVariant(QObject*,const std::vector<QString>&)>;
+    size_t m_count { 0 };       ///< Number of parameters
+    Call   m_call  { nullptr };
+};
+using HTTPInvokers = std::map<QString,HTTPInvoker>;
+
 class MBASE_PUBLIC MythHTTPMetaMethod
 {
   public:
@@ -23,6 +45,27 @@ class MBASE_PUBLIC MythHTTPMetaMethod
     static void*  CreateParameter (void* Parameter, int Type, const QString& Value);
     static QVariant CreateReturnValue (int Type, void* Value);
 
+    template <typename Result, typename... Args>
+    static HTTPInvoker Invoker(Result (*Method)(Args...))
+    {
+        return { sizeof...(Args), [Method](QObject* /*Service*/, const std::vector<QString>& Values)
+        {
+            return Call<Args...>([Method](auto&&... Params) { return Method(Params...); },
+                                 Values, std::index_sequence_for<Args...>{});
+        }};
+    }
+
+    template <typename Class, typename Result, typename... Args>
+    static HTTPInvoker Invoker(Result (Class::*Method)(Args...))
+    {
+        return { sizeof...(Args), [Method](QObject* Service, const std::vector<QString>& Values)
+        {
+            auto * object = static_cast<Class*>(Service);
+            return Call<Args...>([object, Method](auto&&... Params) { return (object->*Method)(Params...); },
+                                 Values, std::index_sequence_for<Args...>{});
+        }};
+    }
+
     bool                    m_valid         { false };
     bool                    m_protected     { false };
     int                     m_index         { 0 };
@@ -31,6 +74,8 @@ class MBASE_PUBLIC MythHTTPMetaMethod
     std::vector<QString>    m_names;
     std::vector<int>        m_types;
     QString                 m_returnTypeName;
+    QStringList             m_cacheEvents;
+    HTTPInvoker             m_invoker;
 
   protected:
     MythHTTPMetaMethod(int Index, QMetaMethod& Method, int RequestTypes,
@@ -54,6 +99,47 @@ class MBASE_PUBLIC MythHTTPMetaMethod
             return true;
         return false;
     }
+
+    template <typename... Args, typename Function, size_t... Index>
+    static QVariant Call(const Function& Func, const std::vector<QString>& Values,
+                         std::index_sequence<Index...> /*unused*/)
+    {
+        return ReturnValue(Func(ParameterValue<std::decay_t<Args>>(Values[Index])...));
+    }
+
+    /// Convert a query value as CreateParameter would, without a QMetaType
+    template <typename Type>
+    static Type ParameterValue(const QString& Value)
+    {
+        if constexpr (std::is_same_v<Type, QString>)
+            return Value;
+        else if constexpr (std::is_same_v<Type, bool>)
+            return ToBool(Value);
+        else if constexpr (std::is_same_v<Type, int>)
+            return Value.toInt();
+        else if constexpr (std::is_same_v<Type, uint>)
+            return Value.toUInt();
+        else if constexpr (std::is_same_v<Type, long>)
+            return Value.toLong();
+        else if constexpr (std::is_same_v<Type, std::chrono::seconds>)
+            return std::chrono::seconds(Value.toInt());
+        else
+        {
+            Type result {};
+            CreateParameter(&result, qMetaTypeId<Type>(), Value);
+            return result;
+        }
+    }
+
+    /// Wrap a result as CreateReturnValue would
+    template <typename Result>
+    static QVariant ReturnValue(const Result& Value)
+    {
+        if constexpr (std::is_pointer_v<Result> && std::is_base_of_v<QObject, std::remove_pointer_t<Result>>)
+            return QVariant::fromValue<QObject*>(Value);
+        else
+            return QVariant::fromValue(Value);
+    }
 };
 
 #endif
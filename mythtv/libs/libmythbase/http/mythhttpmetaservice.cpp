@@ -15,7 +15,8 @@
 */
 MythHTTPMetaService::MythHTTPMetaService(const QString& Name, const QMetaObject& Meta,
                                          const HTTPRegisterTypes& RegisterCallback,
-                                         const QString& MethodsToHide)
+                                         const QString& MethodsToHide,
+                                         const HTTPInvokers& Invokers)
   : m_meta(Meta),
     m_name(Name)
 {
@@ -96,6 +97,7 @@ MythHTTPMetaService::MythHTTPMetaService(const QString& Name, const QMetaObject&
                     if (newmethod)
                     {
                         newmethod->m_protected = isProtected(Meta, name);
+                        newmethod->m_cacheEvents = CacheEvents(Meta, name);
                         RemoveExisting(m_slots, newmethod, name);
                         m_slots.emplace(name, newmethod);
                     }
@@ -104,6 +106,24 @@ MythHTTPMetaService::MythHTTPMetaService(const QString& Name, const QMetaObject&
         }
     }
 
+    // Attach compiled invokers to the slots they were registered for
+    for (const auto & [name, invoker] : Invokers)
+    {
+        auto slot = m_slots.find(name);
+        if (slot == m_slots.end())
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("Service '%1' has no method '%2' to invoke").arg(Name, name));
+            continue;
+        }
+        if (invoker.m_count + 1 != slot->second->m_types.size())
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("Invoker for '%1/%2' takes %3 parameters, not %4")
+                .arg(Name, name).arg(invoker.m_count).arg(slot->second->m_types.size() - 1));
+            continue;
+        }
+        slot->second->m_invoker = invoker;
+    }
+
     int constpropertyindex = -1;
     for (const auto * meta : metas)
     {
@@ -177,3 +197,22 @@ bool MythHTTPMetaService::isProtected(const QMetaObject& Meta, const QString& Me
     }
     return false;
 }
+
+/*! \brief Return the events that invalidate cached results of Method.
+ *
+ * Methods whose results may be cached declare the backend events that make
+ * them stale (e.g. Q_CLASSINFO("GetRecordedList", "cache=RECORDING_LIST_CHANGE")).
+*/
+QStringList MythHTTPMetaService::CacheEvents(const QMetaObject& Meta, const QString& Method)
+{
+    QStringList result;
+    int index = Meta.indexOfClassInfo(Method.toLatin1());
+    if (index > -1)
+    {
+        QStringList infos = QString(Meta.classInfo(index).value()).split(';', Qt::SkipEmptyParts);
+        for (const auto & info : std::as_const(infos))
+            if (info.startsWith(QStringLiteral("cache=")))
+                result += info.mid(6).trimmed().split(',', Qt::SkipEmptyParts);
+    }
+    return result;
+}
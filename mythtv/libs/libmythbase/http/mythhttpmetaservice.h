@@ -12,10 +12,12 @@ class MBASE_PUBLIC MythHTTPMetaService
   public:
     MythHTTPMetaService(const QString& Name, const QMetaObject& Meta,
                         const HTTPRegisterTypes& RegisterCallback = nullptr,
-                        const QString& MethodsToHide = {});
+                        const QString& MethodsToHide = {},
+                        const HTTPInvokers& Invokers = {});
 
     static int ParseRequestTypes(const QMetaObject& Meta, const QString& Method, QString& ReturnName);
     static bool isProtected(const QMetaObject& Meta, const QString& Method);
+    static QStringList CacheEvents(const QMetaObject& Meta, const QString& Method);
 
     const QMetaObject& m_meta;
     QString        m_name;
@@ -0,0 +1,228 @@
+// Std
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <sys/stat.h>
+
+// Qt
+#include <QRunnable>
+
+// MythTV
+#include "mythlogging.h"
+#include "mthreadpool.h"
+#include "http/mythhttpreadcache.h"
+
+#define LOC QString("HTTPCache: ")
+
+/// Big enough to read a recording efficiently, small enough that a seek wastes little
+static constexpr int64_t kBlockSize { INT64_C(256) * 1024 };
+/// Files that have not been read lately are forgotten past this many
+static constexpr qsizetype kMaxFiles { 256 };
+
+QMutex MythHTTPReadCache::s_lock;
+MythHTTPReadCache::Snapshot MythHTTPReadCache::s_current;
+int MythHTTPReadCache::s_prefetch { 0 };
+QHash<MythHTTPReadCache::BlockKey,MythHTTPReadCache::Block> MythHTTPReadCache::s_blocks;
+std::list<MythHTTPReadCache::BlockKey> MythHTTPReadCache::s_lru;
+QHash<QString,int64_t> MythHTTPReadCache::s_lastRead;
+QSet<MythHTTPReadCache::BlockKey> MythHTTPReadCache::s_pending;
+
+namespace
+{
+class MythHTTPReadAheadWork : public QRunnable
+{
+  public:
+    explicit MythHTTPReadAheadWork(std::function<void()> Work) : m_work(std::move(Work)) {}
+    void run() override { m_work(); }
+
+  private:
+    std::function<void()> m_work;
+};
+}
+
+/*! \brief Set how much to keep, and how many blocks to read ahead of a client.
+ *
+ * A Capacity of zero turns the cache off, and files are read as before.
+*/
+void MythHTTPReadCache::Configure(int64_t Capacity, int Prefetch)
+{
+    QMutexLocker locker(&s_lock);
+    s_current.m_capacity = std::max(Capacity, INT64_C(0));
+    s_prefetch = std::max(Prefetch, 0);
+    while (s_current.m_used > s_current.m_capacity && !s_lru.empty())
+    {
+        s_current.m_used -= s_blocks.take(s_lru.back()).m_data.size();
+        s_lru.pop_back();
+        s_current.m_evicted++;
+    }
+    LOG(VB_HTTP, LOG_INFO, LOC + QString("%1MB, reading %2 blocks ahead")
+        .arg(s_current.m_capacity >> 20).arg(s_prefetch));
+}
+
+MythHTTPReadCache::Snapshot MythHTTPReadCache::Get()
+{
+    QMutexLocker locker(&s_lock);
+    return s_current;
+}
+
+/*! \brief Read Size bytes from Offset in File, from cached blocks where possible.
+ *
+ * \return The number of bytes read, which is short at the end of the file, or
+ * -1 if nothing could be read.
+*/
+int64_t MythHTTPReadCache::Read(QFile& File, int64_t Offset, char* Buffer, int64_t Size)
+{
+    s_lock.lock();
+    bool enabled = s_current.m_capacity > 0;
+    s_lock.unlock();
+
+    if (!enabled)
+    {
+        if ((File.pos() != Offset) && !File.seek(Offset))
+            return -1;
+        return File.read(Buffer, Size);
+    }
+
+    QString id = FileId(File);
+    int64_t done = 0;
+    int64_t block = Offset / kBlockSize;
+    while (done < Size)
+    {
+        int64_t position = Offset + done;
+        block = position / kBlockSize;
+        int64_t within = position % kBlockSize;
+
+        BlockKey key { id, block };
+        QByteArray data = Find(key);
+        if (data.isNull())
+        {
+            data = ReadBlock(File, block);
+            if (data.isNull())
+                return done ? done : -1;
+            if (data.size() == kBlockSize)
+                Insert(key, data);
+        }
+
+        if (data.size() <= within)
+            break;
+        int64_t count = std::min(Size - done, static_cast<int64_t>(data.size()) - within);
+        memcpy(Buffer + done, data.constData() + within, static_cast<size_t>(count));
+        done += count;
+
+        // A short block is the end of the file, for now
+        if (data.size() < kBlockSize)
+            break;
+    }
+
+    ReadAhead(id, File.fileName(), block);
+    return done;
+}
+
+/// Names the file by its inode too, so that a replaced file is not confused with the old one
+QString MythHTTPReadCache::FileId(const QFile& File)
+{
+    struct stat info {};
+    if (fstat(File.handle(), &info) == 0)
+        return QString("%1:%2:%3").arg(info.st_dev).arg(info.st_ino).arg(File.fileName());
+    return File.fileName();
+}
+
+QByteArray MythHTTPReadCache::Find(const BlockKey& Key)
+{
+    QMutexLocker locker(&s_lock);
+    auto it = s_blocks.find(Key);
+    if (it == s_blocks.end())
+    {
+        s_current.m_misses++;
+        return {};
+    }
+    s_current.m_hits++;
+    s_lru.splice(s_lru.begin(), s_lru, it->m_lru);
+    return it->m_data;
+}
+
+void MythHTTPReadCache::Insert(const BlockKey& Key, const QByteArray& Data, bool Prefetched)
+{
+    QMutexLocker locker(&s_lock);
+    if (Prefetched)
+    {
+        s_pending.remove(Key);
+        s_current.m_prefetched++;
+    }
+    if (s_blocks.contains(Key) || (Data.size() > s_current.m_capacity))
+        return;
+
+    while ((s_current.m_used + Data.size() > s_current.m_capacity) && !s_lru.empty())
+    {
+        s_current.m_used -= s_blocks.take(s_lru.back()).m_data.size();
+        s_lru.pop_back();
+        s_current.m_evicted++;
+    }
+    s_lru.push_front(Key);
+    s_blocks.insert(Key, { Data, s_lru.begin() });
+    s_current.m_used += Data.size();
+}
+
+/*! \brief Read the blocks after Last in the background, if the file is being read in order.
+ *
+ * They are read with another handle, so the client's reads are not disturbed.
+*/
+void MythHTTPReadCache::ReadAhead(const QString& Id, const QString& FileName, int64_t Last)
+{
+    QList<int64_t> wanted;
+    {
+        QMutexLocker locker(&s_lock);
+        auto previous = s_lastRead.value(Id, -1);
+        if (s_lastRead.size() >= kMaxFiles && !s_lastRead.contains(Id))
+            s_lastRead.clear();
+        s_lastRead.insert(Id, Last);
+        if ((s_prefetch < 1) || (previous < 0) || (Last < previous) || (Last > previous + 1))
+            return;
+
+        for (int64_t block = Last + 1; block <= Last + s_prefetch; ++block)
+        {
+            BlockKey key { Id, block };
+            if (s_blocks.contains(key) || s_pending.contains(key))
+                continue;
+            s_pending.insert(key);
+            wanted.append(block);
+        }
+    }
+
+    if (wanted.isEmpty())
+        return;
+
+    auto * work = new MythHTTPReadAheadWork([Id, FileName, wanted]()
+    {
+        QFile file(FileName);
+        bool same = file.open(QIODevice::ReadOnly) && (FileId(file) == Id);
+        for (auto block : wanted)
+        {
+            QByteArray data = same ? ReadBlock(file, block) : QByteArray();
+            if (data.size() == kBlockSize)
+            {
+                Insert({ Id, block }, data, true);
+                continue;
+            }
+            QMutexLocker locker(&s_lock);
+            s_pending.remove({ Id, block });
+        }
+    });
+    MThreadPool::globalInstance()->start(work, "HTTPReadAhead");
+}
+
+QByteArray MythHTTPReadCache::ReadBlock(QFile& File, int64_t Block)
+{
+    if (!File.seek(Block * kBlockSize))
+        return {};
+    QByteArray data(static_cast<int>(kBlockSize), Qt::Uninitialized);
+    int64_t read = File.read(data.data(), kBlockSize);
+    if (read < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to read '%1': %2")
+            .arg(File.fileName(), File.errorString()));
+        return {};
+    }
+    data.resize(static_cast<int>(read));
+    return data;
+}
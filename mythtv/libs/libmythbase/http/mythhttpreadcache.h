@@ -0,0 +1,71 @@
+#ifndef MYTHHTTPREADCACHE_H
+#define MYTHHTTPREADCACHE_H
+
+// Std
+#include <list>
+
+// Qt
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+
+// MythTV
+#include "libmythbase/mythbaseexp.h"
+
+/*! \class MythHTTPReadCache
+ * \brief Blocks of recently served files, shared by all file responses.
+ *
+ * Several renderers playing the same recording, or one renderer seeking with
+ * overlapping range requests, read the same parts of a file again and again.
+ * File responses read through here instead, in blocks that are kept until
+ * the least recently used ones make room for others. When a file is being
+ * read in order the next few blocks are read ahead of the client.
+ *
+ * Blocks are keyed by the file's inode as well as its name, so a replaced
+ * file is not served from the old one's blocks. Only whole blocks are kept,
+ * so the end of a recording that is still being written is always read again.
+*/
+class MBASE_PUBLIC MythHTTPReadCache
+{
+  public:
+    struct Snapshot
+    {
+        int64_t  m_capacity   { 0 };
+        int64_t  m_used       { 0 };
+        uint64_t m_hits       { 0 };
+        uint64_t m_misses     { 0 };
+        uint64_t m_prefetched { 0 }; ///< Blocks read ahead of a client
+        uint64_t m_evicted    { 0 };
+    };
+
+    static void     Configure(int64_t Capacity, int Prefetch);
+    static Snapshot Get();
+    static int64_t  Read(QFile& File, int64_t Offset, char* Buffer, int64_t Size);
+
+  private:
+    using BlockKey = QPair<QString,int64_t>;
+    struct Block
+    {
+        QByteArray m_data;
+        std::list<BlockKey>::iterator m_lru;
+    };
+
+    static QString    FileId   (const QFile& File);
+    static QByteArray Find     (const BlockKey& Key);
+    static void       Insert   (const BlockKey& Key, const QByteArray& Data, bool Prefetched = false);
+    static void       ReadAhead(const QString& Id, const QString& FileName, int64_t Last);
+    static QByteArray ReadBlock(QFile& File, int64_t Block);
+
+    static QMutex   s_lock;
+    static Snapshot s_current;
+    static int      s_prefetch;
+    static QHash<BlockKey,Block>   s_blocks;
+    static std::list<BlockKey>     s_lru;      ///< Most recently used first
+    static QHash<QString,int64_t>  s_lastRead; ///< The last block read of each file
+    static QSet<BlockKey>          s_pending;  ///< Blocks being read ahead
+};
+
+#endif
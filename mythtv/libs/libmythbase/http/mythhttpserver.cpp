@@ -17,6 +17,8 @@
 #endif
 #include "http/mythhttpsocket.h"
 #include "http/mythhttpresponse.h"
+#include "http/mythhttpreadcache.h"
+#include "http/mythhttpstats.h"
 #include "http/mythhttpthread.h"
 #include "http/mythhttps.h"
 #include "http/mythhttpserver.h"
@@ -185,6 +187,11 @@ void MythHTTPServer::Init()
     // Get keep alive timeout
     auto timeout = gCoreContext->GetNumSetting("HTTP/KeepAliveTimeoutSecs", HTTP_SOCKET_TIMEOUT_MS / 1000);
     m_config.m_timeout = static_cast<std::chrono::milliseconds>(timeout * 1000);
+
+    // File blocks shared by all clients, and how many to read ahead of one
+    MythHTTPReadCache::Configure(
+        static_cast<int64_t>(gCoreContext->GetNumSetting("HTTP/ReadCacheMB", 64)) << 20,
+        gCoreContext->GetNumSetting("HTTP/ReadCachePrefetch", 4));
 }
 
 void MythHTTPServer::Started([[maybe_unused]] bool Tcp,
@@ -240,26 +247,43 @@ void MythHTTPServer::Stopped()
 
 void MythHTTPServer::ThreadFinished()
 {
-    if (!m_connectionQueue.empty())
-    {
-        emit ProcessTCPQueue();
-    }
+    emit ProcessTCPQueue();
 }
 
+/*! \brief Hand queued connections to the I/O threads.
+ *
+ * A new thread is started until we have as many as we want, after which
+ * connections go to the least busy thread. Connections only wait here when
+ * every thread is full.
+*/
 void MythHTTPServer::ProcessTCPQueueHandler()
 {
-    if (AvailableThreads() > 0)
+    while (!m_connectionQueue.empty())
     {
-        auto entry = m_connectionQueue.dequeue();
-        m_threadNum = m_threadNum % MaxThreads();
-        auto name = QString("HTTP%1%2").arg(entry.m_ssl ? "S" : "").arg(m_threadNum++);
-        auto * newthread = new MythHTTPThread(this, m_config, name, entry.m_socketFD, entry.m_ssl);
-        AddThread(newthread);
-        connect(newthread->qthread(), &QThread::finished, this, &MythHTTPThreadPool::ThreadFinished);
-        connect(newthread->qthread(), &QThread::finished, this, &MythHTTPServer::ThreadFinished);
-        newthread->start();
-        return;
+        const auto & entry = m_connectionQueue.head();
+        MythHTTPThread* thread = (ThreadCount() < MaxThreads()) ? nullptr : LeastLoaded();
+        if (!thread && (ThreadCount() >= MaxThreads()))
+            break;
+
+        if (!thread)
+        {
+            m_threadNum = m_threadNum % MaxThreads();
+            auto name = QString("HTTP%1").arg(m_threadNum++);
+            thread = new MythHTTPThread(this, name);
+            AddThread(thread);
+            connect(thread->qthread(), &QThread::finished, this, &MythHTTPThreadPool::ThreadFinished);
+            connect(thread->qthread(), &QThread::finished, this, &MythHTTPServer::ThreadFinished);
+            thread->AddSocket(entry.m_socketFD, entry.m_ssl, m_config);
+            thread->start();
+        }
+        // A thread that is about to finish will not take it
+        else if (!thread->AddSocket(entry.m_socketFD, entry.m_ssl, m_config))
+        {
+            break;
+        }
+        m_connectionQueue.dequeue();
     }
+    MythHTTPStats::SetThreads(ThreadCount(), static_cast<size_t>(m_connectionQueue.size()));
 }
 
 void MythHTTPServer::newTcpConnection(qintptr Socket)
@@ -9,10 +9,26 @@
 #include "http/mythhttpresponse.h"
 #include "http/serialisers/mythserialiser.h"
 #include "http/mythhttpencoding.h"
+#include "http/mythhttpfile.h"
 #include "http/mythhttpmetaservice.h"
+#include "http/mythhttpservicecache.h"
 
 #define LOC QString("HTTPService: ")
 
+/// Serialised results are in memory, or in a file when they are large
+static HTTPResponse SerialisedResponse(const HTTPRequest2& Request, const HTTPVariant& Content)
+{
+    if (const auto * file = std::get_if<HTTPFile>(&Content))
+    {
+        (*file)->m_cacheType = HTTPETag | HTTPShortLife;
+        return MythHTTPResponse::FileResponse(Request, *file);
+    }
+
+    const auto & data = std::get<HTTPData>(Content);
+    data->m_cacheType = HTTPETag | HTTPShortLife;
+    return MythHTTPResponse::DataResponse(Request, data);
+}
+
 MythHTTPService::MythHTTPService(MythHTTPMetaService *MetaService)
   : m_name(MetaService->m_name),
     m_staticMetaService(MetaService)
@@ -52,18 +68,15 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
             QString sVersion =
             m_staticMetaService->m_meta.classInfo(nClassIdx).value();
             auto accept = MythHTTPEncoding::GetMimeTypes(MythHTTP::GetHeader(Request->m_headers, "accept"));
-            HTTPData content = MythSerialiser::Serialise("String", sVersion, accept);
-            content->m_cacheType = HTTPETag | HTTPShortLife;
-            HTTPResponse result = MythHTTPResponse::DataResponse(Request, content);
-            return result;
+            HTTPVariant content = MythSerialiser::Serialise("String", sVersion, accept);
+            return SerialisedResponse(Request, content);
         }
     }
     // Find the method
     LOG(VB_HTTP, LOG_DEBUG, LOC + QString("Looking for method '%1'").arg(method));
     HTTPMethodPtr handler = nullptr;
-    // cppcheck-suppress unassignedVariable
-    for (auto & [path, handle] : m_staticMetaService->m_slots)
-        if (path == method) { handler = handle; break; }
+    if (auto slot = m_staticMetaService->m_slots.find(method); slot != m_staticMetaService->m_slots.cend())
+        handler = slot->second;
 
     if (handler == nullptr)
     {
@@ -88,6 +101,20 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
     if (HTTPResponse options = MythHTTPResponse::HandleOptions(Request))
         return options;
 
+    // Some results are reused until an event tells us they are out of date
+    bool cacheable = !handler->m_cacheEvents.isEmpty() && !handler->m_protected &&
+                     ((Request->m_type & (HTTPGet | HTTPHead)) != 0);
+    QString cachekey;
+    if (cacheable)
+    {
+        cachekey = MythHTTPServiceCache::Key(m_name, method, Request);
+        if (HTTPData cached = MythHTTPServiceCache::Get(cachekey))
+        {
+            LOG(VB_HTTP, LOG_DEBUG, LOC + "Using cached result");
+            return MythHTTPResponse::DataResponse(Request, cached);
+        }
+    }
+
     // Parse the parameters and match against those expected by the method.
     // As for the old code, this allows parameters to be missing and they will
     // thus be allocated a default/null/value.
@@ -99,18 +126,30 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
     std::array<void*, 100> param { nullptr};
     std::array<int,   100> types { 0 };
 
-    // Return type
+    // Compiled invokers convert their own parameters from the incoming values
+    const auto & invoker = handler->m_invoker.m_call;
+    std::vector<QString> values;
+    size_t count = 1;
+    QString error;
+    if (invoker)
+    {
+        values.reserve(typecount - 1);
+        for ( ; count < typecount; ++count)
+            values.emplace_back(Request->m_queries.value(handler->m_names[count].toLower(), ""));
+    }
+    else
+    {
+        // Return type
 #if QT_VERSION < QT_VERSION_CHECK(6,0,0)
-    param[0] = handler->m_types[0] == 0 ? nullptr : QMetaType::create(handler->m_types[0]);
+        param[0] = handler->m_types[0] == 0 ? nullptr : QMetaType::create(handler->m_types[0]);
 #else
-    param[0] = handler->m_types[0] == 0 ? nullptr : QMetaType(handler->m_types[0]).create();
+        param[0] = handler->m_types[0] == 0 ? nullptr : QMetaType(handler->m_types[0]).create();
 #endif
-    types[0] = handler->m_types[0];
+        types[0] = handler->m_types[0];
+    }
 
     // Parameters
     // Iterate over the method's parameters and search for the incoming values...
-    size_t count = 1;
-    QString error;
     while (count < typecount)
     {
         auto name  = handler->m_names[count];
@@ -139,7 +178,9 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
         // Invoke
         QVariant returnvalue;
         try {
-            if (qt_metacall(QMetaObject::InvokeMetaMethod, handler->m_index, param.data()) >= 0)
+            if (invoker)
+                returnvalue = invoker(this, values);
+            else if (qt_metacall(QMetaObject::InvokeMetaMethod, handler->m_index, param.data()) >= 0)
                 LOG(VB_GENERAL, LOG_ERR, "qt_metacall error");
             else
             {
@@ -156,6 +197,11 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
             result = MythHTTPResponse::RedirectionResponse(Request, ex.m_hostName);
         }
 
+        // Methods that cannot be used with HEAD may have changed what the
+        // cached ones return
+        if ((handler->m_requestTypes & HTTPHead) != HTTPHead)
+            MythHTTPServiceCache::Clear();
+
         if (!returnvalue.isValid())
         {
             if (!result)
@@ -197,9 +243,10 @@ HTTPResponse MythHTTPService::HTTPRequest(const HTTPRequest2& Request)
         else
         {
             auto accept = MythHTTPEncoding::GetMimeTypes(MythHTTP::GetHeader(Request->m_headers, "accept"));
-            HTTPData content = MythSerialiser::Serialise(handler->m_returnTypeName, returnvalue, accept);
-            content->m_cacheType = HTTPETag | HTTPShortLife;
-            result = MythHTTPResponse::DataResponse(Request, content);
+            HTTPVariant content = MythSerialiser::Serialise(handler->m_returnTypeName, returnvalue, accept);
+            result = SerialisedResponse(Request, content);
+            if (const auto * data = std::get_if<HTTPData>(&content); data && cacheable)
+                MythHTTPServiceCache::Insert(cachekey, *data, handler->m_cacheEvents);
 
             // If the return type is QObject* we need to cleanup
             if (returnvalue.canConvert<QObject*>())
@@ -0,0 +1,176 @@
+// Qt
+#include <QCoreApplication>
+#include <QCryptographicHash>
+
+// MythTV
+#include "mythchrono.h"
+#include "mythcorecontext.h"
+#include "mythevent.h"
+#include "mythlogging.h"
+#include "http/mythhttpservicecache.h"
+
+#define LOC QString("HTTPServiceCache: ")
+
+/// Results are dropped after this long, whether or not an event said so
+static constexpr std::chrono::milliseconds kMaxAge { 5min };
+/// Total size of the results kept
+static constexpr int64_t kMaxSize { INT64_C(32) * 1024 * 1024 };
+
+MythHTTPServiceCache* MythHTTPServiceCache::Instance()
+{
+    static QMutex s_lock;
+    static MythHTTPServiceCache* s_instance = nullptr;
+    QMutexLocker locker(&s_lock);
+    if (!s_instance)
+    {
+        // Events are delivered to the main thread. The HTTP threads come and go.
+        s_instance = new MythHTTPServiceCache();
+        if (QCoreApplication::instance())
+            s_instance->moveToThread(QCoreApplication::instance()->thread());
+        if (gCoreContext)
+            gCoreContext->addListener(s_instance);
+    }
+    return s_instance;
+}
+
+QString MythHTTPServiceCache::Key(const QString& Service, const QString& Method,
+                                  const HTTPRequest2& Request)
+{
+    // Query names are already lower case, and a QMultiMap keeps them sorted
+    QString key = Service + "/" + Method + "?";
+    for (auto it = Request->m_queries.cbegin(); it != Request->m_queries.cend(); ++it)
+        key += it.key() + "=" + it.value() + "&";
+    // The same call may be serialised differently, or refer to the host asked
+    key += "\n" + MythHTTP::GetHeader(Request->m_headers, "accept");
+    key += "\n" + MythHTTP::GetHeader(Request->m_headers, "host");
+    return key;
+}
+
+/*! \brief Return a copy of a cached result, or nullptr.
+ *
+ * The bytes are shared with the cache, but the copy has its own write
+ * state for the socket.
+*/
+HTTPData MythHTTPServiceCache::Get(const QString& Key)
+{
+    auto * cache = Instance();
+    QMutexLocker locker(&cache->m_lock);
+    auto it = cache->m_entries.constFind(Key);
+    if (it == cache->m_entries.cend())
+        return nullptr;
+    if (it->m_age.hasExpired(kMaxAge.count()))
+    {
+        cache->m_size -= it->m_data->size();
+        cache->m_entries.erase(it);
+        return nullptr;
+    }
+
+    const HTTPData& cached = it->m_data;
+    auto result = MythHTTPData::Create(*cached);
+    result->m_fileName  = cached->m_fileName;
+    result->m_mimeType  = cached->m_mimeType;
+    result->m_etag      = cached->m_etag;
+    result->m_cacheType = cached->m_cacheType;
+    return result;
+}
+
+/// Keep a copy of a result, with the ETag it was (or would be) sent with
+void MythHTTPServiceCache::Insert(const QString& Key, const HTTPData& Data,
+                                  const QStringList& Events)
+{
+    if (!Data || (Data->size() > (kMaxSize / 8)))
+        return;
+
+    if (Data->m_etag.isEmpty())
+        Data->m_etag = QCryptographicHash::hash(Data->constData(), QCryptographicHash::Sha224).toHex();
+
+    Entry entry;
+    entry.m_data = MythHTTPData::Create(*Data);
+    entry.m_data->m_fileName  = Data->m_fileName;
+    entry.m_data->m_mimeType  = Data->m_mimeType;
+    entry.m_data->m_etag      = Data->m_etag;
+    entry.m_data->m_cacheType = Data->m_cacheType;
+    entry.m_events = Events;
+    entry.m_age.start();
+
+    auto * cache = Instance();
+    QMutexLocker locker(&cache->m_lock);
+    auto old = cache->m_entries.constFind(Key);
+    if (old != cache->m_entries.cend())
+        cache->m_size -= old->m_data->size();
+    cache->m_size += entry.m_data->size();
+    cache->m_entries.insert(Key, entry);
+    cache->Expire();
+}
+
+void MythHTTPServiceCache::Clear()
+{
+    auto * cache = Instance();
+    QMutexLocker locker(&cache->m_lock);
+    if (!cache->m_entries.isEmpty())
+        LOG(VB_HTTP, LOG_DEBUG, LOC + "Cleared");
+    cache->m_entries.clear();
+    cache->m_size = 0;
+}
+
+void MythHTTPServiceCache::customEvent(QEvent* Event)
+{
+    if (Event->type() != MythEvent::kMythEventMessage)
+        return;
+    auto * event = dynamic_cast<MythEvent*>(Event);
+    if (!event)
+        return;
+
+    // System events are named by their second word
+    QString message = event->Message();
+    QString name = message.section(' ', 0, 0);
+    if (name == "SYSTEM_EVENT")
+        name = message.section(' ', 1, 1);
+    Invalidate(name);
+}
+
+void MythHTTPServiceCache::Invalidate(const QString& Event)
+{
+    QMutexLocker locker(&m_lock);
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (it->m_events.contains(Event))
+        {
+            LOG(VB_HTTP, LOG_DEBUG, LOC + QString("%1 invalidates '%2'")
+                .arg(Event, it.key().section('\n', 0, 0)));
+            m_size -= it->m_data->size();
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+/// Drop stale results, then the oldest ones until we are within our limit
+void MythHTTPServiceCache::Expire()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (it->m_age.hasExpired(kMaxAge.count()))
+        {
+            m_size -= it->m_data->size();
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    while (m_size > kMaxSize && !m_entries.isEmpty())
+    {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+            if (it->m_age.elapsed() > oldest->m_age.elapsed())
+                oldest = it;
+        m_size -= oldest->m_data->size();
+        m_entries.erase(oldest);
+    }
+}
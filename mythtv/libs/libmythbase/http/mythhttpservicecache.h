@@ -0,0 +1,62 @@
+#ifndef MYTHHTTPSERVICECACHE_H
+#define MYTHHTTPSERVICECACHE_H
+
+// Qt
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+
+// MythTV
+#include "libmythbase/http/mythhttprequest.h"
+#include "libmythbase/http/mythhttpdata.h"
+
+/*! \class MythHTTPServiceCache
+ * \brief Keeps the serialised results of service methods that are polled often.
+ *
+ * A method opts in with a 'cache=' entry in its Q_CLASSINFO, listing the
+ * backend events that make its results stale, e.g.
+ * \code
+ *   Q_CLASSINFO("GetUpcomingList", "cache=SCHEDULE_CHANGE")
+ * \endcode
+ * Results are keyed by service, method, query parameters and the requested
+ * content type, carry a precomputed ETag (so that If-None-Match is answered
+ * without calling the service at all) and expire after a few minutes in any
+ * case. Any call to a method that may change something (i.e. one that cannot
+ * be used with HEAD) clears the cache.
+*/
+class MBASE_PUBLIC MythHTTPServiceCache : public QObject
+{
+    Q_OBJECT
+    friend class TestMythHTTPServiceCache;
+
+  public:
+    static QString  Key    (const QString& Service, const QString& Method, const HTTPRequest2& Request);
+    static HTTPData Get    (const QString& Key);
+    static void     Insert (const QString& Key, const HTTPData& Data, const QStringList& Events);
+    static void     Clear  ();
+
+  protected:
+    void customEvent(QEvent* Event) override;
+
+  private:
+    Q_DISABLE_COPY(MythHTTPServiceCache)
+    MythHTTPServiceCache() = default;
+    static MythHTTPServiceCache* Instance();
+    void Invalidate(const QString& Event);
+    void Expire();
+
+    struct Entry
+    {
+        HTTPData      m_data   { nullptr };
+        QStringList   m_events;
+        QElapsedTimer m_age;
+    };
+
+    QMutex                m_lock;
+    QHash<QString,Entry>  m_entries;
+    int64_t               m_size { 0 };
+};
+
+#endif
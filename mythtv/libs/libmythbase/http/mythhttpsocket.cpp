@@ -1,6 +1,8 @@
 // Qt
+#include <QRunnable>
 #include <QThread>
 #include <QTcpSocket>
+#include <QSocketNotifier>
 #ifndef QT_NO_OPENSSL
 #include <QSslSocket>
 #endif
@@ -8,6 +10,7 @@
 // MythTV
 #include "mythlogging.h"
 #include "mythcorecontext.h"
+#include "mthreadpool.h"
 #include "http/mythwebsocket.h"
 #include "http/mythhttps.h"
 #include "http/mythhttpsocket.h"
@@ -16,15 +19,48 @@
 #include "http/mythhttpresponse.h"
 #include "http/mythhttprequest.h"
 #include "http/mythhttpranges.h"
+#include "http/mythhttpreadcache.h"
 #include "http/mythhttpservices.h"
+#include "http/mythhttpstats.h"
 #include "http/mythwebsocketevent.h"
 
 // Std
 #include <chrono>
+#include <functional>
 using namespace std::chrono_literals;
+#ifdef __linux__
+#include <cerrno>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#endif
 
 #define LOC QString(m_peer + ": ")
 
+namespace
+{
+class MythHTTPWork : public QRunnable
+{
+  public:
+    explicit MythHTTPWork(std::function<void()> Work) : m_work(std::move(Work)) {}
+    void run() override { m_work(); }
+
+  private:
+    std::function<void()> m_work;
+};
+}
+
+/// Requests are processed here, and the responses sent by the sockets' threads
+MThreadPool& MythHTTPSocket::Workers()
+{
+    static MThreadPool* s_workers = []()
+    {
+        auto * pool = new MThreadPool("HTTPWorkers");
+        pool->setMaxThreadCount(std::max(QThread::idealThreadCount() * 2, 4));
+        return pool;
+    }();
+    return *s_workers;
+}
+
 MythHTTPSocket::MythHTTPSocket(qintptr Socket, bool SSL, MythHTTPConfig Config)
   : m_socketFD(Socket),
     m_config(std::move(Config))
@@ -55,7 +91,7 @@ MythHTTPSocket::MythHTTPSocket(qintptr Socket, bool SSL, MythHTTPConfig Config)
     connect(m_socket, &QTcpSocket::readyRead,    this, &MythHTTPSocket::Read);
     connect(m_socket, &QTcpSocket::bytesWritten, this, &MythHTTPSocket::Write);
     connect(m_socket, &QTcpSocket::disconnected, this, &MythHTTPSocket::Disconnected);
-    connect(m_socket, &QTcpSocket::disconnected, QThread::currentThread(), &QThread::quit);
+    connect(m_socket, &QTcpSocket::disconnected, this, &MythHTTPSocket::Stop);
     connect(m_socket, &QTcpSocket::errorOccurred, this, &MythHTTPSocket::Error);
     m_socket->setSocketDescriptor(m_socketFD);
 
@@ -64,8 +100,24 @@ MythHTTPSocket::MythHTTPSocket(qintptr Socket, bool SSL, MythHTTPConfig Config)
         MythHTTPS::InitSSLSocket(sslsocket, m_config.m_sslConfig);
 #endif
 
+#ifdef __linux__
+    // Files are sent without QTcpSocket on plain connections, so it cannot
+    // tell us when there is room for more.
+    if (!SSL)
+    {
+        m_writeNotifier = new QSocketNotifier(m_socketFD, QSocketNotifier::Write, this);
+        m_writeNotifier->setEnabled(false);
+        connect(m_writeNotifier, &QSocketNotifier::activated, this, [this]()
+        {
+            m_writeNotifier->setEnabled(false);
+            Write();
+        });
+    }
+#endif
+
     m_peer = QString("%1:%2").arg(m_socket->peerAddress().toString()).arg(m_socket->peerPort());
     LOG(VB_HTTP, LOG_INFO, LOC + "New connection");
+    MythHTTPStats::Connected(true);
 
     // Setup up timeout timer
     m_timer.setTimerType(Qt::PreciseTimer);
@@ -94,6 +146,11 @@ MythHTTPSocket::MythHTTPSocket(qintptr Socket, bool SSL, MythHTTPConfig Config)
 
 MythHTTPSocket::~MythHTTPSocket()
 {
+    if (m_websocket)
+        MythHTTPStats::Upgraded(false);
+    if (!m_peer.isEmpty())
+        MythHTTPStats::Connected(false);
+    delete m_writeNotifier;
     delete m_websocketevent;
     delete m_websocket;
     if (m_socket)
@@ -139,8 +196,8 @@ void MythHTTPSocket::HostsChanged(const QStringList& Hosts)
 
 /*! \brief The socket was disconnected.
  *
- * The QTcpSocket::disconnected signal is also connected to our QThread::quit slot,
- * so the thread will be closed once the socket is disconnected.
+ * The QTcpSocket::disconnected signal is also connected to Stop, so the
+ * thread will delete us once the socket is disconnected.
 */
 void MythHTTPSocket::Disconnected()
 {
@@ -155,10 +212,17 @@ void MythHTTPSocket::Error(QAbstractSocket::SocketError Error)
 
 /*! \brief Close the socket after a period of inactivity.
  *
- * This ensures we recycle unused threads for new connections.
+ * This ensures we recycle unused connections.
 */
 void MythHTTPSocket::Timeout()
 {
+    // A slow request is not inactivity
+    if (m_processing)
+    {
+        m_timer.start(m_config.m_timeout);
+        return;
+    }
+
     LOG(VB_HTTP, LOG_DEBUG, LOC + "Timed out waiting for activity");
     // Send '408 Request Timeout' - Respond will close the socket.
     // Note: some clients will close the socket themselves at the correct time -
@@ -180,26 +244,32 @@ void MythHTTPSocket::Timeout()
     }
 }
 
-/*! \brief Close the socket and quit the thread.
+/*! \brief Stop serving the socket and tell our thread to delete us.
  *
  * This is triggered by the activity timeout, invalid requests, if signalled
- * by the parent server (i.e. closing down) or when the connection is closed
- * after a request.
+ * by the parent server (i.e. closing down), when the connection is closed
+ * after a request or by the client disconnecting.
+ *
+ * A request that is still being processed by a worker refers to us, so in
+ * that case we are deleted once it is complete.
 */
 void MythHTTPSocket::Stop()
 {
-    LOG(VB_HTTP, LOG_INFO, LOC + "Stop");
+    if (!m_stopping)
+        LOG(VB_HTTP, LOG_INFO, LOC + "Stop");
     if (m_websocket)
         m_websocket->Close();
     m_timer.stop();
     m_stopping = true;
-    // Note: previously this called QTcpSocket::disconnectFromHost - but when
-    // an interrupt is received (i.e. quit the app), there is an intermittent
-    // race condition where the socket is disconnected before the thread is told
-    // to quit and the call to QThread::quit is not triggered (i.e. the connection
-    // between QTcpSocket::disconnected and QThread::quit does not work). So
-    // just quit the thread.
-    QThread::currentThread()->quit();
+    if (!m_processing)
+        emit Closed();
+}
+
+/// Signal again if we stopped before anyone was listening
+void MythHTTPSocket::CheckClosed()
+{
+    if (m_stopping && !m_processing)
+        emit Closed();
 }
 
 /*! \brief Read data from the socket which is parsed by MythHTTPParser
@@ -211,9 +281,10 @@ void MythHTTPSocket::Read()
     if (m_stopping)
         return;
 
-    // Warn if we haven't sent the last response
-    if (!m_queue.empty())
-        LOG(VB_GENERAL, LOG_WARNING, LOC + "New request but queue is not empty");
+    // Requests are answered in order. Pipelined requests stay in the socket
+    // until the current response has been sent.
+    if (m_processing || m_responding)
+        return;
 
     // reset the idle timer
     m_timer.start(m_config.m_timeout);
@@ -231,13 +302,11 @@ void MythHTTPSocket::Read()
 
     // We have a completed request
     HTTPRequest2  request = m_parser.GetRequest(m_config, m_socket);
-    HTTPResponse response = nullptr;
 
     // Request should have initial OK status if valid
     if (request->m_status != HTTPOK)
     {
-        response = MythHTTPResponse::ErrorResponse(request);
-        Respond(response);
+        Respond(MythHTTPResponse::ErrorResponse(request));
         return;
     }
 
@@ -246,36 +315,76 @@ void MythHTTPSocket::Read()
     // Once the response is sent, we will create a WebSocket instance to handle
     // further read/write signals.
     if (!MythHTTP::GetHeader(request->m_headers, "upgrade").isEmpty())
-        response = MythHTTPResponse::UpgradeResponse(request, m_protocol, m_testSocket);
+    {
+        if (HTTPResponse upgrade = MythHTTPResponse::UpgradeResponse(request, m_protocol, m_testSocket))
+        {
+            Respond(upgrade);
+            return;
+        }
+    }
+
+    // Everything else is processed on a worker thread, so that a slow request
+    // does not hold up the other connections served by this thread. Further
+    // (pipelined) requests are left unread until the response has been sent.
+    m_processing = true;
+    MythHTTPStats::RequestStarted();
+    QElapsedTimer timer;
+    timer.start();
+    auto * job = new MythHTTPWork([this, request, config = m_config,
+                                   services = m_activeServices, timer]()
+    {
+        HTTPResponse response = ProcessRequest(request, config, services);
+        QMetaObject::invokeMethod(this, [this, response, timer]()
+        {
+            MythHTTPStats::RequestFinished(std::chrono::nanoseconds(timer.nsecsElapsed()));
+            m_processing = false;
+            if (m_stopping)
+                emit Closed();
+            else
+                Respond(response);
+        }, Qt::QueuedConnection);
+    });
+    Workers().start(job, "HTTPRequest");
+}
+
+/*! \brief Find the handler for a request and return its response.
+ *
+ * This runs on a worker thread and must only use the copies of our
+ * configuration that it is given.
+*/
+HTTPResponse MythHTTPSocket::ProcessRequest(const HTTPRequest2& Request, const MythHTTPConfig& Config,
+                                            const HTTPServicePtrs& Services) const
+{
+    HTTPResponse response = nullptr;
 
     // Try (possibly file specific) handlers
     if (response == nullptr)
     {
         // cppcheck-suppress unassignedVariable
-        for (const auto& [path, function] : m_config.m_handlers)
+        for (const auto& [path, function] : Config.m_handlers)
         {
-            if (path == request->m_url.toString())
+            if (path == Request->m_url.toString())
             {
-                response = std::invoke(function, request);
+                response = std::invoke(function, Request);
                 if (response)
                     break;
             }
         }
     }
 
-    const QString& rpath = request->m_path;
+    const QString& rpath = Request->m_path;
 
     // Try active services first - this is currently the services root only
     if (response == nullptr)
     {
         LOG(VB_HTTP, LOG_INFO, LOC + QString("Processing: path '%1' file '%2'")
-            .arg(rpath, request->m_fileName));
+            .arg(rpath, Request->m_fileName));
 
-        for (auto & service : m_activeServices)
+        for (auto & service : Services)
         {
             if (service->Name() == rpath)
             {
-                response = service->HTTPRequest(request);
+                response = service->HTTPRequest(Request);
                 if (response)
                     break;
             }
@@ -286,12 +395,12 @@ void MythHTTPSocket::Read()
     if (response == nullptr)
     {
         // cppcheck-suppress unassignedVariable
-        for (const auto & [path, constructor] : m_config.m_services)
+        for (const auto & [path, constructor] : Config.m_services)
         {
             if (path == rpath)
             {
                 auto instance = std::invoke(constructor);
-                response = instance->HTTPRequest(request);
+                response = instance->HTTPRequest(Request);
                 if (response)
                     break;
                 // the service object will be deleted here as it goes out of scope
@@ -304,11 +413,11 @@ void MythHTTPSocket::Read()
     if (response == nullptr)
     {
         // cppcheck-suppress unassignedVariable
-        for (const auto& [path, function] : m_config.m_handlers)
+        for (const auto& [path, function] : Config.m_handlers)
         {
             if (path == rpath)
             {
-                response = std::invoke(function, request);
+                response = std::invoke(function, Request);
                 if (response)
                     break;
             }
@@ -318,11 +427,11 @@ void MythHTTPSocket::Read()
     // then simple file path handlers
     if (response == nullptr)
     {
-        for (const auto & path : std::as_const(m_config.m_filePaths))
+        for (const auto & path : std::as_const(Config.m_filePaths))
         {
             if (path == rpath)
             {
-                response = MythHTTPFile::ProcessFile(request);
+                response = MythHTTPFile::ProcessFile(Request);
                 if (response)
                     break;
             }
@@ -332,22 +441,21 @@ void MythHTTPSocket::Read()
     // Try error page handler
     if (response == nullptr || response->m_status == HTTPNotFound)
     {
-        if(m_config.m_errorPageHandler.first.length() > 0)
+        if(Config.m_errorPageHandler.first.length() > 0)
         {
-            auto function = m_config.m_errorPageHandler.second;
-            response = std::invoke(function, request);
+            auto function = Config.m_errorPageHandler.second;
+            response = std::invoke(function, Request);
         }
     }
 
     // nothing to see
     if (response == nullptr)
     {
-        request->m_status = HTTPNotFound;
-        response = MythHTTPResponse::ErrorResponse(request);
+        Request->m_status = HTTPNotFound;
+        response = MythHTTPResponse::ErrorResponse(Request);
     }
 
-    // Send the response
-    Respond(response);
+    return response;
 }
 
 /*! \brief Send response to client.
@@ -363,6 +471,7 @@ void MythHTTPSocket::Respond(const HTTPResponse& Response)
     // Warn if the last response has not been completed
     if (!m_queue.empty())
         LOG(VB_GENERAL, LOG_WARNING, LOC + "Responding but queue is not empty");
+    m_responding = true;
 
     // Reset the write tracker
     m_writeTime.start();
@@ -370,6 +479,8 @@ void MythHTTPSocket::Respond(const HTTPResponse& Response)
     m_totalWritten = 0;
     m_totalSent    = 0;
     m_writeBuffer  = nullptr;
+    m_rawPending.clear();
+    m_chunkLeft    = 0;
 
     // Finalise the response
     Response->Finalise(m_config);
@@ -471,6 +582,10 @@ void MythHTTPSocket::Write(int64_t Written)
         return;
     }
 
+    // Chunk framing for a file sent directly must go before anything else
+    if (!m_rawPending.isEmpty() && !SendRaw())
+        return;
+
     if (m_totalSent >= m_totalToSend)
     {
         auto seconds = static_cast<double>(m_writeTime.nsecsElapsed()) / 1000000000.0;
@@ -481,10 +596,16 @@ void MythHTTPSocket::Write(int64_t Written)
 
         if (m_queue.empty())
         {
+            if (!m_responding)
+                return;
+            m_responding = false;
             if (m_nextConnection == HTTPConnectionClose)
                 Stop();
             else if (m_nextConnection == HTTPConnectionUpgrade)
                 SetupWebSocket();
+            // A pipelined request may be waiting for us already
+            else if (m_socket->bytesAvailable() > 0)
+                QMetaObject::invokeMethod(this, &MythHTTPSocket::Read, Qt::QueuedConnection);
             return;
         }
         // This is going to be unrecoverable
@@ -506,6 +627,16 @@ void MythHTTPSocket::Write(int64_t Written)
         auto * data = std::get_if<HTTPData>(&m_queue.front());
         auto * file = std::get_if<HTTPFile>(&m_queue.front());
 
+        // Multipart ranges interleave their headers with the file data, so
+        // leave those to the buffered path
+        if (file && m_writeNotifier && ((*file)->m_multipartHeaderSize == 0))
+        {
+            // Let QTcpSocket finish sending the headers first
+            if (m_socket->bytesToWrite() == 0)
+                SendFile(*file);
+            return;
+        }
+
         if (data)
         {
             chunk    = (*data)->m_encoding == HTTPChunked;
@@ -532,20 +663,16 @@ void MythHTTPSocket::Write(int64_t Written)
             written  = (*file)->m_written;
             itemsize = (*file)->m_partialSize > 0 ? (*file)->m_partialSize : static_cast<int64_t>((*file)->size());
             towrite  = std::min(itemsize - written, available);
+            int64_t offset = written;
             HTTPMulti multipart { nullptr, nullptr };
             if (!(*file)->m_ranges.empty())
-            {
-                int64_t offset = 0;
                 multipart = MythHTTPRanges::HandleRangeWrite(*file, available, towrite, offset);
-                if (offset != (*file)->pos())
-                    (*file)->seek(offset);
-            }
             int64_t writebufsize = std::min(itemsize, static_cast<int64_t>(HTTP_CHUNKSIZE));
             if (m_writeBuffer && (m_writeBuffer->size() < writebufsize))
                 m_writeBuffer = nullptr;
             if (!m_writeBuffer)
                 m_writeBuffer = MythHTTPData::Create(static_cast<int>(writebufsize), '\0');
-            read = (*file)->read(m_writeBuffer->data(), towrite);
+            read = MythHTTPReadCache::Read(**file, offset, m_writeBuffer->data(), towrite);
             if (read > 0)
             {
                 if (chunk)
@@ -590,6 +717,120 @@ void MythHTTPSocket::Write(int64_t Written)
     }
 }
 
+/*! \brief Send file content straight from the page cache to the socket.
+ *
+ * This avoids copying every byte of a recording into user space and back.
+ * The data bypasses QTcpSocket, so it does not count it nor signal
+ * bytesWritten; instead we wait for the socket descriptor to become writable
+ * and come back to Write(). Chunk framing is sent the same way, in order.
+*/
+void MythHTTPSocket::SendFile([[maybe_unused]] const HTTPFile& File)
+{
+#ifdef __linux__
+    bool chunk = File->m_encoding == HTTPChunked;
+    int64_t budget = HTTP_CHUNKSIZE << 4;
+    while (budget > 0)
+    {
+        int64_t written  = File->m_written;
+        int64_t itemsize = File->m_partialSize > 0 ? File->m_partialSize : static_cast<int64_t>(File->size());
+        if (written >= itemsize)
+        {
+            if (chunk)
+            {
+                m_rawPending.append("0\r\n\r\n");
+                m_totalToSend += 5;
+            }
+            m_queue.pop_front();
+            break;
+        }
+
+        int64_t towrite = std::min(itemsize - written, budget);
+        off_t offset = written;
+        if (!File->m_ranges.empty())
+        {
+            int64_t rangeoffset = 0;
+            MythHTTPRanges::HandleRangeWrite(File, budget, towrite, rangeoffset);
+            offset = rangeoffset;
+        }
+
+        if (chunk)
+        {
+            if (m_chunkLeft == 0)
+            {
+                QByteArray header = QStringLiteral("%1\r\n").arg(towrite, 0, 16).toLatin1();
+                m_rawPending.append(header);
+                m_totalToSend += header.size();
+                m_chunkLeft = towrite;
+            }
+            towrite = std::min(towrite, m_chunkLeft);
+        }
+
+        if (!m_rawPending.isEmpty() && !SendRaw(true))
+            return;
+
+        ssize_t sent = sendfile(static_cast<int>(m_socketFD), File->handle(), &offset,
+                                static_cast<size_t>(towrite));
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (sent <= 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to send '%1'")
+                .arg(File->fileName()) + (sent < 0 ? ENO : QString()));
+            Stop();
+            return;
+        }
+
+        File->m_written += sent;
+        m_totalWritten  += sent;
+        m_totalSent     += sent;
+        budget          -= sent;
+        if (chunk && ((m_chunkLeft -= sent) == 0))
+        {
+            m_rawPending.append("\r\n");
+            m_totalToSend += 2;
+        }
+    }
+
+    // Carry on (or finish up) when the socket has room
+    m_writeNotifier->setEnabled(true);
+#endif
+}
+
+/*! \brief Send framing for a file sent with SendFile().
+ *
+ * \return false if it could not all be sent yet.
+*/
+bool MythHTTPSocket::SendRaw([[maybe_unused]] bool More)
+{
+#ifdef __linux__
+    while (!m_rawPending.isEmpty())
+    {
+        ssize_t sent = send(static_cast<int>(m_socketFD), m_rawPending.constData(),
+                            static_cast<size_t>(m_rawPending.size()),
+                            MSG_NOSIGNAL | (More ? MSG_MORE : 0));
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            m_writeNotifier->setEnabled(true);
+            return false;
+        }
+        if (sent < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Error writing chunk header" + ENO);
+            Stop();
+            return false;
+        }
+        m_rawPending.remove(0, static_cast<int>(sent));
+        m_totalWritten += sent;
+        m_totalSent    += sent;
+    }
+#endif
+    return true;
+}
+
 /*! \brief Transition socket to a WebSocket
 */
 void MythHTTPSocket::SetupWebSocket()
@@ -626,9 +867,9 @@ void MythHTTPSocket::SetupWebSocket()
 
     // Sending messages
     connect(m_websocketevent, &MythWebSocketEvent::SendTextMessage, m_websocket, &MythWebSocket::SendTextFrame);
+    connect(m_websocketevent, &MythWebSocketEvent::SendBinaryMessage, m_websocket, &MythWebSocket::SendBinaryFrame);
 
-    // Add this thread to the list of upgraded threads, so we free up slots
-    // for regular HTTP sockets.
+    MythHTTPStats::Upgraded(true);
     emit ThreadUpgraded(QThread::currentThread());
 }
 
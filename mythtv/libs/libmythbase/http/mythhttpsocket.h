@@ -12,6 +12,8 @@
 
 class QTcpSocket;
 class QSslSocket;
+class QSocketNotifier;
+class MThreadPool;
 class MythWebSocket;
 class MythWebSocketEvent;
 
@@ -21,6 +23,7 @@ class MythHTTPSocket : public QObject
 
   signals:
     void Finish();
+    void Closed();
     void UpdateServices(const HTTPServices& Services);
     void ThreadUpgraded(QThread* Thread);
 
@@ -38,6 +41,7 @@ class MythHTTPSocket : public QObject
     explicit MythHTTPSocket(qintptr Socket, bool SSL, MythHTTPConfig Config);
    ~MythHTTPSocket() override;
     void Respond(const HTTPResponse& Response);
+    void CheckClosed();
     static void RespondDirect(qintptr Socket, const HTTPResponse& Response, const MythHTTPConfig& Config);
 
   protected slots:
@@ -51,11 +55,18 @@ class MythHTTPSocket : public QObject
   private:
     Q_DISABLE_COPY(MythHTTPSocket)
     void SetupWebSocket();
+    HTTPResponse ProcessRequest(const HTTPRequest2& Request, const MythHTTPConfig& Config,
+                                const HTTPServicePtrs& Services) const;
+    static MThreadPool& Workers();
+    void SendFile(const HTTPFile& File);
+    bool SendRaw(bool More = false);
 
     qintptr         m_socketFD       { 0 };
     MythHTTPConfig  m_config;
     HTTPServicePtrs m_activeServices;
     bool            m_stopping       { false };
+    bool            m_processing     { false };
+    bool            m_responding     { false };
     QTcpSocket*     m_socket         { nullptr };
     MythWebSocket*  m_websocket      { nullptr };
     QString         m_peer;
@@ -67,6 +78,10 @@ class MythHTTPSocket : public QObject
     int64_t         m_totalSent      { 0 };
     QElapsedTimer   m_writeTime;
     HTTPData        m_writeBuffer    { nullptr };
+    // Plain sockets only (zero-copy file transfers)
+    QSocketNotifier* m_writeNotifier { nullptr };
+    QByteArray      m_rawPending;
+    int64_t         m_chunkLeft      { 0 };
     MythHTTPConnection m_nextConnection { HTTPConnectionClose };
     MythSocketProtocol m_protocol    { ProtHTTP };
     // WebSockets only
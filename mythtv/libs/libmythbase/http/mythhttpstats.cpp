@@ -0,0 +1,69 @@
+// Std
+#include <algorithm>
+#include <vector>
+
+// MythTV
+#include "http/mythhttpstats.h"
+
+QMutex MythHTTPStats::s_lock;
+MythHTTPStats::Snapshot MythHTTPStats::s_current;
+std::array<std::chrono::microseconds,MythHTTPStats::kSamples> MythHTTPStats::s_samples {};
+
+/// Return the current figures, with percentiles of the most recent requests
+MythHTTPStats::Snapshot MythHTTPStats::Get()
+{
+    QMutexLocker locker(&s_lock);
+    Snapshot result = s_current;
+    size_t count = std::min<uint64_t>(s_current.m_requests, kSamples);
+    std::vector<std::chrono::microseconds> samples(s_samples.cbegin(), s_samples.cbegin() + count);
+    locker.unlock();
+
+    if (samples.empty())
+        return result;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](size_t Percent) { return samples[(samples.size() - 1) * Percent / 100]; };
+    result.m_p50 = percentile(50);
+    result.m_p90 = percentile(90);
+    result.m_p99 = percentile(99);
+    return result;
+}
+
+void MythHTTPStats::Connected(bool Connected)
+{
+    QMutexLocker locker(&s_lock);
+    if (Connected)
+        s_current.m_connections++;
+    else if (s_current.m_connections)
+        s_current.m_connections--;
+}
+
+void MythHTTPStats::Upgraded(bool Upgraded)
+{
+    QMutexLocker locker(&s_lock);
+    if (Upgraded)
+        s_current.m_websockets++;
+    else if (s_current.m_websockets)
+        s_current.m_websockets--;
+}
+
+void MythHTTPStats::SetThreads(size_t IOThreads, size_t Queued)
+{
+    QMutexLocker locker(&s_lock);
+    s_current.m_ioThreads = IOThreads;
+    s_current.m_queued    = Queued;
+}
+
+void MythHTTPStats::RequestStarted()
+{
+    QMutexLocker locker(&s_lock);
+    s_current.m_active++;
+}
+
+void MythHTTPStats::RequestFinished(std::chrono::nanoseconds Latency)
+{
+    QMutexLocker locker(&s_lock);
+    if (s_current.m_active)
+        s_current.m_active--;
+    s_samples[s_current.m_requests++ % kSamples] =
+        std::chrono::duration_cast<std::chrono::microseconds>(Latency);
+}
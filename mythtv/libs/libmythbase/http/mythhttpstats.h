@@ -0,0 +1,50 @@
+#ifndef MYTHHTTPSTATS_H
+#define MYTHHTTPSTATS_H
+
+// Std
+#include <array>
+#include <chrono>
+
+// Qt
+#include <QMutex>
+
+// MythTV
+#include "libmythbase/mythbaseexp.h"
+
+/*! \class MythHTTPStats
+ * \brief Load and latency figures for the HTTP server, for the Status service.
+ *
+ * Latency is measured from a request being parsed until its response is
+ * ready to send, which includes any time spent waiting for a worker thread.
+*/
+class MBASE_PUBLIC MythHTTPStats
+{
+  public:
+    struct Snapshot
+    {
+        size_t   m_connections   { 0 };
+        size_t   m_websockets    { 0 };
+        size_t   m_ioThreads     { 0 };
+        size_t   m_queued        { 0 }; ///< Connections waiting for an I/O thread
+        size_t   m_active        { 0 }; ///< Requests handed to a worker and not yet answered
+        uint64_t m_requests      { 0 };
+        std::chrono::microseconds m_p50 { 0 };
+        std::chrono::microseconds m_p90 { 0 };
+        std::chrono::microseconds m_p99 { 0 };
+    };
+
+    static Snapshot Get();
+    static void Connected(bool Connected);
+    static void Upgraded(bool Upgraded);
+    static void SetThreads(size_t IOThreads, size_t Queued);
+    static void RequestStarted();
+    static void RequestFinished(std::chrono::nanoseconds Latency);
+
+  private:
+    static constexpr size_t kSamples { 1024 };
+    static QMutex   s_lock;
+    static Snapshot s_current;
+    static std::array<std::chrono::microseconds,kSamples> s_samples;
+};
+
+#endif
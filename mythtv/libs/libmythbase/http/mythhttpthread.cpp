@@ -1,4 +1,11 @@
+// C++
+#include <algorithm>
+
+// Qt
+#include <QObject>
+
 // MythTV
+#include "mythlogging.h"
 #include "http/mythhttpthreadpool.h"
 #include "http/mythhttpserver.h"
 #include "http/mythhttpsocket.h"
@@ -6,41 +13,112 @@
 
 #define LOC (QString("%1: ").arg(objectName()))
 
-MythHTTPThread::MythHTTPThread(MythHTTPServer* Server, MythHTTPConfig Config,
-                               const QString& ThreadName, qintptr Socket, bool Ssl)
+MythHTTPThread::MythHTTPThread(MythHTTPServer* Server, const QString& ThreadName)
   : MThread(ThreadName),
-    m_server(Server),
-    m_config(std::move(Config)),
-    m_socketFD(Socket),
-    m_ssl(Ssl)
+    m_server(Server)
+{
+}
+
+/*! \brief Hand a new connection to this thread.
+ *
+ * \return false if the thread is already finishing, in which case the caller
+ * must find another one.
+*/
+bool MythHTTPThread::AddSocket(qintptr Socket, bool Ssl, const MythHTTPConfig& Config)
 {
+    QMutexLocker locker(&m_lock);
+    if (m_quitting)
+        return false;
+    m_pending.push_back({ Socket, Ssl, Config });
+    m_count++;
+    if (m_context)
+        QMetaObject::invokeMethod(m_context, [this]() { CreateSockets(); }, Qt::QueuedConnection);
+    return true;
 }
 
 void MythHTTPThread::run()
 {
     RunProlog();
-    m_socket = new MythHTTPSocket(m_socketFD, m_ssl, m_config);
-    QObject::connect(m_server, &MythHTTPServer::PathsChanged,    m_socket, &MythHTTPSocket::PathsChanged);
-    QObject::connect(m_server, &MythHTTPServer::HandlersChanged, m_socket, &MythHTTPSocket::HandlersChanged);
-    QObject::connect(m_server, &MythHTTPServer::ServicesChanged, m_socket, &MythHTTPSocket::ServicesChanged);
-    QObject::connect(m_server, &MythHTTPServer::HostsChanged,    m_socket, &MythHTTPSocket::HostsChanged);
-    QObject::connect(m_server, &MythHTTPServer::OriginsChanged,  m_socket, &MythHTTPSocket::OriginsChanged);
-    QObject::connect(m_socket, &MythHTTPSocket::ThreadUpgraded,  m_server, &MythHTTPServer::ThreadUpgraded);
+    {
+        QMutexLocker locker(&m_lock);
+        m_context = new QObject();
+    }
+    CreateSockets();
     exec();
-    delete m_socket;
-    m_socket = nullptr;
+    {
+        QMutexLocker locker(&m_lock);
+        m_quitting = true;
+        delete m_context;
+        m_context = nullptr;
+    }
+    for (auto * socket : m_sockets)
+        delete socket;
+    m_sockets.clear();
     RunEpilog();
 }
 
-/*! \brief Tell the socket to complete and disconnect.
+void MythHTTPThread::CreateSockets()
+{
+    std::vector<Pending> pending;
+    {
+        QMutexLocker locker(&m_lock);
+        pending.swap(m_pending);
+    }
+
+    for (auto & entry : pending)
+    {
+        auto * socket = new MythHTTPSocket(entry.m_socketFD, entry.m_ssl, entry.m_config);
+        QObject::connect(m_server, &MythHTTPServer::PathsChanged,    socket, &MythHTTPSocket::PathsChanged);
+        QObject::connect(m_server, &MythHTTPServer::HandlersChanged, socket, &MythHTTPSocket::HandlersChanged);
+        QObject::connect(m_server, &MythHTTPServer::ServicesChanged, socket, &MythHTTPSocket::ServicesChanged);
+        QObject::connect(m_server, &MythHTTPServer::HostsChanged,    socket, &MythHTTPSocket::HostsChanged);
+        QObject::connect(m_server, &MythHTTPServer::OriginsChanged,  socket, &MythHTTPSocket::OriginsChanged);
+        QObject::connect(socket, &MythHTTPSocket::ThreadUpgraded,    m_server, &MythHTTPServer::ThreadUpgraded);
+        // Queued, so that the socket is never deleted from within its own slots
+        QObject::connect(socket, &MythHTTPSocket::Closed, socket, [this, socket]() { SocketClosed(socket); },
+                         Qt::QueuedConnection);
+        m_sockets.push_back(socket);
+        // The socket may have refused the connection already
+        socket->CheckClosed();
+    }
+}
+
+void MythHTTPThread::SocketClosed(MythHTTPSocket* Socket)
+{
+    auto found = std::find(m_sockets.begin(), m_sockets.end(), Socket);
+    if (found == m_sockets.end())
+        return;
+    m_sockets.erase(found);
+    Socket->deleteLater();
+
+    {
+        QMutexLocker locker(&m_lock);
+        if (--m_count == 0 && m_pending.empty())
+        {
+            m_quitting = true;
+            quit();
+            return;
+        }
+    }
+
+    // There is room for a connection that is waiting
+    emit m_server->ProcessTCPQueue();
+}
+
+/*! \brief Tell the sockets to complete and disconnect.
  *
  * We use this mechanism as QThread::quit is a slot and we cannot use it to trigger
- * disconnection (and finished is too late for our needs). So tell the socket to
- * cleanup and close - and once the socket is disconnected it will trigger a call
- * to QThread::quit().
+ * disconnection (and finished is too late for our needs). So tell the sockets to
+ * cleanup and close - and once the last socket is closed the thread will quit.
 */
 void MythHTTPThread::Quit()
 {
-    if (m_socket)
-        emit m_socket->Finish();
+    QMutexLocker locker(&m_lock);
+    if (!m_context)
+        return;
+    QMetaObject::invokeMethod(m_context, [this]()
+    {
+        for (auto * socket : m_sockets)
+            emit socket->Finish();
+    }, Qt::QueuedConnection);
 }
@@ -1,32 +1,60 @@
 #ifndef MYTHHTTPTHREAD_H
 #define MYTHHTTPTHREAD_H
 
+// Std
+#include <atomic>
+#include <list>
+#include <vector>
+
+// Qt
+#include <QMutex>
+
 // MythTV
 #include "libmythbase/http/mythhttptypes.h"
 #include "libmythbase/mthread.h"
 
+class QObject;
 class MythHTTPSocket;
 class MythHTTPServer;
 class MythHTTPThreadPool;
 
+/*! \class MythHTTPThread
+ * \brief An event loop that serves any number of connections.
+ *
+ * Sockets are added from the server's thread and live in this thread until
+ * they close. The thread finishes once its last socket has gone.
+*/
 class MythHTTPThread : public MThread
 {
   public:
-    MythHTTPThread(MythHTTPServer* Server, MythHTTPConfig Config,
-                   const QString& ThreadName, qintptr Socket, bool Ssl);
-    void Quit();
+    MythHTTPThread(MythHTTPServer* Server, const QString& ThreadName);
+    bool   AddSocket(qintptr Socket, bool Ssl, const MythHTTPConfig& Config);
+    size_t SocketCount() const { return m_count; }
+    void   Quit();
 
   protected:
     void run() override;
 
   private:
     Q_DISABLE_COPY(MythHTTPThread)
+    void CreateSockets();
+    void SocketClosed(MythHTTPSocket* Socket);
+
+    struct Pending
+    {
+        qintptr        m_socketFD { 0 };
+        bool           m_ssl      { false };
+        MythHTTPConfig m_config;
+    };
 
-    MythHTTPServer* m_server { nullptr };
-    MythHTTPConfig  m_config;
-    qintptr         m_socketFD { 0 };
-    MythHTTPSocket* m_socket { nullptr };
-    bool            m_ssl    { false };
+    MythHTTPServer*       m_server   { nullptr };
+    QMutex                m_lock;
+    std::vector<Pending>  m_pending;
+    QObject*              m_context  { nullptr };
+    bool                  m_quitting { false };
+    std::atomic<size_t>   m_count    { 0 };
+    // Only used in this thread
+    std::list<MythHTTPSocket*> m_sockets;
 };
 
 #endif
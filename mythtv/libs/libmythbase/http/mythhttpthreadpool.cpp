@@ -7,13 +7,13 @@
 
 MythHTTPThreadPool::MythHTTPThreadPool()
 {
-    // Number of connections processed concurrently
-    m_maxThreads = static_cast<size_t>(std::max(QThread::idealThreadCount() * 2, 4));
-
-    // Don't allow more connections than we can process, it causes browsers
-    // to open lots of new connections instead of reusing existing ones
-    setMaxPendingConnections(static_cast<int>(m_maxThreads));
-    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Using maximum %1 threads").arg(m_maxThreads));
+    // Number of threads serving connections. Each thread multiplexes many
+    // connections, and requests are processed on a separate worker pool, so
+    // idle keep-alive connections no longer hold a thread each.
+    m_maxThreads = static_cast<size_t>(std::max(QThread::idealThreadCount(), 2));
+    setMaxPendingConnections(static_cast<int>(m_maxThreads * m_maxSockets));
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Using maximum %1 threads of %2 connections")
+        .arg(m_maxThreads).arg(m_maxSockets));
 }
 
 MythHTTPThreadPool::~MythHTTPThreadPool()
@@ -26,13 +26,6 @@ MythHTTPThreadPool::~MythHTTPThreadPool()
     }
 }
 
-size_t MythHTTPThreadPool::AvailableThreads() const
-{
-    if (m_upgradedThreads.size() > m_threads.size())
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Threadpool error: upgraded count is higher than total");
-    return m_maxThreads - (m_threads.size() - m_upgradedThreads.size());
-}
-
 size_t MythHTTPThreadPool::MaxThreads() const
 {
     return m_maxThreads;
@@ -49,6 +42,18 @@ void MythHTTPThreadPool::AddThread(MythHTTPThread *Thread)
         m_threads.emplace_back(Thread);
 }
 
+/// Return the thread with the fewest connections, if any has room for another
+MythHTTPThread* MythHTTPThreadPool::LeastLoaded() const
+{
+    MythHTTPThread* result = nullptr;
+    for (auto * thread : m_threads)
+        if (!result || (thread->SocketCount() < result->SocketCount()))
+            result = thread;
+    if (result && (result->SocketCount() >= m_maxSockets))
+        return nullptr;
+    return result;
+}
+
 void MythHTTPThreadPool::ThreadFinished()
 {
     auto * qthread = dynamic_cast<QThread*>(sender());
@@ -60,12 +65,6 @@ void MythHTTPThreadPool::ThreadFinished()
         return;
     }
 
-    // Remove from list of upgraded threads if necessary
-    auto upgraded = std::find_if(m_upgradedThreads.cbegin(), m_upgradedThreads.cend(),
-            [&qthread](MythHTTPThread* Thread) { return Thread->qthread() == qthread; });
-    if (upgraded != m_upgradedThreads.cend())
-        m_upgradedThreads.erase(upgraded);
-
     LOG(VB_HTTP, LOG_INFO, LOC + QString("Deleting thread '%1'").arg((*found)->objectName()));
     delete *found;
     m_threads.erase(found);
@@ -73,27 +72,7 @@ void MythHTTPThreadPool::ThreadFinished()
 
 void MythHTTPThreadPool::ThreadUpgraded(QThread* Thread)
 {
-    auto found = std::find_if(m_threads.cbegin(), m_threads.cend(),
-            [&Thread](MythHTTPThread* QThread) { return QThread->qthread() == Thread; });
-    if (found == m_threads.cend())
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unknown thread '%1' upgraded").arg(Thread->objectName()));
-        return;
-    }
-
-    m_upgradedThreads.emplace_back(*found);
-    auto standard = m_threads.size() - m_upgradedThreads.size();
-    auto upgraded = m_upgradedThreads.size();
-    LOG(VB_HTTP, LOG_INFO, LOC + QString("Thread '%1' upgraded (Standard:%2 Upgraded:%3)")
-        .arg(Thread->objectName()).arg(standard).arg(upgraded));
-
-    // There is no reasonable way of limiting the number of upgraded sockets (i.e.
-    // websockets) as we have no way of knowing what the client intends to use the
-    // socket for when connecting. On the other hand, if we there are a sizeable
-    // number of valid clients - do we want to restrict the number of connections...
-    if (upgraded > m_maxThreads)
-    {
-        LOG(VB_GENERAL, LOG_WARNING, LOC + QString("%1 upgraded sockets - notional max is %2")
-            .arg(upgraded).arg(m_maxThreads));
-    }
+    // WebSockets are long lived but cost no more than any other connection,
+    // so there is no need to limit them separately
+    LOG(VB_HTTP, LOG_INFO, LOC + QString("Socket on thread '%1' upgraded").arg(Thread->objectName()));
 }
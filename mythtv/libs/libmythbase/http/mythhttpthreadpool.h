@@ -14,10 +14,10 @@ class MythHTTPThreadPool : public ServerPool
     MythHTTPThreadPool();
    ~MythHTTPThreadPool() override;
 
-    size_t AvailableThreads() const;
     size_t MaxThreads() const;
     size_t ThreadCount() const;
     void   AddThread(MythHTTPThread* Thread);
+    MythHTTPThread* LeastLoaded() const;
 
   public slots:
     void   ThreadFinished();
@@ -26,8 +26,8 @@ class MythHTTPThreadPool : public ServerPool
   private:
     Q_DISABLE_COPY(MythHTTPThreadPool)
     size_t m_maxThreads { 4 };
+    size_t m_maxSockets { 256 };
     std::list<MythHTTPThread*> m_threads;
-    std::list<MythHTTPThread*> m_upgradedThreads;
 };
 
 #endif
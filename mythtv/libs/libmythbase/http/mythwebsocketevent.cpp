@@ -1,4 +1,11 @@
+// Qt
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+// MythTV
 #include "http/mythwebsocketevent.h"
+#include "http/mythwebsockettopics.h"
 #include "mythcorecontext.h"
 #include "mythlogging.h"
 
@@ -6,11 +13,14 @@ MythWebSocketEvent::MythWebSocketEvent()
 {
     setObjectName("MythWebSocketEvent");
     gCoreContext->addListener(this);
+    connect(MythWebSocketTopics::Instance(), &MythWebSocketTopics::TopicChanged,
+            this, &MythWebSocketEvent::TopicChanged);
 }
 
 MythWebSocketEvent::~MythWebSocketEvent()
 {
     gCoreContext->removeListener(this);
+    Unsubscribe(m_topics);
 }
 
 bool MythWebSocketEvent::HandleRawTextMessage(const DataPayloads& Payloads)
@@ -52,10 +62,80 @@ bool MythWebSocketEvent::HandleTextMessage(const StringPayload& Text)
         QString filterString = m_filters.join(", ");
         LOG(VB_HTTP, LOG_NOTICE, QString("WebSocketMythEvent: Updated filters (%1)").arg(filterString));
     }
+    else if (tokens[0] == "WS_SUBSCRIBE")
+    {
+        Subscribe(tokens.mid(1));
+    }
+    else if (tokens[0] == "WS_UNSUBSCRIBE")
+    {
+        // No topics means all of them
+        Unsubscribe(tokens.length() == 1 ? m_topics : tokens.mid(1));
+    }
+    else if (tokens[0] == "WS_SET_FORMAT" && tokens.length() > 1)
+    {
+        m_cbor = tokens[1].compare("CBOR", Qt::CaseInsensitive) == 0;
+        LOG(VB_HTTP, LOG_NOTICE, QString("WebSocketMythEvent: Sending topics as %1")
+            .arg(m_cbor ? "CBOR" : "JSON"));
+    }
 
     return false;
 }
 
+/*! \brief Start sending the state of Topics, and then what changes.
+ *
+ * With no topics, the client is told which topics there are.
+*/
+void MythWebSocketEvent::Subscribe(const QStringList& Topics)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    if (Topics.isEmpty())
+    {
+        SendTopicMessage({{ "topics", QJsonArray::fromStringList(topics->Topics()) }});
+        return;
+    }
+
+    for (const auto & topic : std::as_const(Topics))
+    {
+        if (m_topics.contains(topic))
+            continue;
+        QJsonObject message;
+        if (!topics->Subscribe(topic, message))
+        {
+            SendTopicMessage({{ "topic", topic }, { "error", "Unknown topic" }});
+            continue;
+        }
+        m_topics.append(topic);
+        LOG(VB_HTTP, LOG_NOTICE, QString("WebSocketMythEvent: Subscribed to %1").arg(topic));
+        if (!message.isEmpty())
+            SendTopicMessage(message);
+    }
+}
+
+void MythWebSocketEvent::Unsubscribe(const QStringList& Topics)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    // Topics may be m_topics itself
+    for (const auto & topic : QStringList(Topics))
+    {
+        if (m_topics.removeOne(topic))
+            topics->Unsubscribe(topic);
+    }
+}
+
+void MythWebSocketEvent::TopicChanged(const QString& Topic, const QJsonObject& Message)
+{
+    if (m_topics.contains(Topic))
+        SendTopicMessage(Message);
+}
+
+void MythWebSocketEvent::SendTopicMessage(const QJsonObject& Message)
+{
+    if (m_cbor)
+        emit SendBinaryMessage(QCborValue::fromJsonValue(Message).toCbor());
+    else
+        emit SendTextMessage(QString::fromUtf8(QJsonDocument(Message).toJson(QJsonDocument::Compact)));
+}
+
 void MythWebSocketEvent::customEvent(QEvent* event)
 {
     if (event->type() == MythEvent::kMythEventMessage)
@@ -1,3 +1,4 @@
+#include <QJsonObject>
 #include <QObject>
 #include <QString>
 
@@ -21,7 +22,16 @@ class MythWebSocketEvent : public QObject
         void SendTextMessage(const QString &);
         void SendBinaryMessage(const QByteArray &);
 
+    private slots:
+        void TopicChanged(const QString& Topic, const QJsonObject& Message);
+
     private:
+        void Subscribe  (const QStringList& Topics);
+        void Unsubscribe(const QStringList& Topics);
+        void SendTopicMessage(const QJsonObject& Message);
+
         QStringList m_filters;
         bool        m_sendEvents {false}; /// True if the client has enabled events
+        QStringList m_topics;             /// Topics the client has subscribed to
+        bool        m_cbor       {false}; /// True if topics are sent as CBOR
 };
@@ -0,0 +1,255 @@
+// Qt
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QRunnable>
+
+// MythTV
+#include "mythchrono.h"
+#include "mythcorecontext.h"
+#include "mythevent.h"
+#include "mythlogging.h"
+#include "mthreadpool.h"
+#include "http/mythwebsockettopics.h"
+
+#define LOC QString("WSTopics: ")
+
+/// Events tend to come in bursts; wait this long for the rest of them
+static constexpr std::chrono::milliseconds kCoalesce { 1s };
+
+namespace
+{
+class MythWebSocketTopicWork : public QRunnable
+{
+  public:
+    explicit MythWebSocketTopicWork(std::function<void()> Work) : m_work(std::move(Work)) {}
+    void run() override { m_work(); }
+
+  private:
+    std::function<void()> m_work;
+};
+}
+
+MythWebSocketTopics* MythWebSocketTopics::Instance()
+{
+    static QMutex s_lock;
+    static MythWebSocketTopics* s_instance = nullptr;
+    QMutexLocker locker(&s_lock);
+    if (!s_instance)
+    {
+        // Events are delivered to the main thread. The HTTP threads come and go.
+        s_instance = new MythWebSocketTopics();
+        if (QCoreApplication::instance())
+            s_instance->moveToThread(QCoreApplication::instance()->thread());
+        if (gCoreContext)
+            gCoreContext->addListener(s_instance);
+    }
+    return s_instance;
+}
+
+MythWebSocketTopics::MythWebSocketTopics()
+  : m_timer(new QTimer(this))
+{
+    setObjectName("MythWebSocketTopics");
+    m_timer->setInterval(1s);
+    connect(m_timer, &QTimer::timeout, this, &MythWebSocketTopics::Tick);
+}
+
+/*! \brief Add a topic that clients may subscribe to.
+ *
+ * \param Events   The (system) events after which Provider is called again.
+ * \param Interval How often to call Provider while there are subscribers, for
+ *                 state that no event reports. Zero if events are enough.
+ * \param Provider Returns the current state. It is called from a thread pool.
+*/
+void MythWebSocketTopics::Register(const QString& Topic, const QStringList& Events,
+                                   std::chrono::seconds Interval, const TopicProvider& Provider)
+{
+    auto * topics = Instance();
+    QMutexLocker locker(&topics->m_lock);
+    TopicState& topic = topics->m_topics[Topic];
+    topic.m_events   = Events;
+    topic.m_interval = Interval;
+    topic.m_provider = Provider;
+}
+
+QStringList MythWebSocketTopics::Topics()
+{
+    QMutexLocker locker(&m_lock);
+    return m_topics.keys();
+}
+
+/*! \brief Add a subscriber to Topic.
+ *
+ * Message is set to the current state of the topic if it is known. Otherwise
+ * it is left empty and the state is sent with TopicChanged once it is.
+ * \return False if there is no such topic.
+*/
+bool MythWebSocketTopics::Subscribe(const QString& Topic, QJsonObject& Message)
+{
+    QMutexLocker locker(&m_lock);
+    auto it = m_topics.find(Topic);
+    if (it == m_topics.end())
+        return false;
+
+    if (it->m_valid)
+    {
+        Message = {{ "topic", Topic }, { "snapshot", it->m_state }};
+    }
+    else if (it->m_subscribers == 0)
+    {
+        QMetaObject::invokeMethod(this, [this, Topic]() { Refresh(Topic); },
+                                  Qt::QueuedConnection);
+    }
+    it->m_subscribers++;
+    return true;
+}
+
+void MythWebSocketTopics::Unsubscribe(const QString& Topic)
+{
+    QMutexLocker locker(&m_lock);
+    auto it = m_topics.find(Topic);
+    if (it == m_topics.end() || it->m_subscribers < 1)
+        return;
+
+    // Forget the state of a topic no-one is watching, rather than keep it current
+    if (--it->m_subscribers == 0)
+    {
+        it->m_valid = false;
+        it->m_state = QJsonObject();
+    }
+}
+
+void MythWebSocketTopics::customEvent(QEvent* Event)
+{
+    if (Event->type() != MythEvent::kMythEventMessage)
+        return;
+    auto * event = dynamic_cast<MythEvent*>(Event);
+    if (!event)
+        return;
+
+    // System events are named by their second word
+    QString message = event->Message();
+    QString name = message.section(' ', 0, 0);
+    if (name == "SYSTEM_EVENT")
+        name = message.section(' ', 1, 1);
+    Changed(name);
+}
+
+void MythWebSocketTopics::Changed(const QString& Event)
+{
+    QMutexLocker locker(&m_lock);
+    for (auto it = m_topics.begin(); it != m_topics.end(); ++it)
+    {
+        if (it->m_subscribers < 1 || it->m_pending || !it->m_events.contains(Event))
+            continue;
+        it->m_pending = true;
+        QTimer::singleShot(kCoalesce, this, [this, topic = it.key()]() { Refresh(topic); });
+    }
+}
+
+/// Call the provider of Topic, unless it is already running.
+void MythWebSocketTopics::Refresh(const QString& Topic)
+{
+    QMutexLocker locker(&m_lock);
+    auto it = m_topics.find(Topic);
+    if (it == m_topics.end())
+        return;
+
+    it->m_pending = false;
+    if (it->m_subscribers < 1)
+        return;
+    if (it->m_busy)
+    {
+        it->m_again = true;
+        return;
+    }
+
+    it->m_busy = true;
+    if (it->m_interval > 0s && !m_timer->isActive())
+        m_timer->start();
+
+    auto * work = new MythWebSocketTopicWork([this, Topic, provider = it->m_provider]()
+    {
+        QJsonObject state = provider();
+        QMetaObject::invokeMethod(this, [this, Topic, state]() { Update(Topic, state); },
+                                  Qt::QueuedConnection);
+    });
+    MThreadPool::globalInstance()->start(work, "WSTopic");
+}
+
+/// Send whatever changed in Topic to its subscribers.
+void MythWebSocketTopics::Update(const QString& Topic, const QJsonObject& State)
+{
+    QJsonObject message;
+    {
+        QMutexLocker locker(&m_lock);
+        auto it = m_topics.find(Topic);
+        if (it == m_topics.end())
+            return;
+
+        it->m_busy = false;
+        it->m_updated.start();
+        if (it->m_again)
+        {
+            it->m_again = false;
+            QMetaObject::invokeMethod(this, [this, Topic]() { Refresh(Topic); },
+                                      Qt::QueuedConnection);
+        }
+        if (it->m_subscribers < 1)
+            return;
+
+        if (!it->m_valid)
+        {
+            message = {{ "topic", Topic }, { "snapshot", State }};
+        }
+        else
+        {
+            QJsonObject changed;
+            QJsonArray removed;
+            for (auto item = State.constBegin(); item != State.constEnd(); ++item)
+            {
+                auto old = it->m_state.constFind(item.key());
+                if (old == it->m_state.constEnd() || old.value() != item.value())
+                    changed.insert(item.key(), item.value());
+            }
+            for (auto item = it->m_state.constBegin(); item != it->m_state.constEnd(); ++item)
+                if (!State.contains(item.key()))
+                    removed.append(item.key());
+
+            if (changed.isEmpty() && removed.isEmpty())
+                return;
+            message = {{ "topic", Topic }};
+            if (!changed.isEmpty())
+                message.insert("changed", changed);
+            if (!removed.isEmpty())
+                message.insert("removed", removed);
+        }
+        it->m_valid = true;
+        it->m_state = State;
+    }
+
+    LOG(VB_HTTP, LOG_DEBUG, LOC + QString("'%1' changed").arg(Topic));
+    emit TopicChanged(Topic, message);
+}
+
+/// Look again at the topics that are not reported by events.
+void MythWebSocketTopics::Tick()
+{
+    QMutexLocker locker(&m_lock);
+    bool polling = false;
+    for (auto it = m_topics.begin(); it != m_topics.end(); ++it)
+    {
+        if (it->m_subscribers < 1 || it->m_interval <= 0s)
+            continue;
+        polling = true;
+        if (it->m_pending || it->m_busy || !it->m_updated.isValid() ||
+            !it->m_updated.hasExpired(std::chrono::milliseconds(it->m_interval).count()))
+            continue;
+        it->m_pending = true;
+        QMetaObject::invokeMethod(this, [this, topic = it.key()]() { Refresh(topic); },
+                                  Qt::QueuedConnection);
+    }
+
+    if (!polling)
+        m_timer->stop();
+}
@@ -0,0 +1,81 @@
+#ifndef MYTHWEBSOCKETTOPICS_H
+#define MYTHWEBSOCKETTOPICS_H
+
+// Std
+#include <chrono>
+#include <functional>
+
+// Qt
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+// MythTV
+#include "libmythbase/mythbaseexp.h"
+
+using TopicProvider = std::function<QJsonObject()>;
+
+/*! \class MythWebSocketTopics
+ * \brief State that WebSocket clients can subscribe to, instead of polling.
+ *
+ * An application registers each topic with a function that returns its
+ * current state, as a JSON object with one entry per item (an input, a
+ * recording...), the events that may change it and, for state that no event
+ * reports, how often to look again. A topic is only looked at while someone is
+ * subscribed to it, and then once per change however many are. Subscribers
+ * are sent the whole state first, and then only the items that changed:
+ * \code
+ *   {"topic":"encoders","snapshot":{"1":{...},"2":{...}}}
+ *   {"topic":"encoders","changed":{"2":{...}},"removed":["1"]}
+ * \endcode
+*/
+class MBASE_PUBLIC MythWebSocketTopics : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static MythWebSocketTopics* Instance();
+    static void Register(const QString& Topic, const QStringList& Events,
+                         std::chrono::seconds Interval, const TopicProvider& Provider);
+    QStringList Topics();
+    bool Subscribe  (const QString& Topic, QJsonObject& Message);
+    void Unsubscribe(const QString& Topic);
+
+  signals:
+    void TopicChanged(const QString& Topic, const QJsonObject& Message);
+
+  protected:
+    void customEvent(QEvent* Event) override;
+
+  private:
+    Q_DISABLE_COPY(MythWebSocketTopics)
+    MythWebSocketTopics();
+    void Changed(const QString& Event);
+    void Refresh(const QString& Topic);
+    void Update (const QString& Topic, const QJsonObject& State);
+    void Tick   ();
+
+    struct TopicState
+    {
+        QStringList   m_events;
+        std::chrono::seconds m_interval { 0 };
+        TopicProvider m_provider;
+        int           m_subscribers { 0 };
+        bool          m_valid   { false }; ///< m_state is current for the subscribers
+        bool          m_pending { false }; ///< A refresh is scheduled
+        bool          m_busy    { false }; ///< m_provider is running
+        bool          m_again   { false }; ///< Something changed while it was running
+        QJsonObject   m_state;
+        QElapsedTimer m_updated;
+    };
+
+    QMutex              m_lock;
+    QHash<QString,TopicState> m_topics;
+    QTimer*             m_timer { nullptr };
+};
+
+#endif
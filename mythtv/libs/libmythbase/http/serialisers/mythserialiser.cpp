@@ -1,30 +1,101 @@
 // Qt
+#include <QDir>
 #include <QMetaProperty>
 // MythTV
 #include "mythlogging.h"
 #include "http/mythmimedatabase.h"
 #include "http/mythhttpdata.h"
+#include "http/mythhttpencoding.h"
+#include "http/mythhttpfile.h"
 #include "http/serialisers/mythxmlserialiser.h"
 #include "http/serialisers/mythxmlplistserialiser.h"
 #include "http/serialisers/mythjsonserialiser.h"
 #include "http/serialisers/mythcborserialiser.h"
 #include "http/serialisers/mythserialiser.h"
 
-MythSerialiser::MythSerialiser()
-  : m_result(MythHTTPData::Create())
+#define LOC QString("Serialiser: ")
+
+/// Results larger than this are written to disk
+static constexpr int64_t kSpoolSize { INT64_C(1048576) };
+// Results this large are sent chunked rather than gzipped, whether they are
+// in memory or on disk, so spooling never changes how a result is encoded
+static_assert(kSpoolSize > MythHTTPEncoding::kMaxCompressSize);
+
+MythSerialiserBuffer::MythSerialiserBuffer()
+  : m_data(MythHTTPData::Create())
 {
-    m_buffer.setBuffer(static_cast<QByteArray*>(m_result.get()));
-    m_buffer.open(QIODevice::WriteOnly);
+    open(QIODevice::WriteOnly);
 }
 
-HTTPData MythSerialiser::Result()
+qint64 MythSerialiserBuffer::writeData(const char* Data, qint64 Size)
 {
-    return m_result;
+    if (!m_file && !m_noSpool && ((m_data->size() + Size) > kSpoolSize))
+    {
+        auto file = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/mythserialiser.XXXXXX");
+        if (file->open() && (file->write(*m_data) == m_data->size()))
+        {
+            // The ETag of a result is a hash of its content, wherever it is kept
+            m_hash.addData(*m_data);
+            m_data->clear();
+            m_data->squeeze();
+            m_file = std::move(file);
+        }
+        else
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC + "Failed to create temporary file");
+            m_noSpool = true;
+        }
+    }
+
+    if (m_file)
+    {
+#if QT_VERSION < QT_VERSION_CHECK(6,0,0)
+        m_hash.addData(Data, static_cast<int>(Size));
+#else
+        m_hash.addData(QByteArrayView(Data, Size));
+#endif
+        return m_file->write(Data, Size);
+    }
+
+    m_data->append(Data, static_cast<int>(Size));
+    return Size;
+}
+
+/*! \brief Return the result in memory, or as a file to be sent from disk.
+ *
+ * \note The temporary file is handed over to the file returned, which removes
+ * it once it has been sent and closed.
+*/
+HTTPVariant MythSerialiserBuffer::Result()
+{
+    if (!m_file)
+        return m_data;
+
+    QString name = m_file->fileName();
+    m_file->setAutoRemove(false);
+    m_file->close();
+    m_file.reset();
+
+    auto result = MythHTTPFile::CreateTemporary(name);
+    if (!result->open(QIODevice::ReadOnly))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to open '%1'").arg(name));
+        return MythHTTPData::Create();
+    }
+    result->m_etag = m_hash.result().toHex();
+    return result;
+}
+
+MythSerialiser::MythSerialiser() = default;
+
+HTTPVariant MythSerialiser::Result()
+{
+    return m_buffer.Result();
 }
 
 /*! \brief Serialise the given data with an encoding suggested by Accept
 */
-HTTPData MythSerialiser::Serialise(const QString &Name, const QVariant& Value, const QStringList &Accept)
+HTTPVariant MythSerialiser::Serialise(const QString &Name, const QVariant& Value, const QStringList &Accept)
 {
     /*
     auto types = MythMimeDatabase().AllTypes();
@@ -40,11 +111,19 @@ HTTPData MythSerialiser::Serialise(const QString &Name, const QVariant& Value, c
     static const MythMimeType s_xmlPList = MythMimeDatabase::MimeTypeForName("text/x-apple-plist+xml");
     static const MythMimeType s_cbor = MythMimeDatabase::MimeTypeForName("application/cbor");
 
-    auto WrapData = [](HTTPData Data, const MythMimeType& Mime, const QString& Alias)
+    auto WrapData = [](HTTPVariant Data, const MythMimeType& Mime, const QString& Alias)
     {
-        Data->m_fileName = "result." + Mime.Suffix();
-        Data->m_mimeType = Mime;
-        Data->m_mimeType.SetAlias(Alias);
+        MythHTTPContent * content = nullptr;
+        if (auto * data = std::get_if<HTTPData>(&Data))
+            content = data->get();
+        else if (auto * file = std::get_if<HTTPFile>(&Data))
+            content = file->get();
+        if (content)
+        {
+            content->m_fileName = "result." + Mime.Suffix();
+            content->m_mimeType = Mime;
+            content->m_mimeType.SetAlias(Alias);
+        }
         return Data;
     };
 
@@ -112,21 +191,29 @@ HTTPData MythSerialiser::Serialise(const QString &Name, const QVariant& Value, c
         for (const auto & jsontype : s_jsonTypes)
         {
             if (const auto & alias = jsontype.Aliases().indexOf(mime); alias >= 0)
-                if (MythJSONSerialiser json(Name, Value); json.Result() != nullptr)
-                    return WrapData(json.Result(), jsontype, jsontype.Aliases().at(alias));
+            {
+                MythJSONSerialiser json(Name, Value);
+                return WrapData(json.Result(), jsontype, jsontype.Aliases().at(alias));
+            }
         }
 
         if (const auto & alias = s_xmlType.Aliases().indexOf(mime); alias >= 0)
-            if (MythXMLSerialiser xml(Name, Value); xml.Result() != nullptr)
-                return WrapData(xml.Result(), s_xmlType, s_xmlType.Aliases().at(alias));
+        {
+            MythXMLSerialiser xml(Name, Value);
+            return WrapData(xml.Result(), s_xmlType, s_xmlType.Aliases().at(alias));
+        }
 
         if (const auto & alias = s_xmlPList.Aliases().indexOf(mime); alias >= 0)
-            if (MythXMLPListSerialiser plist(Name, Value); plist.Result() != nullptr)
-                return WrapData(plist.Result(), s_xmlPList, s_xmlPList.Aliases().at(alias));
+        {
+            MythXMLPListSerialiser plist(Name, Value);
+            return WrapData(plist.Result(), s_xmlPList, s_xmlPList.Aliases().at(alias));
+        }
 
         if (const auto & alias = s_cbor.Aliases().indexOf(mime); alias >= 0)
-            if (MythCBORSerialiser cbor(Name, Value); cbor.Result() != nullptr)
-                return WrapData(cbor.Result(), s_cbor, s_cbor.Aliases().at(alias));
+        {
+            MythCBORSerialiser cbor(Name, Value);
+            return WrapData(cbor.Result(), s_cbor, s_cbor.Aliases().at(alias));
+        }
     }
 
     // Default to XML
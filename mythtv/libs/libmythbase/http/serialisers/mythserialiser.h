@@ -2,25 +2,58 @@
 #define MYTHSERIALISER_H
 
 // Qt
-#include <QBuffer>
+#include <QCryptographicHash>
+#include <QIODevice>
 #include <QMimeType>
+#include <QTemporaryFile>
 
 // MythTV
 #include "http/mythmimetype.h"
 #include "http/mythhttpdata.h"
 
+// Std
+#include <memory>
+
 using HTTPMimes = std::vector<MythMimeType>;
 
+/*! \class MythSerialiserBuffer
+ * \brief Where a serialiser writes its output.
+ *
+ * Results are kept in memory until they grow large, after which everything
+ * written so far, and everything that follows, goes to a temporary file that
+ * is then sent with the file response code (chunked, and with sendfile() where
+ * available).
+ *
+ * This only saves the memory and copies of the rendered output. The service
+ * has already built its whole result before it is serialised.
+*/
+class MythSerialiserBuffer : public QIODevice
+{
+  public:
+    MythSerialiserBuffer();
+    HTTPVariant Result();
+
+  protected:
+    qint64 readData(char* /*Data*/, qint64 /*MaxSize*/) override { return -1; }
+    qint64 writeData(const char* Data, qint64 Size) override;
+
+  private:
+    Q_DISABLE_COPY(MythSerialiserBuffer)
+    HTTPData                        m_data  { nullptr };
+    std::unique_ptr<QTemporaryFile> m_file  { nullptr };
+    QCryptographicHash              m_hash  { QCryptographicHash::Sha224 };
+    bool                            m_noSpool { false };
+};
+
 class MythSerialiser
 {
   public:
-    static HTTPData Serialise(const QString& Name, const QVariant& Value, const QStringList& Accept);
+    static HTTPVariant Serialise(const QString& Name, const QVariant& Value, const QStringList& Accept);
     MythSerialiser();
-    HTTPData Result();
+    HTTPVariant Result();
 
   protected:
-    QBuffer  m_buffer;
-    HTTPData m_result { nullptr };
+    MythSerialiserBuffer m_buffer;
 };
 
 #endif
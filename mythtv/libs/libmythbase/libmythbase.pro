@@ -102,6 +102,7 @@ HEADERS += http/mythhttpthread.h
 HEADERS += http/mythhttpthreadpool.h
 HEADERS += http/mythhttpsocket.h
 HEADERS += http/mythwebsocketevent.h
+HEADERS += http/mythwebsockettopics.h
 HEADERS += http/mythwebsockettypes.h
 HEADERS += http/mythwebsocket.h
 HEADERS += http/mythhttpparser.h
@@ -112,7 +113,10 @@ HEADERS += http/mythhttpencoding.h
 HEADERS += http/mythhttprewrite.h
 HEADERS += http/mythhttproot.h
 HEADERS += http/mythhttpranges.h
+HEADERS += http/mythhttpreadcache.h
 HEADERS += http/mythhttpcache.h
+HEADERS += http/mythhttpservicecache.h
+HEADERS += http/mythhttpstats.h
 HEADERS += http/mythhttpservice.h
 HEADERS += http/mythhttpmetaservice.h
 HEADERS += http/mythhttpmetamethod.h
@@ -135,6 +139,7 @@ SOURCES += http/mythhttpthread.cpp
 SOURCES += http/mythhttpthreadpool.cpp
 SOURCES += http/mythhttpsocket.cpp
 SOURCES += http/mythwebsocketevent.cpp
+SOURCES += http/mythwebsockettopics.cpp
 SOURCES += http/mythwebsockettypes.cpp
 SOURCES += http/mythwebsocket.cpp
 SOURCES += http/mythhttpparser.cpp
@@ -145,7 +150,10 @@ SOURCES += http/mythhttpencoding.cpp
 SOURCES += http/mythhttprewrite.cpp
 SOURCES += http/mythhttproot.cpp
 SOURCES += http/mythhttpranges.cpp
+SOURCES += http/mythhttpreadcache.cpp
 SOURCES += http/mythhttpcache.cpp
+SOURCES += http/mythhttpservicecache.cpp
+SOURCES += http/mythhttpstats.cpp
 SOURCES += http/mythhttpservice.cpp
 SOURCES += http/mythhttpmetaservice.cpp
 SOURCES += http/mythhttpmetamethod.cpp
@@ -102,6 +102,8 @@ QString SkipTypeToString(int flags)
     bool logo  = (COMM_DETECT_LOGO  & flags) != 0;
     bool exp   = (COMM_DETECT_2     & flags) != 0;
     bool prePst= (COMM_DETECT_PREPOSTROLL & flags) != 0;
+    bool audio = (COMM_DETECT_AUDIO & flags) != 0;
+    bool known = (COMM_DETECT_FINGERPRINT & flags) != 0;
 
     if (blank && scene && logo)
         ret = QObject::tr("All Available Methods");
@@ -123,6 +125,13 @@ QString SkipTypeToString(int flags)
     else if(prePst)
         ret = QObject::tr("Pre & Post Roll") + ": " + ret;
 
+    QString audioRet = known ? QObject::tr("Known Commercials + Audio Analysis")
+                             : QObject::tr("Audio Analysis");
+    if ((audio || known) && !blank && !scene && !logo)
+        ret = audioRet;
+    else if (audio || known)
+        ret = QObject::tr("%1, then %2").arg(audioRet, ret);
+
     return ret;
 }
 
@@ -137,6 +146,12 @@ std::deque<int> GetPreferredSkipTypeCombinations(void)
     tmp.push_back(COMM_DETECT_2 | COMM_DETECT_BLANK | COMM_DETECT_LOGO);
     tmp.push_back(COMM_DETECT_PREPOSTROLL | COMM_DETECT_BLANK |
                   COMM_DETECT_SCENE);
+    tmp.push_back(COMM_DETECT_AUDIO);
+    tmp.push_back(COMM_DETECT_AUDIO | COMM_DETECT_BLANK | COMM_DETECT_SCENE |
+                  COMM_DETECT_LOGO);
+    tmp.push_back(COMM_DETECT_AUDIO_FINGERPRINT);
+    tmp.push_back(COMM_DETECT_AUDIO_FINGERPRINT | COMM_DETECT_BLANK |
+                  COMM_DETECT_SCENE | COMM_DETECT_LOGO);
     return tmp;
 }
 
@@ -147,7 +147,15 @@ enum SkipType : std::int16_t {
     COMM_DETECT_PREPOSTROLL = 0x00000200,
     COMM_DETECT_PREPOSTROLL_ALL = (COMM_DETECT_PREPOSTROLL
                                    | COMM_DETECT_BLANKS
-                                   | COMM_DETECT_SCENE)
+                                   | COMM_DETECT_SCENE),
+
+    /* Audio analysis first, then the other methods if it finds nothing. */
+    COMM_DETECT_AUDIO       = 0x00000400,
+    /* Audio analysis, also matching against and adding to the commercials *
+     * already seen in other recordings.                                   */
+    COMM_DETECT_FINGERPRINT = 0x00000800,
+    COMM_DETECT_AUDIO_FINGERPRINT = (COMM_DETECT_AUDIO |
+                                     COMM_DETECT_FINGERPRINT)
 };
 
 MBASE_PUBLIC QString SkipTypeToString(int flags);
@@ -1,9 +1,11 @@
+#include <array>
 #include <iostream>
 
 #include <QFile>
 #include <QFileInfo>
 #include <QRegularExpression>
 #include <QUrl>
+#include <QtEndian>
 
 // POSIX C headers
 #include <unistd.h>
@@ -29,6 +31,15 @@ static constexpr int8_t O_LARGEFILE { 0 };
 
 static constexpr std::chrono::milliseconds MAX_FILE_CHECK { 500ms };
 
+/// How far the backend may stream ahead of what has been read
+static constexpr int kStreamWindow { 4 * 1024 * 1024 };
+/// Credit is returned to the backend in pieces of at least this size
+static constexpr int kStreamCredit { kStreamWindow / 4 };
+static constexpr std::chrono::milliseconds kStreamTimeout { 10s };
+static constexpr qint32 kStreamEnd     {  0 };
+static constexpr qint32 kStreamError   { -1 };
+static constexpr qint32 kStreamStopped { -2 };
+
 static bool RemoteSendReceiveStringList(const QString &host, QStringList &strlist)
 {
     bool ok = false;
@@ -408,6 +419,10 @@ void RemoteFile::Close(bool haslock)
         m_controlSock->DecrRef();
         m_controlSock = nullptr;
     }
+    m_streaming     = false;
+    m_streamParked  = false;
+    m_streamFrame   = 0;
+    m_streamUnacked = 0;
 
     if (!haslock)
     {
@@ -753,7 +768,10 @@ void RemoteFile::Reset(void)
         LOG(VB_NETWORK, LOG_ERR, "RemoteFile::Reset(): Called with no socket");
         return;
     }
-    m_sock->Reset();
+    if (m_streaming)
+        StopStream();
+    else
+        m_sock->Reset();
 }
 
 long long RemoteFile::Seek(long long pos, int whence, long long curpos)
@@ -812,6 +830,8 @@ long long RemoteFile::SeekInternal(long long pos, int whence, long long curpos)
         return -1;
     }
 
+    StopStream();
+
     QStringList strlist( m_query.arg(m_recorderNum) );
     strlist << "SEEK";
     strlist << QString::number(pos);
@@ -965,6 +985,9 @@ int RemoteFile::Read(void *data, int size)
         return -1;
     }
 
+    if (m_streaming || (m_streamAllowed && m_useReadAhead && StartStream()))
+        return ReadStream(static_cast<char*>(data), size);
+
     if (m_sock->IsDataAvailable())
     {
         LOG(VB_NETWORK, LOG_ERR,
@@ -1087,6 +1110,180 @@ int RemoteFile::Read(void *data, int size)
     return recv;
 }
 
+/**
+ *  \brief Ask the backend to send the file ahead of Read(), instead of
+ *         waiting for each block to be requested. Must have lock
+ *  \return True if the backend is streaming the file
+ */
+bool RemoteFile::StartStream(void)
+{
+    QStringList strlist( m_query.arg(m_recorderNum) );
+    strlist << "STREAM_START";
+    strlist << QString::number(kStreamWindow);
+    if (!m_controlSock->SendReceiveStringList(strlist) || strlist.isEmpty())
+        return false;
+
+    if (strlist[0] != "OK")
+    {
+        // Older backends, and mythmediaserver, only answer REQUEST_BLOCK
+        LOG(VB_FILE, LOG_INFO, "RemoteFile: Streaming not available, requesting blocks");
+        m_streamAllowed = false;
+        return false;
+    }
+
+    m_streaming     = true;
+    m_streamParked  = false;
+    m_streamFrame   = 0;
+    m_streamUnacked = 0;
+    m_streamRead    = 0;
+    return true;
+}
+
+/**
+ *  \brief Read what the backend has streamed, waiting only for the first
+ *         bytes. Must have lock
+ */
+int RemoteFile::ReadStream(char *data, int size)
+{
+    // The backend waits at the end of the file until asked again
+    if (m_streamParked)
+    {
+        m_streamParked = false;
+        SendStreamCredit();
+    }
+
+    int recv = 0;
+    bool error = false;
+    while (recv < size)
+    {
+        if (m_streamFrame == 0)
+        {
+            // Return what has arrived rather than wait for more
+            if (recv > 0 && !m_sock->IsDataAvailable())
+                break;
+
+            std::array<char,sizeof(qint32)> header {};
+            if (m_sock->Read(header.data(), header.size(), kStreamTimeout) !=
+                static_cast<int>(header.size()))
+            {
+                error = true;
+                break;
+            }
+            qint32 length = qFromBigEndian<qint32>(header.data());
+            if (length == kStreamEnd || length == kStreamError)
+            {
+                m_streamParked = true;
+                if (length == kStreamError && recv == 0)
+                    recv = -1;
+                break;
+            }
+            if (length < 0)
+            {
+                error = true;
+                break;
+            }
+            m_streamFrame = length;
+        }
+
+        int ret = m_sock->Read(data + recv, std::min(size - recv, m_streamFrame),
+                               kStreamTimeout);
+        if (ret <= 0)
+        {
+            error = true;
+            break;
+        }
+        recv            += ret;
+        m_streamFrame   -= ret;
+        m_streamUnacked += ret;
+        m_streamRead    += ret;
+    }
+
+    if (error)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("RemoteFile::Read(): Stream failed after %1 of %2 bytes")
+            .arg(recv).arg(size));
+        m_lastPosition += recv;
+        // The TCP socket is dropped if there's a timeout, so we reconnect
+        if (!Resume())
+            LOG(VB_GENERAL, LOG_WARNING, "RemoteFile::Read(): Resume failed.");
+        return recv > 0 ? recv : -1;
+    }
+
+    if (m_streamUnacked >= kStreamCredit)
+        SendStreamCredit();
+    if (recv > 0)
+        m_lastPosition += recv;
+    return recv;
+}
+
+/**
+ *  \brief Let the backend send as much again as has been read. Must have lock
+ *
+ *  The backend keeps streaming the rest of the window while this waits for
+ *  its reply, so the round trip does not stall the data.
+ */
+void RemoteFile::SendStreamCredit(void)
+{
+    QStringList strlist( m_query.arg(m_recorderNum) );
+    strlist << "STREAM_CREDIT";
+    strlist << QString::number(m_streamUnacked);
+    if (!m_controlSock->SendReceiveStringList(strlist) || strlist.isEmpty() ||
+        strlist[0] != "OK")
+    {
+        LOG(VB_NETWORK, LOG_ERR, "RemoteFile: Stream credit was not accepted");
+    }
+    m_streamUnacked = 0;
+}
+
+/**
+ *  \brief End the stream, discarding what was sent that has not been read,
+ *         so that the backend is back at what has been. Must have lock
+ */
+void RemoteFile::StopStream(void)
+{
+    if (!m_streaming)
+        return;
+
+    m_streaming     = false;
+    m_streamParked  = false;
+    m_streamUnacked = 0;
+
+    QStringList strlist( m_query.arg(m_recorderNum) );
+    strlist << "STREAM_STOP";
+    strlist << QString::number(m_streamRead);
+    bool ok = m_controlSock->SendReceiveStringList(strlist) &&
+              !strlist.isEmpty() && strlist[0] == "OK";
+
+    // The stream ends with a frame of its own
+    std::vector<char> trash;
+    while (ok)
+    {
+        if (m_streamFrame == 0)
+        {
+            std::array<char,sizeof(qint32)> header {};
+            ok = m_sock->Read(header.data(), header.size(), kStreamTimeout) ==
+                 static_cast<int>(header.size());
+            qint32 length = qFromBigEndian<qint32>(header.data());
+            if (!ok || length == kStreamStopped)
+                break;
+            m_streamFrame = std::max(length, 0);
+            continue;
+        }
+        trash.resize(m_streamFrame);
+        int ret = m_sock->Read(trash.data(), m_streamFrame, kStreamTimeout);
+        ok = ret > 0;
+        m_streamFrame -= std::max(ret, 0);
+    }
+
+    if (!ok)
+    {
+        LOG(VB_NETWORK, LOG_ERR, "RemoteFile::StopStream(): Stream did not end");
+        m_sock->Reset();
+    }
+    m_streamFrame = 0;
+}
+
 /**
  * GetFileSize: returns the remote file's size at the time it was first opened
  * Will query the server in order to get the size. If file isn't being modified
@@ -72,6 +72,10 @@ class MBASE_PUBLIC RemoteFile
     bool IsConnected(void);
     bool Resume(bool repos = true);
     long long SeekInternal(long long pos, int whence, long long curpos = -1);
+    bool StartStream(void);
+    int  ReadStream(char *data, int size);
+    void SendStreamCredit(void);
+    void StopStream(void);
 
     MythSocket     *openSocket(bool control);
 
@@ -98,6 +102,13 @@ class MBASE_PUBLIC RemoteFile
     QStringList     m_auxFiles;
     int             m_localFile        {-1};
     ThreadedFileWriter *m_fileWriter   {nullptr};
+
+    bool            m_streamAllowed    {true};  ///< False if the backend can't stream
+    bool            m_streaming        {false};
+    bool            m_streamParked     {false}; ///< The backend waits at the end of the file
+    int             m_streamFrame      {0};     ///< Bytes left in the current frame
+    int             m_streamUnacked    {0};     ///< Bytes read since the last credit
+    long long       m_streamRead       {0};     ///< Bytes read since the stream started
 };
 
 #endif
@@ -0,0 +1,218 @@
+/*
+ *  Class TestMythHTTPReadCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <array>
+
+#include <QTemporaryDir>
+
+#include "http/mythhttpreadcache.h"
+#include "test_mythhttpreadcache.h"
+
+// The size of the blocks kept by the cache
+static constexpr int64_t kBlock { INT64_C(256) * 1024 };
+// Three whole blocks, and a short one that is never kept
+static constexpr int64_t kFileSize { (3 * kBlock) + 1000 };
+
+// Every byte says where it is, and in which file
+static QByteArray content(int64_t Offset, int64_t Size, char Seed = 0)
+{
+    QByteArray result(static_cast<int>(Size), Qt::Uninitialized);
+    for (int64_t i = 0; i < Size; ++i)
+    {
+        int64_t position = Offset + i;
+        result[static_cast<int>(i)] = static_cast<char>(((position * 7) + (position / kBlock) + Seed) & 0xff);
+    }
+    return result;
+}
+
+static bool write_file(const QString& Name, char Seed = 0)
+{
+    QFile file(Name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(content(0, kFileSize, Seed)) == kFileSize;
+}
+
+static QByteArray read(QFile& File, int64_t Offset, int64_t Size)
+{
+    QByteArray result(static_cast<int>(Size), '\0');
+    int64_t count = MythHTTPReadCache::Read(File, Offset, result.data(), Size);
+    result.resize(static_cast<int>(std::max(count, INT64_C(0))));
+    return result;
+}
+
+// called before each test case
+void TestMythHTTPReadCache::init(void)
+{
+    // Empties the cache
+    MythHTTPReadCache::Configure(0, 0);
+}
+
+// called at the end of these sets of tests
+void TestMythHTTPReadCache::cleanupTestCase(void)
+{
+    MythHTTPReadCache::Configure(0, 0);
+}
+
+void TestMythHTTPReadCache::disabled(void)
+{
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    auto before = MythHTTPReadCache::Get();
+    QCOMPARE(read(file, 1000, 5000), content(1000, 5000));
+    QCOMPARE(read(file, kFileSize - 10, 100), content(kFileSize - 10, 10));
+    auto after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_hits, before.m_hits);
+    QCOMPARE(after.m_misses, before.m_misses);
+    QCOMPARE(after.m_used, INT64_C(0));
+}
+
+void TestMythHTTPReadCache::hits(void)
+{
+    MythHTTPReadCache::Configure(8 * kBlock, 0);
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // Across the end of the first block
+    auto before = MythHTTPReadCache::Get();
+    QCOMPARE(read(file, kBlock - 100, 200), content(kBlock - 100, 200));
+    auto after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_misses - before.m_misses, UINT64_C(2));
+    QCOMPARE(after.m_used, 2 * kBlock);
+
+    // Both blocks are kept, whoever reads them
+    QFile other(name);
+    QVERIFY(other.open(QIODevice::ReadOnly));
+    before = after;
+    QCOMPARE(read(other, 10, 100), content(10, 100));
+    QCOMPARE(read(other, kBlock + 10, 100), content(kBlock + 10, 100));
+    after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_hits - before.m_hits, UINT64_C(2));
+    QCOMPARE(after.m_misses, before.m_misses);
+}
+
+void TestMythHTTPReadCache::partial_block(void)
+{
+    MythHTTPReadCache::Configure(8 * kBlock, 0);
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // The end of a file that may still be growing is always read again
+    QCOMPARE(read(file, (3 * kBlock) + 500, 1000), content((3 * kBlock) + 500, 500));
+    auto before = MythHTTPReadCache::Get();
+    QCOMPARE(before.m_used, INT64_C(0));
+    QCOMPARE(read(file, (3 * kBlock) + 500, 1000), content((3 * kBlock) + 500, 500));
+    auto after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_misses - before.m_misses, UINT64_C(1));
+    QCOMPARE(after.m_hits, before.m_hits);
+
+    // and nothing is read past it
+    std::array<char,10> buffer {};
+    QCOMPARE(MythHTTPReadCache::Read(file, kFileSize + 10, buffer.data(), static_cast<int64_t>(buffer.size())), INT64_C(0));
+}
+
+void TestMythHTTPReadCache::eviction(void)
+{
+    MythHTTPReadCache::Configure(2 * kBlock, 0);
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    auto before = MythHTTPReadCache::Get();
+    for (int64_t block = 0; block < 3; ++block)
+        QCOMPARE(read(file, block * kBlock, 100), content(block * kBlock, 100));
+    auto after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_evicted - before.m_evicted, UINT64_C(1));
+    QCOMPARE(after.m_used, 2 * kBlock);
+
+    // The least recently used block made room
+    before = after;
+    QCOMPARE(read(file, (2 * kBlock) + 100, 100), content((2 * kBlock) + 100, 100));
+    QCOMPARE(read(file, 100, 100), content(100, 100));
+    after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_hits - before.m_hits, UINT64_C(1));
+    QCOMPARE(after.m_misses - before.m_misses, UINT64_C(1));
+
+    // Shrinking the cache drops the oldest blocks at once
+    MythHTTPReadCache::Configure(kBlock, 0);
+    QCOMPARE(MythHTTPReadCache::Get().m_used, kBlock);
+}
+
+void TestMythHTTPReadCache::read_ahead(void)
+{
+    MythHTTPReadCache::Configure(8 * kBlock, 2);
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // A single read is not a reason to read ahead
+    auto before = MythHTTPReadCache::Get();
+    QCOMPARE(read(file, 0, kBlock), content(0, kBlock));
+    QTest::qWait(100);
+    QCOMPARE(MythHTTPReadCache::Get().m_prefetched, before.m_prefetched);
+
+    // Reading on from there is. Only whole blocks are kept, so the short
+    // last block is not.
+    QCOMPARE(read(file, kBlock, kBlock), content(kBlock, kBlock));
+    QTRY_COMPARE(MythHTTPReadCache::Get().m_prefetched - before.m_prefetched, UINT64_C(1));
+
+    auto middle = MythHTTPReadCache::Get();
+    QCOMPARE(read(file, 2 * kBlock, kBlock), content(2 * kBlock, kBlock));
+    auto after = MythHTTPReadCache::Get();
+    QCOMPARE(after.m_hits - middle.m_hits, UINT64_C(1));
+    QCOMPARE(after.m_misses, middle.m_misses);
+}
+
+void TestMythHTTPReadCache::replaced_file(void)
+{
+    MythHTTPReadCache::Configure(8 * kBlock, 0);
+    QTemporaryDir dir;
+    QString name = dir.filePath("recording.ts");
+    QVERIFY(write_file(name));
+    {
+        QFile file(name);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(read(file, 0, 100), content(0, 100));
+    }
+
+    // A new file under the same name is not served from the old one's blocks
+    QString replacement = dir.filePath("replacement.ts");
+    QVERIFY(write_file(replacement, 1));
+    QVERIFY(QFile::remove(name));
+    QVERIFY(QFile::rename(replacement, name));
+
+    QFile file(name);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(read(file, 0, 100), content(0, 100, 1));
+}
+
+QTEST_GUILESS_MAIN(TestMythHTTPReadCache)
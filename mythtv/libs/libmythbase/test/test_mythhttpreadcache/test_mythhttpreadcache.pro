@@ -0,0 +1,20 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += testlib
+
+TEMPLATE = app
+TARGET = test_mythhttpreadcache
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../..
+LIBS += -L../.. -lmythbase-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_mythhttpreadcache.h
+SOURCES += test_mythhttpreadcache.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -0,0 +1,206 @@
+/*
+ *  Class TestMythHTTPServiceCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QThread>
+
+#include "mythevent.h"
+#include "http/mythhttpdata.h"
+#include "http/mythhttpmetaservice.h"
+#include "http/mythhttprequest.h"
+#include "http/mythhttpresponse.h"
+#include "http/mythhttpservicecache.h"
+#include "test_mythhttpservicecache.h"
+
+Q_GLOBAL_STATIC_WITH_ARGS(MythHTTPMetaService, s_service,
+    ("Test", TestCacheService::staticMetaObject))
+
+int TestCacheService::s_calls = 0;
+
+TestCacheService::TestCacheService()
+  : MythHTTPService(s_service)
+{
+}
+
+int TestCacheService::GetCount(void)
+{
+    return ++s_calls;
+}
+
+bool TestCacheService::Bump(void)
+{
+    return true;
+}
+
+static HTTPRequest2 make_request(const QString& Method, const QString& Accept = "application/json")
+{
+    auto headers = std::make_shared<HTTPMap>();
+    headers->insert("host", "localhost:6544");
+    headers->insert("accept", Accept);
+    return std::make_shared<MythHTTPRequest>(MythHTTPConfig(), Method + " HTTP/1.1",
+                                             headers, nullptr);
+}
+
+static HTTPData make_data(int Size, char Fill = 'x')
+{
+    auto result = MythHTTPData::Create(QByteArray(Size, Fill));
+    result->m_fileName = "result.json";
+    return result;
+}
+
+// called before each test case
+void TestMythHTTPServiceCache::init(void)
+{
+    MythHTTPServiceCache::Clear();
+    TestCacheService::s_calls = 0;
+}
+
+void TestMythHTTPServiceCache::key_query_order(void)
+{
+    auto key1 = MythHTTPServiceCache::Key("Dvr", "GetRecordedList",
+                                          make_request("GET /Dvr/GetRecordedList?Count=10&StartIndex=5"));
+    auto key2 = MythHTTPServiceCache::Key("Dvr", "GetRecordedList",
+                                          make_request("GET /Dvr/GetRecordedList?startindex=5&count=10"));
+    auto key3 = MythHTTPServiceCache::Key("Dvr", "GetRecordedList",
+                                          make_request("GET /Dvr/GetRecordedList?Count=10&StartIndex=6"));
+    auto key4 = MythHTTPServiceCache::Key("Dvr", "GetUpcomingList",
+                                          make_request("GET /Dvr/GetUpcomingList?Count=10&StartIndex=5"));
+    QCOMPARE(key1, key2);
+    QVERIFY(key1 != key3);
+    QVERIFY(key1 != key4);
+}
+
+void TestMythHTTPServiceCache::key_accept(void)
+{
+    auto json = MythHTTPServiceCache::Key("Dvr", "GetRecordedList",
+                                          make_request("GET /Dvr/GetRecordedList", "application/json"));
+    auto xml  = MythHTTPServiceCache::Key("Dvr", "GetRecordedList",
+                                          make_request("GET /Dvr/GetRecordedList", "text/xml"));
+    QVERIFY(json != xml);
+
+    // Results are only shared by calls that ask for the same thing
+    MythHTTPServiceCache::Insert(json, make_data(100), { "TEST_CHANGE" });
+    QVERIFY(MythHTTPServiceCache::Get(json) != nullptr);
+    QVERIFY(MythHTTPServiceCache::Get(xml) == nullptr);
+}
+
+void TestMythHTTPServiceCache::etag(void)
+{
+    auto data = make_data(100);
+    MythHTTPServiceCache::Insert("key", data, { "TEST_CHANGE" });
+    QVERIFY(!data->m_etag.isEmpty());
+
+    auto cached = MythHTTPServiceCache::Get("key");
+    QVERIFY(cached != nullptr);
+    QVERIFY(cached != data);
+    QCOMPARE(QByteArray(*cached), QByteArray(*data));
+    QCOMPARE(cached->m_etag, data->m_etag);
+    QCOMPARE(cached->m_fileName, data->m_fileName);
+
+    // A different result gets a different ETag
+    auto other = make_data(100, 'y');
+    MythHTTPServiceCache::Insert("key", other, { "TEST_CHANGE" });
+    QVERIFY(other->m_etag != data->m_etag);
+    QCOMPARE(MythHTTPServiceCache::Get("key")->m_etag, other->m_etag);
+}
+
+void TestMythHTTPServiceCache::event_invalidates(void)
+{
+    MythHTTPServiceCache::Insert("recorded", make_data(100), { "RECORDING_LIST_CHANGE" });
+    MythHTTPServiceCache::Insert("upcoming", make_data(100), { "SCHEDULE_CHANGE", "RECORDING_LIST_CHANGE" });
+    MythHTTPServiceCache::Insert("guide",    make_data(100), { "MYTHFILLDATABASE_RAN" });
+
+    MythEvent event("RECORDING_LIST_CHANGE UPDATE 1234");
+    MythHTTPServiceCache::Instance()->customEvent(&event);
+
+    QVERIFY(MythHTTPServiceCache::Get("recorded") == nullptr);
+    QVERIFY(MythHTTPServiceCache::Get("upcoming") == nullptr);
+    QVERIFY(MythHTTPServiceCache::Get("guide") != nullptr);
+}
+
+void TestMythHTTPServiceCache::system_event_invalidates(void)
+{
+    MythHTTPServiceCache::Insert("upcoming", make_data(100), { "SCHEDULE_CHANGE" });
+    MythHTTPServiceCache::Insert("guide",    make_data(100), { "MYTHFILLDATABASE_RAN" });
+
+    MythEvent event("SYSTEM_EVENT MYTHFILLDATABASE_RAN SENDER backend");
+    MythHTTPServiceCache::Instance()->customEvent(&event);
+
+    QVERIFY(MythHTTPServiceCache::Get("upcoming") != nullptr);
+    QVERIFY(MythHTTPServiceCache::Get("guide") == nullptr);
+}
+
+void TestMythHTTPServiceCache::size_eviction(void)
+{
+    // Results over an eighth of the 32MB limit are never kept
+    static constexpr int kLargest { 4 * 1024 * 1024 };
+    MythHTTPServiceCache::Insert("huge", make_data(kLargest + 1), { "TEST_CHANGE" });
+    QVERIFY(MythHTTPServiceCache::Get("huge") == nullptr);
+
+    // The ninth largest result pushes out the oldest
+    MythHTTPServiceCache::Insert("0", make_data(kLargest), { "TEST_CHANGE" });
+    QThread::msleep(20);
+    for (int i = 1; i < 9; ++i)
+        MythHTTPServiceCache::Insert(QString::number(i), make_data(kLargest), { "TEST_CHANGE" });
+
+    QVERIFY(MythHTTPServiceCache::Get("0") == nullptr);
+    for (int i = 1; i < 9; ++i)
+        QVERIFY(MythHTTPServiceCache::Get(QString::number(i)) != nullptr);
+}
+
+void TestMythHTTPServiceCache::service_uses_cache(void)
+{
+    TestCacheService service;
+    auto first = service.HTTPRequest(make_request("GET /Test/GetCount"));
+    QVERIFY(first != nullptr);
+    QCOMPARE(first->m_status, HTTPOK);
+    QCOMPARE(TestCacheService::s_calls, 1);
+
+    // Answered from the cache, without calling the method again
+    auto second = service.HTTPRequest(make_request("GET /Test/GetCount"));
+    QVERIFY(second != nullptr);
+    QCOMPARE(second->m_status, HTTPOK);
+    QCOMPARE(TestCacheService::s_calls, 1);
+
+    auto head = service.HTTPRequest(make_request("HEAD /Test/GetCount"));
+    QVERIFY(head != nullptr);
+    QCOMPARE(TestCacheService::s_calls, 1);
+
+    // Until an event it listens for
+    MythEvent event("TEST_CHANGE");
+    MythHTTPServiceCache::Instance()->customEvent(&event);
+    service.HTTPRequest(make_request("GET /Test/GetCount"));
+    QCOMPARE(TestCacheService::s_calls, 2);
+}
+
+void TestMythHTTPServiceCache::service_clears_on_change(void)
+{
+    TestCacheService service;
+    service.HTTPRequest(make_request("GET /Test/GetCount"));
+    service.HTTPRequest(make_request("GET /Test/GetCount"));
+    QCOMPARE(TestCacheService::s_calls, 1);
+
+    // Bump cannot be used with HEAD, so it may have changed anything
+    auto bump = service.HTTPRequest(make_request("POST /Test/Bump"));
+    QVERIFY(bump != nullptr);
+    QCOMPARE(bump->m_status, HTTPOK);
+
+    service.HTTPRequest(make_request("GET /Test/GetCount"));
+    QCOMPARE(TestCacheService::s_calls, 2);
+}
+
+QTEST_APPLESS_MAIN(TestMythHTTPServiceCache)
@@ -0,0 +1,55 @@
+/*
+ *  Class TestMythHTTPServiceCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QTest>
+
+#include "http/mythhttpservice.h"
+
+/// A service with one cached method, and one that may change what it returns
+class TestCacheService : public MythHTTPService
+{
+    Q_OBJECT
+    Q_CLASSINFO("Version",  "1.0")
+    Q_CLASSINFO("GetCount", "cache=TEST_CHANGE")
+    Q_CLASSINFO("Bump",     "methods=POST;name=bool")
+
+  public:
+    TestCacheService();
+    static int s_calls;
+
+  public slots:
+    static int  GetCount(void);
+    static bool Bump(void);
+};
+
+class TestMythHTTPServiceCache : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void init(void);
+
+    static void key_query_order(void);
+    static void key_accept(void);
+    static void etag(void);
+    static void event_invalidates(void);
+    static void system_event_invalidates(void);
+    static void size_eviction(void);
+    static void service_uses_cache(void);
+    static void service_clears_on_change(void);
+};
@@ -0,0 +1,196 @@
+/*
+ *  Class TestMythWebSocketTopics
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QMutex>
+#include <QSignalSpy>
+
+#include "mythevent.h"
+#include "http/mythwebsockettopics.h"
+#include "test_mythwebsockettopics.h"
+
+using namespace std::chrono_literals;
+
+// Changes are sent a second after the event, to catch the rest of a burst
+static constexpr int kWait { 5000 };
+
+// Providers are called from a thread pool
+static QMutex s_lock;
+static QHash<QString,QJsonObject> s_states;
+
+static void set_state(const QString& Topic, const QJsonObject& State)
+{
+    QMutexLocker locker(&s_lock);
+    s_states.insert(Topic, State);
+}
+
+static void register_topic(const QString& Topic, const QJsonObject& State)
+{
+    set_state(Topic, State);
+    MythWebSocketTopics::Register(Topic, { "TEST_CHANGE" }, 0s, [Topic]()
+    {
+        QMutexLocker locker(&s_lock);
+        return s_states.value(Topic);
+    });
+}
+
+static void send_event(const QString& Message)
+{
+    MythEvent event(Message);
+    QCoreApplication::sendEvent(MythWebSocketTopics::Instance(), &event);
+}
+
+static QJsonObject item(int Value)
+{
+    return {{ "value", Value }};
+}
+
+void TestMythWebSocketTopics::unknown_topic(void)
+{
+    QJsonObject message;
+    QVERIFY(!MythWebSocketTopics::Instance()->Subscribe("unknown", message));
+    QVERIFY(message.isEmpty());
+}
+
+void TestMythWebSocketTopics::snapshot(void)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    QJsonObject state {{ "1", item(1) }, { "2", item(2) }};
+    register_topic("snapshot", state);
+    QVERIFY(topics->Topics().contains("snapshot"));
+
+    // The first subscriber is sent the state once it is known
+    QSignalSpy spy(topics, &MythWebSocketTopics::TopicChanged);
+    QJsonObject message;
+    QVERIFY(topics->Subscribe("snapshot", message));
+    QVERIFY(message.isEmpty());
+    QVERIFY(spy.wait(kWait));
+    QCOMPARE(spy.first().at(0).toString(), QString("snapshot"));
+    message = spy.first().at(1).toJsonObject();
+    QCOMPARE(message["topic"].toString(), QString("snapshot"));
+    QCOMPARE(message["snapshot"].toObject(), state);
+
+    // Later ones are given it when they subscribe
+    QJsonObject second;
+    QVERIFY(topics->Subscribe("snapshot", second));
+    QCOMPARE(second["snapshot"].toObject(), state);
+
+    topics->Unsubscribe("snapshot");
+    topics->Unsubscribe("snapshot");
+}
+
+void TestMythWebSocketTopics::changes(void)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    register_topic("changes", {{ "1", item(1) }, { "2", item(2) }, { "3", item(3) }});
+
+    QSignalSpy spy(topics, &MythWebSocketTopics::TopicChanged);
+    QJsonObject message;
+    QVERIFY(topics->Subscribe("changes", message));
+    QVERIFY(spy.wait(kWait));
+    spy.clear();
+
+    // One item changed, one went and one arrived
+    set_state("changes", {{ "1", item(1) }, { "2", item(20) }, { "4", item(4) }});
+    send_event("TEST_CHANGE");
+    QVERIFY(spy.wait(kWait));
+    message = spy.first().at(1).toJsonObject();
+    QCOMPARE(message["topic"].toString(), QString("changes"));
+    QVERIFY(!message.contains("snapshot"));
+    QJsonObject changed {{ "2", item(20) }, { "4", item(4) }};
+    QCOMPARE(message["changed"].toObject(), changed);
+    QCOMPARE(message["removed"].toArray(), QJsonArray({ "3" }));
+
+    // System events are named by their second word
+    spy.clear();
+    set_state("changes", {{ "1", item(1) }, { "2", item(20) }});
+    send_event("SYSTEM_EVENT TEST_CHANGE SENDER backend");
+    QVERIFY(spy.wait(kWait));
+    message = spy.first().at(1).toJsonObject();
+    QVERIFY(!message.contains("changed"));
+    QCOMPARE(message["removed"].toArray(), QJsonArray({ "4" }));
+
+    topics->Unsubscribe("changes");
+}
+
+void TestMythWebSocketTopics::no_changes(void)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    register_topic("same", {{ "1", item(1) }});
+
+    QSignalSpy spy(topics, &MythWebSocketTopics::TopicChanged);
+    QJsonObject message;
+    QVERIFY(topics->Subscribe("same", message));
+    QVERIFY(spy.wait(kWait));
+    spy.clear();
+
+    // Nothing is sent if the event did not change anything
+    send_event("TEST_CHANGE");
+    QVERIFY(!spy.wait(3000));
+
+    topics->Unsubscribe("same");
+}
+
+void TestMythWebSocketTopics::other_events(void)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    register_topic("other", {{ "1", item(1) }});
+
+    QSignalSpy spy(topics, &MythWebSocketTopics::TopicChanged);
+    QJsonObject message;
+    QVERIFY(topics->Subscribe("other", message));
+    QVERIFY(spy.wait(kWait));
+    spy.clear();
+
+    // The topic is not looked at again for an event it does not list
+    set_state("other", {{ "1", item(10) }});
+    send_event("SCHEDULE_CHANGE");
+    QVERIFY(!spy.wait(3000));
+
+    topics->Unsubscribe("other");
+}
+
+void TestMythWebSocketTopics::unsubscribe(void)
+{
+    auto * topics = MythWebSocketTopics::Instance();
+    register_topic("gone", {{ "1", item(1) }});
+
+    QSignalSpy spy(topics, &MythWebSocketTopics::TopicChanged);
+    QJsonObject message;
+    QVERIFY(topics->Subscribe("gone", message));
+    QVERIFY(spy.wait(kWait));
+    spy.clear();
+
+    // Without subscribers the state is forgotten and no longer followed
+    topics->Unsubscribe("gone");
+    set_state("gone", {{ "1", item(10) }});
+    send_event("TEST_CHANGE");
+    QVERIFY(!spy.wait(3000));
+
+    // so a new subscriber waits for a fresh snapshot
+    QVERIFY(topics->Subscribe("gone", message));
+    QVERIFY(message.isEmpty());
+    QVERIFY(spy.wait(kWait));
+    message = spy.first().at(1).toJsonObject();
+    QCOMPARE(message["snapshot"].toObject(), QJsonObject({{ "1", item(10) }}));
+
+    topics->Unsubscribe("gone");
+}
+
+QTEST_GUILESS_MAIN(TestMythWebSocketTopics)
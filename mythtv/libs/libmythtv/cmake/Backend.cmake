@@ -80,8 +80,10 @@ target_sources(
           recorders/recorderbase.h
           recorders/DeviceReadBuffer.h
           recorders/dtvrecorder.h
+          recorders/recordercommflagger.h
           recorders/DeviceReadBuffer.cpp
           recorders/dtvrecorder.cpp
+          recorders/recordercommflagger.cpp
           recorders/recorderbase.cpp
           # Import recorder
           recorders/importrecorder.h
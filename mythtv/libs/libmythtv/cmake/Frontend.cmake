@@ -35,6 +35,7 @@ target_sources(
           mythplayeruibase.h
           mythplayerui.h
           mythplayereditorui.h
+          mythdecodedframecache.h
           mythplayervideoui.h
           mythplayercaptionsui.h
           mythplayeroverlayui.h
@@ -60,6 +61,7 @@ target_sources(
           mheg/netstream.cpp
           mythccextractorplayer.cpp
           mythcommflagplayer.cpp
+          mythdecodedframecache.cpp
           mythplayer.cpp
           mythplayeraudioui.cpp
           mythplayeravsync.cpp
@@ -90,10 +92,12 @@ target_sources(
           decoders/avformatdecoder.h
           decoders/mythcodeccontext.h
           decoders/mythdecoderthread.h
+          decoders/mythdecodethreading.h
           decoders/avformatdecoder.cpp
           decoders/decoderbase.cpp
           decoders/mythcodeccontext.cpp
           decoders/mythdecoderthread.cpp
+          decoders/mythdecodethreading.cpp
           # On screen display (video output overlay)
           osd.h
           mythmediaoverlay.h
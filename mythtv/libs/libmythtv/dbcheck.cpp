@@ -1229,6 +1229,32 @@ static bool doUpgradeTVDatabaseSchema(void)
             return false;
     }
 
+    if (dbver == "1384")
+    {
+        DBUpdates updates {
+            "CREATE TABLE IF NOT EXISTS commsegment ("
+            "  segmentid INT UNSIGNED NOT NULL AUTO_INCREMENT,"
+            "  duration FLOAT NOT NULL DEFAULT 0,"
+            "  hits INT UNSIGNED NOT NULL DEFAULT 0,"
+            "  created DATETIME NOT NULL,"
+            "  lastseen DATETIME NOT NULL,"
+            "  PRIMARY KEY (segmentid),"
+            "  KEY lastseen (lastseen)"
+            ") ENGINE=MyISAM DEFAULT CHARSET=utf8;",
+            "CREATE TABLE IF NOT EXISTS commfingerprint ("
+            "  segmentid INT UNSIGNED NOT NULL,"
+            "  second SMALLINT UNSIGNED NOT NULL,"
+            "  audiohash INT UNSIGNED NOT NULL,"
+            "  videohash BIGINT UNSIGNED DEFAULT NULL,"
+            "  PRIMARY KEY (segmentid, second),"
+            "  KEY audiohash (audiohash)"
+            ") ENGINE=MyISAM DEFAULT CHARSET=utf8;"
+        };
+        if (!performActualUpdate("MythTV", "DBSchemaVer",
+                                 updates, "1385", dbver))
+            return false;
+    }
+
     return true;
 }
 
@@ -17,6 +17,7 @@ extern "C" {
 #include "libavutil/intreadwrite.h" // for AV_RB32 and AV_RB24
 #include "libavutil/log.h"
 #include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
 #include "libavformat/avio.h"
@@ -121,6 +122,10 @@ using namespace std::string_view_literals;
 // active hardware context when it is errored.
 static constexpr int SEQ_PKT_ERR_MAX { 50 };
 
+// Upper bound on the frames assumed dropped between two decoded frames
+// when sampling non-reference frames, in case of a timestamp jump.
+static constexpr int kMaxSkippedNonRef { 16 };
+
 #if QT_VERSION < QT_VERSION_CHECK(6,0,0)
 static constexpr int16_t kMaxVideoQueueSize = 220;
 #else
@@ -1456,6 +1461,15 @@ void AvFormatDecoder::InitVideoCodec(AVStream *stream, AVCodecContext *codecCont
         codecContext->skip_loop_filter = AVDISCARD_ALL;
     }
 
+    if (FlagIsSet(kDecodeLumaOnly) && codec1)
+    {
+        // Analysis only, take every shortcut the codec offers
+        if (FlagIsSet(kDecodeLowRes))
+            codecContext->lowres = std::min(2, static_cast<int>(codec1->max_lowres));
+        codecContext->flags2 |= AV_CODEC_FLAG2_FAST;
+        codecContext->skip_loop_filter = AVDISCARD_ALL;
+    }
+
     if (FlagIsSet(kDecodeNoDecode))
         codecContext->skip_idct = AVDISCARD_ALL;
 
@@ -2018,9 +2032,6 @@ int AvFormatDecoder::autoSelectVideoTrack(int& scanerror)
         break;
     }
 
-    if (FlagIsSet(kDecodeSingleThreaded))
-        thread_count = 1;
-
     if (HAVE_THREADS)
     {
         // Only use a single thread for hardware decoding. There is no
@@ -2030,9 +2041,12 @@ int AvFormatDecoder::autoSelectVideoTrack(int& scanerror)
         // before they are recreated
         if (!foundgpudecoder)
         {
-            LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using %1 CPUs for decoding")
-                .arg(HAVE_THREADS ? thread_count : 1));
-            codecContext->thread_count = static_cast<int>(thread_count);
+            if (FlagIsSet(kDecodeSingleThreaded))
+                codecContext->thread_count = 1;
+            else
+                MythDecodeThreading::Configure(codecContext, codec, thread_count, GetDecodeLatency());
+            LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using %1 for decoding")
+                .arg(MythDecodeThreading::Describe(codecContext)));
         }
     }
 
@@ -2047,9 +2061,23 @@ int AvFormatDecoder::autoSelectVideoTrack(int& scanerror)
     {
         scanerror = -1;
     }
+    else if (!foundgpudecoder)
+    {
+        m_decodeThreading.Start(codecContext, m_fps, GetDecodeLatency());
+    }
     return stream_index;
 }
 
+/// Describe how decoded video will be consumed, for the decoder threading policy
+MythDecodeLatency AvFormatDecoder::GetDecodeLatency(void)
+{
+    if (FlagIsSet(kVideoIsNull) || m_transcoding)
+        return kDecodeLatencyThroughput;
+    if (m_livetv)
+        return kDecodeLatencyLow;
+    return kDecodeLatencyNormal;
+}
+
 void AvFormatDecoder::remove_tracks_not_in_same_AVProgram(int stream_index)
 {
     AVProgram* program = av_find_program_from_stream(m_ic, nullptr, stream_index);
@@ -3250,6 +3278,8 @@ bool AvFormatDecoder::ProcessVideoPacket(AVCodecContext* context, AVStream *curs
     bool sentPacket = false;
     int ret2 = 0;
 
+    QElapsedTimer decodetimer;
+    decodetimer.start();
     m_avCodecLock.lock();
 
     //  SUGGESTION
@@ -3273,6 +3303,14 @@ bool AvFormatDecoder::ProcessVideoPacket(AVCodecContext* context, AVStream *curs
     // all available pictures
     if (ret==0 && !gotpicture)
     {
+        // Let the codec drop most non-reference frames, ProcessVideoFrame()
+        // accounts for them in the frame count. Frames that are kept are
+        // decoded in full.
+        if (m_nonRefSampling > 1)
+        {
+            context->skip_frame = ((m_nonRefCount++ % m_nonRefSampling) == 0) ?
+                AVDISCARD_DEFAULT : AVDISCARD_NONREF;
+        }
         ret2 = avcodec_send_packet(context, pkt);
         if (ret2 == AVERROR(EAGAIN))
         {
@@ -3285,6 +3323,8 @@ bool AvFormatDecoder::ProcessVideoPacket(AVCodecContext* context, AVStream *curs
         }
     }
     m_avCodecLock.unlock();
+    m_decodeThreading.AddDecodeTime(std::chrono::microseconds(decodetimer.nsecsElapsed() / 1000),
+                                    gotpicture != 0);
 
     if (ret < 0 || ret2 < 0)
     {
@@ -3353,6 +3393,36 @@ bool AvFormatDecoder::ProcessVideoPacket(AVCodecContext* context, AVStream *curs
     return true;
 }
 
+/*! \brief Copies just the luma plane of an 8 bit YUV picture into a YV12 frame.
+ *
+ * The chroma planes are set to neutral grey, so anything that does look at
+ * them (such as DetectLetterbox) sees a black and white picture rather
+ * than whatever the buffer last held.
+*/
+bool AvFormatDecoder::CopyLuma(MythVideoFrame *Frame, const AVFrame *AvFrame)
+{
+    const AVPixFmtDescriptor *desc =
+        av_pix_fmt_desc_get(static_cast<AVPixelFormat>(AvFrame->format));
+    if (!desc || !Frame || (Frame->m_type != FMT_YV12) || !AvFrame->data[0] ||
+        (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL)) ||
+        (desc->comp[0].depth != 8) || (desc->comp[0].step != 1) ||
+        (AvFrame->width > Frame->m_width) || (AvFrame->height > Frame->m_height))
+    {
+        return false;
+    }
+
+    MythVideoFrame::CopyPlane(Frame->m_buffer + Frame->m_offsets[0], Frame->m_pitches[0],
+                              AvFrame->data[0], AvFrame->linesize[0],
+                              AvFrame->width, AvFrame->height);
+    for (uint plane = 1; plane < 3; ++plane)
+    {
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        memset(Frame->m_buffer + Frame->m_offsets[plane], 128,
+               static_cast<size_t>(Frame->m_pitches[plane]) * static_cast<size_t>(height));
+    }
+    return true;
+}
+
 bool AvFormatDecoder::ProcessVideoFrame(AVCodecContext* context, AVStream *Stream, AVFrame *AvFrame)
 {
     // look for A53 captions
@@ -3378,7 +3448,11 @@ bool AvFormatDecoder::ProcessVideoFrame(AVCodecContext* context, AVStream *Strea
         frame = m_parent->GetNextVideoFrame();
         frame->m_directRendering = false;
 
-        if (!m_mythCodecCtx->RetrieveFrame(context, frame, AvFrame))
+        if (FlagIsSet(kDecodeLumaOnly) && CopyLuma(frame, AvFrame))
+        {
+            // Chroma is filled with 128, the frame is only looked at for its luma
+        }
+        else if (!m_mythCodecCtx->RetrieveFrame(context, frame, AvFrame))
         {
             AVFrame tmppicture;
             av_image_fill_arrays(tmppicture.data, tmppicture.linesize,
@@ -3493,6 +3567,24 @@ bool AvFormatDecoder::ProcessVideoFrame(AVCodecContext* context, AVStream *Strea
     frame->m_topFieldFirst       = (AvFrame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST) != 0;
     frame->m_newGOP              = m_nextDecodedFrameIsKeyFrame;
     frame->m_repeatPic           = AvFrame->repeat_pict != 0;
+    // Count the non-reference frames the codec was allowed to skip. The
+    // gap is measured in average frame durations of the stream, so the
+    // uneven frame durations of pulldown content do not look like drops.
+    if ((m_nonRefSampling > 1) && (m_lastVPts > 0ms))
+    {
+        AVRational rate = Stream->avg_frame_rate;
+        if ((rate.num <= 0) || (rate.den <= 0))
+            rate = Stream->r_frame_rate;
+        double duration = ((rate.num > 0) && (rate.den > 0)) ? 1000.0 / av_q2d(rate) :
+                          (m_fps > 0.0) ? 1000.0 / m_fps : 0.0;
+        if (duration > 0.0)
+        {
+            long skipped = std::lround((temppts - m_lastVPts).count() / duration) - 1;
+            if (skipped > 0)
+                m_framesPlayed += std::min(skipped, static_cast<long>(kMaxSkippedNonRef));
+        }
+    }
+
     frame->m_displayTimecode     = NormalizeVideoTimecode(Stream, std::chrono::milliseconds(temppts));
     frame->m_frameNumber         = m_framesPlayed;
     frame->m_frameCounter        = m_frameCounter++;
@@ -3516,6 +3608,10 @@ bool AvFormatDecoder::ProcessVideoFrame(AVCodecContext* context, AVStream *Strea
     // Retrieve HDR metadata
     MythHDRVideoMetadata::Populate(frame, AvFrame);
 
+    // Copy the frame before it is handed on, when it may be reused at any time
+    if (auto *cache = m_parent->GetDecodedFrameCache(); cache)
+        cache->AddFrame(frame);
+
     m_parent->ReleaseNextVideoFrame(frame, std::chrono::milliseconds(temppts));
     m_mythCodecCtx->PostProcessFrame(context, frame);
 
@@ -4548,6 +4644,17 @@ bool AvFormatDecoder::GetFrame(DecodeType decodetype, bool &Retry)
     AVPacket *pkt = nullptr;
     bool have_err = false;
 
+    if (m_frameCacheResync && (decodetype & kDecodeVideo))
+    {
+        MythVideoFrame *cached = GetCachedFrame();
+        if (cached)
+        {
+            m_decodedVideoFrame = cached;
+            m_gotVideoFrame = true;
+            return true;
+        }
+    }
+
     const DecodeType origDecodetype = decodetype;
 
     m_gotVideoFrame = false;
@@ -24,6 +24,7 @@ extern "C" {
 #include "io/mythavformatbuffer.h"
 #include "mpeg/AVCParser.h"
 #include "mythcodeccontext.h"
+#include "mythdecodethreading.h"
 #include "mythplayer.h"
 
 class TeletextDecoder;
@@ -183,6 +184,7 @@ class AvFormatDecoder : public DecoderBase
     bool PreProcessVideoPacket(AVCodecContext* codecContext, AVStream *stream, AVPacket *pkt);
     virtual bool ProcessVideoPacket(AVCodecContext* codecContext, AVStream *stream, AVPacket *pkt, bool &Retry);
     virtual bool ProcessVideoFrame(AVCodecContext* codecContext, AVStream *Stream, AVFrame *AvFrame);
+    static bool CopyLuma(MythVideoFrame *Frame, const AVFrame *AvFrame);
     bool ProcessAudioPacket(AVCodecContext* codecContext, AVStream *stream, AVPacket *pkt,
                             DecodeType decodetype);
     bool ProcessSubtitlePacket(AVCodecContext* codecContext, AVStream *stream, AVPacket *pkt);
@@ -225,6 +227,7 @@ class AvFormatDecoder : public DecoderBase
     virtual int ReadPacket(AVFormatContext *ctx, AVPacket *pkt, bool &storePacket);
 
     bool FlagIsSet(PlayerFlags arg) { return m_playerFlags & arg; }
+    MythDecodeLatency GetDecodeLatency(void);
 
     int autoSelectVideoTrack(int& scanerror);
     void remove_tracks_not_in_same_AVProgram(int stream_index);
@@ -245,6 +248,7 @@ class AvFormatDecoder : public DecoderBase
 
     int                m_frameDecoded                 {0};
     MythVideoFrame    *m_decodedVideoFrame            {nullptr};
+    MythDecodeThreading m_decodeThreading;
     MythAVFormatBuffer *m_avfRingBuffer               {nullptr};
 
     struct SwsContext *m_swsCtx                       {nullptr};
@@ -276,6 +280,7 @@ class AvFormatDecoder : public DecoderBase
     bool               m_firstVPtsInuse               {false};
 
     PlayerFlags        m_playerFlags;
+    uint               m_nonRefCount                  {0};
     MythCodecID        m_videoCodecId                 {kCodec_NONE};
 
     int                m_maxKeyframeDist              {-1};
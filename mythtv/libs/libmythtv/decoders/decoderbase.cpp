@@ -62,6 +62,7 @@ void DecoderBase::Reset(bool reset_video_data, bool seek_reset, bool reset_file)
         m_framesRead = 0;
         m_totalDuration = MythAVRational(0);
         m_dontSyncPositionMap = false;
+        m_frameCacheResync = false;
     }
 
     if (reset_file)
@@ -558,9 +559,13 @@ bool DecoderBase::DoRewind(long long desiredFrame, bool discardFrames)
             .arg(desiredFrame).arg(m_framesPlayed)
             .arg((discardFrames) ? "do" : "don't"));
 
+    if (SeekToCachedFrame(desiredFrame, discardFrames))
+        return true;
+
     if (!DoRewindSeek(desiredFrame))
         return false;
 
+    m_frameCacheResync = false;
     m_framesPlayed = m_lastKey;
     m_fpsSkip = 0;
     m_framesRead = m_lastKey;
@@ -697,6 +702,66 @@ long long DecoderBase::ConditionallyUpdatePosMap(long long desiredFrame)
     return last_frame;
 }
 
+/*! \brief Satisfy a seek from the player's decoded frame cache.
+ *
+ *  If desiredFrame is cached, the decoder position is updated without touching
+ *  the demuxer or codec and subsequent calls to GetCachedFrame() deliver frames
+ *  from the cache. The decoder is resynchronised with a real seek the first
+ *  time a frame is requested that is not cached.
+ */
+bool DecoderBase::SeekToCachedFrame(long long desiredFrame, bool discardFrames)
+{
+    if (!discardFrames)
+        return false;
+
+    MythDecodedFrameCache *cache = m_parent->GetDecodedFrameCache();
+    if (!cache || !cache->HasFrame(desiredFrame))
+        return false;
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Seeking to cached frame %1").arg(desiredFrame));
+
+    m_parent->DiscardVideoFrames(true, false);
+    m_framesPlayed = desiredFrame;
+    m_framesRead = desiredFrame;
+    m_fpsSkip = 0;
+    m_frameCacheResync = true;
+    m_parent->SetFramesPlayed(m_framesPlayed + 1);
+    return true;
+}
+
+/*! \brief Deliver the next frame from the player's decoded frame cache.
+ *
+ *  Only valid after SeekToCachedFrame(). If the next frame is not cached, the
+ *  decoder is resynchronised with a real seek and nullptr is returned so that
+ *  normal decoding can continue from the correct position.
+ */
+MythVideoFrame* DecoderBase::GetCachedFrame(void)
+{
+    if (!m_frameCacheResync)
+        return nullptr;
+
+    MythDecodedFrameCache *cache = m_parent->GetDecodedFrameCache();
+    if (cache && cache->HasFrame(m_framesPlayed))
+    {
+        MythVideoFrame *frame = m_parent->GetNextVideoFrame();
+        if (frame && cache->GetFrame(m_framesPlayed, frame))
+        {
+            m_parent->ReleaseNextVideoFrame(frame, frame->m_timecode, false);
+            m_framesRead = ++m_framesPlayed;
+            return frame;
+        }
+        if (frame)
+            m_parent->DiscardVideoFrame(frame);
+    }
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+        QString("Frame %1 not cached - resynchronising").arg(m_framesPlayed));
+    m_frameCacheResync = false;
+    DoRewind(m_framesPlayed, false);
+    return nullptr;
+}
+
 /** \fn DecoderBase::DoFastForward(long long, bool)
  *  \brief Skips ahead or rewinds to desiredFrame.
  *
@@ -725,6 +790,17 @@ bool DecoderBase::DoFastForward(long long desiredFrame, bool discardFrames)
     {
         return false;
     }
+
+    // If we are currently serving frames from the decoder cache, the demuxer
+    // is not where m_framesPlayed says it is. Either carry on serving from the
+    // cache or force a keyframe seek to resynchronise.
+    if (m_frameCacheResync)
+    {
+        if (SeekToCachedFrame(desiredFrame, discardFrames))
+            return true;
+        return DoRewind(desiredFrame, discardFrames);
+    }
+
     // Rewind if we have already played the desiredFrame. The +1 is for
     // MPEG4 NUV files, which need to decode an extra frame sometimes.
     // This shouldn't effect how this works in general because this is
@@ -1,6 +1,7 @@
 #ifndef DECODERBASE_H_
 #define DECODERBASE_H_
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <vector>
@@ -212,6 +213,8 @@ class DecoderBase
                            bool doFlush, bool discardFrames);
 
     void SetTranscoding(bool value) { m_transcoding = value; }
+    /// Decode only one in every Sampling non-reference frames
+    void SetNonRefSampling(uint Sampling) { m_nonRefSampling = std::max(Sampling, 1U); }
 
     bool IsErrored() const { return m_errored; }
 
@@ -261,6 +264,8 @@ class DecoderBase
     void         FileChanged(void);
     virtual bool DoRewindSeek(long long desiredFrame);
     virtual void DoFastForwardSeek(long long desiredFrame, bool &needflush);
+    bool         SeekToCachedFrame(long long desiredFrame, bool discardFrames);
+    MythVideoFrame* GetCachedFrame(void);
 
     long long ConditionallyUpdatePosMap(long long desiredFrame);
     long long GetLastFrameInPosMap(void) const;
@@ -306,6 +311,10 @@ class DecoderBase
 
     bool                 m_exitAfterDecoded        {false};
     bool                 m_transcoding             {false};
+    uint                 m_nonRefSampling          {1};
+    /// Set when frames are being served from the player's decoded frame
+    /// cache and the demuxer/codec no longer match m_framesPlayed.
+    bool                 m_frameCacheResync        {false};
 
     bool                 m_hasFullPositionMap      {false};
     bool                 m_recordingHasPositionMap {false};
@@ -0,0 +1,154 @@
+// Std
+#include <algorithm>
+#include <thread>
+
+// MythTV
+#include "libmythbase/mythlogging.h"
+#include "mythdecodethreading.h"
+
+#define LOC QString("DecThreading: ")
+
+// Number of frames to time before storing the result
+static constexpr uint64_t DECODE_STATS_FRAMES { 300 };
+// Above this fraction of the frame interval, slice threading alone is not
+// fast enough for low latency decoding
+static constexpr double   DECODE_LOAD_LIMIT   { 0.8 };
+// Largest picture considered to be standard definition
+static constexpr int      DECODE_SD_PIXELS    { 720 * 576 };
+
+QString MythDecodeThreading::StreamKey(AVCodecID CodecId, int Width, int Height, MythDecodeLatency Latency)
+{
+    return QString("%1:%2x%3:%4").arg(avcodec_get_name(CodecId)).arg(Width).arg(Height)
+        .arg(static_cast<int>(Latency));
+}
+
+/*! \brief Set the thread type and count for a software decoder before it is opened.
+ *
+ * \param MaxCPUs The number of threads requested by the video display profile.
+ * \param Latency How the decoded frames will be consumed.
+*/
+void MythDecodeThreading::Configure(AVCodecContext* Context, const AVCodec* Codec,
+                                    uint MaxCPUs, MythDecodeLatency Latency)
+{
+    if (!Context)
+        return;
+
+    const auto cores = std::max(std::thread::hardware_concurrency(), 1U);
+    const bool slice = Codec && ((Codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) != 0);
+    const bool frame = Codec && ((Codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) != 0);
+    const bool small = (Context->width * Context->height) <= DECODE_SD_PIXELS;
+    uint threads = std::max(MaxCPUs, 1U);
+    int  type    = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+    switch (Latency)
+    {
+        case kDecodeLatencyThroughput:
+            // Nobody is watching - use every core and let FFmpeg prefer frame threading
+            threads = std::max(threads, std::min(cores, 16U));
+            break;
+        case kDecodeLatencyLow:
+        {
+            // Frame threading delays output by one frame per thread. Slice
+            // threading only helps streams with several slices per picture,
+            // and many broadcast HD streams have one. So larger pictures only
+            // use slice threads once they have been measured to keep up with
+            // them. Standard definition is cheap enough to try.
+            double load = -1.0;
+            {
+                QMutexLocker locker(&s_statsLock);
+                auto known = s_load.find(StreamKey(Context->codec_id, Context->width,
+                                                   Context->height, Latency));
+                if (known != s_load.cend())
+                    load = known->second;
+            }
+            bool measured = load >= 0.0;
+            if (slice && (measured ? (load < DECODE_LOAD_LIMIT) : small))
+            {
+                type = FF_THREAD_SLICE;
+                if (small)
+                    threads = std::max(threads, std::min(cores, 2U));
+            }
+            else if (measured && (load >= DECODE_LOAD_LIMIT))
+            {
+                LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Slice decoding measured at %1% "
+                    "of realtime - allowing frame threads").arg(static_cast<int>(load * 100)));
+            }
+            break;
+        }
+        case kDecodeLatencyNormal:
+            // Standard definition profiles commonly request a single thread. Slice
+            // threading is free in latency terms, so give these streams a second core.
+            if (small && slice && (threads < 2))
+            {
+                type = FF_THREAD_SLICE;
+                threads = std::min(cores, 2U);
+            }
+            break;
+    }
+
+    if (!slice && !frame)
+        threads = 1;
+
+    Context->thread_count = static_cast<int>(threads);
+    Context->thread_type  = type;
+}
+
+QString MythDecodeThreading::Describe(const AVCodecContext* Context)
+{
+    if (!Context)
+        return {};
+    QString type = "auto";
+    if (Context->thread_type == FF_THREAD_SLICE)
+        type = "slice";
+    else if (Context->thread_type == FF_THREAD_FRAME)
+        type = "frame";
+    return QString("%1 %2 threads").arg(Context->thread_count).arg(type);
+}
+
+/// Start timing a newly opened decoder
+void MythDecodeThreading::Start(const AVCodecContext* Context, double FrameRate, MythDecodeLatency Latency)
+{
+    m_frames  = 0;
+    m_pending = 0us;
+    m_total   = 0us;
+    m_key.clear();
+    if (!Context || FrameRate <= 0.0)
+        return;
+    // With frame threading the time spent in the codec API no longer reflects
+    // the real cost of decoding a frame
+    if ((Context->thread_count > 1) && (Context->active_thread_type == FF_THREAD_FRAME))
+        return;
+    m_key = StreamKey(Context->codec_id, Context->width, Context->height, Latency);
+    m_frameInterval = std::chrono::microseconds(static_cast<int64_t>(1000000.0 / FrameRate));
+}
+
+/*! \brief Record time spent in the codec.
+ *
+ * Time is accumulated across calls until the codec returns a frame, as a frame
+ * is usually the product of separate send and receive calls.
+ * Once enough frames have been timed, the mean load is stored so that the next
+ * decoder opened for a similar stream can choose its threading accordingly.
+*/
+void MythDecodeThreading::AddDecodeTime(std::chrono::microseconds Elapsed, bool GotFrame)
+{
+    if (m_key.isEmpty() || m_frames > DECODE_STATS_FRAMES)
+        return;
+
+    m_pending += Elapsed;
+    if (!GotFrame)
+        return;
+
+    m_total += m_pending;
+    m_pending = 0us;
+    if (++m_frames < DECODE_STATS_FRAMES)
+        return;
+
+    double load = (static_cast<double>(m_total.count()) / m_frames) / m_frameInterval.count();
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("%1: mean decode %2us per frame (%3% of realtime)")
+        .arg(m_key).arg(m_total.count() / static_cast<int64_t>(m_frames))
+        .arg(static_cast<int>(load * 100)));
+
+    QMutexLocker locker(&s_statsLock);
+    s_load[m_key] = load;
+    m_frames++;
+}
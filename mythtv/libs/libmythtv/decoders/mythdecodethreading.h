@@ -0,0 +1,60 @@
+#ifndef MYTHDECODETHREADING_H
+#define MYTHDECODETHREADING_H
+
+// Qt
+#include <QMutex>
+#include <QString>
+
+// MythTV
+#include "libmythbase/mythchrono.h"
+#include "libmythtv/mythtvexp.h"
+
+// Std
+#include <cstdint>
+#include <map>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+enum MythDecodeLatency : std::uint8_t
+{
+    kDecodeLatencyNormal = 0, ///< Interactive playback
+    kDecodeLatencyLow,        ///< Live TV and channel changes
+    kDecodeLatencyThroughput  ///< Commercial flagging, transcoding etc
+};
+
+/*! \class MythDecodeThreading
+ * \brief Chooses FFmpeg thread type and thread count for a software video decoder.
+ *
+ * Frame threading scales well but adds one frame of latency per thread, which
+ * delays the first picture after a channel change. Slice threading adds no
+ * latency but only helps where the codec and stream support it. The choice
+ * depends on the codec, the picture size, what the decoder is being used for
+ * and on decode timings measured for similar streams earlier in this process.
+*/
+class MTV_PUBLIC MythDecodeThreading
+{
+  public:
+    static void    Configure (AVCodecContext* Context, const AVCodec* Codec,
+                              uint MaxCPUs, MythDecodeLatency Latency);
+    static QString Describe  (const AVCodecContext* Context);
+
+    void Start         (const AVCodecContext* Context, double FrameRate, MythDecodeLatency Latency);
+    void AddDecodeTime (std::chrono::microseconds Elapsed, bool GotFrame);
+
+  private:
+    static QString StreamKey(AVCodecID CodecId, int Width, int Height, MythDecodeLatency Latency);
+
+    static inline QMutex s_statsLock;
+    /// Mean decode time per frame, as a fraction of the frame interval, by StreamKey
+    static inline std::map<QString,double> s_load;
+
+    QString m_key;
+    std::chrono::microseconds m_frameInterval { 0us };
+    std::chrono::microseconds m_pending       { 0us };
+    std::chrono::microseconds m_total         { 0us };
+    uint64_t m_frames { 0 };
+};
+
+#endif
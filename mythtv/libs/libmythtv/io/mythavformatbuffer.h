@@ -2,6 +2,7 @@
 #define AVFRINGBUFFER_H
 
 // MythTV
+#include "libmythtv/mythtvexp.h"
 #include "libmythtv/io/mythmediabuffer.h"
 
 // FFmpeg
@@ -9,7 +10,7 @@ extern "C" {
 #include "libavformat/avio.h"
 }
 
-class MythAVFormatBuffer
+class MTV_PUBLIC MythAVFormatBuffer
 {
   public:
     MythAVFormatBuffer(MythMediaBuffer *Buffer, bool write_flag, bool force_seek);
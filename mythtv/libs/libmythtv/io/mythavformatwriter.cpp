@@ -23,6 +23,7 @@
 
 #include <QtGlobal>
 #include <QtEndian>
+#include <QMutexLocker>
 
 // MythTV
 #include "libmyth/audio/audiooutpututil.h"
@@ -266,9 +267,15 @@ int MythAVFormatWriter::WriteVideoFrame(MythVideoFrame *Frame)
             pkt->flags |= AV_PKT_FLAG_KEY;
     }
 
-    if (m_startingTimecodeOffset == -1ms)
-        m_startingTimecodeOffset = tc - 1ms;
-    tc -= m_startingTimecodeOffset;
+    // The audio may be encoded on another thread, serialise the muxing
+    QMutexLocker locker(&m_muxLock);
+    std::chrono::milliseconds offset = m_startingTimecodeOffset;
+    if (offset == -1ms)
+    {
+        offset = tc - 1ms;
+        m_startingTimecodeOffset = offset;
+    }
+    tc -= offset;
 
     pkt->pts = tc.count() * m_videoStream->time_base.den / m_videoStream->time_base.num / 1000;
     pkt->dts = AV_NOPTS_VALUE;
@@ -277,8 +284,9 @@ int MythAVFormatWriter::WriteVideoFrame(MythVideoFrame *Frame)
     ret = av_interleaved_write_frame(m_ctx, pkt);
     if (ret != 0)
         LOG(VB_RECORD, LOG_ERR, LOC + "WriteVideoFrame(): av_interleaved_write_frame couldn't write Video");
+    locker.unlock();
 
-    Frame->m_timecode = tc + m_startingTimecodeOffset;
+    Frame->m_timecode = tc + offset;
     m_framesWritten++;
     av_packet_unref(pkt);
     av_packet_free(&pkt);
@@ -369,9 +377,14 @@ int MythAVFormatWriter::WriteAudioFrame(unsigned char *Buffer, int /*FrameNumber
     if (!m_bufferedAudioFrameTimes.empty())
         tc = m_bufferedAudioFrameTimes.takeFirst();
 
-    if (m_startingTimecodeOffset == -1ms)
-        m_startingTimecodeOffset = tc - 1ms;
-    tc -= m_startingTimecodeOffset;
+    QMutexLocker locker(&m_muxLock);
+    std::chrono::milliseconds offset = m_startingTimecodeOffset;
+    if (offset == -1ms)
+    {
+        offset = tc - 1ms;
+        m_startingTimecodeOffset = offset;
+    }
+    tc -= offset;
 
     if (m_avVideoCodec)
         pkt->pts = tc.count() * m_videoStream->time_base.den / m_videoStream->time_base.num / 1000;
@@ -385,8 +398,9 @@ int MythAVFormatWriter::WriteAudioFrame(unsigned char *Buffer, int /*FrameNumber
     ret = av_interleaved_write_frame(m_ctx, pkt);
     if (ret != 0)
         LOG(VB_RECORD, LOG_ERR, LOC + "WriteAudioFrame(): av_interleaved_write_frame couldn't write Audio");
+    locker.unlock();
 
-    Timecode = tc + m_startingTimecodeOffset;
+    Timecode = tc + offset;
     av_packet_unref(pkt);
     av_packet_free(&pkt);
     return 1;
@@ -410,6 +424,7 @@ bool MythAVFormatWriter::SwitchToNextFile(void)
 
 bool MythAVFormatWriter::ReOpen(const QString& Filename)
 {
+    QMutexLocker locker(&m_muxLock);
     bool result = m_buffer->ReOpen(Filename);
     if (result)
         m_filename = Filename;
@@ -3,6 +3,7 @@
 
 // Qt
 #include <QList>
+#include <QMutex>
 
 // MythTV
 #include "libmythbase/mythconfig.h"
@@ -61,6 +62,8 @@ class MTV_PUBLIC MythAVFormatWriter : public MythMediaWriter
     QList<std::chrono::milliseconds> m_bufferedVideoFrameTimes;
     QList<int>             m_bufferedVideoFrameTypes;
     QList<std::chrono::milliseconds> m_bufferedAudioFrameTimes;
+    /// Audio and video may be written from different threads
+    QMutex                 m_muxLock;
 };
 
 #endif
@@ -44,6 +44,13 @@ extern "C" {
 
 #define LOC      QString("RingBuf(%1): ").arg(m_filename)
 
+/// How often the read ahead thread looks at what has been consumed
+static constexpr std::chrono::milliseconds kReadAheadSample { 500ms };
+/// The least the buffer should hold, however fast the storage
+static constexpr std::chrono::milliseconds kReadAheadTime   { 2s };
+/// Reads slower than this are worth making bigger
+static constexpr std::chrono::milliseconds kSlowRead        { 50ms };
+
 
 /*
   Locking relations:
@@ -583,6 +590,20 @@ void MythMediaBuffer::ResetReadAhead(long long NewInternal)
     m_rbrLock.lockForWrite();
     m_rbwLock.lockForWrite();
 
+    // The buffer is about to be emptied, so it can shrink as well as grow
+    uint resize = (m_targetBufferSize > m_bufferSize) ? m_targetBufferSize - m_bufferSize
+                                                      : m_bufferSize - m_targetBufferSize;
+    if (m_readAheadBuffer && m_targetBufferSize && (resize >= m_bufferSize / 4))
+    {
+        LOG(VB_FILE, LOG_INFO, LOC + QString("Resizing readAheadBuffer: %1Mb -> %2Mb")
+            .arg(m_bufferSize >> 20).arg(m_targetBufferSize >> 20));
+        delete [] m_readAheadBuffer;
+        m_bufferSize = m_targetBufferSize;
+        m_readAheadBuffer = new char[m_bufferSize + 1024];
+        m_minReadBlock  = std::min(m_minReadBlock, static_cast<int>(m_bufferSize / 8));
+        m_readBlockSize = std::min(m_readBlockSize, static_cast<int>(m_bufferSize / 8));
+    }
+
     CalcReadAheadThresh();
 
     m_rbrPos          = 0;
@@ -600,6 +621,65 @@ void MythMediaBuffer::ResetReadAhead(long long NewInternal)
     m_rbrLock.unlock();
 }
 
+/** \fn MythMediaBuffer::AdaptReadAhead(std::chrono::milliseconds, long long)
+ *  \brief Sizes the buffer and reads from how fast the buffer is emptied
+ *         and how long the storage takes to fill it.
+ *
+ *   The buffer should hold twice what is played while a few reads are
+ *   outstanding, and never less than kReadAheadTime of it. It is grown
+ *   straight away but only made smaller by ResetReadAhead(), when it is
+ *   empty anyway. When the storage is slow the reads are made big enough
+ *   to keep up with one in flight.
+ *
+ *  \warning Must be called from the read ahead thread with rwlock in read lock state.
+ *  \param Elapsed  Time since the last call
+ *  \param Consumed How far the read position moved in that time
+ *  \return True if the buffer should be grown now
+ */
+bool MythMediaBuffer::AdaptReadAhead(std::chrono::milliseconds Elapsed, long long Consumed)
+{
+    // Nothing consumed is a paused player, and going backwards or
+    // further than the buffer holds is a seek.
+    if (Elapsed <= 0ms || Consumed <= 0 || Consumed > m_bufferSize)
+        return false;
+
+    uint64_t rate = static_cast<uint64_t>(Consumed) * 1000 / static_cast<uint64_t>(Elapsed.count());
+    uint64_t last = m_consumeRate;
+    rate = last ? ((last * 3) + rate) / 4 : rate;
+    m_consumeRate = rate;
+
+    auto latency = std::chrono::milliseconds(m_readLatency.load());
+    auto ahead = std::max(kReadAheadTime, latency * 4);
+    uint64_t target = 2 * rate * static_cast<uint64_t>(ahead.count()) / 1000;
+    target = ((target + 0xFFFFF) >> 20) << 20; // whole Mb
+    m_targetBufferSize = static_cast<uint>(std::clamp<uint64_t>(target, BUFFER_SIZE_MINIMUM,
+                                                                BUFFER_SIZE_MAXIMUM));
+
+    // The read interval adaptation in run() will not go below this
+    int minblock = 0;
+    if (latency > kSlowRead)
+    {
+        uint64_t block = 2 * rate * static_cast<uint64_t>(latency.count()) / 1000;
+        block = std::min<uint64_t>(block, m_bufferSize / 8);
+        minblock = static_cast<int>((block / DEFAULT_CHUNK_SIZE) * DEFAULT_CHUNK_SIZE);
+    }
+    if (minblock != m_minReadBlock)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC + QString("Reads take %1ms at %2: min block size %3K -> %4K")
+            .arg(latency.count()).arg(BitrateToString(rate * 8))
+            .arg(m_minReadBlock / 1024).arg(minblock / 1024));
+        m_minReadBlock = minblock;
+    }
+    m_readBlockSize = std::max(m_readBlockSize, m_minReadBlock);
+
+    // Don't copy the buffer for every small change in the rate
+    if (m_targetBufferSize < m_bufferSize + (m_bufferSize / 4))
+        return false;
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Growing readAheadBuffer for %1 with %2ms reads")
+        .arg(BitrateToString(rate * 8)).arg(latency.count()));
+    return true;
+}
+
 /**
  *  \brief Starts the read-ahead thread.
  *
@@ -789,6 +869,7 @@ void MythMediaBuffer::CreateReadAheadBuffer(void)
         if (m_unknownBitrate)
             newsize *= BUFFER_FACTOR_BITRATE;
     }
+    newsize = std::max(newsize, m_targetBufferSize);
 
     // N.B. Don't try and make it smaller - bad things happen...
     if (m_readAheadBuffer && (oldsize >= newsize))
@@ -833,6 +914,10 @@ void MythMediaBuffer::run(void)
 
     auto lastread = nowAsDuration<std::chrono::milliseconds>();
 
+    // These are used to size the buffer from how fast it is emptied
+    auto lastsample = lastread;
+    long long lastreadpos = 0;
+
     CreateReadAheadBuffer();
     m_rwLock.lockForWrite();
     m_posLock.lockForWrite();
@@ -933,7 +1018,8 @@ void MythMediaBuffer::run(void)
                         .arg(readTimeAvg.count()).arg(old_block_size/1024).arg(m_readBlockSize/1024));
                     readTimeAvg = 225ms;
                 }
-                else if (readTimeAvg > 300ms && m_readBlockSize > DEFAULT_CHUNK_SIZE)
+                else if (readTimeAvg > 300ms &&
+                         m_readBlockSize > std::max(DEFAULT_CHUNK_SIZE, m_minReadBlock))
                 {
                     m_readBlockSize -= DEFAULT_CHUNK_SIZE;
                     LOG(VB_FILE, LOG_INFO, LOC +
@@ -982,6 +1068,8 @@ void MythMediaBuffer::run(void)
                 .arg(QString("(%1Mbps)").arg(static_cast<double>(bps) / 1000000.0))
                 .arg(readTimeAvg.count()));
             UpdateStorageRate(bps);
+            if (readResult > 0)
+                m_readLatency = ((m_readLatency * 7) + sr_elapsed) / 8;
 
             if (readResult >= 0)
             {
@@ -1129,6 +1217,22 @@ void MythMediaBuffer::run(void)
                 m_rwLock.lockForRead();
             }
         }
+
+        auto sampled = nowAsDuration<std::chrono::milliseconds>();
+        if (sampled - lastsample >= kReadAheadSample)
+        {
+            m_posLock.lockForRead();
+            long long readpos = m_readPos;
+            m_posLock.unlock();
+            if (AdaptReadAhead(sampled - lastsample, readpos - lastreadpos))
+            {
+                m_rwLock.unlock();
+                CreateReadAheadBuffer();
+                m_rwLock.lockForRead();
+            }
+            lastsample  = sampled;
+            lastreadpos = readpos;
+        }
     }
 
     m_rwLock.unlock();
@@ -1560,6 +1664,19 @@ QString MythMediaBuffer::GetAvailableBuffer(void)
     return QString("%1%").arg(lroundf((static_cast<float>(avail) / static_cast<float>(m_bufferSize) * 100.0F)));
 }
 
+/// How long the buffered data will last, and the reads that fill it.
+QString MythMediaBuffer::GetReadAheadStats(void)
+{
+    if (m_type == kMythBufferDVD || m_type == kMythBufferBD)
+        return "N/A";
+
+    uint64_t rate = m_consumeRate;
+    QString ahead = rate ? QString("%1s").arg(static_cast<double>(ReadBufAvail()) / rate, 0, 'f', 1)
+                         : QString("-");
+    return QString("%1 ahead, %2K reads in %3ms")
+        .arg(ahead).arg(m_readBlockSize / 1024).arg(m_readLatency.load());
+}
+
 uint MythMediaBuffer::GetBufferSize(void) const
 {
     return m_bufferSize;
@@ -1,6 +1,9 @@
 #ifndef MYTHMEDIABUFFER_H
 #define MYTHMEDIABUFFER_H
 
+// Std
+#include <atomic>
+
 // Qt
 #include <QReadWriteLock>
 #include <QWaitCondition>
@@ -24,6 +27,8 @@ static constexpr qint64 kReadTestSize { 20 };
 
 // about one second at 35Mb
 static constexpr uint32_t BUFFER_SIZE_MINIMUM    { 4 * 1024 * 1024 };
+// enough for a few seconds of UHD from slow storage
+static constexpr uint32_t BUFFER_SIZE_MAXIMUM    { 64 * 1024 * 1024 };
 static constexpr uint8_t  BUFFER_FACTOR_NETWORK  { 2 };
 static constexpr uint8_t  BUFFER_FACTOR_BITRATE  { 2 };
 static constexpr uint8_t  BUFFER_FACTOR_MATROSKA { 2 };
@@ -89,6 +94,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     QString   GetDecoderRate       (void);
     QString   GetStorageRate       (void);
     QString   GetAvailableBuffer   (void);
+    QString   GetReadAheadStats    (void);
     uint      GetBufferSize        (void) const;
     bool      IsNearEnd            (double Framerate, uint Frames) const;
     long long GetWritePosition     (void) const;
@@ -158,6 +164,7 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     int      ReadBufFree           (void) const;
     int      ReadBufAvail          (void) const;
     void     ResetReadAhead        (long long NewInternal);
+    bool     AdaptReadAhead        (std::chrono::milliseconds Elapsed, long long Consumed);
     void     KillReadAheadThread   (void);
     uint64_t UpdateDecoderRate     (uint64_t Latest = 0);
     uint64_t UpdateStorageRate     (uint64_t Latest = 0);
@@ -236,12 +243,21 @@ class MTV_PUBLIC MythMediaBuffer : protected MThread
     QMutex                 m_storageReadLock;
     QMap<std::chrono::milliseconds, uint64_t> m_storageReads;
 
+    // Measured by the read ahead thread, see AdaptReadAhead()
+    std::atomic<uint64_t>  m_consumeRate      { 0 }; ///< Bytes per second taken by the reader
+    std::atomic<int>       m_readLatency      { 0 }; ///< Average milliseconds a SafeRead takes
+    uint                   m_targetBufferSize { 0 }; // (see note 2)
+    int                    m_minReadBlock     { 0 }; // (see note 2)
+
     // note 1: numfailures is modified with only a read lock in the
     // read ahead thread, but this is safe since all other places
     // that use it are protected by a write lock. But this is a
     // fragile state of affairs and care must be taken when modifying
     // code or locking around this variable.
 
+    // note 2: these are set with only a read lock in the read ahead
+    // thread, and only used there or with the write lock held.
+
     /// Condition to signal that the read ahead thread is running
     QWaitCondition         m_generalWait; // protected by rwLock
 
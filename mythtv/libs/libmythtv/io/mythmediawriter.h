@@ -1,6 +1,10 @@
 #ifndef FILEWRITERBASE_H
 #define FILEWRITERBASE_H
 
+// C++
+#include <atomic>
+#include <chrono>
+
 // QT
 #include <QString>
 
@@ -65,7 +69,7 @@ class MTV_PUBLIC MythMediaWriter
     int         m_audioFrameSize         { -1     };
     int         m_encodingThreadCount    { 1      };
     long long   m_framesWritten          { 0      };
-    std::chrono::milliseconds  m_startingTimecodeOffset { -1ms   };
+    std::atomic<std::chrono::milliseconds> m_startingTimecodeOffset { -1ms };
     QString     m_encodingPreset;
     QString     m_encodingTune;
 };
@@ -31,6 +31,7 @@
 #include "previewgenerator.h"
 #include "recordinginfo.h"
 #include "recordingprofile.h"
+#include "trickplaygenerator.h"
 
 #define LOC     QString("JobQueue: ")
 
@@ -629,6 +630,9 @@ bool JobQueue::QueueJobs(int jobTypes, uint chanid, const QDateTime &recstartts,
         }
     }
 
+    if (jobTypes & JOB_TRICKPLAY)
+        QueueJob(JOB_TRICKPLAY, chanid, recstartts, args, comment, host);
+
     if (jobTypes & JOB_USERJOB1)
         QueueJob(JOB_USERJOB1, chanid, recstartts, args, comment, host);
     if (jobTypes & JOB_USERJOB2)
@@ -1117,6 +1121,7 @@ QString JobQueue::JobText(int jobType)
         case JOB_COMMFLAG:   return tr("Flag Commercials");
         case JOB_METADATA:   return tr("Look up Metadata");
         case JOB_PREVIEW:    return tr("Preview Generation");
+        case JOB_TRICKPLAY:  return tr("Thumbnail Generation");
     }
 
     if (jobType & JOB_USERJOB)
@@ -1455,6 +1460,8 @@ bool JobQueue::AllowedToRun(const JobQueueEntry& job)
                                  break;
             case JOB_PREVIEW:    allowSetting = "JobAllowPreview";
                                  break;
+            case JOB_TRICKPLAY:  allowSetting = "JobAllowTrickplay";
+                                 break;
             default:             return false;
         }
     }
@@ -1761,6 +1768,10 @@ void JobQueue::ProcessJob(const JobQueueEntry& job)
     {
         StartChildJob(MetadataLookupThread, jobID);
     }
+    else if (job.type == JOB_TRICKPLAY)
+    {
+        StartChildJob(TrickplayThread, jobID);
+    }
     else if (job.type & JOB_USERJOB)
     {
         StartChildJob(UserJobThread, jobID);
@@ -2061,6 +2072,9 @@ void JobQueue::DoTranscodeThread(int jobID)
                 ChangeJobStatus(jobID, JOB_FINISHED, tr("Finished."));
                 retry = false;
 
+                // The thumbnails show the recording as it was
+                bool trickplay = TrickplayGenerator::Remove(filename);
+
                 program_info->Reload(); // Refresh, the basename may have changed
                 filename = program_info->GetPlaybackURL(false, true);
                 QFileInfo st(filename);
@@ -2099,6 +2113,12 @@ void JobQueue::DoTranscodeThread(int jobID)
                 }
 
                 program_info->SaveTranscodeStatus(TRANSCODING_COMPLETE);
+
+                if (trickplay)
+                {
+                    QueueJob(JOB_TRICKPLAY, program_info->GetChanID(),
+                             program_info->GetRecordingStartTime());
+                }
             }
             else
             {
@@ -2252,6 +2272,104 @@ void JobQueue::DoMetadataLookupThread(int jobID)
     m_runningJobsLock->unlock();
 }
 
+void *JobQueue::TrickplayThread(void *param)
+{
+    auto *jts = (JobThreadStruct *)param;
+    JobQueue *jq = jts->jq;
+
+    MThread::ThreadSetup(QString("Trickplay_%1").arg(jts->jobID));
+    jq->DoTrickplayThread(jts->jobID);
+    MThread::ThreadCleanup();
+
+    delete jts;
+
+    return nullptr;
+}
+
+void JobQueue::DoTrickplayThread(int jobID)
+{
+    m_runningJobsLock->lock();
+    if (!m_runningJobs[jobID].pginfo)
+    {
+        LOG(VB_JOBQUEUE, LOG_ERR, LOC +
+            "The JobQueue cannot generate thumbnails for items which do "
+            "not have a chanid/starttime in the recorded table.");
+        ChangeJobStatus(jobID, JOB_ERRORED, "ProgramInfo data not found");
+        RemoveRunningJob(jobID);
+        m_runningJobsLock->unlock();
+        return;
+    }
+
+    ProgramInfo *program_info = m_runningJobs[jobID].pginfo;
+    m_runningJobsLock->unlock();
+
+    QString details = QString("%1 recorded from channel %3")
+        .arg(program_info->toString(ProgramInfo::kTitleSubtitle),
+             program_info->toString(ProgramInfo::kRecordingKey));
+
+    LOG(VB_GENERAL, LOG_INFO,
+        LOC + "Thumbnail Generation Starting for " + details);
+
+    QString command = QString("%1 --trickplay --chanid %2 --starttime %3")
+        .arg(GetAppBinDir() + "mythpreviewgen")
+        .arg(program_info->GetChanID())
+        .arg(program_info->GetRecordingStartTime(MythDate::kFilename));
+    command += logPropagateArgs;
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC + QString("Running command: '%1'")
+            .arg(command));
+
+    GetMythDB()->GetDBManager()->CloseDatabases();
+    uint retVal = myth_system(command);
+    int priority = LOG_NOTICE;
+    QString comment;
+
+    m_runningJobsLock->lock();
+
+    if ((retVal == GENERIC_EXIT_DAEMONIZING_ERROR) ||
+        (retVal == GENERIC_EXIT_CMD_NOT_FOUND))
+    {
+        comment = tr("Unable to find mythpreviewgen");
+        ChangeJobStatus(jobID, JOB_ERRORED, comment);
+        priority = LOG_WARNING;
+    }
+    else if (m_runningJobs[jobID].flag == JOB_STOP)
+    {
+        comment = tr("Aborted by user");
+        ChangeJobStatus(jobID, JOB_ABORTED, comment);
+        priority = LOG_WARNING;
+    }
+    else if (retVal == GENERIC_EXIT_NO_RECORDING_DATA)
+    {
+        comment = tr("Unable to open file or init decoder");
+        ChangeJobStatus(jobID, JOB_ERRORED, comment);
+        priority = LOG_WARNING;
+    }
+    else if (retVal >= GENERIC_EXIT_NOT_OK) // 256 or above - error
+    {
+        comment = tr("Failed with exit status %1").arg(retVal);
+        ChangeJobStatus(jobID, JOB_ERRORED, comment);
+        priority = LOG_WARNING;
+    }
+    else
+    {
+        comment = tr("Thumbnail Generation Complete.");
+        ChangeJobStatus(jobID, JOB_FINISHED, comment);
+    }
+
+    QString msg = tr("Thumbnail Generation %1", "Job ID")
+        .arg(StatusText(GetJobStatus(jobID)));
+
+    if (!comment.isEmpty())
+        details += QString(" (%1)").arg(comment);
+
+    if (priority <= LOG_WARNING)
+        LOG(VB_GENERAL, LOG_ERR, LOC + msg + ": " + details);
+
+    RemoveRunningJob(jobID);
+    m_runningJobsLock->unlock();
+}
+
 void *JobQueue::FlagCommercialsThread(void *param)
 {
     auto *jts = (JobThreadStruct *)param;
@@ -82,6 +82,7 @@ enum JobTypes : std::uint16_t {
     JOB_COMMFLAG     = 0x0002,
     JOB_METADATA     = 0x0004,
     JOB_PREVIEW      = 0x0008,
+    JOB_TRICKPLAY    = 0x0010,
 
     JOB_USERJOB      = 0xff00,
     JOB_USERJOB1     = 0x0100,
@@ -249,6 +250,9 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     static void *MetadataLookupThread(void *param);
     void DoMetadataLookupThread(int jobID);
 
+    static void *TrickplayThread(void *param);
+    void DoTrickplayThread(int jobID);
+
     static void *FlagCommercialsThread(void *param);
     void DoFlagCommercialsThread(int jobID);
 
@@ -107,6 +107,7 @@ HEADERS += livetvchain.h            playgroup.h
 HEADERS += channelsettings.h
 HEADERS += previewgenerator.h       previewgeneratorqueue.h
 HEADERS += transporteditor.h        listingsources.h
+HEADERS += trickplaygenerator.h
 HEADERS += restoredata.h
 HEADERS += channelgroup.h
 HEADERS += recordingrule.h
@@ -150,6 +151,7 @@ SOURCES += livetvchain.cpp          playgroup.cpp
 SOURCES += channelsettings.cpp
 SOURCES += previewgenerator.cpp     previewgeneratorqueue.cpp
 SOURCES += transporteditor.cpp
+SOURCES += trickplaygenerator.cpp
 SOURCES += restoredata.cpp
 SOURCES += channelgroup.cpp
 SOURCES += recordingrule.cpp
@@ -206,6 +208,7 @@ HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
 HEADERS += mpeg/H2645Parser.h mpeg/AVCParser.h mpeg/HEVCParser.h
 HEADERS += mpeg/tablestatus.h
 HEADERS += mpeg/tsstreamdata.h
+HEADERS += mpeg/psisnapshot.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
@@ -223,6 +226,7 @@ SOURCES += mpeg/iso6937tables.cpp
 SOURCES += mpeg/H2645Parser.cpp mpeg/AVCParser.cpp mpeg/HEVCParser.cpp
 SOURCES += mpeg/tablestatus.cpp
 SOURCES += mpeg/tsstreamdata.cpp
+SOURCES += mpeg/psisnapshot.cpp
 
 # Channels, and the multiplexes that transmit them
 HEADERS += frequencies.h            frequencytables.h
@@ -360,6 +364,7 @@ using_frontend {
     HEADERS += mythplayeruibase.h
     HEADERS += mythplayerui.h
     HEADERS += mythplayereditorui.h
+    HEADERS += mythdecodedframecache.h
     HEADERS += mythplayervideoui.h
     HEADERS += mythplayercaptionsui.h
     HEADERS += mythplayeroverlayui.h
@@ -384,6 +389,7 @@ using_frontend {
     SOURCES += mythplayeruibase.cpp
     SOURCES += mythplayerui.cpp
     SOURCES += mythplayereditorui.cpp
+    SOURCES += mythdecodedframecache.cpp
     SOURCES += mythplayervideoui.cpp
     SOURCES += mythplayercaptionsui.cpp
     SOURCES += mythplayeroverlayui.cpp
@@ -416,10 +422,12 @@ using_frontend {
     HEADERS += decoders/avformatdecoder.h
     HEADERS += decoders/mythcodeccontext.h
     HEADERS += decoders/mythdecoderthread.h
+    HEADERS += decoders/mythdecodethreading.h
     SOURCES += decoders/decoderbase.cpp
     SOURCES += decoders/avformatdecoder.cpp
     SOURCES += decoders/mythcodeccontext.cpp
     SOURCES += decoders/mythdecoderthread.cpp
+    SOURCES += decoders/mythdecodethreading.cpp
 
     using_libass: LIBS += -lass
 
@@ -763,9 +771,11 @@ using_backend {
     HEADERS += recorders/recorderbase.h
     HEADERS += recorders/DeviceReadBuffer.h
     HEADERS += recorders/dtvrecorder.h
+    HEADERS += recorders/recordercommflagger.h
     SOURCES += recorders/recorderbase.cpp
     SOURCES += recorders/DeviceReadBuffer.cpp
     SOURCES += recorders/dtvrecorder.cpp
+    SOURCES += recorders/recordercommflagger.cpp
 
     # Import recorder
     HEADERS += recorders/importrecorder.h
@@ -206,6 +206,18 @@ bool ATSCStreamData::IsRedundant(uint pid, const PSIPTable &psip) const
      return false;
 }
 
+void ATSCStreamData::ForgetTableVersion(const PSIPTable &psip)
+{
+    if (TableID::MGT == psip.TableID())
+        SetVersionMGT(-1);
+    else if (TableID::TVCT == psip.TableID())
+        SetVersionTVCT(psip.TableIDExtension(), -1);
+    else if (TableID::CVCT == psip.TableID())
+        SetVersionCVCT(psip.TableIDExtension(), -1);
+    else
+        MPEGStreamData::ForgetTableVersion(psip);
+}
+
 bool ATSCStreamData::HandleTables(uint pid, const PSIPTable &psip)
 {
     if (MPEGStreamData::HandleTables(pid, psip))
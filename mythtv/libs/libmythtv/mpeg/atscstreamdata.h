@@ -123,6 +123,7 @@ class MTV_PUBLIC ATSCStreamData : virtual public MPEGStreamData
     void CacheCVCT(uint pid, CableVirtualChannelTable *cvct);
   protected:
     bool DeleteCachedTable(const PSIPTable *psip) const override; // MPEGStreamData
+    void ForgetTableVersion(const PSIPTable &psip) override; // MPEGStreamData
 
   private:
     uint                      m_gpsUtcOffset { GPS_LEAP_SECONDS };
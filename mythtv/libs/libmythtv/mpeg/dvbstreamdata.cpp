@@ -202,6 +202,14 @@ void DVBStreamData::Reset(uint desired_netid, uint desired_tsid,
     AddListeningPID(PID::DVB_TDT_PID);
 }
 
+void DVBStreamData::ForgetTableVersion(const PSIPTable &psip)
+{
+    if (TableID::SDT == psip.TableID())
+        SetVersionSDT(psip.TableIDExtension(), -1, 0);
+    else
+        MPEGStreamData::ForgetTableVersion(psip);
+}
+
 /** \fn DVBStreamData::HandleTables(uint pid, const PSIPTable&)
  *  \brief Process PSIP packets.
  */
@@ -127,6 +127,7 @@ class MTV_PUBLIC DVBStreamData : virtual public MPEGStreamData
 
   protected:
     bool DeleteCachedTable(const PSIPTable *psip) const override; // MPEGStreamData
+    void ForgetTableVersion(const PSIPTable &psip) override; // MPEGStreamData
 
   private:
     /// DVB table monitoring
@@ -13,6 +13,7 @@
 #include "libmythbase/mythlogging.h"
 #include "mpegstreamdata.h"
 #include "mpegtables.h"
+#include "psisnapshot.h"
 
 #include "atscstreamdata.h"
 #include "atsctables.h"
@@ -163,12 +164,81 @@ void MPEGStreamData::Reset(int desiredProgram)
         m_cachedCats.clear();
     }
 
+    m_seededSections.clear();
+
     ResetDecryptionMonitoringState();
 
     AddListeningPID(PID::MPEG_PAT_PID);
     AddListeningPID(PID::MPEG_CAT_PID);
 }
 
+/** \brief Handles the tables stored in the PSI snapshot of this multiplex
+ *         as if they had just been received.
+ *
+ *   Call this after Reset() and before any packets are processed. Each
+ *   seeded section is compared with the live one when it arrives, and is
+ *   replaced if it has changed. See CheckSeededTable().
+ *
+ *  \return Number of sections seeded.
+ */
+uint MPEGStreamData::SeedFromPSISnapshot(void)
+{
+    m_seededSections.clear();
+
+    // Sections are ordered by table id, so the PAT is handled first
+    PSISnapshot::section_list_t sections = PSISnapshot::Get(m_psiSnapshotKey);
+    for (const auto & section : sections)
+    {
+        std::vector<uint8_t> raw(section.m_data.cbegin(), section.m_data.cend());
+        PSIPTable psip(raw);
+        if (!psip.IsGood() || IsRedundant(section.m_pid, psip))
+            continue;
+
+        m_seededSections[PSISnapshot::SectionKey(psip)] = psip.CRC();
+        HandleTables(section.m_pid, psip);
+    }
+
+    if (!m_seededSections.empty())
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Seeded %1 sections from PSI snapshot of multiplex %2")
+                .arg(m_seededSections.size()).arg(m_psiSnapshotKey));
+    }
+    return m_seededSections.size();
+}
+
+/** \brief Compares a live section with the one seeded from the PSI snapshot.
+ *
+ *   If the section has changed without a change of version number, the
+ *   version is forgotten so the live section is handled in place of the
+ *   stale one.
+ */
+void MPEGStreamData::CheckSeededTable(const PSIPTable &psip)
+{
+    auto it = m_seededSections.find(PSISnapshot::SectionKey(psip));
+    if (it == m_seededSections.end())
+        return;
+
+    bool stale = (*it != psip.CRC());
+    m_seededSections.erase(it);
+    if (!stale)
+        return;
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Snapshot of table 0x%1 extension %2 is stale, replacing")
+            .arg(psip.TableID(),2,16,QChar('0')).arg(psip.TableIDExtension()));
+    ForgetTableVersion(psip);
+}
+
+/// Marks the table as not seen, so the next copy received is handled.
+void MPEGStreamData::ForgetTableVersion(const PSIPTable &psip)
+{
+    if (TableID::PAT == psip.TableID())
+        m_patStatus.SetVersion(psip.TableIDExtension(), -1, 0);
+    else if (TableID::PMT == psip.TableID())
+        m_pmtStatus.SetVersion(psip.TableIDExtension(), -1, 0);
+}
+
 void MPEGStreamData::DeletePartialPSIP(uint pid)
 {
     pid_psip_map_t::iterator it = m_partialPsipPacketCache.find(pid);
@@ -920,6 +990,10 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
         DONE_WITH_PSIP_PACKET();
     }
 
+    // Validate any table seeded from the PSI snapshot
+    if (!m_seededSections.empty())
+        CheckSeededTable(*psip);
+
     // Don't decode redundant packets,
     // but if it is a desired PAT or PMT emit a "heartbeat" signal.
     if (MPEGStreamData::IsRedundant(tspacket->PID(), *psip))
@@ -944,6 +1018,9 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
 
     HandleTables(tspacket->PID(), *psip);
 
+    if (m_psiSnapshotKey)
+        PSISnapshot::Store(m_psiSnapshotKey, tspacket->PID(), *psip);
+
     DONE_WITH_PSIP_PACKET();
 }
 #undef DONE_WITH_PSIP_PACKET
@@ -89,6 +89,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     ~MPEGStreamData() override;
 
     void SetCaching(bool cacheTables) { m_cacheTables = cacheTables; }
+    /// Multiplex whose PSI snapshot is seeded from and kept up to date
+    void SetPSISnapshotKey(uint mplexid) { m_psiSnapshotKey = mplexid; }
+    uint SeedFromPSISnapshot(void);
     void SetListeningDisabled(bool lt) { m_listeningDisabled = lt; }
 
     virtual void Reset(void) { Reset(-1); }
@@ -292,6 +295,8 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void ProcessCAT(const ConditionalAccessTable *cat);
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket &tspacket);
+    void CheckSeededTable(const PSIPTable &psip);
+    virtual void ForgetTableVersion(const PSIPTable &psip);
 
     static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
 
@@ -359,6 +364,11 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     mutable psip_refcnt_map_t        m_cachedRefCnt;
     mutable psip_refcnt_map_t        m_cachedSlatedForDeletion;
 
+    // PSI snapshot
+    uint                      m_psiSnapshotKey              {0};
+    /// CRCs of sections seeded from the snapshot but not yet seen live
+    QMap<uint, uint>          m_seededSections;
+
     // Single program variables
     int                       m_desiredProgram;
     QString                   m_recordingType               {"all"};
@@ -0,0 +1,190 @@
+// -*- Mode: c++ -*-
+
+// C++
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// MythTV
+#include "libmythbase/mythdirs.h"
+#include "libmythbase/mythlogging.h"
+
+#include "mpegtables.h"
+#include "psisnapshot.h"
+
+#define LOC QString("PSISnapshot: ")
+
+static constexpr quint32 kSnapshotMagic   { 0x50534931 }; // "PSI1"
+static constexpr uint    kMaxSections     { 1024 };
+
+QMutex                                      PSISnapshot::s_lock;
+QMutex                                      PSISnapshot::s_saveLock;
+QMap<uint, QMap<uint,PSISnapshot::Section>> PSISnapshot::s_snapshots;
+QSet<uint>                                  PSISnapshot::s_loaded;
+QSet<uint>                                  PSISnapshot::s_dirty;
+
+/// Tables that must be seen before a signal monitor reports a lock.
+bool PSISnapshot::IsSnapshotTable(uint table_id)
+{
+    switch (table_id)
+    {
+        case TableID::PAT:
+        case TableID::PMT:
+        case TableID::SDT:
+        case TableID::MGT:
+        case TableID::TVCT:
+        case TableID::CVCT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Identifies a section by table, table extension and section number.
+uint PSISnapshot::SectionKey(const PSIPTable &psip)
+{
+    return (psip.TableID() << 24) | (psip.TableIDExtension() << 8) |
+           psip.Section();
+}
+
+QString PSISnapshot::FileName(uint mplexid)
+{
+    return QString("%1/psi/%2.psi").arg(GetCacheDir()).arg(mplexid);
+}
+
+/// Returns a copy of the sections known for multiplex mplexid.
+PSISnapshot::section_list_t PSISnapshot::Get(uint mplexid)
+{
+    if (!mplexid)
+        return {};
+
+    QMutexLocker locker(&s_lock);
+    Load(mplexid);
+    return s_snapshots.value(mplexid).values();
+}
+
+/** \brief Replaces the stored copy of a section if it has changed.
+ *
+ *   This is called for every table handled on the stream handler thread,
+ *   so it never touches the disk. See Flush().
+ */
+void PSISnapshot::Store(uint mplexid, uint pid, const PSIPTable &psip)
+{
+    if (!mplexid || !IsSnapshotTable(psip.TableID()) || !psip.HasCRC())
+        return;
+
+    QByteArray data(reinterpret_cast<const char*>(psip.pesdata()),
+                    static_cast<int>(psip.SectionLength()));
+
+    QMutexLocker locker(&s_lock);
+    Load(mplexid);
+    QMap<uint,Section> &sections = s_snapshots[mplexid];
+    uint key = SectionKey(psip);
+    auto it = sections.find(key);
+    if (it != sections.end() && it->m_pid == pid && it->m_data == data)
+        return;
+    if (it == sections.end() && static_cast<uint>(sections.size()) >= kMaxSections)
+        return;
+
+    sections[key] = { pid, data };
+    s_dirty.insert(mplexid);
+}
+
+/// Writes out the snapshots that have changed since the last flush.
+void PSISnapshot::Flush(void)
+{
+    QMutexLocker saver(&s_saveLock);
+
+    QMap<uint, QMap<uint,Section>> changed;
+    {
+        QMutexLocker locker(&s_lock);
+        for (uint mplexid : std::as_const(s_dirty))
+            changed.insert(mplexid, s_snapshots.value(mplexid));
+        s_dirty.clear();
+    }
+
+    for (auto it = changed.cbegin(); it != changed.cend(); ++it)
+        Save(it.key(), it.value());
+}
+
+/// Must be called with s_lock held.
+void PSISnapshot::Load(uint mplexid)
+{
+    if (s_loaded.contains(mplexid))
+        return;
+    s_loaded.insert(mplexid);
+
+    QFile file(FileName(mplexid));
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 count = 0;
+    stream >> magic >> count;
+    if (magic != kSnapshotMagic || count > kMaxSections)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Ignoring invalid snapshot '%1'")
+            .arg(file.fileName()));
+        return;
+    }
+
+    QMap<uint,Section> sections;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        quint16 pid = 0;
+        Section section;
+        stream >> pid >> section.m_data;
+        section.m_pid = pid;
+        if (section.m_data.size() < 8)
+            continue;
+
+        std::vector<uint8_t> raw(section.m_data.cbegin(), section.m_data.cend());
+        PSIPTable psip(raw);
+        if (psip.HasCRC() && psip.IsGood())
+            sections[SectionKey(psip)] = section;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Truncated snapshot '%1'")
+            .arg(file.fileName()));
+        return;
+    }
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC + QString("Loaded %1 sections for multiplex %2")
+        .arg(sections.size()).arg(mplexid));
+    s_snapshots[mplexid] = sections;
+}
+
+/// Must be called with s_saveLock held.
+void PSISnapshot::Save(uint mplexid, const QMap<uint,Section> &sections)
+{
+    QString filename = FileName(mplexid);
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Unable to write '%1'")
+            .arg(filename));
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << kSnapshotMagic << static_cast<quint32>(sections.size());
+    for (const auto & section : sections)
+        stream << static_cast<quint16>(section.m_pid) << section.m_data;
+
+    if (!file.commit())
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Unable to write '%1'")
+            .arg(filename));
+    }
+}
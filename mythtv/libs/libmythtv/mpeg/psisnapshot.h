@@ -0,0 +1,58 @@
+// -*- Mode: c++ -*-
+#ifndef PSISNAPSHOT_H
+#define PSISNAPSHOT_H
+
+// Qt
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include "libmythtv/mythtvexp.h"
+
+class PSIPTable;
+
+/** \class PSISnapshot
+ *  \brief Keeps the last PAT, PMT, SDT, MGT and VCT sections seen on
+ *         each multiplex, in memory and on disk.
+ *
+ *   MPEGStreamData seeds itself from the snapshot when a multiplex is tuned,
+ *   so the signal monitor and recorder do not have to wait for the tables
+ *   to be repeated in the stream. A snapshot is marked dirty when a
+ *   different version is seen live, and written back by Flush(), which is
+ *   called from TVRec rather than the stream handler threads. Snapshots
+ *   survive backend restarts in the "psi" subdirectory of the cache directory.
+ */
+class MTV_PUBLIC PSISnapshot
+{
+    friend class TestPSISnapshot;
+
+  public:
+    struct Section
+    {
+        uint       m_pid {0};
+        QByteArray m_data;
+    };
+    using section_list_t = QList<Section>;
+
+    static bool IsSnapshotTable(uint table_id);
+    static section_list_t Get(uint mplexid);
+    static void Store(uint mplexid, uint pid, const PSIPTable &psip);
+    static uint SectionKey(const PSIPTable &psip);
+    static void Flush(void);
+
+  private:
+    static QString FileName(uint mplexid);
+    static void Load(uint mplexid);
+    static void Save(uint mplexid, const QMap<uint,Section> &sections);
+
+    static QMutex                         s_lock;
+    static QMutex                         s_saveLock;
+    static QMap<uint, QMap<uint,Section>> s_snapshots;
+    static QSet<uint>                     s_loaded;
+    static QSet<uint>                     s_dirty;
+};
+
+#endif // PSISNAPSHOT_H
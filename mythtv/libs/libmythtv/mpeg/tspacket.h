@@ -118,6 +118,9 @@ class MTV_PUBLIC TSHeader
     bool GetDiscontinuityIndicator(void) const
     { return (AdaptationFieldSize() > 0) && ((data()[5] & 0x80 ) != 0); }
 
+    bool GetRandomAccessIndicator(void) const
+    { return (AdaptationFieldSize() > 0) && ((data()[5] & 0x40 ) != 0); }
+
     bool HasPCR(void) const { return (AdaptationFieldSize() > 0) &&
                               ((data()[5] & 0x10 ) != 0); }
 
@@ -3,11 +3,13 @@
 
 // MythTV
 #include "libmythbase/mthreadpool.h"
+#include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythlogging.h"
 #include "mythcommflagplayer.h"
 
 // Std
 #include <unistd.h>
+#include <algorithm>
 #include <iostream>
 
 QMutex                   MythRebuildSaver::s_lock;
@@ -55,6 +57,11 @@ void MythRebuildSaver::Wait(DecoderBase*Decoder)
 MythCommFlagPlayer::MythCommFlagPlayer(PlayerContext* Context, PlayerFlags Flags)
   : MythPlayer(Context, Flags)
 {
+    if (Flags & kDecodeLumaOnly)
+    {
+        int sampling = gCoreContext->GetNumSetting("CommFlagNonRefSampling", 1);
+        SetNonRefSampling(static_cast<uint>(std::max(sampling, 1)));
+    }
 }
 
 bool MythCommFlagPlayer::RebuildSeekTable(bool ShowPercentage, StatusCallback Callback, void* Opaque)
@@ -0,0 +1,150 @@
+// Std
+#include <iterator>
+
+// MythTV
+#include "libmythbase/mythlogging.h"
+#include "mythdecodedframecache.h"
+
+#define LOC QString("FrameCache: ")
+
+MythDecodedFrameCache::~MythDecodedFrameCache()
+{
+    Clear();
+}
+
+/*! \brief Set the memory budget for cached frames.
+ *
+ * A budget of zero disables the cache and releases any frames already held.
+*/
+void MythDecodedFrameCache::SetMaxBytes(size_t MaxBytes)
+{
+    QMutexLocker locker(&m_lock);
+    if (MaxBytes != m_maxBytes)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Memory budget %1MB")
+            .arg(MaxBytes / (1024 * 1024)));
+    }
+    m_maxBytes = MaxBytes;
+    if (m_maxBytes == 0)
+    {
+        if (m_hits || m_misses)
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Disabled after %1 hits, %2 misses")
+                .arg(m_hits).arg(m_misses));
+        }
+        m_frames.clear();
+        m_usedBytes = 0;
+        m_hits = 0;
+        m_misses = 0;
+    }
+    else if (!m_frames.empty())
+    {
+        Prune(m_frames.rbegin()->first);
+    }
+}
+
+bool MythDecodedFrameCache::IsEnabled() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_maxBytes > 0;
+}
+
+size_t MythDecodedFrameCache::GetUsedBytes() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_usedBytes;
+}
+
+size_t MythDecodedFrameCache::GetFrameCount() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_frames.size();
+}
+
+/*! \brief Take a copy of the given decoded frame.
+ *
+ * The frame is keyed on its frame number. Hardware frames, dummy frames and
+ * frames that would not fit within the budget on their own are ignored.
+*/
+void MythDecodedFrameCache::AddFrame(MythVideoFrame* Frame)
+{
+    if (!Frame || Frame->m_dummy || !Frame->m_buffer || (Frame->m_type == FMT_NONE) ||
+        MythVideoFrame::HardwareFormat(Frame->m_type))
+    {
+        return;
+    }
+
+    QMutexLocker locker(&m_lock);
+    if (m_maxBytes == 0)
+        return;
+
+    size_t size = MythVideoFrame::GetBufferSize(Frame->m_type, Frame->m_width, Frame->m_height);
+    if (size > m_maxBytes)
+        return;
+
+    auto existing = m_frames.find(Frame->m_frameNumber);
+    if (existing != m_frames.end())
+    {
+        // Reuse the existing buffer if the format has not changed
+        MythVideoFrame* cached = existing->second.get();
+        if (cached->CopyFrame(Frame))
+            return;
+        m_usedBytes -= cached->m_bufferSize;
+        m_frames.erase(existing);
+    }
+
+    auto copy = std::make_unique<MythVideoFrame>(Frame->m_type, Frame->m_width, Frame->m_height);
+    if (!copy->m_buffer || !copy->CopyFrame(Frame))
+        return;
+
+    m_usedBytes += copy->m_bufferSize;
+    m_frames.emplace(Frame->m_frameNumber, std::move(copy));
+    Prune(Frame->m_frameNumber);
+}
+
+bool MythDecodedFrameCache::HasFrame(long long FrameNumber) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_frames.find(FrameNumber) != m_frames.cend();
+}
+
+/*! \brief Copy the cached frame FrameNumber into Destination.
+ *
+ * Destination must be a software frame of the same format and size as the
+ * cached frame (i.e. a buffer from the same video output).
+*/
+bool MythDecodedFrameCache::GetFrame(long long FrameNumber, MythVideoFrame* Destination) const
+{
+    if (!Destination)
+        return false;
+
+    QMutexLocker locker(&m_lock);
+    auto cached = m_frames.find(FrameNumber);
+    if ((cached == m_frames.cend()) || !Destination->CopyFrame(cached->second.get()))
+    {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    return true;
+}
+
+void MythDecodedFrameCache::Clear()
+{
+    QMutexLocker locker(&m_lock);
+    m_frames.clear();
+    m_usedBytes = 0;
+}
+
+/// Evict the frames furthest from Centre until the cache is within budget.
+void MythDecodedFrameCache::Prune(long long Centre)
+{
+    while ((m_usedBytes > m_maxBytes) && !m_frames.empty())
+    {
+        auto first = m_frames.begin();
+        auto last  = std::prev(m_frames.end());
+        auto evict = (Centre - first->first) > (last->first - Centre) ? first : last;
+        m_usedBytes -= evict->second->m_bufferSize;
+        m_frames.erase(evict);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef MYTHDECODEDFRAMECACHE_H
+#define MYTHDECODEDFRAMECACHE_H
+
+// Qt
+#include <QMutex>
+
+// MythTV
+#include "libmythtv/mythframe.h"
+
+// Std
+#include <map>
+#include <memory>
+
+/*! \class MythDecodedFrameCache
+ * \brief A bounded store of decoded, software video frames keyed by frame number.
+ *
+ * Used by the cutlist editor to avoid re-decoding from the previous keyframe
+ * on every frame step or short rewind. Frames are copied in by the decoder
+ * thread as they are decoded (including the frames that are decoded and
+ * thrown away during an exact seek) and copied back out into a video output
+ * buffer when a seek target is already cached.
+ *
+ * The cache is limited by a memory budget rather than a frame count. When the
+ * budget is exceeded, the frames furthest from the most recently added frame
+ * are evicted first, so the cache stays centred on the current position.
+ *
+ * Hardware frames are never cached. All methods are thread safe.
+*/
+class MTV_PUBLIC MythDecodedFrameCache
+{
+  public:
+    MythDecodedFrameCache() = default;
+   ~MythDecodedFrameCache();
+
+    void   SetMaxBytes   (size_t MaxBytes);
+    bool   IsEnabled     () const;
+    size_t GetUsedBytes  () const;
+    size_t GetFrameCount () const;
+
+    void   AddFrame      (MythVideoFrame* Frame);
+    bool   HasFrame      (long long FrameNumber) const;
+    bool   GetFrame      (long long FrameNumber, MythVideoFrame* Destination) const;
+    void   Clear         ();
+
+  private:
+    Q_DISABLE_COPY(MythDecodedFrameCache)
+    void   Prune         (long long Centre);
+
+    mutable QMutex m_lock;
+    std::map<long long, std::unique_ptr<MythVideoFrame>> m_frames;
+    size_t m_maxBytes  { 0 };
+    size_t m_usedBytes { 0 };
+    mutable uint64_t m_hits   { 0 };
+    mutable uint64_t m_misses { 0 };
+};
+
+#endif
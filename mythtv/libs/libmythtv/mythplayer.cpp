@@ -510,6 +510,7 @@ int MythPlayer::OpenFile(int Retries)
     m_decoder->SetWatchingRecording(m_watchingRecording);
     // TODO (re)move this into MythTranscode player
     m_decoder->SetTranscoding(m_transcoding);
+    m_decoder->SetNonRefSampling(m_nonRefSampling);
 
     // Open the decoder
     int result = m_decoder->OpenFile(m_playerCtx->m_buffer, false, testbuf);
@@ -32,6 +32,7 @@
 #include "libmythtv/captions/teletextreader.h"
 #include "libmythtv/commbreakmap.h"
 #include "libmythtv/decoders/decoderbase.h"
+#include "libmythtv/mythdecodedframecache.h"
 #include "libmythtv/deletemap.h"
 #include "libmythtv/mythavutil.h"
 #include "libmythtv/mythplayeravsync.h"
@@ -71,6 +72,7 @@ enum PlayerFlags
     kDecodeNoDecode       = 0x000010,
     kDecodeAllowGPU       = 0x000020,
     kVideoIsNull          = 0x000040,
+    kDecodeLumaOnly       = 0x000080, ///< Only the luma plane is looked at
     kAudioMuted           = 0x010000,
     kNoITV                = 0x020000,
     kMusicChoice          = 0x040000,
@@ -117,6 +119,7 @@ class MTV_PUBLIC MythPlayer : public QObject
     void SetFramesPlayed(uint64_t played);
     void SetEof(EofState eof);
     void SetWatchingRecording(bool mode);
+    void SetNonRefSampling(uint Sampling) { m_nonRefSampling = Sampling; }
     void SetKeyframeDistance(int keyframedistance);
     virtual void SetVideoParams(int w, int h, double fps, float aspect,
                         bool ForceUpdate, int ReferenceFrames,
@@ -182,6 +185,9 @@ class MTV_PUBLIC MythPlayer : public QObject
     void DiscardVideoFrames(bool KeyFrame, bool Flushed);
     /// Returns the stream decoder currently in use.
     DecoderBase *GetDecoder(void) { return m_decoder; }
+    /// Returns the decoded frame cache, or nullptr if it is not in use.
+    MythDecodedFrameCache *GetDecodedFrameCache(void)
+        { return m_frameCache.IsEnabled() ? &m_frameCache : nullptr; }
     virtual bool HasReachedEof(void) const;
     void SetDisablePassThrough(bool disabled);
     void ForceSetupAudioStream(void);
@@ -403,6 +409,7 @@ class MTV_PUBLIC MythPlayer : public QObject
     bool     m_liveTV                     {false};
     bool     m_watchingRecording          {false};
     bool     m_transcoding                {false};
+    uint     m_nonRefSampling             {1};
     bool     m_hasFullPositionMap         {false};
     mutable bool     m_limitKeyRepeat     {false};
 
@@ -476,6 +483,7 @@ class MTV_PUBLIC MythPlayer : public QObject
     bool       m_forcePositionMapSync     {false};
     // Manual editing
     DeleteMap  m_deleteMap;
+    MythDecodedFrameCache m_frameCache;
 
     // Playback (output) speed control
     /// Lock for next_play_speed and next_normal_speed
@@ -1,6 +1,7 @@
 #include <algorithm>
 
 // MythTV
+#include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythui/mythuiactions.h"
 #include "tv_actions.h"
@@ -78,6 +79,11 @@ void MythPlayerEditorUI::EnableEdit()
     if (loadedAutoSave)
         UpdateOSDMessage(tr("Using previously auto-saved cuts"), kOSDTimeout_Short);
 
+    // Keep recently decoded frames so that frame stepping and short rewinds
+    // do not need to decode forward from the previous keyframe.
+    auto cachesize = static_cast<size_t>(gCoreContext->GetNumSetting("EditFrameCacheSize", 256));
+    m_frameCache.SetMaxBytes(cachesize * 1024 * 1024);
+
     m_deleteMap.UpdateSeekAmount(0);
     m_deleteMap.UpdateOSD(m_framesPlayed, m_videoFrameRate, &m_osd);
     m_deleteMap.SetFileEditing(true);
@@ -109,6 +115,7 @@ void MythPlayerEditorUI::DisableEdit(int HowToSave)
     if (m_playerCtx->m_playingInfo)
         m_playerCtx->m_playingInfo->SaveEditing(false);
     m_playerCtx->UnlockPlayingInfo(__FILE__, __LINE__);
+    m_frameCache.SetMaxBytes(0);
     ClearAudioGraph();
     m_tcWrap[TC_AUDIO] = m_savedAudioTimecodeOffset;
     m_savedAudioTimecodeOffset = 0ms;
@@ -826,6 +826,7 @@ void MythPlayerUI::GetPlaybackData(InfoMap& Map)
     Map.insert("storagerate", m_playerCtx->m_buffer->GetStorageRate());
     Map.insert("bufferavail", m_playerCtx->m_buffer->GetAvailableBuffer());
     Map.insert("buffersize",  QString::number(m_playerCtx->m_buffer->GetBufferSize() >> 20));
+    Map.insert("readahead",   m_playerCtx->m_buffer->GetReadAheadStats());
     m_avSync.GetAVSyncData(Map);
 
     if (m_videoOutput)
@@ -56,7 +56,8 @@ uint8_t *MythPreviewPlayer::GetScreenGrabAtFrame(uint64_t FrameNum, bool Absolut
     FrameWidth = FrameHeight = 0;
     AspectRatio = 0;
 
-    if (OpenFile(0) < 0)
+    // The player is left open, so that one player can take several grabs
+    if (!m_decoder && (OpenFile(0) < 0))
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Could not open file for preview.");
         return nullptr;
@@ -99,7 +100,7 @@ uint8_t *MythPreviewPlayer::GetScreenGrabAtFrame(uint64_t FrameNum, bool Absolut
         return result;
     }
 
-    if (!InitVideo())
+    if (!m_videoOutput && !InitVideo())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to initialize video for screen grab.");
         return nullptr;
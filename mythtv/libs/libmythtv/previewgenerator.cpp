@@ -16,6 +16,7 @@
 #include <QImage>
 #include <QMetaType>
 #include <QTemporaryFile>
+#include <QTextStream>
 #include <QUrl>
 
 // MythTV headers
@@ -40,6 +41,9 @@
 
 #define LOC QString("Preview: ")
 
+/// Most images taken from one recording in a single run
+static constexpr qsizetype kMaxBatch { 16 };
+
 /** \class PreviewGenerator
  *  \brief This class creates a preview image of a recording.
  *
@@ -95,9 +99,7 @@ void PreviewGenerator::SetOutputFilename(const QString &fileName)
 {
     if (fileName.isEmpty())
         return;
-    QFileInfo fileinfo = QFileInfo(fileName);
     m_outFileName = fileName;
-    m_outFormat = fileinfo.suffix().toUpper();
 }
 
 void PreviewGenerator::TeardownAll(void)
@@ -119,6 +121,77 @@ void PreviewGenerator::AttachSignals(QObject *obj)
     m_listener = obj;
 }
 
+/**
+ *  \brief True if the image \p other asks for can be taken in the same
+ *         run as this one.
+ *
+ *   Both must be local previews of the same file, written to different
+ *   files. The batch then opens the recording and syncs its position map
+ *   once, and seeks to each image in turn.
+ */
+bool PreviewGenerator::CanBatch(const PreviewGenerator &other) const
+{
+    if ((&other == this) || (other.m_pathname != m_pathname) ||
+        !other.m_batch.isEmpty() || (m_batch.size() + 1 >= kMaxBatch) ||
+        !(m_mode & kLocal) || !(other.m_mode & kLocal))
+    {
+        return false;
+    }
+
+    QString outname = CreateAccessibleFilename(m_pathname, other.m_outFileName);
+    if (outname == CreateAccessibleFilename(m_pathname, m_outFileName))
+        return false;
+    for (const auto & item : m_batch)
+    {
+        if (outname == CreateAccessibleFilename(m_pathname, item.m_outFileName))
+            return false;
+    }
+
+    return IsLocal() && other.IsLocal();
+}
+
+void PreviewGenerator::AddToBatch(const PreviewGenerator &other)
+{
+    BatchItem item;
+    item.m_time        = other.m_captureTime;
+    item.m_outFileName = other.m_outFileName;
+    item.m_outSize     = other.m_outSize;
+    item.m_token       = other.m_token;
+    m_batch.push_back(item);
+}
+
+/**
+ *  \brief Post a PREVIEW_SUCCESS or PREVIEW_FAILED event to the listener.
+ *
+ *   The caller must hold m_previewLock and have checked m_listener.
+ */
+void PreviewGenerator::PostResult(bool ok, const QString &msg,
+                                  const QString &outFileName,
+                                  const QString &token)
+{
+    // keep in sync with default filename in
+    // PreviewGeneratorQueue::GeneratePreviewImage
+    QString output_fn = outFileName.isEmpty() ?
+        (m_programInfo.GetPathname()+".png") : outFileName;
+
+    QDateTime dt;
+    if (ok)
+    {
+        QFileInfo fi(output_fn);
+        if (fi.exists())
+            dt = fi.lastModified();
+    }
+
+    QString message = (ok) ? "PREVIEW_SUCCESS" : "PREVIEW_FAILED";
+    QStringList list;
+    list.push_back(QString::number(m_programInfo.GetRecordingID()));
+    list.push_back(output_fn);
+    list.push_back(msg);
+    list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
+    list.push_back(token);
+    QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
+}
+
 /** \fn PreviewGenerator::RunReal(void)
  *  \brief This call creates a preview without starting a new thread.
  */
@@ -180,27 +253,12 @@ bool PreviewGenerator::RunReal(void)
     QMutexLocker locker(&m_previewLock);
     if (m_listener)
     {
-        // keep in sync with default filename in
-        // PreviewGeneratorQueue::GeneratePreviewImage
-        QString output_fn = m_outFileName.isEmpty() ?
-            (m_programInfo.GetPathname()+".png") : m_outFileName;
-
-        QDateTime dt;
-        if (ok)
+        PostResult(ok, msg, m_outFileName, m_token);
+        for (const auto & item : std::as_const(m_batch))
         {
-            QFileInfo fi(output_fn);
-            if (fi.exists())
-                dt = fi.lastModified();
+            PostResult(item.m_ok, item.m_ok ? msg : "Batched preview failed",
+                       item.m_outFileName, item.m_token);
         }
-
-        QString message = (ok) ? "PREVIEW_SUCCESS" : "PREVIEW_FAILED";
-        QStringList list;
-        list.push_back(QString::number(m_programInfo.GetRecordingID()));
-        list.push_back(output_fn);
-        list.push_back(msg);
-        list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
-        list.push_back(m_token);
-        QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
     }
 
     return ok;
@@ -256,7 +314,16 @@ bool PreviewGenerator::Run(void)
         if (!m_outFileName.isEmpty())
             cmdargs << "--outfile" << m_outFileName;
 
-        // Timeout in 30s
+        // The other images of this recording are listed in a file
+        QTemporaryFile batchfile(QDir::tempPath() + "/mythpreviewgen.XXXXXX");
+        if (!m_batch.isEmpty() && WriteBatchFile(batchfile))
+            cmdargs << "--batchfile" << batchfile.fileName();
+
+        // Images older than this were not written by this run
+        QDateTime started = MythDate::current();
+        started = started.addMSecs(-started.time().msec());
+
+        // Timeout in 30s, and a little longer for each batched image
         auto *ms = new MythSystemLegacy(command, cmdargs,
                                         kMSDontBlockInputDevs |
                                         kMSDontDisableDrawing |
@@ -266,21 +333,14 @@ bool PreviewGenerator::Run(void)
         ms->SetNice(10);
         ms->SetIOPrio(7);
 
-        ms->Run(30s);
+        ms->Run(30s + (m_batch.size() * 5s));
         uint ret = ms->Wait();
         delete ms;
 
-        if (ret != GENERIC_EXIT_OK)
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC +
-                QString("Encountered problems running '%1 %2' - (%3)")
-                    .arg(command, cmdargs.join(" "), QString::number(ret)));
-        }
-        else
+        auto find_output = [this](const QString &outFileName)
         {
-            LOG(VB_PLAYBACK, LOG_INFO, LOC + "Preview process returned 0.");
-            QString outname = (!m_outFileName.isEmpty()) ?
-                m_outFileName : (m_pathname + ".png");
+            QString outname = (!outFileName.isEmpty()) ?
+                outFileName : (m_pathname + ".png");
 
             QString lpath = QFileInfo(outname).fileName();
             if (lpath == outname)
@@ -289,6 +349,26 @@ bool PreviewGenerator::Run(void)
                 QString tmpFile = sgroup.FindFile(lpath);
                 outname = (tmpFile.isEmpty()) ? outname : tmpFile;
             }
+            return outname;
+        };
+
+        for (auto & item : m_batch)
+        {
+            QFileInfo fi(find_output(item.m_outFileName));
+            item.m_ok = (fi.exists() && fi.isReadable() && (fi.size() != 0) &&
+                         (fi.lastModified() >= started));
+        }
+
+        if (ret != GENERIC_EXIT_OK)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Encountered problems running '%1 %2' - (%3)")
+                    .arg(command, cmdargs.join(" "), QString::number(ret)));
+        }
+        else
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC + "Preview process returned 0.");
+            QString outname = find_output(m_outFileName);
 
             QFileInfo fi(outname);
             ok = (fi.exists() && fi.isReadable() && (fi.size() != 0));
@@ -317,33 +397,43 @@ bool PreviewGenerator::Run(void)
     }
 
     QMutexLocker locker(&m_previewLock);
+    if (m_listener)
+    {
+        PostResult(ok, msg, m_outFileName, m_token);
+        for (const auto & item : std::as_const(m_batch))
+        {
+            PostResult(item.m_ok, item.m_ok ? msg : "Batched preview failed",
+                       item.m_outFileName, item.m_token);
+        }
+    }
 
-    // Backdate file to start of preview time in case a bookmark was made
-    // while we were generating the preview.
-    QString output_fn = m_outFileName.isEmpty() ?
-        (m_programInfo.GetPathname()+".png") : m_outFileName;
+    return ok;
+}
 
-    QDateTime dt;
-    if (ok)
+/**
+ *  \brief Write the batched images to a file for mythpreviewgen.
+ *
+ *   One image per line: seconds, width, height and the output file,
+ *   separated by tabs.
+ */
+bool PreviewGenerator::WriteBatchFile(QFile &file) const
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
     {
-        QFileInfo fi(output_fn);
-        if (fi.exists())
-            dt = fi.lastModified();
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to create batch file.");
+        return false;
     }
 
-    QString message = (ok) ? "PREVIEW_SUCCESS" : "PREVIEW_FAILED";
-    if (m_listener)
+    QTextStream stream(&file);
+    for (const auto & item : m_batch)
     {
-        QStringList list;
-        list.push_back(QString::number(m_programInfo.GetRecordingID()));
-        list.push_back(output_fn);
-        list.push_back(msg);
-        list.push_back(dt.isValid()?dt.toUTC().toString(Qt::ISODate):"");
-        list.push_back(m_token);
-        QCoreApplication::postEvent(m_listener, new MythEvent(message, list));
+        stream << item.m_time.count() << '\t' << item.m_outSize.width()
+               << '\t' << item.m_outSize.height() << '\t' << item.m_outFileName
+               << '\n';
     }
-
-    return ok;
+    stream.flush();
+    file.close();
+    return true;
 }
 
 void PreviewGenerator::run(void)
@@ -636,8 +726,26 @@ bool PreviewGenerator::LocalPreviewRun(void)
     m_programInfo.MarkAsInUse(true, kPreviewGeneratorInUseID);
     m_programInfo.SetIgnoreProgStart(true);
 
+    // The player is opened by the first grab, and reused by the others
+    PlayerContext *ctx = nullptr;
+    bool ok = LocalPreviewGrab(ctx, m_captureTime, m_outFileName, m_outSize);
+    for (auto & item : m_batch)
+    {
+        item.m_ok = LocalPreviewGrab(ctx, item.m_time, item.m_outFileName,
+                                     item.m_outSize);
+    }
+    delete ctx;
+
+    m_programInfo.MarkAsInUse(false, kPreviewGeneratorInUseID);
+
+    return ok;
+}
+
+bool PreviewGenerator::LocalPreviewGrab(
+    PlayerContext *&ctx, std::chrono::seconds captime,
+    const QString &outFileName, QSize outSize)
+{
     float aspect = 0;
-    std::chrono::seconds captime = m_captureTime;
     long long capframe = -1;
 
     QDateTime dt = MythDate::current();
@@ -692,15 +800,18 @@ bool PreviewGenerator::LocalPreviewRun(void)
     int width = 0;
     int height = 0;
     int sz = 0;
-    auto *data = GetScreenGrab(m_programInfo, m_pathname, captime, capframe,
+    auto *data = GetScreenGrab(ctx, m_programInfo, m_pathname, captime, capframe,
                                sz, width, height, aspect);
 
-    QString outname = CreateAccessibleFilename(m_pathname, m_outFileName);
+    QString outname = CreateAccessibleFilename(m_pathname, outFileName);
 
-    QString format = (m_outFormat.isEmpty()) ? "PNG" : m_outFormat;
+    QString format = outFileName.isEmpty() ?
+        "PNG" : QFileInfo(outFileName).suffix().toUpper();
+    if (format.isEmpty())
+        format = "PNG";
 
-    int dw = (m_outSize.width()  < 0) ? width  : m_outSize.width();
-    int dh = (m_outSize.height() < 0) ? height : m_outSize.height();
+    int dw = (outSize.width()  < 0) ? width  : outSize.width();
+    int dh = (outSize.height() < 0) ? height : outSize.height();
 
     bool ok = SavePreview(outname, data, width, height, aspect, dw, dh,
                           format);
@@ -716,8 +827,6 @@ bool PreviewGenerator::LocalPreviewRun(void)
 
     delete[] data;
 
-    m_programInfo.MarkAsInUse(false, kPreviewGeneratorInUseID);
-
     return ok;
 }
 
@@ -778,6 +887,9 @@ bool PreviewGenerator::IsLocal(void) const
 /**
  *  \brief Returns a AV_PIX_FMT_RGBA32 buffer containg a frame from the video.
  *
+ *  \param ctx          Player to grab with. If null, one is created for
+ *                      \p filename and returned, so that the next grab from
+ *                      the same file can reuse it. The caller deletes it.
  *  \param pginfo       Recording to grab from.
  *  \param filename     File containing recording.
  *  \param seektime     Seconds into the video to seek before capturing
@@ -792,6 +904,7 @@ bool PreviewGenerator::IsLocal(void) const
  *          successful, nullptr otherwise.
  */
 uint8_t *PreviewGenerator::GetScreenGrab(
+    PlayerContext *&ctx,
     const ProgramInfo &pginfo, const QString &filename,
     std::chrono::seconds seektime, long long seekframe,
     int &bufferlen,
@@ -800,14 +913,14 @@ uint8_t *PreviewGenerator::GetScreenGrab(
     uint8_t *retbuf = nullptr;
     bufferlen = 0;
 
-    if (!MSqlQuery::testDBConnection())
+    if (!ctx && !MSqlQuery::testDBConnection())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Previewer could not connect to DB.");
         return nullptr;
     }
 
     // pre-test local files for existence and size. 500 ms speed-up...
-    if (filename.startsWith("/"))
+    if (!ctx && filename.startsWith("/"))
     {
         QFileInfo info(filename);
         bool invalid = (!info.exists() || !info.isReadable() || (info.isFile() && (info.size() < 8LL*1024)));
@@ -819,20 +932,27 @@ uint8_t *PreviewGenerator::GetScreenGrab(
         }
     }
 
-    MythMediaBuffer* buffer = MythMediaBuffer::Create(filename, false, false, 0ms);
-    if (!buffer || !buffer->IsOpen())
+    if (!ctx)
     {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Previewer could not open file: " +
-                QString("'%1'").arg(filename));
-        delete buffer;
-        return nullptr;
+        MythMediaBuffer* buffer = MythMediaBuffer::Create(filename, false, false, 0ms);
+        if (!buffer || !buffer->IsOpen())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Previewer could not open file: " +
+                    QString("'%1'").arg(filename));
+            delete buffer;
+            return nullptr;
+        }
+
+        ctx = new PlayerContext(kPreviewGeneratorInUseID);
+        auto * player = new MythPreviewPlayer(ctx, static_cast<PlayerFlags>(kAudioMuted | kVideoIsNull | kNoITV));
+        ctx->SetRingBuffer(buffer);
+        ctx->SetPlayingInfo(&pginfo);
+        ctx->SetPlayer(player);
     }
 
-    auto *ctx = new PlayerContext(kPreviewGeneratorInUseID);
-    auto * player = new MythPreviewPlayer(ctx, static_cast<PlayerFlags>(kAudioMuted | kVideoIsNull | kNoITV));
-    ctx->SetRingBuffer(buffer);
-    ctx->SetPlayingInfo(&pginfo);
-    ctx->SetPlayer(player);
+    auto *player = dynamic_cast<MythPreviewPlayer*>(ctx->m_player);
+    if (!player)
+        return nullptr;
 
     if (seektime >= 0s)
     {
@@ -844,7 +964,6 @@ uint8_t *PreviewGenerator::GetScreenGrab(
         retbuf = player->GetScreenGrabAtFrame(static_cast<uint64_t>(seekframe), true,
                                               bufferlen, video_width, video_height, video_aspect);
     }
-    delete ctx;
 
     auto pos_text = (seektime != std::chrono::seconds::max())
         ? QString::number(seektime.count()) + "s"
@@ -9,6 +9,7 @@
 #include <QSize>
 #include <QMap>
 #include <QSet>
+#include <QVector>
 
 #include "libmythbase/mthread.h"
 #include "libmythbase/mythdate.h"
@@ -16,8 +17,10 @@
 
 #include "mythtvexp.h"
 
+class PlayerContext;
 class PreviewGenerator;
 class QByteArray;
+class QFile;
 class MythSocket;
 class QObject;
 class QEvent;
@@ -32,7 +35,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                               std::chrono::seconds previewSeconds,
                               QSize          previewSize,
                               const QString &infile,
-                              const QString &outfile);
+                              const QString &outfile,
+                              const QString &batchfile);
 
     Q_OBJECT
 
@@ -63,6 +67,19 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 
     QString GetToken(void) const { return m_token; }
 
+    /// Another image of the same recording, taken in the same run
+    struct BatchItem
+    {
+        std::chrono::seconds m_time        {-1s};
+        QString              m_outFileName;
+        QSize                m_outSize     {0,0};
+        QString              m_token;
+        bool                 m_ok          {false};
+    };
+    bool CanBatch(const PreviewGenerator &other) const;
+    void AddToBatch(const PreviewGenerator &other);
+    void AddToBatch(const BatchItem &item) { m_batch.push_back(item); }
+
     void run(void) override; // MThread
     bool Run(void);
 
@@ -80,8 +97,14 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
     bool IsLocal(void) const;
 
     bool RunReal(void);
-
-    static uint8_t *GetScreenGrab(const ProgramInfo &pginfo,
+    bool LocalPreviewGrab(PlayerContext *&ctx, std::chrono::seconds captime,
+                          const QString &outFileName, QSize outSize);
+    bool WriteBatchFile(QFile &file) const;
+    void PostResult(bool ok, const QString &msg, const QString &outFileName,
+                    const QString &token);
+
+    static uint8_t *GetScreenGrab(PlayerContext    *&ctx,
+                                  const ProgramInfo &pginfo,
                                   const QString     &filename,
                                   std::chrono::seconds seektime,
                                   long long          seekframe,
@@ -117,7 +140,7 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
     long long          m_captureFrame  {-1};
     QString            m_outFileName;
     QSize              m_outSize       {0,0};
-    QString            m_outFormat     {"PNG"};
+    QVector<BatchItem> m_batch;
 
     QString            m_token;
     bool               m_gotReply      {false};
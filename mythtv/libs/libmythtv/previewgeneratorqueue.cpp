@@ -3,6 +3,7 @@
 
 // C++
 #include <algorithm>
+#include <cmath>
 
 // QT
 #include <QCoreApplication>
@@ -13,6 +14,7 @@
 #include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdirs.h"
 #include "libmythbase/mythlogging.h"
+#include "libmythbase/mythmiscutil.h"
 #include "libmythbase/remoteutil.h"
 
 // libmythtv
@@ -136,13 +138,15 @@ PreviewGeneratorQueue::~PreviewGeneratorQueue()
  *            request with the response from the backend, and as a key for
  *            some indexing.  A token isn't required, but is strongly
  *            suggested.
+ * \param[in] priority kVisible if someone is waiting to see the image,
+ *            kBackground if it can wait until the visible ones are done.
  */
 void PreviewGeneratorQueue::GetPreviewImage(
     const ProgramInfo &pginfo,
     const QSize outputsize,
     const QString &outputfile,
     std::chrono::seconds time, long long frame,
-    const QString& token)
+    const QString& token, Priority priority)
 {
     if (!s_pgq)
         return;
@@ -172,6 +176,7 @@ void PreviewGeneratorQueue::GetPreviewImage(
         extra += QString::number(frame);
         extra += "0";
     }
+    extra += QString::number(priority);
     auto *e = new MythEvent("GET_PREVIEW", extra);
     QCoreApplication::postEvent(s_pgq, e);
 }
@@ -254,15 +259,19 @@ bool PreviewGeneratorQueue::event(QEvent *e)
         if (it != list.end())
         {
             bool time_fmt_sec = (*it++).toInt() != 0;
+            Priority priority = kVisible;
+            if (it != list.end() && (*it++).toInt() == kBackground)
+                priority = kBackground;
             if (time_fmt_sec)
             {
                 GeneratePreviewImage(evinfo, outputsize, outputfile,
-                                     std::chrono::seconds(time_or_frame), -1, token);
+                                     std::chrono::seconds(time_or_frame), -1,
+                                     token, priority);
             }
             else
             {
                 GeneratePreviewImage(evinfo, outputsize, outputfile,
-                                     -1s, time_or_frame, token);
+                                     -1s, time_or_frame, token, priority);
             }
         }
         return true;
@@ -295,8 +304,12 @@ bool PreviewGeneratorQueue::event(QEvent *e)
 
             if ((*it).m_gen)
                 (*it).m_gen->deleteLater();
+            // A batched preview did not have a thread of its own
+            bool batched = (*it).m_batched;
             (*it).m_gen           = nullptr;
             (*it).m_genStarted    = false;
+            (*it).m_batched       = false;
+            (*it).m_background    = false;
             if (me->Message() == "PREVIEW_SUCCESS")
             {
                 (*it).m_attempts      = 0;
@@ -334,7 +347,8 @@ bool PreviewGeneratorQueue::event(QEvent *e)
                 (*it).m_tokens.clear();
             }
 
-            m_running = (m_running > 0) ? m_running - 1 : 0;
+            if (!batched)
+                m_running = (m_running > 0) ? m_running - 1 : 0;
         }
 
         UpdatePreviewGeneratorThreads();
@@ -409,6 +423,7 @@ void PreviewGeneratorQueue::SendEvent(
  *        request with the response from the backend, and as a key for
  *        some indexing.  A token isn't required, but is strongly
  *        suggested.
+ * \param priority Whether anyone is waiting to see the image.
  * \return The filename of the preview images. This will be null if
  *         the preview does not yet or will never exist.
  *
@@ -426,7 +441,7 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
     const QSize size,
     const QString &outputfile,
     std::chrono::seconds time, long long frame,
-    const QString& token)
+    const QString& token, Priority priority)
 {
     auto pos_text = (time >= 0s)
         ? QString::number(time.count()) + "s"
@@ -557,7 +572,7 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
                 pg->SetOutputSize(size);
             }
 
-            SetPreviewGenerator(key, pg);
+            SetPreviewGenerator(key, pg, priority);
 
             LOG(VB_PLAYBACK, LOG_INFO, LOC +
                 QString("Requested preview for '%1'").arg(key));
@@ -576,7 +591,7 @@ QString PreviewGeneratorQueue::GeneratePreviewImage(
             QString("Not requesting preview for %1,"
                     "as it is already being generated")
                 .arg(pginfo.toString(ProgramInfo::kTitleSubtitle)));
-        IncPreviewGeneratorPriority(key, token);
+        IncPreviewGeneratorPriority(key, token, priority);
     }
 
     UpdatePreviewGeneratorThreads();
@@ -616,7 +631,7 @@ void PreviewGeneratorQueue::GetInfo(
     const QString &key, uint &queue_depth, uint &token_cnt)
 {
     QMutexLocker locker(&m_lock);
-    queue_depth = m_queue.size();
+    queue_depth = m_queue.size() + m_backgroundQueue.size();
     PreviewMap::iterator pit = m_previewMap.find(key);
     token_cnt = (pit == m_previewMap.end()) ? 0 : (*pit).m_tokens.size();
 }
@@ -627,19 +642,36 @@ void PreviewGeneratorQueue::GetInfo(
  *            and are in the form \<basenane\>_\<w\>x\<h\>_\<offset\>.
  *
  * \param[in] token
+ *
+ * \param[in] priority A visible request moves a background preview
+ *            into the visible queue.
  */
 void PreviewGeneratorQueue::IncPreviewGeneratorPriority(
-    const QString &key, const QString& token)
+    const QString &key, const QString& token, Priority priority)
 {
     QMutexLocker locker(&m_lock);
     m_queue.removeAll(key);
 
     PreviewMap::iterator pit = m_previewMap.find(key);
     if (pit == m_previewMap.end())
+    {
+        m_backgroundQueue.removeAll(key);
         return;
+    }
+
+    if (priority == kVisible && (*pit).m_background)
+    {
+        (*pit).m_background = false;
+        m_backgroundQueue.removeAll(key);
+    }
 
     if ((*pit).m_gen && !(*pit).m_genStarted)
-        m_queue.push_back(key);
+    {
+        if (!(*pit).m_background)
+            m_queue.push_back(key);
+        else if (!m_backgroundQueue.contains(key))
+            m_backgroundQueue.push_back(key);
+    }
 
     if (!token.isEmpty())
     {
@@ -650,19 +682,29 @@ void PreviewGeneratorQueue::IncPreviewGeneratorPriority(
 
 /**
  * As long as there are items in the queue, make sure we're running
- * the maximum allowed number of preview generators.
+ * the maximum allowed number of preview generators.  Background
+ * previews are only started when no visible ones are waiting, and
+ * while there are idle cores to spare.
  */
 void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
 {
     QMutexLocker locker(&m_lock);
-    QStringList &q = m_queue;
-    if (!q.empty() && (m_running < m_maxThreads))
+    uint background = m_backgroundQueue.empty() ? 0 : BackgroundThreads();
+    while (m_running < m_maxThreads)
     {
-        QString fn = q.back();
-        q.pop_back();
+        QString fn;
+        if (!m_queue.empty())
+            fn = m_queue.takeLast();
+        else if (!m_backgroundQueue.empty() && (m_running < background))
+            fn = m_backgroundQueue.takeFirst();
+        else
+            break;
+
         PreviewMap::iterator it = m_previewMap.find(fn);
         if (it != m_previewMap.end() && (*it).m_gen && !(*it).m_genStarted)
         {
+            BatchPreviewGenerators((*it).m_gen, m_queue);
+            BatchPreviewGenerators((*it).m_gen, m_backgroundQueue);
             m_running++;
             (*it).m_gen->start();
             (*it).m_genStarted = true;
@@ -670,6 +712,55 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
     }
 }
 
+/**
+ * Hand the queued previews of the same file as \p lead to it, so that
+ * the file is opened and decoded once for all of them.  Each batched
+ * preview still gets its own PREVIEW_SUCCESS or PREVIEW_FAILED event.
+ *
+ * \note Must be called with m_lock held.
+ */
+void PreviewGeneratorQueue::BatchPreviewGenerators(
+    PreviewGenerator *lead, QStringList &queue)
+{
+    for (auto qit = queue.begin(); qit != queue.end(); )
+    {
+        PreviewMap::iterator it = m_previewMap.find(*qit);
+        // The token is how the result finds its way back to this key
+        if (it != m_previewMap.end() && (*it).m_gen && !(*it).m_genStarted &&
+            !(*it).m_gen->GetToken().isEmpty() && lead->CanBatch(*(*it).m_gen))
+        {
+            lead->AddToBatch(*(*it).m_gen);
+            (*it).m_genStarted = true;
+            (*it).m_batched    = true;
+            qit = queue.erase(qit);
+        }
+        else
+        {
+            ++qit;
+        }
+    }
+}
+
+/**
+ * The number of generators that may run for background previews.  This
+ * is the number of cores that the load average says are idle, and the
+ * load average on Linux also counts processes waiting for the disk, so
+ * background previews back off while recordings or other I/O keep the
+ * disks busy.  One is always allowed, so the queue keeps moving.
+ */
+uint PreviewGeneratorQueue::BackgroundThreads(void) const
+{
+    if (!(PreviewGenerator::kLocal & m_mode))
+        return m_maxThreads;
+
+    double load = getLoadAvgs()[0];
+    if (load < 0)
+        return std::max(m_maxThreads / 2, 1U);
+
+    int idle = QThread::idealThreadCount() - static_cast<int>(std::ceil(load));
+    return static_cast<uint>(std::clamp(idle, 1, static_cast<int>(m_maxThreads)));
+}
+
 /** \brief Sets the PreviewGenerator for a specific file.
  *
  * \param[in] key The name of the specific preview being
@@ -677,9 +768,11 @@ void PreviewGeneratorQueue::UpdatePreviewGeneratorThreads(void)
  *            and are in the form \<basenane\>_\<w\>x\<h\>_\<offset\>.
  *
  * \param[in] g
+ *
+ * \param[in] priority Whether anyone is waiting to see the image.
  */
 void PreviewGeneratorQueue::SetPreviewGenerator(
-    const QString &key, PreviewGenerator *g)
+    const QString &key, PreviewGenerator *g, Priority priority)
 {
     if (!g)
         return;
@@ -703,12 +796,14 @@ void PreviewGeneratorQueue::SetPreviewGenerator(
             g->AttachSignals(this);
             state.m_gen = g;
             state.m_genStarted = false;
+            state.m_batched = false;
+            state.m_background = (priority == kBackground);
             if (!g->GetToken().isEmpty())
                 state.m_tokens.insert(g->GetToken());
         }
     }
 
-    IncPreviewGeneratorPriority(key, "");
+    IncPreviewGeneratorPriority(key, "", priority);
 }
 
 /**
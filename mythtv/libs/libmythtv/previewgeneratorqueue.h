@@ -31,6 +31,14 @@ class PreviewGenState
     /// The preview generator for this file is currently running.
     bool              m_genStarted    {false};
 
+    /// Nobody is waiting to see this preview, so it is only generated
+    /// when the machine has time to spare.
+    bool              m_background    {false};
+
+    /// This preview is being generated by the generator of another
+    /// preview of the same file, rather than by a thread of its own.
+    bool              m_batched       {false};
+
     /// How many attempts have been made to generate a preview for
     /// this file.
     uint              m_attempts      {0};
@@ -59,6 +67,11 @@ using PreviewMap = QMap<QString,PreviewGenState>;
  * that the queue will be created at application startup, and torn
  * down at application shutdown.
  *
+ * Requests for previews that are on screen are handled before background
+ * requests, such as the preview of a recording that has just finished.
+ * Queued previews of the same file are generated together, by a single
+ * preview generator.
+ *
  * Preview requestors use tokens to refer to their request.  These
  * have no meaning to the preview generator code, and are mapped to
  * keys which are the used internally for indexing.  Multiple caller
@@ -70,6 +83,12 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     Q_OBJECT
 
   public:
+    enum Priority : std::uint8_t
+    {
+        kVisible    = 0,    ///< Someone is waiting to see this preview
+        kBackground = 1,    ///< Generate this preview when there is time
+    };
+
     static void CreatePreviewGeneratorQueue(
         PreviewGenerator::Mode mode,
         uint maxAttempts, std::chrono::seconds minBlockSeconds);
@@ -85,15 +104,18 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
      *            request with the response from the backend, and as a key for
      *            some indexing.  A token isn't required, but is strongly
      *            suggested.
+     * \param[in] priority Whether anyone is waiting to see the image.
      */
-    static void GetPreviewImage(const ProgramInfo &pginfo, const QString& token)
+    static void GetPreviewImage(const ProgramInfo &pginfo, const QString& token,
+                                Priority priority = kVisible)
     {
-        GetPreviewImage(pginfo, QSize(0,0), "", -1s, -1, token);
+        GetPreviewImage(pginfo, QSize(0,0), "", -1s, -1, token, priority);
     }
     static void GetPreviewImage(const ProgramInfo &pginfo, QSize outputsize,
                                 const QString &outputfile,
                                 std::chrono::seconds time, long long frame,
-                                const QString& token);
+                                const QString& token,
+                                Priority priority = kVisible);
     static void AddListener(QObject *listener);
     static void RemoveListener(QObject *listener);
 
@@ -105,12 +127,16 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     QString GeneratePreviewImage(ProgramInfo &pginfo, QSize size,
                                  const QString &outputfile,
                                  std::chrono::seconds time, long long frame,
-                                 const QString& token);
+                                 const QString& token, Priority priority);
 
     void GetInfo(const QString &key, uint &queue_depth, uint &token_cnt);
-    void SetPreviewGenerator(const QString &key, PreviewGenerator *g);
-    void IncPreviewGeneratorPriority(const QString &key, const QString& token);
+    void SetPreviewGenerator(const QString &key, PreviewGenerator *g,
+                             Priority priority);
+    void IncPreviewGeneratorPriority(const QString &key, const QString& token,
+                                     Priority priority);
     void UpdatePreviewGeneratorThreads(void);
+    void BatchPreviewGenerators(PreviewGenerator *lead, QStringList &queue);
+    uint BackgroundThreads(void) const;
     bool IsGeneratingPreview(const QString &key) const;
     uint IncPreviewGeneratorAttempts(const QString &key);
     void ClearPreviewGeneratorAttempts(const QString &key);
@@ -143,6 +169,9 @@ class MTV_PUBLIC PreviewGeneratorQueue : public QObject, public MThread
     /// The queue of previews to be generated. The next item to be
     /// processed is the one at the *back* of the queue.
     QStringList            m_queue;
+    /// The queue of background previews, which are only generated
+    /// when m_queue is empty. These are processed from the *front*.
+    QStringList            m_backgroundQueue;
     /// The number of threads currently generating previews.
     uint                   m_running    {0};
     /// The maximum number of threads that may concurrently generate
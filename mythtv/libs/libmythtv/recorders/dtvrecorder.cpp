@@ -33,6 +33,7 @@
 #include "mpeg/mpegstreamdata.h"
 #include "mpeg/mpegtables.h"
 #include "mythsystemevent.h"
+#include "recordercommflagger.h"
 #include "tv_rec.h"
 
 #define LOC ((m_tvrec) ? \
@@ -68,6 +69,11 @@ DTVRecorder::~DTVRecorder(void)
 {
     StopRecording();
 
+    delete m_commFlagger;
+    m_commFlagger = nullptr;
+    RecorderCommFlagger::FinishInBackground(m_finishedCommFlagger);
+    m_finishedCommFlagger = nullptr;
+
     DTVRecorder::SetStreamData(nullptr);
 
     if (m_inputPat)
@@ -135,12 +141,24 @@ void DTVRecorder::FinishRecording(void)
         SetTotalFrames(m_framesWrittenCount);
     }
 
+    // The next recording decides for itself. TVRec takes the flagger of
+    // this one, it knows whether a flagging job is wanted.
+    m_commFlagEnabled = false;
+    {
+        QMutexLocker locker(&m_commFlagLock);
+        RecorderCommFlagger::FinishInBackground(m_finishedCommFlagger);
+        m_finishedCommFlagger = m_commFlagger;
+        m_commFlagger = nullptr;
+    }
+
     RecorderBase::FinishRecording();
 }
 
 void DTVRecorder::ResetForNewFile(void)
 {
     LOG(VB_RECORD, LOG_INFO, LOC + "ResetForNewFile(void)");
+    FinishCommFlagging();
+
     QMutexLocker locker(&m_positionMapLock);
 
     // m_seen_psp and m_h2645_parser should
@@ -216,6 +234,60 @@ void DTVRecorder::Reset(void)
     }
 }
 
+/** \brief Flag commercials from the video stream as it is recorded,
+ *         instead of running a commercial flagging job afterwards.
+ *
+ *   Takes effect from the next keyframe of the current recording.
+ */
+void DTVRecorder::SetCommFlagging(bool enable)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("SetCommFlagging(%1)").arg(enable));
+    m_commFlagEnabled = enable;
+    if (!enable)
+        FinishCommFlagging();
+}
+
+void DTVRecorder::CommFlagPacket(const TSPacket &tspacket)
+{
+    QMutexLocker locker(&m_commFlagLock);
+    if (!m_commFlagger)
+    {
+        if (!m_curRecording || (m_primaryVideoCodec == AV_CODEC_ID_NONE) ||
+            !tspacket.PayloadStart())
+            return;
+        m_commFlagger = new RecorderCommFlagger(
+            *m_curRecording, m_primaryVideoCodec, GetFrameRate());
+    }
+    m_commFlagger->AddPacket(tspacket, m_framesWrittenCount);
+}
+
+void DTVRecorder::FinishCommFlagging(void)
+{
+    RecorderCommFlagger *flagger = nullptr;
+    {
+        QMutexLocker locker(&m_commFlagLock);
+        flagger = m_commFlagger;
+        m_commFlagger = nullptr;
+    }
+
+    // The rest of the queue is decoded in the background, so the
+    // recording is not held up.
+    RecorderCommFlagger::FinishInBackground(flagger);
+}
+
+/** \brief Returns the flagger of the recording that has just finished,
+ *         the caller must hand it to RecorderCommFlagger::FinishInBackground().
+ *
+ *   It is nullptr if the recording was not flagged by the recorder.
+ */
+RecorderCommFlagger *DTVRecorder::TakeCommFlagger(void)
+{
+    QMutexLocker locker(&m_commFlagLock);
+    RecorderCommFlagger *flagger = m_finishedCommFlagger;
+    m_finishedCommFlagger = nullptr;
+    return flagger;
+}
+
 void DTVRecorder::SetStreamData(MPEGStreamData *data)
 {
     if (data == m_streamData)
@@ -1638,6 +1710,9 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
         LOG(VB_RECORD, LOG_ERR, LOC +
             "ProcessVideoTSPacket: unknown stream type!");
 
+    if (m_commFlagEnabled && m_firstKeyframe >= 0)
+        CommFlagPacket(tspacket);
+
     return ProcessAVTSPacket(tspacket);
 }
 
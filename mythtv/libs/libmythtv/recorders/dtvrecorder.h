@@ -12,6 +12,7 @@
 #include <vector>
 
 #include <QAtomicInt>
+#include <QMutex>
 #include <QString>
 
 #include "libmythtv/mpeg/H2645Parser.h"
@@ -20,6 +21,7 @@
 #include "libmythtv/scantype.h"
 
 class MPEGStreamData;
+class RecorderCommFlagger;
 class TSPacket;
 class StreamID;
 
@@ -54,6 +56,9 @@ class DTVRecorder :
     int GetVideoFd(void) override // RecorderBase
         { return m_streamFd; }
 
+    void SetCommFlagging(bool enable);
+    RecorderCommFlagger *TakeCommFlagger(void);
+
     virtual void SetStreamData(MPEGStreamData* data);
     MPEGStreamData *GetStreamData(void) const { return m_streamData; }
 
@@ -119,6 +124,10 @@ class DTVRecorder :
     // For handling other (non audio/video) packets
     bool FindOtherKeyframes(const TSPacket *tspacket);
 
+    // In-recorder commercial flagging
+    void CommFlagPacket(const TSPacket &tspacket);
+    void FinishCommFlagging(void);
+
     inline bool CheckCC(uint pid, uint new_cnt);
 
     virtual QString GetSIStandard(void) const { return "mpeg"; }
@@ -214,6 +223,13 @@ class DTVRecorder :
 
     bool                     m_useIForKeyframe            {true};
 
+    // Commercial flagging
+    bool                     m_commFlagEnabled            {false};
+    QMutex                   m_commFlagLock;
+    RecorderCommFlagger     *m_commFlagger                {nullptr};
+    /// Flagger of the last finished recording, until TVRec takes it
+    RecorderCommFlagger     *m_finishedCommFlagger        {nullptr};
+
     // constants
     /// If the number of regular frames detected since the last
     /// detected keyframe exceeds this value, then we begin marking
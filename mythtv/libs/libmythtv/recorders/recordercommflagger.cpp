@@ -0,0 +1,597 @@
+// C++
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+// Qt
+#include <QRunnable>
+
+// MythTV
+#include "libmythbase/mthreadpool.h"
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythdb.h"
+#include "libmythbase/mythlogging.h"
+
+#include "jobqueue.h"
+#include "mpeg/tspacket.h"
+#include "recordercommflagger.h"
+#include "recordinginfo.h"
+
+extern "C"
+{
+#include "libavutil/pixdesc.h"
+}
+
+#define LOC QString("RecCommFlag(%1): ").arg(m_pginfo.MakeUniqueKey())
+
+namespace
+{
+struct SpotLength
+{
+    int m_seconds;
+    int m_tolerance; // in frames
+};
+
+// Same lengths and tolerances as the aggressive blank frame
+// detection in mythcommflag's ClassicCommDetector.
+const std::array<SpotLength,10> kSpotLengths
+{{
+    {   5,  5 }, {  10,  7 }, {  15, 10 }, {  20, 11 }, {  30, 12 },
+    {  40,  1 }, {  45,  1 }, {  60, 15 }, {  90, 10 }, { 120, 10 },
+}};
+
+// Spots closer than this are part of the same break
+constexpr int kMaxSpotGap     { 15 };
+// Programme segments shorter than this between breaks are absorbed
+constexpr int kMinShowSegment { 35 };
+
+class RecorderCommFlaggerFinisher : public QRunnable
+{
+  public:
+    RecorderCommFlaggerFinisher(RecorderCommFlagger *flagger, bool replace_job)
+      : m_flagger(flagger), m_replaceJob(replace_job) {}
+
+    void run(void) override // QRunnable
+    {
+        m_flagger->Finish(m_replaceJob);
+        delete m_flagger;
+    }
+
+  private:
+    RecorderCommFlagger *m_flagger;
+    bool                 m_replaceJob;
+};
+
+/// The commercial detection method a flagging job would use for a
+/// recording on chanid, as mythcommflag decides it.
+SkipType commflag_method(uint chanid)
+{
+    auto method = static_cast<SkipType>(
+        gCoreContext->GetNumSetting("CommercialSkipMethod", COMM_DETECT_ALL));
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT commmethod FROM channel "
+                  "WHERE chanid = :CHANID");
+    query.bindValue(":CHANID", chanid);
+    if (!query.exec())
+    {
+        MythDB::DBError("commflag_method", query);
+        return method;
+    }
+
+    if (query.next())
+    {
+        auto channel = static_cast<SkipType>(query.value(0).toInt());
+        if ((channel != COMM_DETECT_COMMFREE) && (channel != COMM_DETECT_UNINIT))
+            method = channel;
+    }
+    return method;
+}
+} // namespace
+
+RecorderCommFlagger::RecorderCommFlagger(const ProgramInfo &pginfo,
+                                         AVCodecID codec, double frame_rate)
+  : MThread("RecCommFlag"),
+    m_pginfo(pginfo),
+    m_codecId(codec),
+    m_frameRate((frame_rate > 1.0) ? frame_rate : 29.97)
+{
+    m_blankMaxDiff   = gCoreContext->GetNumSetting("CommDetectBlankFrameMaxDiff", 25);
+    m_dimBrightness  = gCoreContext->GetNumSetting("CommDetectDimBrightness", 120);
+    m_minBreakLength = gCoreContext->GetNumSetting("CommDetectMinCommBreakLength", 60);
+    m_maxBreakLength = gCoreContext->GetNumSetting("CommDetectMaxCommBreakLength", 395);
+    start();
+}
+
+RecorderCommFlagger::~RecorderCommFlagger()
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_finishing = true;
+        m_wait.wakeAll();
+    }
+    wait();
+    CloseDecoder();
+}
+
+/** \brief Queues the video payload of a transport stream packet.
+ *
+ *   Called on the recorder's packet thread, frame is the number of
+ *   frames written so far. This never blocks on the decoder.
+ */
+void RecorderCommFlagger::AddPacket(const TSPacket &tspacket, long long frame)
+{
+    if (!tspacket.HasPayload() || tspacket.Scrambled())
+        return;
+
+    uint offset = tspacket.AFCOffset();
+    if (offset >= TSPacket::kSize)
+        return;
+
+    const uint8_t *data = tspacket.data() + offset;
+    uint len = TSPacket::kSize - offset;
+
+    if (tspacket.PayloadStart())
+    {
+        QueuePending();
+
+        // Skip the PES header, ISO 13818-1 2.4.3.6
+        m_pesSynced = false;
+        if (len < 9 || data[0] != 0x00 || data[1] != 0x00 || data[2] != 0x01)
+            return;
+        uint header = 9 + data[8];
+        if (header > len)
+            return;
+
+        data += header;
+        len  -= header;
+        m_pesSynced       = true;
+        m_pendingFrame    = frame;
+        m_pendingKeyframe = tspacket.GetRandomAccessIndicator();
+    }
+
+    if (m_pesSynced && len)
+        m_pending.append(reinterpret_cast<const char*>(data), static_cast<int>(len));
+}
+
+/** \brief Waits for everything queued so far to be analysed and
+ *         saves the final break list.
+ *
+ *   If replace_job is set the recording's flagging job was left to this
+ *   flagger, and it is queued now unless the break list is as good as the
+ *   job's would be.
+ *
+ *  \return true if every frame was decoded and analysed.
+ */
+bool RecorderCommFlagger::Finish(bool replace_job)
+{
+    QueuePending();
+    {
+        QMutexLocker locker(&m_lock);
+        m_finishing = true;
+        m_wait.wakeAll();
+    }
+    wait();
+
+    if (m_droppedChunks)
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+            QString("Dropped %1 PES packets while flagging")
+                .arg(m_droppedChunks));
+    }
+
+    bool complete = IsComplete();
+    if (replace_job)
+        QueueJobIfNeeded(complete);
+    return complete;
+}
+
+/** \brief Finishes and deletes flagger on a pool thread.
+ *
+ *   Decoding what is still queued can take a while, so the recorder
+ *   hands the flagger over here instead of waiting for it in
+ *   FinishRecording(). Nothing may call AddPacket() afterwards.
+ */
+void RecorderCommFlagger::FinishInBackground(RecorderCommFlagger *flagger,
+                                             bool replace_job)
+{
+    if (flagger)
+    {
+        MThreadPool::globalInstance()->start(
+            new RecorderCommFlaggerFinisher(flagger, replace_job),
+            "RecCommFlagFinish");
+    }
+}
+
+/// True if every frame since the first keyframe was decoded and analysed.
+bool RecorderCommFlagger::IsComplete(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_decoded && !m_failed && (m_droppedChunks == 0);
+}
+
+/// Queues the flagging job that was left to this flagger, unless the
+/// job would only look for blank frames in what was all analysed here.
+void RecorderCommFlagger::QueueJobIfNeeded(bool complete)
+{
+    if (complete && (commflag_method(m_pginfo.GetChanID()) == COMM_DETECT_BLANK))
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC + "No flagging job needed");
+        return;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC + "Queueing the flagging job");
+    JobQueue::QueueRecordingJobs(RecordingInfo(m_pginfo), JOB_COMMFLAG);
+}
+
+/// Moves the PES payload gathered by AddPacket() to the worker queue.
+void RecorderCommFlagger::QueuePending(void)
+{
+    if (m_pending.isEmpty())
+        return;
+
+    Chunk chunk { m_pending, m_pendingFrame, false };
+    m_pending.clear();
+
+    QMutexLocker locker(&m_lock);
+    if (m_finishing)
+        return;
+
+    if (m_dropping)
+    {
+        // Resume at a keyframe once there is room again, or anywhere
+        // once the worker has caught up completely.
+        bool resume = m_pendingKeyframe ? (m_queuedBytes < kMaxQueuedBytes / 2)
+                                        : m_queue.isEmpty();
+        if (!resume)
+        {
+            ++m_droppedChunks;
+            return;
+        }
+        m_dropping = false;
+        chunk.m_resync = true;
+    }
+    else if (m_queuedBytes + chunk.m_data.size() > kMaxQueuedBytes)
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+            "Decoder is falling behind, dropping data");
+        m_dropping = true;
+        ++m_droppedChunks;
+        return;
+    }
+
+    m_queuedBytes += chunk.m_data.size();
+    m_queue.append(chunk);
+    m_wait.wakeAll();
+}
+
+void RecorderCommFlagger::run(void)
+{
+    RunProlog();
+
+    if (!OpenDecoder())
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            m_failed = true;
+            m_finishing = true;
+            m_queue.clear();
+            m_queuedBytes = 0;
+        }
+        RunEpilog();
+        return;
+    }
+
+    m_pginfo.SaveCommFlagged(COMM_FLAG_PROCESSING);
+    gCoreContext->SendMessage("COMMFLAG_START " + m_pginfo.MakeUniqueKey());
+    m_publishTimer.start();
+
+    bool first = true;
+    while (true)
+    {
+        Chunk chunk;
+        {
+            QMutexLocker locker(&m_lock);
+            while (m_queue.isEmpty() && !m_finishing)
+                m_wait.wait(&m_lock);
+            if (m_queue.isEmpty())
+                break;
+            chunk = m_queue.takeFirst();
+            m_queuedBytes -= chunk.m_data.size();
+        }
+
+        if (first)
+        {
+            m_frameNumber = chunk.m_frame - 1;
+            first = false;
+        }
+        else if (chunk.m_resync)
+        {
+            // Data was dropped, restart the decoder and frame count
+            avcodec_flush_buffers(m_ctx);
+            av_parser_close(m_parser);
+            m_parser = av_parser_init(m_codecId);
+            if (!m_parser)
+            {
+                m_failed = true;
+                break;
+            }
+            m_frameNumber = chunk.m_frame - 1;
+            m_lastBlank = -2;
+        }
+
+        Decode(reinterpret_cast<const uint8_t*>(chunk.m_data.constData()),
+               static_cast<int>(chunk.m_data.size()));
+
+        if (m_publishTimer.hasExpired(kPublishInterval.count()))
+        {
+            Publish(false);
+            m_publishTimer.restart();
+        }
+    }
+
+    if (m_parser)
+        Decode(nullptr, 0);
+    Publish(true);
+
+    RunEpilog();
+}
+
+bool RecorderCommFlagger::OpenDecoder(void)
+{
+    const AVCodec *codec = avcodec_find_decoder(m_codecId);
+    if (!codec)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("No decoder for %1")
+            .arg(avcodec_get_name(m_codecId)));
+        return false;
+    }
+
+    m_ctx    = avcodec_alloc_context3(codec);
+    m_parser = av_parser_init(m_codecId);
+    m_packet = av_packet_alloc();
+    m_frame  = av_frame_alloc();
+    if (!m_ctx || !m_parser || !m_packet || !m_frame)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to allocate decoder");
+        return false;
+    }
+
+    // Only a rough picture is needed to find blank frames
+    m_ctx->thread_count = 1;
+    m_ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+    m_ctx->skip_loop_filter = AVDISCARD_ALL;
+    m_ctx->lowres = std::min(2, static_cast<int>(codec->max_lowres));
+
+    if (avcodec_open2(m_ctx, codec, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to open %1 decoder")
+            .arg(codec->name));
+        return false;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("Flagging %1 stream, lowres %2")
+        .arg(codec->name).arg(m_ctx->lowres));
+    return true;
+}
+
+void RecorderCommFlagger::CloseDecoder(void)
+{
+    if (m_parser)
+        av_parser_close(m_parser);
+    m_parser = nullptr;
+    avcodec_free_context(&m_ctx);
+    av_packet_free(&m_packet);
+    av_frame_free(&m_frame);
+}
+
+/// Splits elementary stream data into packets and decodes them,
+/// a null buffer flushes the parser and the decoder.
+void RecorderCommFlagger::Decode(const uint8_t *buf, int size)
+{
+    bool flush = (buf == nullptr);
+    while (size > 0 || flush)
+    {
+        uint8_t *data = nullptr;
+        int len = 0;
+        int used = av_parser_parse2(m_parser, m_ctx, &data, &len, buf, size,
+                                    AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+        if (used < 0)
+            break;
+
+        if (!flush)
+        {
+            buf  += used;
+            size -= used;
+        }
+
+        if (len > 0)
+        {
+            m_packet->data = data;
+            m_packet->size = len;
+            DecodePacket(m_packet);
+        }
+
+        if (flush)
+            break;
+    }
+
+    if (flush)
+        DecodePacket(nullptr);
+}
+
+void RecorderCommFlagger::DecodePacket(const AVPacket *pkt)
+{
+    if (avcodec_send_packet(m_ctx, pkt) < 0)
+        return;
+
+    while (avcodec_receive_frame(m_ctx, m_frame) == 0)
+    {
+        AnalyseFrame(m_frame);
+        av_frame_unref(m_frame);
+    }
+}
+
+/// Classic blank frame test on a sparse sample of the luma plane.
+void RecorderCommFlagger::AnalyseFrame(const AVFrame *frame)
+{
+    ++m_frameNumber;
+
+    const AVPixFmtDescriptor *desc =
+        av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL)) ||
+        desc->comp[0].depth != 8 || !frame->data[0] ||
+        frame->width < 16 || frame->height < 16)
+    {
+        return;
+    }
+    m_decoded = true;
+
+    // Stay clear of the edges, which often carry overscan junk
+    int left   = frame->width / 10;
+    int right  = frame->width - left;
+    int top    = frame->height / 10;
+    int bottom = frame->height - top;
+    int step   = std::max(1, frame->width / 80);
+
+    int min = 255;
+    int max = 0;
+    for (int y = top; y < bottom; y += step)
+    {
+        const uint8_t *row = frame->data[0] + (static_cast<ptrdiff_t>(y) *
+                                               frame->linesize[0]);
+        for (int x = left; x < right; x += step)
+        {
+            min = std::min(min, static_cast<int>(row[x]));
+            max = std::max(max, static_cast<int>(row[x]));
+        }
+    }
+
+    if (((max - min) > m_blankMaxDiff) || (max >= m_dimBrightness))
+        return;
+
+    // A run of blank frames counts as one separator
+    if (m_frameNumber != m_lastBlank + 1)
+        m_separators.push_back(m_frameNumber);
+    m_lastBlank = m_frameNumber;
+}
+
+/** \brief Turns the blank frame separators seen so far into breaks.
+ *
+ *   Any two separators a commercial spot length apart delimit a spot,
+ *   spots close together are merged into a break and short programme
+ *   segments between breaks are absorbed, as in ClassicCommDetector.
+ */
+void RecorderCommFlagger::BuildBreakList(frm_dir_map_t &breaks) const
+{
+    double fps = m_frameRate;
+    if (m_ctx && m_ctx->framerate.num > 0 && m_ctx->framerate.den > 0)
+        fps = av_q2d(m_ctx->framerate);
+
+    long long max_spot = std::llround((kSpotLengths.back().m_seconds * fps) +
+                                      kSpotLengths.back().m_tolerance);
+
+    std::vector<std::pair<long long,long long>> spots;
+    for (size_t i = 0; i < m_separators.size(); ++i)
+    {
+        for (size_t j = i + 1; j < m_separators.size(); ++j)
+        {
+            long long gap = m_separators[j] - m_separators[i];
+            if (gap > max_spot)
+                break;
+
+            for (const auto & spot : kSpotLengths)
+            {
+                long long length = std::llround(spot.m_seconds * fps);
+                if (std::abs(gap - length) <= spot.m_tolerance)
+                {
+                    spots.emplace_back(m_separators[i], m_separators[j]);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<long long,long long>> merged;
+    auto max_spot_gap = std::llround(kMaxSpotGap * fps);
+    for (const auto & spot : spots)
+    {
+        if (!merged.empty() && spot.first <= merged.back().second + max_spot_gap)
+            merged.back().second = std::max(merged.back().second, spot.second);
+        else
+            merged.push_back(spot);
+    }
+
+    std::vector<std::pair<long long,long long>> absorbed;
+    auto min_show = std::llround(kMinShowSegment * fps);
+    for (const auto & brk : merged)
+    {
+        if (!absorbed.empty() && brk.first < absorbed.back().second + min_show)
+            absorbed.back().second = std::max(absorbed.back().second, brk.second);
+        else
+            absorbed.push_back(brk);
+    }
+
+    for (const auto & brk : absorbed)
+    {
+        double length = (brk.second - brk.first) / fps;
+        if (length < m_minBreakLength || length > m_maxBreakLength)
+            continue;
+        breaks[brk.first]  = MARK_COMM_START;
+        breaks[brk.second] = MARK_COMM_END;
+    }
+}
+
+/** \brief Writes the break list to the database if it has changed.
+ *
+ *   The final list only marks the recording as flagged if every frame
+ *   was analysed. A running flagging job owns the markup, so nothing is
+ *   written then.
+ */
+void RecorderCommFlagger::Publish(bool final)
+{
+    if (JobQueue::IsJobRunning(JOB_COMMFLAG, m_pginfo))
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC +
+            "A flagging job is running, leaving the markup to it");
+        return;
+    }
+
+    if (!m_decoded)
+    {
+        if (final)
+            m_pginfo.SaveCommFlagged(COMM_FLAG_NOT_FLAGGED);
+        return;
+    }
+
+    frm_dir_map_t breaks;
+    BuildBreakList(breaks);
+
+    if (breaks != m_published)
+    {
+        m_published = breaks;
+        m_pginfo.SaveCommBreakList(breaks);
+
+        QString message = "COMMFLAG_UPDATE " + m_pginfo.MakeUniqueKey();
+        for (auto it = breaks.cbegin(); it != breaks.cend(); ++it)
+        {
+            message += (it == breaks.cbegin()) ? " " : ",";
+            message += QString("%1:%2").arg(it.key()).arg(*it);
+        }
+        gCoreContext->SendMessage(message);
+
+        LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("%1 breaks at frame %2")
+            .arg(breaks.size() / 2).arg(m_frameNumber));
+    }
+
+    if (final)
+    {
+        m_pginfo.SaveMarkupFlag(MARK_UPDATED_CUT);
+        m_pginfo.SaveCommFlagged(IsComplete() ? COMM_FLAG_DONE : COMM_FLAG_NOT_FLAGGED);
+        LOG(VB_COMMFLAG, LOG_INFO, LOC +
+            QString("Finished, %1 breaks in %2 frames")
+                .arg(breaks.size() / 2).arg(m_frameNumber + 1));
+    }
+}
@@ -0,0 +1,126 @@
+// -*- Mode: c++ -*-
+#ifndef RECORDERCOMMFLAGGER_H
+#define RECORDERCOMMFLAGGER_H
+
+// C++
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Qt
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+// MythTV
+#include "libmythbase/mthread.h"
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/programinfo.h"
+#include "libmythbase/programtypes.h"
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+}
+
+class TSPacket;
+
+/** \class RecorderCommFlagger
+ *  \brief Flags commercial breaks while a recording is being written,
+ *         from the video elementary stream seen by the recorder.
+ *
+ *   DTVRecorder hands over every video packet once it has found the first
+ *   keyframe. The PES payload is queued and decoded on a worker thread at
+ *   reduced resolution and without the loop filter, only the luma plane
+ *   of each frame is looked at. Breaks are found with the blank frame
+ *   method of the classic commercial detector and written to the
+ *   recordedmarkup table as they change, so there is a skip list while
+ *   the recording is still being made. Nothing is written while a
+ *   mythcommflag job is running for the recording.
+ *
+ *   If the worker falls behind, packets are dropped until the next
+ *   keyframe rather than delaying the recorder. The flagging job is only
+ *   left out when every frame was analysed and the job would look for
+ *   nothing but blank frames either.
+ */
+class RecorderCommFlagger : public MThread
+{
+  public:
+    RecorderCommFlagger(const ProgramInfo &pginfo, AVCodecID codec,
+                        double frame_rate);
+    ~RecorderCommFlagger() override;
+
+    void AddPacket(const TSPacket &tspacket, long long frame);
+    bool Finish(bool replace_job = false);
+    static void FinishInBackground(RecorderCommFlagger *flagger,
+                                   bool replace_job = false);
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    Q_DISABLE_COPY(RecorderCommFlagger)
+
+    struct Chunk
+    {
+        QByteArray m_data;
+        long long  m_frame  {0};
+        bool       m_resync {false};
+    };
+
+    void QueuePending(void);
+    bool OpenDecoder(void);
+    void CloseDecoder(void);
+    void Decode(const uint8_t *buf, int size);
+    void DecodePacket(const AVPacket *pkt);
+    void AnalyseFrame(const AVFrame *frame);
+    void BuildBreakList(frm_dir_map_t &breaks) const;
+    void Publish(bool final);
+    bool IsComplete(void);
+    void QueueJobIfNeeded(bool complete);
+
+    ProgramInfo          m_pginfo;
+    AVCodecID            m_codecId;
+    double               m_frameRate;
+
+    // Recorder side, only touched by AddPacket()
+    QByteArray           m_pending;
+    long long            m_pendingFrame     {0};
+    bool                 m_pendingKeyframe  {false};
+    bool                 m_pesSynced        {false};
+
+    // Shared between the recorder and the worker
+    QMutex               m_lock;
+    QWaitCondition       m_wait;
+    QList<Chunk>         m_queue;
+    int                  m_queuedBytes      {0};
+    bool                 m_dropping         {false};
+    bool                 m_finishing        {false};
+    uint64_t             m_droppedChunks    {0};
+
+    // Worker side
+    AVCodecContext      *m_ctx              {nullptr};
+    AVCodecParserContext*m_parser           {nullptr};
+    AVPacket            *m_packet           {nullptr};
+    AVFrame             *m_frame            {nullptr};
+    long long            m_frameNumber      {-1};
+    long long            m_lastBlank        {-2};
+    std::vector<long long> m_separators;
+    frm_dir_map_t        m_published;
+    QElapsedTimer        m_publishTimer;
+    std::atomic<bool>    m_decoded          {false};
+    bool                 m_failed           {false};
+
+    // Settings shared with the classic commercial detector
+    int                  m_blankMaxDiff     {25};
+    int                  m_dimBrightness    {120};
+    int                  m_minBreakLength   {60};
+    int                  m_maxBreakLength   {395};
+
+    static constexpr int kMaxQueuedBytes    { 32 * 1024 * 1024 };
+    static constexpr std::chrono::milliseconds kPublishInterval { 30s };
+};
+
+#endif // RECORDERCOMMFLAGGER_H
@@ -0,0 +1,174 @@
+/*
+ *  Class TestPSISnapshot
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <memory>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+
+#include "libmythbase/mythdirs.h"
+#include "libmythtv/mpeg/mpegtables.h"
+#include "libmythtv/mpeg/psisnapshot.h"
+#include "test_psisnapshot.h"
+
+static std::unique_ptr<ProgramAssociationTable> make_pat(uint tsid, uint version, uint pmtpid)
+{
+    std::vector<uint> pnums { 1 };
+    std::vector<uint> pids  { pmtpid };
+    return std::unique_ptr<ProgramAssociationTable>(
+        ProgramAssociationTable::Create(tsid, version, pnums, pids));
+}
+
+static QByteArray section_data(const PSIPTable& psip)
+{
+    return { reinterpret_cast<const char*>(psip.pesdata()),
+             static_cast<int>(psip.SectionLength()) };
+}
+
+static QString snapshot_file(uint mplexid)
+{
+    return QString("%1/psi/%2.psi").arg(GetCacheDir()).arg(mplexid);
+}
+
+// Snapshots are kept on disk in the cache directory
+void TestPSISnapshot::initTestCase(void)
+{
+    QVERIFY(m_confDir.isValid());
+    qputenv("MYTHCONFDIR", m_confDir.path().toLocal8Bit());
+    InitializeMythDirs();
+    QCOMPARE(GetCacheDir(), m_confDir.path() + "/cache");
+}
+
+/// As if the backend had been restarted
+void TestPSISnapshot::forget(void)
+{
+    QMutexLocker locker(&PSISnapshot::s_lock);
+    PSISnapshot::s_snapshots.clear();
+    PSISnapshot::s_loaded.clear();
+    PSISnapshot::s_dirty.clear();
+}
+
+void TestPSISnapshot::snapshot_tables(void)
+{
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::PAT));
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::PMT));
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::SDT));
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::MGT));
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::TVCT));
+    QVERIFY(PSISnapshot::IsSnapshotTable(TableID::CVCT));
+    QVERIFY(!PSISnapshot::IsSnapshotTable(TableID::NIT));
+    QVERIFY(!PSISnapshot::IsSnapshotTable(TableID::PF_EIT));
+    QVERIFY(!PSISnapshot::IsSnapshotTable(TableID::TDT));
+}
+
+void TestPSISnapshot::no_multiplex(void)
+{
+    auto pat = make_pat(1, 0, 0x100);
+    PSISnapshot::Store(0, 0, *pat);
+    QVERIFY(PSISnapshot::Get(0).isEmpty());
+}
+
+void TestPSISnapshot::store(void)
+{
+    auto pat = make_pat(10, 0, 0x100);
+    PSISnapshot::Store(10, 0, *pat);
+
+    auto sections = PSISnapshot::Get(10);
+    QCOMPARE(sections.size(), 1);
+    QCOMPARE(sections.first().m_pid, 0U);
+    QCOMPARE(sections.first().m_data, section_data(*pat));
+
+    // Other multiplexes are kept apart
+    QVERIFY(PSISnapshot::Get(11).isEmpty());
+}
+
+void TestPSISnapshot::replace(void)
+{
+    auto pat = make_pat(20, 0, 0x100);
+    PSISnapshot::Store(20, 0, *pat);
+
+    // A new version of the same section replaces the old one
+    auto newer = make_pat(20, 1, 0x200);
+    PSISnapshot::Store(20, 0, *newer);
+    auto sections = PSISnapshot::Get(20);
+    QCOMPARE(sections.size(), 1);
+    QCOMPARE(sections.first().m_data, section_data(*newer));
+
+    // A section of another transport is kept as well
+    auto other = make_pat(21, 0, 0x300);
+    PSISnapshot::Store(20, 0, *other);
+    QCOMPARE(PSISnapshot::Get(20).size(), 2);
+}
+
+void TestPSISnapshot::flush_and_load(void)
+{
+    auto pat = make_pat(30, 3, 0x100);
+    PSISnapshot::Store(30, 0, *pat);
+
+    // Nothing is written until Flush()
+    QVERIFY(!QFile::exists(snapshot_file(30)));
+    PSISnapshot::Flush();
+    QVERIFY(QFile::exists(snapshot_file(30)));
+
+    forget();
+    auto sections = PSISnapshot::Get(30);
+    QCOMPARE(sections.size(), 1);
+    QCOMPARE(sections.first().m_pid, 0U);
+    QCOMPARE(sections.first().m_data, section_data(*pat));
+}
+
+void TestPSISnapshot::flush_only_changes(void)
+{
+    auto pat = make_pat(40, 0, 0x100);
+    PSISnapshot::Store(40, 0, *pat);
+    PSISnapshot::Flush();
+    QVERIFY(QFile::remove(snapshot_file(40)));
+
+    // Seeing the same section again does not make it worth writing
+    PSISnapshot::Store(40, 0, *pat);
+    PSISnapshot::Flush();
+    QVERIFY(!QFile::exists(snapshot_file(40)));
+
+    // A different one does
+    auto newer = make_pat(40, 1, 0x200);
+    PSISnapshot::Store(40, 0, *newer);
+    PSISnapshot::Flush();
+    QVERIFY(QFile::exists(snapshot_file(40)));
+}
+
+void TestPSISnapshot::invalid_file(void)
+{
+    forget();
+    QVERIFY(QDir().mkpath(GetCacheDir() + "/psi"));
+    QFile file(snapshot_file(50));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write("This is not a snapshot") > 0);
+    file.close();
+
+    QVERIFY(PSISnapshot::Get(50).isEmpty());
+
+    // and it is replaced by the next good one
+    auto pat = make_pat(50, 0, 0x100);
+    PSISnapshot::Store(50, 0, *pat);
+    PSISnapshot::Flush();
+    forget();
+    QCOMPARE(PSISnapshot::Get(50).size(), 1);
+}
+
+QTEST_APPLESS_MAIN(TestPSISnapshot)
@@ -0,0 +1,41 @@
+/*
+ *  Class TestPSISnapshot
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QTemporaryDir>
+#include <QTest>
+
+class TestPSISnapshot : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase(void);
+
+    static void snapshot_tables(void);
+    static void no_multiplex(void);
+    static void store(void);
+    static void replace(void);
+    static void flush_and_load(void);
+    static void flush_only_changes(void);
+    static void invalid_file(void);
+
+  private:
+    static void forget(void);
+
+    QTemporaryDir m_confDir;
+};
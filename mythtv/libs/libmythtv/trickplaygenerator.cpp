@@ -0,0 +1,230 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QUrl>
+
+// MythTV
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythlogging.h"
+#include "libmythbase/mythmiscutil.h"
+
+#include "io/mythmediabuffer.h"
+#include "mythpreviewplayer.h"
+#include "playercontext.h"
+#include "trickplaygenerator.h"
+
+#define LOC QString("Trickplay: ")
+
+/// Time between thumbnails
+static constexpr std::chrono::seconds kInterval { 10s };
+static constexpr int kTileWidth { 160 };
+static constexpr int kColumns   { 10 };
+static constexpr int kRows      { 10 };
+static constexpr int kTilesPerSheet { kColumns * kRows };
+static constexpr int kQuality   { 75 };
+
+TrickplayGenerator::TrickplayGenerator(const ProgramInfo &ProgInfo)
+  : m_programInfo(ProgInfo),
+    m_pathname(ProgInfo.GetPathname())
+{
+}
+
+QString TrickplayGenerator::IndexFilename(const QString &Pathname)
+{
+    return Pathname + ".trickplay.vtt";
+}
+
+QString TrickplayGenerator::SheetFilename(const QString &Pathname, int Sheet)
+{
+    return Pathname + QString(".trickplay.%1.jpg").arg(Sheet);
+}
+
+/// Delete the thumbnails of a recording, returns true if it had any.
+bool TrickplayGenerator::Remove(const QString &Pathname)
+{
+    bool found = QFile::remove(IndexFilename(Pathname));
+    for (int i = 0; QFile::exists(SheetFilename(Pathname, i)); ++i)
+    {
+        QFile::remove(SheetFilename(Pathname, i));
+        found = true;
+    }
+    return found;
+}
+
+bool TrickplayGenerator::Run(void)
+{
+    QFileInfo info(m_pathname);
+    if (!info.isFile() || !info.isReadable())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Cannot read '%1'").arg(m_pathname));
+        return false;
+    }
+    if (!QFileInfo(info.path()).isWritable())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Cannot write to '%1'").arg(info.path()));
+        return false;
+    }
+
+    MythMediaBuffer *buffer = MythMediaBuffer::Create(m_pathname, false, false, 0ms);
+    if (!buffer || !buffer->IsOpen())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Could not open '%1'").arg(m_pathname));
+        delete buffer;
+        return false;
+    }
+
+    m_programInfo.MarkAsInUse(true, kPreviewGeneratorInUseID);
+
+    PlayerContext ctx(kPreviewGeneratorInUseID);
+    auto *player = new MythPreviewPlayer(&ctx, static_cast<PlayerFlags>(kAudioMuted | kVideoIsNull | kNoITV));
+    ctx.SetRingBuffer(buffer);
+    ctx.SetPlayingInfo(&m_programInfo);
+    ctx.SetPlayer(player);
+
+    QString group = QString::fromLatin1(QUrl::toPercentEncoding(m_programInfo.GetStorageGroup()));
+    QString index = "WEBVTT\n";
+    QImage sheet;
+    QSize tile;
+    float fps = 0.0F;
+    uint64_t total = 0;
+    uint64_t step = 0;
+    int count = 0;
+    int sheets = 0;
+    bool ok = true;
+
+    // The first grab opens the file, and tells us the frame rate and length
+    for (uint64_t frame = 0; ok && (step == 0 || frame < total); frame += step)
+    {
+        int bufferlen = 0;
+        int width = 0;
+        int height = 0;
+        float aspect = 0.0F;
+        uint8_t *data = player->GetScreenGrabAtFrame(frame, true, bufferlen,
+                                                     width, height, aspect);
+        if (step == 0)
+        {
+            fps   = player->GetFrameRate();
+            total = player->GetTotalFrameCount();
+            if (!data || fps <= 0.0F || total == 0)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC + QString("Could not decode '%1'")
+                    .arg(m_pathname));
+                delete[] data;
+                ok = false;
+                break;
+            }
+            step = std::max<uint64_t>(1, std::llround(fps * kInterval.count()));
+            aspect = (aspect <= 0.0F) ? static_cast<float>(width) / height : aspect;
+            tile = QSize(kTileWidth, std::max(2, static_cast<int>(std::lround(kTileWidth / aspect / 2)) * 2));
+        }
+
+        int pos = count % kTilesPerSheet;
+        if (pos == 0)
+        {
+            sheet = QImage(tile.width() * kColumns, tile.height() * kRows, QImage::Format_RGB32);
+            sheet.fill(Qt::black);
+        }
+
+        int x = (pos % kColumns) * tile.width();
+        int y = (pos / kColumns) * tile.height();
+        if (data)
+        {
+            // A frame that failed to decode is left black
+            QImage thumb = QImage(data, width, height, QImage::Format_RGB32)
+                .scaled(tile, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            for (int line = 0; line < thumb.height(); ++line)
+            {
+                memcpy(sheet.scanLine(y + line) + (x * 4), thumb.constScanLine(line),
+                       static_cast<size_t>(thumb.width()) * 4);
+            }
+            delete[] data;
+        }
+
+        auto start = std::chrono::milliseconds(std::llround(frame * 1000 / fps));
+        auto end   = std::chrono::milliseconds(std::llround(std::min(frame + step, total) * 1000 / fps));
+        QString url = QString("/Content/GetFile?StorageGroup=%1&FileName=%2")
+            .arg(group, QString::fromLatin1(QUrl::toPercentEncoding(
+                     QFileInfo(SheetFilename(m_pathname, sheets)).fileName())));
+        index += QString("\n%1 --> %2\n%3#xywh=%4,%5,%6,%7\n")
+            .arg(MythDate::formatTime(start, "HH:mm:ss.zzz"),
+                 MythDate::formatTime(end, "HH:mm:ss.zzz"), url)
+            .arg(x).arg(y).arg(tile.width()).arg(tile.height());
+
+        if (++count % kTilesPerSheet == 0)
+            ok = SaveSheet(sheet, sheets++);
+    }
+
+    // The last sheet only keeps the rows it uses
+    if (ok && (count % kTilesPerSheet))
+    {
+        int rows = (((count % kTilesPerSheet) - 1) / kColumns) + 1;
+        ok = SaveSheet(sheet.copy(0, 0, sheet.width(), rows * tile.height()), sheets++);
+    }
+
+    if (ok)
+    {
+        // Sheets left over from a longer version of the recording
+        for (int i = sheets; QFile::exists(SheetFilename(m_pathname, i)); ++i)
+            QFile::remove(SheetFilename(m_pathname, i));
+        ok = SaveIndex(index);
+    }
+
+    if (ok)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Saved %1 thumbnails of '%2' in %3 sheets")
+            .arg(count).arg(m_pathname).arg(sheets));
+    }
+
+    m_programInfo.MarkAsInUse(false, kPreviewGeneratorInUseID);
+    return ok;
+}
+
+bool TrickplayGenerator::SaveSheet(const QImage &Sheet, int Number) const
+{
+    QString filename = SheetFilename(m_pathname, Number);
+    QTemporaryFile file(filename + ".XXXXXX");
+    file.setAutoRemove(false);
+    if (!file.open() || !Sheet.save(&file, "JPEG", kQuality))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to save '%1'").arg(filename));
+        file.remove();
+        return false;
+    }
+
+    makeFileAccessible(file.fileName());
+    QFile::remove(filename);
+    if (!file.rename(filename))
+    {
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+bool TrickplayGenerator::SaveIndex(const QString &Index) const
+{
+    QString filename = IndexFilename(m_pathname);
+    QTemporaryFile file(filename + ".XXXXXX");
+    file.setAutoRemove(false);
+    if (!file.open() || file.write(Index.toUtf8()) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Failed to save '%1'").arg(filename));
+        file.remove();
+        return false;
+    }
+
+    makeFileAccessible(file.fileName());
+    QFile::remove(filename);
+    if (!file.rename(filename))
+    {
+        file.remove();
+        return false;
+    }
+    return true;
+}
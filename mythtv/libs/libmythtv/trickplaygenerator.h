@@ -0,0 +1,42 @@
+#ifndef TRICKPLAYGENERATOR_H
+#define TRICKPLAYGENERATOR_H
+
+// Qt
+#include <QImage>
+#include <QString>
+
+// MythTV
+#include "libmythbase/programinfo.h"
+#include "mythtvexp.h"
+
+/** \class TrickplayGenerator
+ *  \brief Creates the seek bar thumbnails of a recording.
+ *
+ *  One small image is taken at a fixed interval through the recording, and
+ *  the images are tiled into a few JPEG sprite sheets next to it, so that a
+ *  client can show the picture under the seek position without decoding.
+ *  A WebVTT file maps each interval to its tile, using the usual
+ *  "sheet#xywh=x,y,w,h" fragment, with the sheets referred to by their
+ *  /Content/GetFile URL in the recording's storage group.
+ */
+class MTV_PUBLIC TrickplayGenerator
+{
+  public:
+    explicit TrickplayGenerator(const ProgramInfo &ProgInfo);
+    bool Run(void);
+
+    static QString IndexFilename(const QString &Pathname);
+    static QString SheetFilename(const QString &Pathname, int Sheet);
+    static bool    Remove(const QString &Pathname);
+
+  private:
+    Q_DISABLE_COPY(TrickplayGenerator)
+
+    bool SaveSheet(const QImage &Sheet, int Number) const;
+    bool SaveIndex(const QString &Index) const;
+
+    ProgramInfo m_programInfo;
+    QString     m_pathname;
+};
+
+#endif // TRICKPLAYGENERATOR_H
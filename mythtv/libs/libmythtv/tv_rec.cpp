@@ -29,6 +29,7 @@
 #include "mpeg/atscstreamdata.h"
 #include "mpeg/atsctables.h"
 #include "mpeg/dvbstreamdata.h"
+#include "mpeg/psisnapshot.h"
 #include "mythsystemevent.h"
 #include "osd.h"
 #include "previewgeneratorqueue.h"
@@ -36,6 +37,7 @@
 #include "recorders/dtvchannel.h"
 #include "recorders/dtvrecorder.h"
 #include "recorders/dtvsignalmonitor.h"
+#include "recorders/recordercommflagger.h"
 #include "recorders/v4lchannel.h"
 #include "recorders/vboxutils.h"
 #include "recordingprofile.h"
@@ -56,6 +58,7 @@ QMutex            TVRec::s_eitLock;
 static bool is_dishnet_eit(uint inputid);
 static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
                      bool on_host, bool transcode_bfr_comm, bool on_line_comm);
+static bool use_recorder_commflag(const RecordingInfo *rec, bool transcode_bfr_comm);
 static void apply_broken_dvb_driver_crc_hack(ChannelBase* /*c*/, MPEGStreamData* /*s*/);
 static std::chrono::seconds eit_start_rand(uint inputId, std::chrono::seconds eitTransportTimeout);
 
@@ -188,6 +191,7 @@ bool TVRec::Init(void)
 
     m_transcodeFirst    = gCoreContext->GetBoolSetting("AutoTranscodeBeforeAutoCommflag", false);
     m_earlyCommFlag     = gCoreContext->GetBoolSetting("AutoCommflagWhileRecording", false);
+    m_recorderCommFlag  = gCoreContext->GetBoolSetting("CommFlagInRecorder", false);
     m_runJobOnHostOnly  = gCoreContext->GetBoolSetting("JobsRunOnRecordHost", false);
     m_eitTransportTimeout = gCoreContext->GetDurSetting<std::chrono::minutes>("EITTransportTimeout", 5min);
     if (m_eitTransportTimeout < 15s)
@@ -236,6 +240,7 @@ void TVRec::TeardownAll(void)
     LOG(VB_RECORD, LOG_INFO, LOC + "TeardownAll");
 
     TeardownSignalMonitor();
+    PSISnapshot::Flush();
 
     if (m_scanner)
     {
@@ -851,13 +856,20 @@ void TVRec::StartedRecording(RecordingInfo *curRec)
  *         programs. If the recording type is kOneRecord this find
  *         is removed.
  *  \sa ProgramInfo::FinishedRecording(bool prematurestop)
- *  \param curRec RecordingInfo or recording to mark as done
- *  \param recq   Information on the quality if the recording.
+ *  \param curRec  RecordingInfo or recording to mark as done
+ *  \param recq    Information on the quality if the recording.
+ *  \param flagger The recorder's commercial flagger for curRec, if any.
+ *                 It is finished in the background, and takes over the
+ *                 flagging job.
  */
-void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
+void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq,
+                              RecorderCommFlagger *flagger)
 {
     if (!curRec)
+    {
+        RecorderCommFlagger::FinishInBackground(flagger);
         return;
+    }
 
     // Make sure the recording group is up to date
     const QString recgrp = curRec->QueryRecordingGroup();
@@ -925,7 +937,10 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
 
     // This has already been called on this recording..
     if (was_finished)
+    {
+        RecorderCommFlagger::FinishInBackground(flagger);
         return;
+    }
 
     // Notify the frontend watching live tv that this file is final
     if (m_tvChain)
@@ -936,6 +951,7 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
     {
         curRec->FinishedRecording(true); // so end time is updated
         SendMythSystemRecEvent("REC_FINISHED", curRec);
+        RecorderCommFlagger::FinishInBackground(flagger);
         return;
     }
 
@@ -980,7 +996,8 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
     if (curRec->IsLocal() && (fsize >= 1000) &&
         (curRec->GetRecordingStatus() == RecStatus::Recorded))
     {
-        PreviewGeneratorQueue::GetPreviewImage(*curRec, "");
+        PreviewGeneratorQueue::GetPreviewImage(
+            *curRec, "", PreviewGeneratorQueue::kBackground);
     }
 
     // store recording in recorded table
@@ -1029,7 +1046,16 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
     {
         JobQueue::RemoveJobsFromMask(JOB_COMMFLAG,  *autoJob);
         JobQueue::RemoveJobsFromMask(JOB_TRANSCODE, *autoJob);
+        JobQueue::RemoveJobsFromMask(JOB_TRICKPLAY, *autoJob);
     }
+
+    // The flagger queues the flagging job once it has finished, if its
+    // own break list is not as good as the job's would be
+    bool flag_job = flagger && JobQueue::JobIsInMask(JOB_COMMFLAG, *autoJob);
+    if (flag_job)
+        JobQueue::RemoveJobsFromMask(JOB_COMMFLAG, *autoJob);
+    RecorderCommFlagger::FinishInBackground(flagger, flag_job);
+
     if (*autoJob != JOB_NONE)
         JobQueue::QueueRecordingJobs(*curRec, *autoJob);
     m_autoRunJobs.erase(autoJob);
@@ -1202,6 +1228,7 @@ void TVRec::TeardownRecorder(uint request_flags)
                __FILE__, __LINE__);
 
     RecordingQuality *recq = nullptr;
+    RecorderCommFlagger *flagger = nullptr;
     if (m_recorder)
     {
         if (GetV4LChannel())
@@ -1209,6 +1236,9 @@ void TVRec::TeardownRecorder(uint request_flags)
 
         recq = m_recorder->GetRecordingQuality(m_curRecording);
 
+        if (GetDTVRecorder())
+            flagger = GetDTVRecorder()->TakeCommFlagger();
+
         QMutexLocker locker(&m_stateChangeLock);
         delete m_recorder;
         m_recorder = nullptr;
@@ -1225,12 +1255,14 @@ void TVRec::TeardownRecorder(uint request_flags)
         if (!!(request_flags & kFlagKillRec))
             m_curRecording->SetRecordingStatus(RecStatus::Failed);
 
-        FinishedRecording(m_curRecording, recq);
+        FinishedRecording(m_curRecording, recq, flagger);
+        flagger = nullptr;
 
         m_curRecording->MarkAsInUse(false, kRecorderInUseID);
         delete m_curRecording;
         m_curRecording = nullptr;
     }
+    RecorderCommFlagger::FinishInBackground(flagger);
 
     m_pauseNotify = true;
 
@@ -1607,6 +1639,9 @@ void TVRec::run(void)
             m_eitScanStartTime = MythDate::current().addSecs(secs.count());
         }
 
+        // Write out any tables that changed, away from the stream handlers
+        PSISnapshot::Flush();
+
         // We should be no more than a few thousand milliseconds,
         // as the end recording code does not have a trigger...
         // NOTE: If you change anything here, make sure that
@@ -2123,6 +2158,18 @@ bool TVRec::SetupSignalMonitor(bool tablemon, bool EITscan, bool notify)
             return false;
         }
 
+        // Start from the tables seen the last time this multiplex was tuned.
+        // 32767 is how old lineups said there is no multiplex.
+        MPEGStreamData *sd = GetDTVSignalMonitor() && tablemon ?
+            GetDTVSignalMonitor()->GetStreamData() : nullptr;
+        uint mplexid = ChannelUtil::GetMplexID(static_cast<uint>(m_channel->GetChanID()));
+        mplexid = (32767 == mplexid) ? 0 : mplexid;
+        if (sd && mplexid)
+        {
+            sd->SetPSISnapshotKey(mplexid);
+            sd->SeedFromPSISnapshot();
+        }
+
         m_signalMonitor->AddListener(this);
         m_signalMonitor->SetUpdateRate(m_signalMonitor->HasExtraSlowTuning() ?
                                      kSignalMonitoringRate * 5 :
@@ -2856,9 +2903,12 @@ void TVRec::InitAutoRunJobs(RecordingInfo *rec, AutoRunInitType t,
             LoadProfile(nullptr, rec, profile);
             recpro = &profile;
         }
+        // Recordings flagged by the recorder are not flagged early too
+        bool recorder_commflag = m_recorderCommFlag &&
+            use_recorder_commflag(rec, m_transcodeFirst);
         m_autoRunJobs[rec->MakeUniqueKey()] =
             init_jobs(rec, *recpro, m_runJobOnHostOnly,
-                      m_transcodeFirst, m_earlyCommFlag);
+                      m_transcodeFirst, m_earlyCommFlag && !recorder_commflag);
     }
     else
     {
@@ -4134,6 +4184,10 @@ static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
     // grab standard jobs flags from program info
     JobQueue::AddJobsToMask(rec->GetAutoRunJobs(), jobs);
 
+    // seek bar thumbnails are made for every recording, when enabled
+    if (gCoreContext->GetBoolSetting("AutoTrickplay", false))
+        JobQueue::AddJobsToMask(JOB_TRICKPLAY, jobs);
+
     // disable commercial flagging on PBS, BBC, etc.
     if (rec->IsCommercialFree())
         JobQueue::RemoveJobsFromMask(JOB_COMMFLAG, jobs);
@@ -4181,6 +4235,28 @@ static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
     return jobs;
 }
 
+/** \brief Returns true if the recorder should flag commercials in rec
+ *         as it is being recorded.
+ *
+ *   The flagging job is then left to the recorder's flagger, which queues
+ *   it when the recording ends unless the job would find nothing more.
+ */
+static bool use_recorder_commflag(const RecordingInfo *rec,
+                                  bool transcode_bfr_comm)
+{
+    if (!rec || rec->IsCommercialFree() ||
+        (rec->GetRecordingGroup() == "LiveTV"))
+        return false;
+
+    int jobs = 0;
+    JobQueue::AddJobsToMask(rec->GetAutoRunJobs(), jobs);
+    if (JobQueue::JobIsNotInMask(JOB_COMMFLAG, jobs))
+        return false;
+
+    // The break list would not match the transcoded file
+    return JobQueue::JobIsNotInMask(JOB_TRANSCODE, jobs) || !transcode_bfr_comm;
+}
+
 QString TVRec::LoadProfile(void *tvchain, RecordingInfo *rec,
                            RecordingProfile &profile) const
 {
@@ -4339,6 +4415,12 @@ void TVRec::TuningNewRecorder(MPEGStreamData *streamData)
     if (rec)
         m_recorder->SetRecording(rec);
 
+    if (GetDTVRecorder())
+    {
+        GetDTVRecorder()->SetCommFlagging(
+            m_recorderCommFlag && use_recorder_commflag(rec, m_transcodeFirst));
+    }
+
     if (GetDTVRecorder() && streamData)
     {
         const StandardSetting *setting = profile.byName("recordingtype");
@@ -4861,7 +4943,8 @@ RecordingInfo *TVRec::SwitchRecordingRingBuffer(const RecordingInfo &rcinfo)
         return nullptr;
     }
 
-    PreviewGeneratorQueue::GetPreviewImage(*m_curRecording, "");
+    PreviewGeneratorQueue::GetPreviewImage(
+        *m_curRecording, "", PreviewGeneratorQueue::kBackground);
 
     ri->MarkAsInUse(true, kRecorderInUseID);
     StartedRecording(ri);
@@ -42,6 +42,7 @@ class LiveTVChain;
 
 class RecorderBase;
 class DTVRecorder;
+class RecorderCommFlagger;
 class DVBRecorder;
 class HDHRRecorder;
 class ASIRecorder;
@@ -318,7 +319,8 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     RecordingInfo *SwitchRecordingRingBuffer(const RecordingInfo &rcinfo);
 
     void StartedRecording(RecordingInfo *curRec);
-    void FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq);
+    void FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq,
+                           RecorderCommFlagger *flagger = nullptr);
     QDateTime GetRecordEndTime(const ProgramInfo *pi) const;
     void CheckForRecGroupChange(void);
     void NotifySchedulerOfRecording(RecordingInfo *rec);
@@ -357,6 +359,7 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     // Configuration variables from database
     bool               m_transcodeFirst           {false};
     bool               m_earlyCommFlag            {false};
+    bool               m_recorderCommFlag         {false};
     bool               m_runJobOnHostOnly         {false};
     std::chrono::seconds m_eitCrawlIdleStart      {1min};
     std::chrono::seconds m_eitTransportTimeout    {5min};
@@ -36,6 +36,7 @@
 
 #include "libmythbase/compat.h"
 #include "libmythbase/configuration.h"
+#include "libmythbase/http/mythhttpreadcache.h"
 #include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdate.h"
 #include "libmythbase/mythlogging.h"
@@ -648,7 +649,49 @@ qint64 HTTPRequest::SendData( QIODevice *pDevice, qint64 llStart, qint64 llBytes
 
 qint64 HTTPRequest::SendFile( QFile &file, qint64 llStart, qint64 llBytes )
 {
-    qint64 sent = SendData( (QIODevice *)(&file), llStart, llBytes );
+    bool bShouldClose = false;
+
+    if (!file.isOpen())
+    {
+        if (!file.open( QIODevice::ReadOnly ))
+            return -1;
+        bShouldClose = true;
+    }
+
+    // ----------------------------------------------------------------------
+    // Read through the cache shared with the other web server, so renderers
+    // playing the same file (or seeking about in it) don't each go to disk.
+    // ----------------------------------------------------------------------
+
+    std::array<char,SENDFILE_BUFFER_SIZE> aBuffer {};
+
+    qint64 sent = 0;
+
+    while (sent < llBytes)
+    {
+        qint64 llBytesToRead = std::min( (qint64)SENDFILE_BUFFER_SIZE, llBytes - sent );
+        qint64 llBytesRead   = MythHTTPReadCache::Read( file, llStart + sent,
+                                                        aBuffer.data(), llBytesToRead );
+        if (llBytesRead < 0)
+        {
+            sent = -1;
+            break;
+        }
+
+        if (llBytesRead == 0)
+            break;
+
+        if ( WriteBlock( aBuffer.data(), llBytesRead ) == -1)
+        {
+            sent = -1;
+            break;
+        }
+
+        sent += llBytesRead;
+    }
+
+    if (bShouldClose)
+        file.close();
 
     return( sent );
 }
@@ -0,0 +1,199 @@
+// Qt
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+
+// MythTV
+#include "libmythbase/http/mythwebsockettopics.h"
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythcoreutil.h"
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythdb.h"
+#include "libmythbase/programinfo.h"
+#include "libmythtv/jobqueue.h"
+#include "libmythtv/recordinginfo.h"
+#include "libmythtv/tv.h"
+#include "libmythtv/tv_rec.h"
+
+// MythBackend
+#include "backendcontext.h"
+#include "backendtopics.h"
+#include "encoderlink.h"
+#include "scheduler.h"
+
+/// Sleeping backends and remote encoders do not always send events
+static constexpr std::chrono::seconds kEncoderInterval { 30s };
+/// Jobs report their progress in the job queue, not with events
+static constexpr std::chrono::seconds kJobInterval     { 5s };
+static constexpr std::chrono::seconds kStorageInterval { 60s };
+
+void BackendTopics::Register(void)
+{
+    MythWebSocketTopics::Register("encoders",
+        { "REC_STARTED", "REC_FINISHED", "REC_FAILING", "LIVETV_WATCH", "LIVETV_EXITED",
+          "QUIT_LIVETV", "DONE_RECORDING", "UPDATE_RECORDING_STATUS",
+          "SLAVE_CONNECTED", "SLAVE_DISCONNECTED" },
+        kEncoderInterval, &BackendTopics::Encoders);
+    MythWebSocketTopics::Register("recordings",
+        { "RECORDING_LIST_CHANGE", "REC_STARTED", "REC_FINISHED" }, 0s, &BackendTopics::Recordings);
+    MythWebSocketTopics::Register("schedule",
+        { "SCHEDULE_CHANGE", "SCHEDULER_RAN", "UPDATE_RECORDING_STATUS" }, 0s, &BackendTopics::Schedule);
+    MythWebSocketTopics::Register("jobs",     {}, kJobInterval,     &BackendTopics::Jobs);
+    MythWebSocketTopics::Register("storage",  {}, kStorageInterval, &BackendTopics::Storage);
+}
+
+/// The state of each input, and what it is recording, by input id.
+QJsonObject BackendTopics::Encoders(void)
+{
+    QJsonObject result;
+    QReadLocker tvlocker(&TVRec::s_inputsLock);
+    for (auto * elink : std::as_const(gTVList))
+    {
+        if (elink == nullptr)
+            continue;
+
+        QJsonObject encoder {
+            { "State",       StateToString(elink->GetState()) },
+            { "Connected",   elink->IsConnected() },
+            { "SleepStatus", static_cast<int>(elink->GetSleepStatus()) },
+            { "HostName",    elink->IsLocal() ? gCoreContext->GetHostName() : elink->GetHostName() }
+        };
+
+        TVState state = elink->GetState();
+        if (state == kState_WatchingLiveTV || state == kState_RecordingOnly ||
+            state == kState_WatchingRecording)
+        {
+            ProgramInfo *pginfo = elink->GetRecording();
+            if (pginfo)
+            {
+                encoder.insert("RecordedId", static_cast<int>(pginfo->GetRecordingID()));
+                encoder.insert("ChanId",     static_cast<int>(pginfo->GetChanID()));
+                encoder.insert("Title",      pginfo->GetTitle());
+                encoder.insert("SubTitle",   pginfo->GetSubtitle());
+                delete pginfo;
+            }
+        }
+        result.insert(QString::number(elink->GetInputID()), encoder);
+    }
+    return result;
+}
+
+/// The recordings that are not being deleted, by recorded id.
+QJsonObject BackendTopics::Recordings(void)
+{
+    QJsonObject result;
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT recordedid, chanid, starttime, endtime, title, subtitle,"
+                  " recgroup, watched, preserve, autoexpire"
+                  " FROM recorded WHERE deletepending = 0 ;");
+    if (!query.exec())
+    {
+        MythDB::DBError("BackendTopics::Recordings", query);
+        return result;
+    }
+
+    while (query.next())
+    {
+        result.insert(query.value(0).toString(), QJsonObject {
+            { "ChanId",     query.value(1).toInt() },
+            { "StartTime",  MythDate::toString(MythDate::as_utc(query.value(2).toDateTime()), MythDate::ISODate) },
+            { "EndTime",    MythDate::toString(MythDate::as_utc(query.value(3).toDateTime()), MythDate::ISODate) },
+            { "Title",      query.value(4).toString() },
+            { "SubTitle",   query.value(5).toString() },
+            { "RecGroup",   query.value(6).toString() },
+            { "Watched",    query.value(7).toBool() },
+            { "Preserve",   query.value(8).toBool() },
+            { "AutoExpire", query.value(9).toBool() }
+        });
+    }
+    return result;
+}
+
+/// What will be recorded, as in Dvr/GetUpcomingList, by "<chanid>_<starttime>".
+QJsonObject BackendTopics::Schedule(void)
+{
+    QJsonObject result;
+    auto *scheduler = dynamic_cast<Scheduler*>(gCoreContext->GetScheduler());
+    if (!scheduler)
+        return result;
+
+    RecList pending;
+    scheduler->GetAllPending(pending);
+    QDateTime now = MythDate::current();
+    for (auto * pginfo : pending)
+    {
+        RecStatus::Type status = pginfo->GetRecordingStatus();
+        if (pginfo->GetRecordingEndTime() > now &&
+            ((status >= RecStatus::Pending && status <= RecStatus::WillRecord) ||
+             status == RecStatus::Offline || status == RecStatus::Conflict))
+        {
+            result.insert(QString("%1_%2").arg(pginfo->GetChanID())
+                          .arg(pginfo->GetScheduledStartTime(MythDate::ISODate)),
+                          QJsonObject {
+                { "RecordId",  static_cast<int>(pginfo->GetRecordingRuleID()) },
+                { "Title",     pginfo->GetTitle() },
+                { "SubTitle",  pginfo->GetSubtitle() },
+                { "StartTime", pginfo->GetRecordingStartTime(MythDate::ISODate) },
+                { "EndTime",   pginfo->GetRecordingEndTime(MythDate::ISODate) },
+                { "Status",    RecStatus::toString(status) },
+                { "InputId",   static_cast<int>(pginfo->GetInputID()) }
+            });
+        }
+        delete pginfo;
+    }
+    return result;
+}
+
+/// Queued and running jobs, and ones that finished lately, by job id.
+QJsonObject BackendTopics::Jobs(void)
+{
+    QJsonObject result;
+    QMap<int, JobQueueEntry> jobs;
+    JobQueue::GetJobsInQueue(jobs, JOB_LIST_NOT_DONE | JOB_LIST_RECENT);
+    for (const auto & job : std::as_const(jobs))
+    {
+        result.insert(QString::number(job.id), QJsonObject {
+            { "ChanId",    static_cast<int>(job.chanid) },
+            { "StartTime", MythDate::toString(job.recstartts, MythDate::ISODate) },
+            { "Type",      JobQueue::JobText(job.type) },
+            { "Status",    JobQueue::StatusText(job.status) },
+            { "HostName",  job.hostname },
+            { "Comment",   job.comment }
+        });
+    }
+    return result;
+}
+
+/// Space in this backend's storage group directories, by directory.
+QJsonObject BackendTopics::Storage(void)
+{
+    QJsonObject result;
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT groupname, dirname FROM storagegroup"
+                  " WHERE hostname = :HOSTNAME ;");
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+    if (!query.exec())
+    {
+        MythDB::DBError("BackendTopics::Storage", query);
+        return result;
+    }
+
+    while (query.next())
+    {
+        QString dir = query.value(1).toString();
+        int64_t total = 0;
+        int64_t used  = 0;
+        int64_t free  = getDiskSpace(dir, total, used);
+        // Directories are shared by groups
+        QJsonObject entry = result.value(dir).toObject();
+        QJsonArray groups = entry.value("Groups").toArray();
+        groups.append(query.value(0).toString());
+        result.insert(dir, QJsonObject {
+            { "Groups",     groups },
+            { "KiBFree",    static_cast<qint64>(free) },
+            { "KiBTotal",   static_cast<qint64>(total) },
+            { "DirWrite",   QFileInfo(dir).isWritable() }
+        });
+    }
+    return result;
+}
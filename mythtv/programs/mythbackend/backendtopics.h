@@ -0,0 +1,29 @@
+#ifndef BACKENDTOPICS_H
+#define BACKENDTOPICS_H
+
+// Qt
+#include <QJsonObject>
+
+/** \class BackendTopics
+ *  \brief The backend state that WebSocket clients can subscribe to.
+ *
+ *  A client sends "WS_SUBSCRIBE encoders schedule" rather than polling
+ *  Dvr/GetEncoderList and Dvr/GetUpcomingList, and is sent what changed
+ *  when a recording starts or the scheduler runs. Each item only carries
+ *  what a client needs to see that it changed; the services still return
+ *  the details.
+ */
+class BackendTopics
+{
+  public:
+    static void Register(void);
+
+  private:
+    static QJsonObject Encoders(void);
+    static QJsonObject Recordings(void);
+    static QJsonObject Schedule(void);
+    static QJsonObject Jobs(void);
+    static QJsonObject Storage(void);
+};
+
+#endif // BACKENDTOPICS_H
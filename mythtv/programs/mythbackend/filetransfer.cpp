@@ -1,12 +1,15 @@
 // C++ headers
+#include <functional>
 #include <utility>
 
 // Qt headers
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
+#include <QtEndian>
 
 // MythTV
+#include "libmythbase/mthread.h"
 #include "libmythbase/mythdate.h"
 #include "libmythbase/mythlogging.h"
 #include "libmythbase/mythsocket.h"
@@ -16,6 +19,35 @@
 // MythBackend
 #include "filetransfer.h"
 
+/// Largest frame sent to a streaming client
+static constexpr int kStreamChunk { 256 * 1024 };
+/// Most a streaming client may ask to be sent ahead of what it has read
+static constexpr int kMaxStreamWindow { 32 * 1024 * 1024 };
+static constexpr qint32 kStreamEnd     {  0 };
+static constexpr qint32 kStreamError   { -1 };
+static constexpr qint32 kStreamStopped { -2 };
+
+namespace
+{
+class BEFileTransferThread : public MThread
+{
+  public:
+    BEFileTransferThread(const QString &Name, std::function<void()> Work)
+      : MThread(Name), m_work(std::move(Work)) {}
+
+  protected:
+    void run(void) override
+    {
+        RunProlog();
+        m_work();
+        RunEpilog();
+    }
+
+  private:
+    std::function<void()> m_work;
+};
+}
+
 BEFileTransfer::BEFileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, std::chrono::milliseconds timeout) :
     ReferenceCounter(QString("BEFileTransfer:%1").arg(filename)),
@@ -80,6 +112,19 @@ bool BEFileTransfer::ReOpen(const QString& newFilename)
 
 void BEFileTransfer::Stop(void)
 {
+    StopStream();
+
+    if (m_transferTime.isValid() && m_bytesSent)
+    {
+        double secs = std::max<qint64>(m_transferTime.elapsed(), 1) / 1000.0;
+        LOG(VB_FILE, LOG_INFO, QString("Sent %1 MB of '%2' at %3 Mb/s, "
+                                       "%4 read stalls, %5 window stalls")
+            .arg(m_bytesSent / 1000000.0, 0, 'f', 1).arg(GetFileName())
+            .arg(m_bytesSent * 8 / secs / 1000000.0, 0, 'f', 1)
+            .arg(m_readStalls).arg(m_windowStalls));
+        m_bytesSent = 0;
+    }
+
     if (m_readthreadlive)
     {
         m_readthreadlive = false;
@@ -127,7 +172,7 @@ void BEFileTransfer::Unpause(void)
 
 int BEFileTransfer::RequestBlock(int size)
 {
-    if (!m_readthreadlive || !m_rbuffer)
+    if (!m_readthreadlive || !m_rbuffer || m_streamThread)
         return -1;
 
     int tot = 0;
@@ -159,12 +204,134 @@ int BEFileTransfer::RequestBlock(int size)
             break; // we hit eof
     }
 
+    if (tot > 0)
+    {
+        if (!m_transferTime.isValid())
+            m_transferTime.start();
+        m_bytesSent += tot;
+    }
+    if (tot < size && ret >= 0)
+        m_readStalls++;
+
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
     return (ret < 0) ? -1 : tot;
 }
 
+/// Start sending the file without waiting for REQUEST_BLOCK.
+bool BEFileTransfer::StartStream(int window)
+{
+    if (m_writemode || !m_rbuffer || !m_readthreadlive || window <= 0)
+        return false;
+
+    StopStream();
+    {
+        QMutexLocker locker(&m_streamLock);
+        m_streamStop   = false;
+        m_streamParked = false;
+        m_credit       = std::min(window, kMaxStreamWindow);
+    }
+    m_streamStart = m_rbuffer->GetReadPosition();
+    if (!m_transferTime.isValid())
+        m_transferTime.start();
+
+    LOG(VB_FILE, LOG_INFO, QString("Streaming '%1' with a %2 KB window")
+        .arg(GetFileName()).arg(m_credit / 1024));
+    m_streamThread = new BEFileTransferThread("FileTransferStream", [this]() { Stream(); });
+    m_streamThread->start();
+    return true;
+}
+
+/// The client has read this much more of the stream.
+void BEFileTransfer::StreamCredit(int size)
+{
+    QMutexLocker locker(&m_streamLock);
+    m_credit = std::min(m_credit + std::max(size, 0), static_cast<long long>(kMaxStreamWindow));
+    m_streamParked = false;
+    m_streamCond.wakeAll();
+}
+
+/*! \brief Stop streaming, and move back to where the client has read up to.
+ *
+ * \param read How much of the stream the client has read, or -1 to stay put.
+ * This returns once the stream has ended, with a frame of length -2 that
+ * tells the client where to stop discarding the rest of it.
+ */
+void BEFileTransfer::StopStream(long long read)
+{
+    if (!m_streamThread)
+        return;
+
+    {
+        QMutexLocker locker(&m_streamLock);
+        m_streamStop = true;
+        m_streamCond.wakeAll();
+    }
+    // Don't wait for a read of a file that is still being written
+    m_rbuffer->StopReads();
+    m_streamThread->wait();
+    delete m_streamThread;
+    m_streamThread = nullptr;
+    m_rbuffer->StartReads();
+
+    if (read >= 0)
+        m_rbuffer->Seek(m_streamStart + read, SEEK_SET);
+
+    if (m_pginfo)
+        m_pginfo->UpdateInUseMark();
+}
+
+void BEFileTransfer::Stream(void)
+{
+    std::vector<char> buffer(sizeof(qint32) + kStreamChunk);
+    bool connected = true;
+
+    while (connected)
+    {
+        int size = 0;
+        {
+            QMutexLocker locker(&m_streamLock);
+            if (!m_streamStop && !m_streamParked && m_credit <= 0)
+                m_windowStalls++;
+            while (!m_streamStop && (m_streamParked || m_credit <= 0))
+                m_streamCond.wait(&m_streamLock, 100);
+            if (m_streamStop)
+                break;
+            size = static_cast<int>(std::min(m_credit, static_cast<long long>(kStreamChunk)));
+        }
+
+        int ret = m_rbuffer->Read(buffer.data() + sizeof(qint32), size);
+        {
+            QMutexLocker locker(&m_streamLock);
+            if (m_streamStop)
+                break;
+            if (ret > 0)
+            {
+                m_credit -= ret;
+                m_bytesSent += ret;
+            }
+            else
+            {
+                // Wait for the client to ask again, rather than spin at the end
+                m_readStalls++;
+                m_streamParked = true;
+            }
+        }
+
+        qToBigEndian<qint32>(ret > 0 ? ret : (ret == 0 ? kStreamEnd : kStreamError),
+                             buffer.data());
+        int length = static_cast<int>(sizeof(qint32)) + std::max(ret, 0);
+        connected = m_sock->Write(buffer.data(), length) == length;
+    }
+
+    if (connected)
+    {
+        qToBigEndian<qint32>(kStreamStopped, buffer.data());
+        m_sock->Write(buffer.data(), sizeof(qint32));
+    }
+}
+
 int BEFileTransfer::WriteBlock(int size)
 {
     if (!m_writemode || !m_rbuffer)
@@ -236,6 +403,7 @@ long long BEFileTransfer::Seek(long long curpos, long long pos, int whence)
     if (!m_readthreadlive)
         return -1;
 
+    StopStream();
     m_ateof = false;
 
     Pause();
@@ -6,6 +6,7 @@
 #include <vector>
 
 // Qt headers
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QWaitCondition>
 
@@ -15,8 +16,23 @@
 class ProgramInfo;
 class MythMediaBuffer;
 class MythSocket;
+class MThread;
 class QString;
 
+/** \class BEFileTransfer
+ *  \brief A file opened by a client with ANN FileTransfer.
+ *
+ *  The client either asks for each block with REQUEST_BLOCK, and waits for
+ *  it, or asks for the file to be streamed with STREAM_START. The backend
+ *  then sends the file as it is read ahead, in frames of a 32 bit big endian
+ *  length followed by that many bytes, for as long as the client has not
+ *  fallen behind by more than the window it asked for. The client returns
+ *  credit for what it has read with STREAM_CREDIT, which is answered like
+ *  every other command so that the control socket stays in step. A
+ *  frame of length 0 means the end of the file for now; the next credit
+ *  resumes it. STREAM_STOP ends the stream with a frame of length -2, and
+ *  moves back to the end of what the client has read of it, before SEEK.
+ */
 class BEFileTransfer : public ReferenceCounter
 {
     friend class QObject; // quiet OSX gcc warning
@@ -38,6 +54,10 @@ class BEFileTransfer : public ReferenceCounter
     int RequestBlock(int size);
     int WriteBlock(int size);
 
+    bool StartStream(int window);
+    void StreamCredit(int size);
+    void StopStream(long long read = -1);
+
     long long Seek(long long curpos, long long pos, int whence);
 
     uint64_t GetFileSize(void);
@@ -47,6 +67,7 @@ class BEFileTransfer : public ReferenceCounter
 
   private:
    ~BEFileTransfer() override;
+    void Stream(void);
 
     volatile bool   m_readthreadlive    {true};
     bool            m_readsLocked       {false};
@@ -62,6 +83,19 @@ class BEFileTransfer : public ReferenceCounter
     QMutex          m_lock;
 
     bool            m_writemode         {false};
+
+    MThread        *m_streamThread      {nullptr};
+    QMutex          m_streamLock;
+    QWaitCondition  m_streamCond;
+    bool            m_streamStop        {false};
+    bool            m_streamParked      {false}; ///< At the end of the file
+    long long       m_credit            {0};
+    long long       m_streamStart       {0};
+
+    QElapsedTimer   m_transferTime;
+    uint64_t        m_bytesSent         {0};
+    uint            m_readStalls        {0}; ///< The file could not keep up
+    uint            m_windowStalls      {0}; ///< The client could not keep up
 };
 
 #endif
@@ -0,0 +1,258 @@
+// C++
+#include <algorithm>
+#include <cmath>
+
+// Qt
+#include <QFileInfo>
+#include <QUrl>
+
+// MythTV
+#include "libmythbase/http/mythhttpdata.h"
+#include "libmythbase/http/mythhttpresponse.h"
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythdb.h"
+#include "libmythbase/mythlogging.h"
+#include "libmythbase/programinfo.h"
+#include "libmythprotoserver/requesthandler/fileserverutil.h"
+
+// MythBackend
+#include "hlspackager.h"
+
+#define LOC QString("HLSPackager: ")
+
+/// Shortest segment; segments end at the first keyframe after this.
+static constexpr std::chrono::milliseconds kTargetSegment { 6s };
+/// Forget the seek table of a recording nobody has asked for in this long.
+static constexpr std::chrono::seconds kStreamIdle { 10min };
+
+QMutex                              HLSPackager::s_lock;
+QHash<uint,HLSPackager::StreamPtr>  HLSPackager::s_streams;
+
+/*! \brief Return the playlist for /HLS/<recordedid>.m3u8
+ *
+ * Only MPEG-TS recordings can be served this way, since each byte range
+ * must be playable on its own. MythTV recorders repeat the PAT and PMT
+ * often enough for that.
+ */
+HTTPResponse HLSPackager::ProcessRequest(const HTTPRequest2 &Request)
+{
+    if (!Request)
+        return nullptr;
+
+    bool ok = false;
+    QString name = Request->m_fileName;
+    uint recordedid = name.endsWith(".m3u8", Qt::CaseInsensitive) ?
+        name.chopped(5).toUInt(&ok) : 0;
+    if (!ok || recordedid == 0)
+    {
+        Request->m_status = HTTPNotFound;
+        return MythHTTPResponse::ErrorResponse(Request);
+    }
+
+    ProgramInfo pginfo(recordedid);
+    if (!pginfo.GetChanID())
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + QString("Unknown recording %1").arg(recordedid));
+        Request->m_status = HTTPNotFound;
+        return MythHTTPResponse::ErrorResponse(Request);
+    }
+
+    if (pginfo.GetHostname().toLower() != gCoreContext->GetHostName().toLower() &&
+        !gCoreContext->GetBoolSetting("MasterBackendOverride", false))
+    {
+        // The seek table is shared, but the file is only on its own host
+        QUrl url;
+        url.setScheme("http");
+        url.setHost(gCoreContext->GetBackendServerIP(pginfo.GetHostname()));
+        url.setPort(gCoreContext->GetBackendStatusPort(pginfo.GetHostname()));
+        url.setPath(Request->m_path + Request->m_fileName);
+        return MythHTTPResponse::RedirectionResponse(Request, url.toString());
+    }
+
+    QFileInfo info(GetPlaybackURL(&pginfo));
+    if (!info.exists() || info.suffix().compare("ts", Qt::CaseInsensitive) != 0)
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + QString("Recording %1 is not a local MPEG-TS file")
+            .arg(recordedid));
+        Request->m_status = HTTPNotFound;
+        return MythHTTPResponse::ErrorResponse(Request);
+    }
+
+    bool complete = pginfo.GetRecordingStatus() != RecStatus::Recording &&
+                    pginfo.GetRecordingEndTime() < MythDate::current();
+    auto filesize = static_cast<uint64_t>(info.size());
+
+    StreamPtr stream = GetStream(recordedid);
+    std::vector<Segment> segments;
+    {
+        QMutexLocker locker(&stream->m_lock);
+        Update(*stream, pginfo, filesize);
+        segments = Segments(*stream, pginfo, filesize, complete);
+    }
+
+    auto data = MythHTTPData::Create(name, Playlist(recordedid, segments, complete)
+                                     .toUtf8().constData());
+    // A live playlist changes with every keyframe that is written
+    if (!complete)
+        data->m_cacheType = HTTPNoCache;
+    return MythHTTPResponse::DataResponse(Request, data);
+}
+
+HLSPackager::StreamPtr HLSPackager::GetStream(uint RecordedId)
+{
+    QMutexLocker locker(&s_lock);
+
+    QDateTime now = MythDate::current();
+    for (auto it = s_streams.begin(); it != s_streams.end(); )
+    {
+        if ((*it)->m_lastUsed.addSecs(kStreamIdle.count()) < now)
+            it = s_streams.erase(it);
+        else
+            ++it;
+    }
+
+    StreamPtr &stream = s_streams[RecordedId];
+    if (!stream)
+        stream = std::make_shared<Stream>();
+    stream->m_lastUsed = now;
+    return stream;
+}
+
+/// Read the seek table entries added since the last request.
+void HLSPackager::Update(Stream &Stream, const ProgramInfo &ProgInfo,
+                         uint64_t FileSize)
+{
+    // A recording that shrank has been transcoded or cut; start again
+    if (FileSize < Stream.m_lastOffset)
+    {
+        LOG(VB_HTTP, LOG_INFO, LOC + QString("Recording %1 was rewritten")
+            .arg(ProgInfo.GetRecordingID()));
+        Stream.m_positions.clear();
+        Stream.m_durations.clear();
+        Stream.m_lastMark   = 0;
+        Stream.m_lastOffset = 0;
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT mark, `offset`, type FROM recordedseek"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " AND type IN (:GOP, :DURATION)"
+                  " AND mark >= :MARK"
+                  " ORDER BY mark ;");
+    query.bindValue(":CHANID", ProgInfo.GetChanID());
+    query.bindValue(":STARTTIME", ProgInfo.GetRecordingStartTime());
+    query.bindValue(":GOP", MARK_GOP_BYFRAME);
+    query.bindValue(":DURATION", MARK_DURATION_MS);
+    query.bindValue(":MARK", static_cast<qulonglong>(Stream.m_lastMark));
+
+    if (!query.exec())
+    {
+        MythDB::DBError("HLSPackager::Update", query);
+        return;
+    }
+
+    while (query.next())
+    {
+        uint64_t mark   = query.value(0).toULongLong();
+        uint64_t offset = query.value(1).toULongLong();
+        if (query.value(2).toInt() == MARK_GOP_BYFRAME)
+        {
+            Stream.m_positions[mark] = offset;
+            Stream.m_lastOffset = std::max(Stream.m_lastOffset, offset);
+        }
+        else
+        {
+            Stream.m_durations[mark] = offset;
+        }
+        Stream.m_lastMark  = std::max(Stream.m_lastMark, mark);
+    }
+}
+
+/// Split the recording into segments that start at keyframes.
+std::vector<HLSPackager::Segment> HLSPackager::Segments(
+    const Stream &Stream, const ProgramInfo &ProgInfo,
+    uint64_t FileSize, bool Complete)
+{
+    std::vector<Segment> segments;
+    if (Stream.m_positions.isEmpty())
+        return segments;
+
+    // Older recordings have no duration map
+    uint fps = 0;
+    if (Stream.m_durations.isEmpty())
+    {
+        fps = ProgInfo.QueryAverageFrameRate();
+        if (!fps)
+            fps = 25000;
+    }
+    auto timeof = [&Stream, fps](uint64_t Frame)
+    {
+        auto it = Stream.m_durations.constFind(Frame);
+        if (it != Stream.m_durations.cend())
+            return std::chrono::milliseconds(*it);
+        if (fps)
+            return std::chrono::milliseconds(Frame * 1000000 / fps);
+        // Nearest earlier entry, for a keyframe saved before its duration
+        it = Stream.m_durations.lowerBound(Frame);
+        if (it != Stream.m_durations.cbegin())
+            --it;
+        return std::chrono::milliseconds(*it);
+    };
+
+    // The first segment also carries whatever precedes the first keyframe
+    uint64_t start = 0;
+    std::chrono::milliseconds starttime = timeof(Stream.m_positions.firstKey());
+    for (auto it = Stream.m_positions.cbegin(); it != Stream.m_positions.cend(); ++it)
+    {
+        std::chrono::milliseconds time = timeof(it.key());
+        if (time - starttime < kTargetSegment || *it <= start || *it > FileSize)
+            continue;
+        segments.push_back({ start, *it - start, time - starttime });
+        start = *it;
+        starttime = time;
+    }
+
+    // The end of a live recording becomes a segment once it is long enough
+    if (Complete && FileSize > start)
+    {
+        std::chrono::milliseconds total = ProgInfo.QueryTotalDuration();
+        segments.push_back({ start, FileSize - start,
+                             std::max(total - starttime, 1ms) });
+    }
+
+    return segments;
+}
+
+QString HLSPackager::Playlist(uint RecordedId, const std::vector<Segment> &Segments,
+                              bool Complete)
+{
+    std::chrono::milliseconds longest = kTargetSegment;
+    for (const auto & segment : Segments)
+        longest = std::max(longest, segment.m_duration);
+
+    QString uri = QString("/Content/GetRecording?RecordedId=%1").arg(RecordedId);
+    QString result = QString("#EXTM3U\n"
+                             "#EXT-X-VERSION:4\n"
+                             "#EXT-X-TARGETDURATION:%1\n"
+                             "#EXT-X-MEDIA-SEQUENCE:0\n"
+                             "#EXT-X-PLAYLIST-TYPE:%2\n"
+                             "#EXT-X-INDEPENDENT-SEGMENTS\n")
+        .arg(static_cast<int>(std::ceil(longest.count() / 1000.0)))
+        .arg(Complete ? "VOD" : "EVENT");
+
+    for (const auto & segment : Segments)
+    {
+        result += QString("#EXTINF:%1,\n"
+                          "#EXT-X-BYTERANGE:%2@%3\n"
+                          "%4\n")
+            .arg(segment.m_duration.count() / 1000.0, 0, 'f', 3)
+            .arg(segment.m_length).arg(segment.m_offset).arg(uri);
+    }
+
+    if (Complete)
+        result += "#EXT-X-ENDLIST\n";
+    return result;
+}
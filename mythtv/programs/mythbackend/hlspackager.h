@@ -0,0 +1,72 @@
+#ifndef HLSPACKAGER_H
+#define HLSPACKAGER_H
+
+// C++
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Qt
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// MythTV
+#include "libmythbase/http/mythhttptypes.h"
+#include "libmythbase/programtypes.h"
+
+class ProgramInfo;
+
+/** \class HLSPackager
+ *  \brief Serves MPEG-TS recordings, including ones still being recorded,
+ *         as HTTP Live Streams without transcoding them.
+ *
+ *  A request for /HLS/<recordedid>.m3u8 returns a media playlist. Each
+ *  segment starts at a keyframe taken from the recording's seek table, and
+ *  the playlist refers to it as a byte range of the recording itself, as
+ *  served by /Content/GetRecording. Nothing is written to disk, and the
+ *  seek table of a recording in progress is read incrementally as the
+ *  recorder saves it.
+ */
+class HLSPackager
+{
+    friend class TestHLSPackager;
+
+  public:
+    static HTTPResponse ProcessRequest(const HTTPRequest2 &Request);
+
+  private:
+    struct Segment
+    {
+        uint64_t                   m_offset   { 0 };
+        uint64_t                   m_length   { 0 };
+        std::chrono::milliseconds  m_duration { 0 };
+    };
+
+    /// What is known about one recording's seek table
+    struct Stream
+    {
+        QMutex                     m_lock;
+        QDateTime                  m_lastUsed;
+        uint64_t                   m_lastMark     { 0 };
+        uint64_t                   m_lastOffset   { 0 };
+        frm_pos_map_t              m_positions;    ///< keyframe => byte offset
+        frm_pos_map_t              m_durations;    ///< keyframe => ms
+    };
+    using StreamPtr = std::shared_ptr<Stream>;
+
+    static StreamPtr GetStream(uint RecordedId);
+    static void      Update(Stream &Stream, const ProgramInfo &ProgInfo,
+                            uint64_t FileSize);
+    static std::vector<Segment> Segments(const Stream &Stream,
+                                         const ProgramInfo &ProgInfo,
+                                         uint64_t FileSize, bool Complete);
+    static QString   Playlist(uint RecordedId, const std::vector<Segment> &Segments,
+                              bool Complete);
+
+    static QMutex                   s_lock;
+    static QHash<uint,StreamPtr>    s_streams;
+};
+
+#endif // HLSPACKAGER_H
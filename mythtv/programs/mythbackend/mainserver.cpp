@@ -2475,6 +2475,7 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
     nameFilters.push_back(fInfo.fileName() + ".old");
     nameFilters.push_back(fInfo.fileName() + ".map");
     nameFilters.push_back(fInfo.fileName() + ".tmp.map");
+    nameFilters.push_back(fInfo.fileName() + ".trickplay.vtt");
     nameFilters.push_back(fInfo.baseName() + ".srt");  // e.g. 1234_20150213165800.srt
 
     QDir dir (fInfo.path());
@@ -7139,6 +7140,22 @@ void MainServer::HandleFileTransferQuery(QStringList &slist,
 
         retlist << QString::number(ft->WriteBlock(size));
     }
+    else if (command == "STREAM_START")
+    {
+        int window = slist[2].toInt();
+
+        retlist << (ft->StartStream(window) ? "OK" : "ERROR");
+    }
+    else if (command == "STREAM_CREDIT")
+    {
+        ft->StreamCredit(slist[2].toInt());
+        retlist << "OK";
+    }
+    else if (command == "STREAM_STOP")
+    {
+        ft->StopStream(slist[2].toLongLong());
+        retlist << "OK";
+    }
     else if (command == "SEEK")
     {
         long long pos = slist[2].toLongLong();
@@ -28,7 +28,7 @@ HEADERS += playbacksock.h scheduler.h backendhousekeeper.h
 HEADERS += upnpcdstv.h upnpcdsmusic.h upnpcdsvideo.h mediaserver.h
 HEADERS += internetContent.h mythbackend_main_helpers.h backendcontext.h
 HEADERS += httpconfig.h mythsettings.h mythbackend_commandlineparser.h
-HEADERS += recordingextender.h
+HEADERS += recordingextender.h hlspackager.h backendtopics.h
 
 SOURCES += autoexpire.cpp encoderlink.cpp filetransfer.cpp httpstatus.cpp
 SOURCES += mythbackend.cpp mainserver.cpp playbacksock.cpp scheduler.cpp
@@ -36,7 +36,7 @@ SOURCES += backendhousekeeper.cpp
 SOURCES += upnpcdstv.cpp upnpcdsmusic.cpp upnpcdsvideo.cpp mediaserver.cpp
 SOURCES += internetContent.cpp mythbackend_main_helpers.cpp backendcontext.cpp
 SOURCES += httpconfig.cpp mythsettings.cpp mythbackend_commandlineparser.cpp
-SOURCES += recordingextender.cpp
+SOURCES += recordingextender.cpp hlspackager.cpp backendtopics.cpp
 
 HEADERS += servicesv2/v2myth.h servicesv2/v2connectionInfo.h servicesv2/v2wolInfo.h
 HEADERS += servicesv2/v2databaseInfo.h servicesv2/v2versionInfo.h
@@ -81,7 +81,7 @@ HEADERS += servicesv2/v2channelRestore.h
 HEADERS += servicesv2/v2videoSource.h servicesv2/v2videoSourceList.h
 HEADERS += servicesv2/v2videoMultiplex.h servicesv2/v2videoMultiplexList.h
 HEADERS += servicesv2/v2status.h
-HEADERS += servicesv2/preformat.h servicesv2/v2backendStatus.h
+HEADERS += servicesv2/preformat.h servicesv2/v2backendStatus.h servicesv2/v2httpStatus.h
 HEADERS += servicesv2/v2capture.h
 HEADERS += servicesv2/v2captureCard.h servicesv2/v2captureCardList.h
 HEADERS += servicesv2/v2recordingProfile.h
@@ -51,7 +51,9 @@ static inline void be_sd_notify(const char */*str*/) {};
 #include "autoexpire.h"
 #include "backendcontext.h"
 #include "backendhousekeeper.h"
+#include "backendtopics.h"
 #include "encoderlink.h"
+#include "hlspackager.h"
 #include "httpstatus.h"
 #include "mainserver.h"
 #include "mediaserver.h"
@@ -729,6 +731,7 @@ int run_backend(MythBackendCommandLineParser &cmdline)
     };
 
     MythHTTPInstance::Addservices(be_services);
+    BackendTopics::Register();
 
     // Send all unknown requests into the web app. make bookmarks and direct access work.
     auto spa_index = [](auto && PH1) { return MythHTTPRewrite::RewriteToSPA(std::forward<decltype(PH1)>(PH1), "apps/backend/index.html"); };
@@ -748,6 +751,7 @@ int run_backend(MythBackendCommandLineParser &cmdline)
         { "/styles.css", styles_css },
         { "/polyfills.js", polyfills_js },
         { "/runtime.js", runtime_js },
+        { "/HLS/", &HLSPackager::ProcessRequest },
         { "/", root }
     };
 
@@ -46,9 +46,19 @@
 #include "v2capture.h"
 #include "v2serviceUtil.h"
 
+// Methods that are polled often are called directly
+static HTTPInvokers CaptureInvokers()
+{
+    return {
+        { "GetCaptureCardList", MythHTTPMetaMethod::Invoker(&V2Capture::GetCaptureCardList) },
+        { "GetCaptureCard",     MythHTTPMetaMethod::Invoker(&V2Capture::GetCaptureCard)     },
+        { "GetCardSubType",     MythHTTPMetaMethod::Invoker(&V2Capture::GetCardSubType)     },
+    };
+}
+
 // This will be initialised in a thread safe manner on first use
 Q_GLOBAL_STATIC_WITH_ARGS(MythHTTPMetaService, s_service,
-    (CAPTURE_HANDLE, V2Capture::staticMetaObject, &V2Capture::RegisterCustomTypes))
+    (CAPTURE_HANDLE, V2Capture::staticMetaObject, &V2Capture::RegisterCustomTypes, {}, CaptureInvokers()))
 
 void V2Capture::RegisterCustomTypes()
 {
@@ -59,6 +59,7 @@ class V2Channel : public MythHTTPService
     Q_CLASSINFO("SendScanDialogResponse", "methods=POST;name=bool")
     Q_CLASSINFO("SaveRestoreData",        "methods=POST;name=bool")
     Q_CLASSINFO("CopyIconToBackend",      "methods=POST")
+    Q_CLASSINFO("GetChannelInfoList",     "cache=MYTHFILLDATABASE_RAN")
 
     public:
         V2Channel();
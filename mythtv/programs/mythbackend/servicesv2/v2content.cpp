@@ -47,6 +47,7 @@
 #include "libmythprotoserver/requesthandler/fileserverutil.h"
 #include "libmythtv/metadataimagehelper.h"
 #include "libmythtv/previewgenerator.h"
+#include "libmythtv/trickplaygenerator.h"
 
 // MythBackend
 #include "v2content.h"
@@ -747,6 +748,55 @@ QFileInfo V2Content::GetRecording( int              nRecordedId,
 //
 /////////////////////////////////////////////////////////////////////////////
 
+QFileInfo V2Content::GetTrickplayIndex( int              nRecordedId,
+                                        int              nChanId,
+                                        const QDateTime &StartTime )
+{
+    if ((nRecordedId <= 0) &&
+        (nChanId <= 0 || !StartTime.isValid()))
+        throw QString("Recorded ID or Channel ID and StartTime appears invalid.");
+
+    ProgramInfo pginfo;
+    if (nRecordedId > 0)
+        pginfo = ProgramInfo(nRecordedId);
+    else
+        pginfo = ProgramInfo(nChanId, StartTime.toUTC());
+
+    if (!pginfo.GetChanID())
+    {
+        LOG(VB_UPNP, LOG_ERR, QString("GetTrickplayIndex - for '%1' failed")
+            .arg(nRecordedId));
+
+        return {};
+    }
+
+    if (pginfo.GetHostname().toLower() != gCoreContext->GetHostName().toLower()
+            &&  ! gCoreContext->GetBoolSetting("MasterBackendOverride", false))
+    {
+        // The index refers to its images on the same backend
+        throw V2HttpRedirectException( pginfo.GetHostname() );
+    }
+
+    // ----------------------------------------------------------------------
+    // The thumbnails are made by the preview generation job
+    // ----------------------------------------------------------------------
+
+    QString sFileName = TrickplayGenerator::IndexFilename(GetPlaybackURL(&pginfo));
+
+    if (QFile::exists( sFileName ))
+        return QFileInfo( sFileName );
+
+    LOG(VB_UPNP, LOG_INFO,
+        QString("GetTrickplayIndex - No thumbnails for recording %1")
+            .arg(pginfo.GetRecordingID()));
+
+    return {};
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QFileInfo V2Content::GetMusic( int nId )
 {
     QString sFileName;
@@ -98,6 +98,10 @@ class V2Content : public MythHTTPService
                                                   const QDateTime &StartTime,
                                                   const QString   &Download );
 
+        static QFileInfo    GetTrickplayIndex   ( int              RecordedId,
+                                                  int              ChanId,
+                                                  const QDateTime &StartTime );
+
         static QFileInfo    GetMusic            ( int Id );
         static QFileInfo    GetVideo            ( int Id );
 
@@ -87,6 +87,8 @@ class V2Dvr : public MythHTTPService
     Q_CLASSINFO("AddPowerPriority",     "methods=POST")
     Q_CLASSINFO("UpdatePowerPriority",  "methods=POST")
     Q_CLASSINFO("CheckPowerQuery",      "methods=GET,POST,HEAD")
+    Q_CLASSINFO("GetRecordedList",      "cache=RECORDING_LIST_CHANGE")
+    Q_CLASSINFO("GetUpcomingList",      "cache=SCHEDULE_CHANGE,RECORDING_LIST_CHANGE")
 
   public:
     V2Dvr();
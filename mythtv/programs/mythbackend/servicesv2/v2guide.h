@@ -52,6 +52,8 @@ class V2Guide : public MythHTTPService
     Q_CLASSINFO("AddChannelGroup",        "methods=POST;name=int")
     Q_CLASSINFO("RemoveChannelGroup",     "methods=POST;name=bool")
     Q_CLASSINFO("UpdateChannelGroup",     "methods=POST;name=bool")
+    Q_CLASSINFO("GetProgramGuide",        "cache=SCHEDULE_CHANGE,MYTHFILLDATABASE_RAN")
+    Q_CLASSINFO("GetProgramList",         "cache=SCHEDULE_CHANGE,MYTHFILLDATABASE_RAN")
 
     public:
         V2Guide();
@@ -0,0 +1,51 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpStatus.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef V2HTTPSTATUS_H_
+#define V2HTTPSTATUS_H_
+
+#include <QDateTime>
+
+#include "libmythbase/http/mythhttpservice.h"
+
+class V2HTTPStatus : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+    Q_CLASSINFO( "AsOf"   , "transient=true" )
+
+    SERVICE_PROPERTY2( QDateTime , AsOf         )
+    SERVICE_PROPERTY2( uint      , Connections  )
+    SERVICE_PROPERTY2( uint      , WebSockets   )
+    SERVICE_PROPERTY2( uint      , IOThreads    )
+    SERVICE_PROPERTY2( uint      , QueuedConnections )
+    SERVICE_PROPERTY2( uint      , ActiveRequests    )
+    SERVICE_PROPERTY2( qulonglong, Requests     )
+    SERVICE_PROPERTY2( double    , LatencyP50   )
+    SERVICE_PROPERTY2( double    , LatencyP90   )
+    SERVICE_PROPERTY2( double    , LatencyP99   )
+    SERVICE_PROPERTY2( qulonglong, ReadCacheSize       )
+    SERVICE_PROPERTY2( qulonglong, ReadCacheUsed       )
+    SERVICE_PROPERTY2( qulonglong, ReadCacheHits       )
+    SERVICE_PROPERTY2( qulonglong, ReadCacheMisses     )
+    SERVICE_PROPERTY2( double    , ReadCacheHitRate    )
+    SERVICE_PROPERTY2( qulonglong, ReadCachePrefetched )
+
+    public:
+
+        Q_INVOKABLE V2HTTPStatus(QObject *parent = nullptr)
+            : QObject( parent )
+        {
+        }
+
+    private:
+        Q_DISABLE_COPY(V2HTTPStatus);
+};
+
+Q_DECLARE_METATYPE(V2HTTPStatus*)
+
+#endif
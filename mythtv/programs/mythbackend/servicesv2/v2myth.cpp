@@ -37,9 +37,25 @@ static inline void api_sd_notify(const char *str) { sd_notify(0, str); };
 static inline void api_sd_notify(const char */*str*/) {};
 #endif
 
+// Methods that are polled often are called directly
+static HTTPInvokers MythInvokers()
+{
+    return {
+        { "GetHostName",        MythHTTPMetaMethod::Invoker(&V2Myth::GetHostName)        },
+        { "GetHosts",           MythHTTPMetaMethod::Invoker(&V2Myth::GetHosts)           },
+        { "GetSetting",         MythHTTPMetaMethod::Invoker(&V2Myth::GetSetting)         },
+        { "GetTimeZone",        MythHTTPMetaMethod::Invoker(&V2Myth::GetTimeZone)        },
+        { "GetFormatDate",      MythHTTPMetaMethod::Invoker(&V2Myth::GetFormatDate)      },
+        { "GetFormatDateTime",  MythHTTPMetaMethod::Invoker(&V2Myth::GetFormatDateTime)  },
+        { "GetFormatTime",      MythHTTPMetaMethod::Invoker(&V2Myth::GetFormatTime)      },
+        { "ParseISODateString", MythHTTPMetaMethod::Invoker(&V2Myth::ParseISODateString) },
+        { "GetBackendInfo",     MythHTTPMetaMethod::Invoker(&V2Myth::GetBackendInfo)     },
+    };
+}
+
 // This will be initialised in a thread safe manner on first use
 Q_GLOBAL_STATIC_WITH_ARGS(MythHTTPMetaService, s_service,
-    (MYTH_HANDLE, V2Myth::staticMetaObject, &V2Myth::RegisterCustomTypes))
+    (MYTH_HANDLE, V2Myth::staticMetaObject, &V2Myth::RegisterCustomTypes, {}, MythInvokers()))
 
 void V2Myth::RegisterCustomTypes()
 {
@@ -27,6 +27,8 @@
 #include "libmythbase/compat.h"
 #include "libmythbase/exitcodes.h"
 #include "libmythbase/http/mythhttpmetaservice.h"
+#include "libmythbase/http/mythhttpreadcache.h"
+#include "libmythbase/http/mythhttpstats.h"
 #include "libmythbase/mythconfig.h"
 #include "libmythbase/mythcorecontext.h"
 #include "libmythbase/mythdate.h"
@@ -62,6 +64,7 @@ void V2Status::RegisterCustomTypes()
     qRegisterMetaType<Preformat*>("Preformat");
     qRegisterMetaType<V2MachineInfo*>("V2MachineInfo");
     qRegisterMetaType<V2BackendStatus*>("V2BackendStatus");
+    qRegisterMetaType<V2HTTPStatus*>("V2HTTPStatus");
     qRegisterMetaType<V2Encoder*>("V2Encoder");
     qRegisterMetaType<V2Program*>("V2Program");
     qRegisterMetaType<V2Frontend*>("V2Frontend");
@@ -303,6 +306,34 @@ V2BackendStatus*  V2Status::GetBackendStatus()
     return pStatus;
 }
 
+/// Connections, queues, request latency and file cache use of this web server
+V2HTTPStatus* V2Status::GetHTTPStatus()
+{
+    auto stats = MythHTTPStats::Get();
+    auto toms = [](std::chrono::microseconds Value) { return Value.count() / 1000.0; };
+    auto* pStatus = new V2HTTPStatus();
+    pStatus->setAsOf             ( MythDate::current() );
+    pStatus->setConnections      ( static_cast<uint>(stats.m_connections) );
+    pStatus->setWebSockets       ( static_cast<uint>(stats.m_websockets) );
+    pStatus->setIOThreads        ( static_cast<uint>(stats.m_ioThreads) );
+    pStatus->setQueuedConnections( static_cast<uint>(stats.m_queued) );
+    pStatus->setActiveRequests   ( static_cast<uint>(stats.m_active) );
+    pStatus->setRequests         ( static_cast<qulonglong>(stats.m_requests) );
+    pStatus->setLatencyP50       ( toms(stats.m_p50) );
+    pStatus->setLatencyP90       ( toms(stats.m_p90) );
+    pStatus->setLatencyP99       ( toms(stats.m_p99) );
+
+    auto cache = MythHTTPReadCache::Get();
+    uint64_t lookups = cache.m_hits + cache.m_misses;
+    pStatus->setReadCacheSize      ( static_cast<qulonglong>(cache.m_capacity) );
+    pStatus->setReadCacheUsed      ( static_cast<qulonglong>(cache.m_used) );
+    pStatus->setReadCacheHits      ( static_cast<qulonglong>(cache.m_hits) );
+    pStatus->setReadCacheMisses    ( static_cast<qulonglong>(cache.m_misses) );
+    pStatus->setReadCacheHitRate   ( lookups ? 100.0 * static_cast<double>(cache.m_hits) / static_cast<double>(lookups) : 0.0 );
+    pStatus->setReadCachePrefetched( static_cast<qulonglong>(cache.m_prefetched) );
+    return pStatus;
+}
+
 void V2Status::FillDriveSpace(V2MachineInfo* pMachineInfo)
 {
     QStringList strlist;
@@ -25,6 +25,7 @@
 // MythBackend
 #include "preformat.h"
 #include "v2backendStatus.h"
+#include "v2httpStatus.h"
 
 class Scheduler;
 class AutoExpire;
@@ -42,6 +43,7 @@ class V2Status : public MythHTTPService
     Q_CLASSINFO("Status",       "methods=GET,POST,HEAD")
     Q_CLASSINFO("xml",          "methods=GET,POST,HEAD")
     Q_CLASSINFO("GetBackendStatus", "methods=GET,POST,HEAD")
+    Q_CLASSINFO("GetHTTPStatus",    "methods=GET,POST,HEAD")
 
     public:
         V2Status();
@@ -54,6 +56,7 @@ class V2Status : public MythHTTPService
         Preformat*         GetStatus ();  // XML
         Preformat*         xml ();        // XML
         V2BackendStatus*   GetBackendStatus(); // Standardized version of GetStatus
+        static V2HTTPStatus* GetHTTPStatus();  // Web server load
 
     private:
 
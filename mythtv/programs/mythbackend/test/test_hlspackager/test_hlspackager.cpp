@@ -0,0 +1,124 @@
+/*
+ *  Class TestHLSPackager
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/programinfo.h"
+
+#include "hlspackager.h"
+#include "test_hlspackager.h"
+
+// A keyframe every second, 10000 bytes apart
+static constexpr uint64_t kFramesPerKey { 30 };
+static constexpr uint64_t kBytesPerKey  { 10000 };
+// Segments end at the first keyframe six seconds in
+static constexpr uint64_t kSegmentBytes { 6 * kBytesPerKey };
+
+// Keyframes 0 to Count, with durations for those up to LastDuration
+static void fill(HLSPackager::Stream &Stream, uint64_t Count, uint64_t LastDuration)
+{
+    for (uint64_t key = 0; key <= Count; ++key)
+    {
+        Stream.m_positions[key * kFramesPerKey] = key * kBytesPerKey;
+        if (key <= LastDuration)
+            Stream.m_durations[key * kFramesPerKey] = key * 1000;
+    }
+}
+
+void TestHLSPackager::segments_empty(void)
+{
+    HLSPackager::Stream stream;
+    ProgramInfo pginfo;
+    QVERIFY(HLSPackager::Segments(stream, pginfo, 100000, false).empty());
+}
+
+void TestHLSPackager::segments_keyframes(void)
+{
+    HLSPackager::Stream stream;
+    ProgramInfo pginfo;
+    fill(stream, 20, 20);
+
+    // The last two seconds are too short to be a segment while recording
+    auto segments = HLSPackager::Segments(stream, pginfo, 205000, false);
+    QCOMPARE(segments.size(), static_cast<size_t>(3));
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        QCOMPARE(segments[i].m_offset, i * kSegmentBytes);
+        QCOMPARE(segments[i].m_length, kSegmentBytes);
+        QVERIFY(segments[i].m_duration == 6s);
+    }
+}
+
+void TestHLSPackager::segments_past_end(void)
+{
+    HLSPackager::Stream stream;
+    ProgramInfo pginfo;
+    fill(stream, 20, 20);
+
+    // Keyframes the seek table has but the file does not yet
+    auto segments = HLSPackager::Segments(stream, pginfo, 150000, false);
+    QCOMPARE(segments.size(), static_cast<size_t>(2));
+    QCOMPARE(segments.back().m_offset, kSegmentBytes);
+    QCOMPARE(segments.back().m_length, kSegmentBytes);
+}
+
+void TestHLSPackager::segments_missing_duration(void)
+{
+    HLSPackager::Stream stream;
+    ProgramInfo pginfo;
+    fill(stream, 20, 12);
+
+    // Keyframes saved before their durations take the last one known
+    auto segments = HLSPackager::Segments(stream, pginfo, 205000, false);
+    QCOMPARE(segments.size(), static_cast<size_t>(2));
+    QCOMPARE(segments.back().m_offset, kSegmentBytes);
+    QVERIFY(segments.back().m_duration == 6s);
+}
+
+void TestHLSPackager::playlist_complete(void)
+{
+    std::vector<HLSPackager::Segment> segments {
+        { 0,   100, 6000ms },
+        { 100, 50,  7500ms } };
+
+    QString expected("#EXTM3U\n"
+                     "#EXT-X-VERSION:4\n"
+                     "#EXT-X-TARGETDURATION:8\n"
+                     "#EXT-X-MEDIA-SEQUENCE:0\n"
+                     "#EXT-X-PLAYLIST-TYPE:VOD\n"
+                     "#EXT-X-INDEPENDENT-SEGMENTS\n"
+                     "#EXTINF:6.000,\n"
+                     "#EXT-X-BYTERANGE:100@0\n"
+                     "/Content/GetRecording?RecordedId=42\n"
+                     "#EXTINF:7.500,\n"
+                     "#EXT-X-BYTERANGE:50@100\n"
+                     "/Content/GetRecording?RecordedId=42\n"
+                     "#EXT-X-ENDLIST\n");
+    QCOMPARE(HLSPackager::Playlist(42, segments, true), expected);
+}
+
+void TestHLSPackager::playlist_live(void)
+{
+    // Nothing long enough yet, and more to come
+    QString playlist = HLSPackager::Playlist(42, {}, false);
+    QVERIFY(playlist.contains("#EXT-X-TARGETDURATION:6\n"));
+    QVERIFY(playlist.contains("#EXT-X-PLAYLIST-TYPE:EVENT\n"));
+    QVERIFY(!playlist.contains("#EXTINF"));
+    QVERIFY(!playlist.contains("#EXT-X-ENDLIST"));
+}
+
+QTEST_APPLESS_MAIN(TestHLSPackager)
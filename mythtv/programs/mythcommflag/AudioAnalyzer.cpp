@@ -0,0 +1,961 @@
+// C++ headers
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+// Qt headers
+#include <QtAlgorithms>
+
+// MythTV headers
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythlogging.h"
+#include "libmythtv/io/mythavformatbuffer.h"
+#include "libmythtv/io/mythmediabuffer.h"
+
+// Commercial Flagging headers
+#include "AudioAnalyzer.h"
+#include "CommDetector2.h"
+
+extern "C" {
+#include "libavutil/channel_layout.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+}
+
+using namespace commDetector2;
+
+#define LOC QString("AudioAnalyzer: ")
+
+namespace {
+
+/*
+ * TUNABLE:
+ *
+ * Loudness is measured in 100ms blocks, as in EBU R128. Blocks quieter than
+ * kSilenceLoudness are silent; kMinSilenceBlocks of them in a row separate
+ * two segments.
+ */
+constexpr int       kBlocksPerSecond    = 10;
+constexpr double    kSilenceLoudness    = -50.0;    /* LUFS */
+constexpr size_t    kMinSilenceBlocks   = 2;
+
+/*
+ * TUNABLE:
+ *
+ * Segments (audio between two silences) are candidate commercials if they
+ * are between kMinCommLength and kMaxCommLength seconds long. A candidate is
+ * a commercial if it scores at least kMinCommScore:
+ *
+ *  - 2 if at least half of it is audio that also occurs elsewhere in the
+ *    recording,
+ *  - 1 if it is within kLengthSlop seconds of a common commercial length,
+ *  - 1 if it is at least kLouderLU louder than the integrated loudness of
+ *    the whole recording,
+ *  - kMinCommScore if at least half of it is a known commercial. The ends
+ *    of a known commercial also delimit segments, unless they are within
+ *    kKnownSnap seconds of a silence.
+ */
+constexpr double    kMinCommLength      = 5.0;
+constexpr double    kMaxCommLength      = 125.0;
+constexpr double    kLengthSlop         = 1.0;
+constexpr double    kLouderLU           = 2.0;
+constexpr double    kKnownSnap          = 1.0;
+constexpr int       kMinCommScore       = 2;
+constexpr std::array<double,8> kCommLengths
+    { 10.0, 15.0, 20.0, 30.0, 45.0, 60.0, 90.0, 120.0 };
+
+/*
+ * TUNABLE:
+ *
+ * Repeated audio is found by looking up each sub-fingerprint among earlier
+ * ones at least kMinRepeatGap seconds away, and comparing kMatchSeconds of
+ * fingerprints from there. Matches with fewer than kMaxBitErrorRate of the
+ * bits different are extended for as long as they keep matching, and kept
+ * if they last kMinRepeatLength seconds. Sub-fingerprints that occur more
+ * than kMaxOccurrences times are uninformative and are not looked up.
+ */
+constexpr int       kMinRepeatGap       = 30;
+constexpr int       kMatchSeconds       = 2;
+constexpr double    kMaxBitErrorRate    = 0.25;
+constexpr int       kMinRepeatLength    = 5;
+constexpr size_t    kMaxOccurrences     = 50;
+constexpr int       kProbeStep          = 4;
+
+/* Spectral bands used by the fingerprints, as in Haitsma & Kalker. */
+constexpr int       kBands              = 33;
+constexpr double    kLowFrequency       = 300.0;
+constexpr double    kHighFrequency      = 2000.0;
+constexpr float     kSilentRMS          = 0.001F;
+
+/*
+ * Video keyframes are hashed by comparing the mean luma of horizontally
+ * adjacent cells of a kHashColumns x kHashRows grid, sampling every
+ * kHashStep pixels, which gives one bit per pair.
+ */
+constexpr int       kHashColumns        = 9;
+constexpr int       kHashRows           = 8;
+constexpr int       kHashStep           = 4;
+constexpr double    kMaxKeyframeDistance = 0.5;   /* seconds */
+
+float get_sample(const AVFrame *frame, AVSampleFormat packed, bool planar,
+                 int channels, int ch, int idx)
+{
+    const uint8_t *data = planar ? frame->extended_data[ch] :
+                                   frame->extended_data[0];
+    const int      pos  = planar ? idx : (idx * channels) + ch;
+
+    switch (packed)
+    {
+        case AV_SAMPLE_FMT_U8:
+            return (data[pos] - 128) / 128.0F;
+        case AV_SAMPLE_FMT_S16:
+            return reinterpret_cast<const int16_t*>(data)[pos] / 32768.0F;
+        case AV_SAMPLE_FMT_S32:
+            return reinterpret_cast<const int32_t*>(data)[pos] / 2147483648.0F;
+        case AV_SAMPLE_FMT_FLT:
+            return reinterpret_cast<const float*>(data)[pos];
+        case AV_SAMPLE_FMT_DBL:
+            return static_cast<float>(reinterpret_cast<const double*>(data)[pos]);
+        default:
+            return 0.0F;
+    }
+}
+
+/* ITU-R BS.1770 channel weights; the LFE channel is ignored. */
+double channel_weight(const AVChannelLayout *layout, int ch)
+{
+    switch (av_channel_layout_channel_from_index(layout, ch))
+    {
+        case AV_CHAN_LOW_FREQUENCY:
+        case AV_CHAN_LOW_FREQUENCY_2:
+            return 0.0;
+        case AV_CHAN_SIDE_LEFT:
+        case AV_CHAN_SIDE_RIGHT:
+        case AV_CHAN_BACK_LEFT:
+        case AV_CHAN_BACK_RIGHT:
+            return 1.41;
+        default:
+            return 1.0;
+    }
+}
+
+double power_to_lufs(double power)
+{
+    return power > 0.0 ? -0.691 + (10.0 * log10(power)) : -70.0;
+}
+
+};  /* namespace */
+
+double AudioAnalyzer::Biquad::process(double in)
+{
+    double out = (m_b[0] * in) + m_z[0];
+    m_z[0] = (m_b[1] * in) - (m_a[1] * out) + m_z[1];
+    m_z[1] = (m_b[2] * in) - (m_a[2] * out);
+    return out;
+}
+
+AudioAnalyzer::AudioAnalyzer(QString filename)
+    : m_filename(std::move(filename))
+{
+    m_minBreakLength = gCoreContext->GetNumSetting("CommDetectMinCommBreakLength", 60);
+    m_maxBreakLength = gCoreContext->GetNumSetting("CommDetectMaxCommBreakLength", 395);
+}
+
+AudioAnalyzer::~AudioAnalyzer()
+{
+    close();
+}
+
+bool AudioAnalyzer::open(void)
+{
+    m_opened = true;
+
+    m_buffer = MythMediaBuffer::Create(m_filename, false);
+    if (!m_buffer || !m_buffer->IsOpen())
+    {
+        LOG(VB_COMMFLAG, LOG_ERR, LOC + QString("Unable to open '%1'")
+            .arg(m_filename));
+        return false;
+    }
+    m_fileSize = m_buffer->GetRealFileSize();
+
+    m_fmt = avformat_alloc_context();
+    if (!m_fmt)
+        return false;
+    m_avfBuffer = new MythAVFormatBuffer(m_buffer, false, false);
+    m_fmt->pb = m_avfBuffer->getAVIOContext();
+    m_fmt->flags |= AVFMT_FLAG_CUSTOM_IO;
+    m_avfBuffer->SetInInit(false);
+
+    QByteArray fname = m_filename.toLocal8Bit();
+    if (avformat_open_input(&m_fmt, fname.constData(), nullptr, nullptr) < 0)
+    {
+        // m_fmt is freed on failure
+        LOG(VB_COMMFLAG, LOG_ERR, LOC + QString("Unable to demux '%1'")
+            .arg(m_filename));
+        return false;
+    }
+    if (avformat_find_stream_info(m_fmt, nullptr) < 0)
+        return false;
+
+    const AVCodec *codec = nullptr;
+    m_streamIndex = av_find_best_stream(m_fmt, AVMEDIA_TYPE_AUDIO, -1, -1,
+                                        &codec, 0);
+    if (m_streamIndex < 0 || !codec)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC + "No audio stream");
+        return false;
+    }
+
+    int video = av_find_best_stream(m_fmt, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                    nullptr, 0);
+    if (video >= 0)
+    {
+        const AVStream *st = m_fmt->streams[video];
+        AVRational rate = st->avg_frame_rate.num ? st->avg_frame_rate :
+                                                   st->r_frame_rate;
+        if (rate.num && rate.den)
+            m_frameRate = static_cast<float>(av_q2d(rate));
+
+        if (m_videoHashing)
+        {
+            const AVCodec *vcodec = avcodec_find_decoder(st->codecpar->codec_id);
+            m_videoCtx = vcodec ? avcodec_alloc_context3(vcodec) : nullptr;
+            if (m_videoCtx &&
+                avcodec_parameters_to_context(m_videoCtx, st->codecpar) >= 0)
+            {
+                m_videoCtx->skip_frame = AVDISCARD_NONKEY;
+                m_videoCtx->skip_loop_filter = AVDISCARD_ALL;
+                if (avcodec_open2(m_videoCtx, vcodec, nullptr) >= 0)
+                    m_videoIndex = video;
+            }
+            if (m_videoIndex < 0)
+            {
+                LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+                    "Unable to decode the video, not hashing keyframes");
+                avcodec_free_context(&m_videoCtx);
+            }
+        }
+    }
+
+    /*
+     * Only the audio packets (and the video keyframes, if hashed) are wanted,
+     * leave everything else undecoded.
+     */
+    for (uint ii = 0; ii < m_fmt->nb_streams; ii++)
+    {
+        if (static_cast<int>(ii) == m_videoIndex)
+            m_fmt->streams[ii]->discard = AVDISCARD_NONKEY;
+        else if (static_cast<int>(ii) != m_streamIndex)
+            m_fmt->streams[ii]->discard = AVDISCARD_ALL;
+    }
+
+    m_ctx = avcodec_alloc_context3(codec);
+    if (!m_ctx ||
+        avcodec_parameters_to_context(m_ctx, m_fmt->streams[m_streamIndex]->codecpar) < 0 ||
+        avcodec_open2(m_ctx, codec, nullptr) < 0)
+    {
+        LOG(VB_COMMFLAG, LOG_ERR, LOC + QString("Unable to open %1 decoder")
+            .arg(codec->name));
+        return false;
+    }
+
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("Analyzing %1 audio of '%2'")
+        .arg(codec->name, m_filename));
+    return m_packet && m_frame;
+}
+
+void AudioAnalyzer::close(void)
+{
+    av_frame_free(&m_frame);
+    av_packet_free(&m_packet);
+    avcodec_free_context(&m_ctx);
+    avcodec_free_context(&m_videoCtx);
+    if (m_fmt)
+    {
+        m_fmt->pb = nullptr;
+        avformat_close_input(&m_fmt);
+    }
+    delete m_avfBuffer;
+    m_avfBuffer = nullptr;
+    delete m_buffer;
+    m_buffer = nullptr;
+
+    av_tx_uninit(&m_tx);
+    av_freep(reinterpret_cast<void*>(&m_txIn));
+    av_freep(reinterpret_cast<void*>(&m_txOut));
+}
+
+AudioAnalyzer::analyzeResult AudioAnalyzer::analyzeSome(int npackets)
+{
+    if (m_finished)
+        return ANALYZE_FINISHED;
+    if (!m_opened && !open())
+        m_failed = true;
+    if (m_failed)
+        return ANALYZE_FATAL;
+
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    analyzeResult result = ANALYZE_OK;
+    for (int ii = 0; ii < npackets; )
+    {
+        if (av_read_frame(m_fmt, m_packet) < 0)
+        {
+            decodePacket(nullptr);
+            if (m_videoCtx)
+                decodeVideoPacket(nullptr);
+            m_finished = true;
+            result = ANALYZE_FINISHED;
+            break;
+        }
+        if (m_packet->stream_index == m_streamIndex)
+        {
+            decodePacket(m_packet);
+            ii++;
+        }
+        else if (m_packet->stream_index == m_videoIndex &&
+                 (m_packet->flags & AV_PKT_FLAG_KEY))
+        {
+            decodeVideoPacket(m_packet);
+        }
+        av_packet_unref(m_packet);
+    }
+    m_analyzeTime += nowAsDuration<std::chrono::microseconds>() - start;
+
+    if (result == ANALYZE_FINISHED && m_power.empty())
+    {
+        LOG(VB_COMMFLAG, LOG_ERR, LOC + "No audio decoded");
+        return ANALYZE_FATAL;
+    }
+    return result;
+}
+
+void AudioAnalyzer::decodePacket(const AVPacket *pkt)
+{
+    if (avcodec_send_packet(m_ctx, pkt) < 0)
+        return;
+    while (avcodec_receive_frame(m_ctx, m_frame) == 0)
+    {
+        processFrame(m_frame);
+        av_frame_unref(m_frame);
+    }
+}
+
+void AudioAnalyzer::decodeVideoPacket(const AVPacket *pkt)
+{
+    if (avcodec_send_packet(m_videoCtx, pkt) < 0)
+        return;
+    while (avcodec_receive_frame(m_videoCtx, m_frame) == 0)
+    {
+        hashVideoFrame(m_frame);
+        av_frame_unref(m_frame);
+    }
+}
+
+void AudioAnalyzer::hashVideoFrame(const AVFrame *frame)
+{
+    const auto *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!desc || frame->best_effort_timestamp == AV_NOPTS_VALUE ||
+        (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL |
+                        AV_PIX_FMT_FLAG_HWACCEL)) ||
+        frame->width < kHashColumns * kHashStep ||
+        frame->height < kHashRows * kHashStep)
+    {
+        return;
+    }
+
+    /* Mean luma of each cell of the grid. */
+    const bool wide = desc->comp[0].depth > 8;
+    std::array<double,kHashColumns * kHashRows> cells {};
+    for (int row = 0; row < kHashRows; row++)
+    {
+        const int y0 = row * frame->height / kHashRows;
+        const int y1 = (row + 1) * frame->height / kHashRows;
+        for (int col = 0; col < kHashColumns; col++)
+        {
+            const int x0 = col * frame->width / kHashColumns;
+            const int x1 = (col + 1) * frame->width / kHashColumns;
+            uint64_t sum = 0;
+            int count = 0;
+            for (int yy = y0; yy < y1; yy += kHashStep)
+            {
+                const uint8_t *line = frame->data[0] +
+                    (static_cast<ptrdiff_t>(yy) * frame->linesize[0]);
+                for (int xx = x0; xx < x1; xx += kHashStep, count++)
+                {
+                    sum += wide ? reinterpret_cast<const uint16_t*>(line)[xx]
+                                : line[xx];
+                }
+            }
+            cells[(row * kHashColumns) + col] =
+                count ? static_cast<double>(sum) / count : 0.0;
+        }
+    }
+
+    uint64_t hash = 0;
+    for (int row = 0; row < kHashRows; row++)
+    {
+        for (int col = 0; col + 1 < kHashColumns; col++)
+        {
+            if (cells[(row * kHashColumns) + col] <
+                cells[(row * kHashColumns) + col + 1])
+                hash |= 1ULL << ((row * (kHashColumns - 1)) + col);
+        }
+    }
+
+    const AVStream *st = m_fmt->streams[m_videoIndex];
+    double time = frame->best_effort_timestamp * av_q2d(st->time_base);
+    if (m_fmt->start_time != AV_NOPTS_VALUE)
+        time -= static_cast<double>(m_fmt->start_time) / AV_TIME_BASE;
+    m_keyframes.push_back({ time, hash });
+}
+
+void AudioAnalyzer::configure(const AVFrame *frame)
+{
+    const int rate = frame->sample_rate;
+    const int channels = frame->ch_layout.nb_channels;
+
+    if (rate != m_sampleRate)
+    {
+        if (m_sampleRate)
+        {
+            LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+                QString("Sample rate changed from %1 to %2")
+                    .arg(m_sampleRate).arg(rate));
+        }
+        m_sampleRate = rate;
+        m_blockLength = std::max(1, rate / kBlocksPerSecond);
+        m_blockSamples = 0;
+        m_blockPower = 0.0;
+
+        /* Fingerprint windows of about 85ms, kFingerprintRate per second. */
+        m_windowLength = rate >= 32000 ? 4096 : 2048;
+        m_hop = std::max(1, rate / kFingerprintRate);
+        m_window.assign(m_windowLength, 0.0F);
+        m_windowPos = 0;
+        m_windowFill = 0;
+        m_sinceHop = 0;
+        m_hann.resize(m_windowLength);
+        for (int ii = 0; ii < m_windowLength; ii++)
+            m_hann[ii] = 0.5F - (0.5F * cosf(2.0F * static_cast<float>(M_PI) *
+                                             ii / (m_windowLength - 1)));
+
+        av_tx_uninit(&m_tx);
+        av_freep(reinterpret_cast<void*>(&m_txIn));
+        av_freep(reinterpret_cast<void*>(&m_txOut));
+        float scale = 1.0F;
+        m_txIn = static_cast<float*>(av_malloc(sizeof(float) * m_windowLength));
+        m_txOut = static_cast<AVComplexFloat*>(
+            av_malloc(sizeof(AVComplexFloat) * ((m_windowLength / 2) + 1)));
+        if (!m_txIn || !m_txOut ||
+            av_tx_init(&m_tx, &m_txFn, AV_TX_FLOAT_RDFT, 0, m_windowLength,
+                       &scale, 0) < 0)
+        {
+            LOG(VB_COMMFLAG, LOG_ERR, LOC + "Unable to set up the FFT");
+            m_failed = true;
+            return;
+        }
+
+        m_bandEdges.resize(kBands + 1);
+        for (int ii = 0; ii <= kBands; ii++)
+        {
+            double freq = kLowFrequency *
+                pow(kHighFrequency / kLowFrequency, static_cast<double>(ii) / kBands);
+            m_bandEdges[ii] = std::clamp(
+                static_cast<int>(lround(freq * m_windowLength / rate)),
+                1, m_windowLength / 2);
+        }
+        m_prevBands.assign(kBands, 0.0);
+        m_channels = 0;
+    }
+
+    if (channels != m_channels)
+    {
+        /*
+         * K-weighting: a high shelf followed by a high pass, designed for the
+         * sample rate in use (ITU-R BS.1770-4).
+         */
+        std::array<Biquad,2> kweight;
+
+        double kk = tan(M_PI * 1681.974450955533 / rate);
+        double vh = pow(10.0, 3.999843853973347 / 20.0);
+        double vb = pow(vh, 0.4996667741545416);
+        double qq = 0.7071752369554196;
+        double a0 = 1.0 + (kk / qq) + (kk * kk);
+        kweight[0].m_b = { (vh + (vb * kk / qq) + (kk * kk)) / a0,
+                           2.0 * ((kk * kk) - vh) / a0,
+                           (vh - (vb * kk / qq) + (kk * kk)) / a0 };
+        kweight[0].m_a = { 1.0,
+                           2.0 * ((kk * kk) - 1.0) / a0,
+                           (1.0 - (kk / qq) + (kk * kk)) / a0 };
+
+        kk = tan(M_PI * 38.13547087602444 / rate);
+        qq = 0.5003270373238773;
+        a0 = 1.0 + (kk / qq) + (kk * kk);
+        kweight[1].m_b = { 1.0, -2.0, 1.0 };
+        kweight[1].m_a = { 1.0,
+                           2.0 * ((kk * kk) - 1.0) / a0,
+                           (1.0 - (kk / qq) + (kk * kk)) / a0 };
+
+        m_channels = channels;
+        m_filters.assign(channels, kweight);
+        m_weights.resize(channels);
+        for (int ch = 0; ch < channels; ch++)
+            m_weights[ch] = channel_weight(&frame->ch_layout, ch);
+    }
+}
+
+void AudioAnalyzer::processFrame(const AVFrame *frame)
+{
+    if (frame->sample_rate <= 0 || frame->ch_layout.nb_channels <= 0)
+        return;
+
+    if (!m_haveStart && frame->best_effort_timestamp != AV_NOPTS_VALUE)
+    {
+        /* Align audio time with the start of the file. */
+        m_haveStart = true;
+        const AVStream *st = m_fmt->streams[m_streamIndex];
+        double start = frame->best_effort_timestamp * av_q2d(st->time_base);
+        if (m_fmt->start_time != AV_NOPTS_VALUE)
+            start -= static_cast<double>(m_fmt->start_time) / AV_TIME_BASE;
+        m_startOffset = std::max(0.0, start);
+    }
+
+    if (frame->sample_rate != m_sampleRate ||
+        frame->ch_layout.nb_channels != m_channels)
+    {
+        configure(frame);
+        if (m_failed)
+            return;
+    }
+
+    const auto fmt = static_cast<AVSampleFormat>(frame->format);
+    const AVSampleFormat packed = av_get_packed_sample_fmt(fmt);
+    const bool planar = av_sample_fmt_is_planar(fmt) != 0;
+    const int channels = m_channels;
+
+    for (int ii = 0; ii < frame->nb_samples; ii++)
+    {
+        double power = 0.0;
+        float mono = 0.0F;
+        for (int ch = 0; ch < channels; ch++)
+        {
+            float sample = get_sample(frame, packed, planar, channels, ch, ii);
+            double filtered = m_filters[ch][1].process(
+                m_filters[ch][0].process(sample));
+            power += m_weights[ch] * filtered * filtered;
+            mono += sample;
+        }
+
+        m_blockPower += power;
+        if (++m_blockSamples == m_blockLength)
+        {
+            m_power.push_back(static_cast<float>(m_blockPower / m_blockLength));
+            m_blockPower = 0.0;
+            m_blockSamples = 0;
+        }
+
+        m_window[m_windowPos] = mono / channels;
+        m_windowPos = (m_windowPos + 1) % m_windowLength;
+        m_windowFill = std::min(m_windowFill + 1, m_windowLength);
+        if (++m_sinceHop == m_hop)
+        {
+            m_sinceHop = 0;
+            if (m_windowFill == m_windowLength)
+                addFingerprintFrame();
+        }
+    }
+}
+
+void AudioAnalyzer::addFingerprintFrame(void)
+{
+    /*
+     * Haitsma & Kalker style sub-fingerprint: one bit per pair of adjacent
+     * bands, set if the energy difference between the bands grew since the
+     * previous frame.
+     */
+    double sumsq = 0.0;
+    for (int ii = 0; ii < m_windowLength; ii++)
+    {
+        float sample = m_window[(m_windowPos + ii) % m_windowLength];
+        sumsq += static_cast<double>(sample) * sample;
+        m_txIn[ii] = sample * m_hann[ii];
+    }
+    m_txFn(m_tx, m_txOut, m_txIn, sizeof(float));
+
+    std::array<double,kBands> bands {};
+    for (int band = 0; band < kBands; band++)
+    {
+        double energy = 0.0;
+        for (int bin = m_bandEdges[band]; bin < m_bandEdges[band + 1]; bin++)
+        {
+            energy += (static_cast<double>(m_txOut[bin].re) * m_txOut[bin].re) +
+                      (static_cast<double>(m_txOut[bin].im) * m_txOut[bin].im);
+        }
+        bands[band] = energy;
+    }
+
+    uint32_t subfp = 0;
+    for (int bit = 0; bit < kBands - 1; bit++)
+    {
+        double diff = (bands[bit] - bands[bit + 1]) -
+                      (m_prevBands[bit] - m_prevBands[bit + 1]);
+        if (diff > 0.0)
+            subfp |= 1U << bit;
+    }
+    std::copy(bands.cbegin(), bands.cend(), m_prevBands.begin());
+
+    m_subfp.push_back(subfp);
+    m_subfpLive.push_back(sqrt(sumsq / m_windowLength) > kSilentRMS ? 1 : 0);
+}
+
+double AudioAnalyzer::loudness(size_t first, size_t last) const
+{
+    last = std::min(last, m_power.size());
+    if (first >= last)
+        return power_to_lufs(0.0);
+    double sum = 0.0;
+    for (size_t ii = first; ii < last; ii++)
+        sum += m_power[ii];
+    return power_to_lufs(sum / (last - first));
+}
+
+void AudioAnalyzer::findSilences(void)
+{
+    m_silences.clear();
+    size_t run = 0;
+    for (size_t ii = 0; ii <= m_power.size(); ii++)
+    {
+        if (ii < m_power.size() && loudness(ii, ii + 1) < kSilenceLoudness)
+        {
+            run++;
+            continue;
+        }
+        if (run >= kMinSilenceBlocks)
+        {
+            m_silences.push_back({ m_startOffset +
+                                       (static_cast<double>(ii - run) / kBlocksPerSecond),
+                                   m_startOffset +
+                                       (static_cast<double>(ii) / kBlocksPerSecond) });
+        }
+        run = 0;
+    }
+
+    /*
+     * Integrated loudness of the whole recording, with the absolute and
+     * relative gates of EBU R128, over 400ms blocks overlapping by 75%.
+     */
+    std::vector<double> gated;
+    for (size_t ii = 0; ii + 4 <= m_power.size(); ii++)
+    {
+        double lufs = loudness(ii, ii + 4);
+        if (lufs > -70.0)
+            gated.push_back(lufs);
+    }
+    auto integrated = [](const std::vector<double> &blocks, double gate)
+    {
+        double sum = 0.0;
+        size_t count = 0;
+        for (double lufs : blocks)
+        {
+            if (lufs > gate)
+            {
+                sum += pow(10.0, (lufs + 0.691) / 10.0);
+                count++;
+            }
+        }
+        return count ? power_to_lufs(sum / count) : -70.0;
+    };
+    m_referenceLoudness = integrated(gated, integrated(gated, -70.0) - 10.0);
+}
+
+void AudioAnalyzer::findRepeats(void)
+{
+    m_repeats.clear();
+
+    const int nn = static_cast<int>(m_subfp.size());
+    const int block = kMatchSeconds * kFingerprintRate;
+    const int step = block / 4;
+    const int minGap = kMinRepeatGap * kFingerprintRate;
+    const int maxErrors = static_cast<int>(kMaxBitErrorRate * 32 * block);
+    if (nn < minGap + block)
+        return;
+
+    std::unordered_map<uint32_t,std::vector<int>> positions;
+    for (int ii = 0; ii < nn; ii++)
+    {
+        if (m_subfpLive[ii])
+            positions[m_subfp[ii]].push_back(ii);
+    }
+
+    auto errors = [this](int aa, int bb, int len)
+    {
+        int count = 0;
+        for (int kk = 0; kk < len; kk++)
+            count += static_cast<int>(qPopulationCount(m_subfp[aa + kk] ^ m_subfp[bb + kk]));
+        return count;
+    };
+
+    std::vector<uint8_t> repeated(nn, 0);
+    for (int ii = minGap; ii + block <= nn; ii += kProbeStep)
+    {
+        if (!m_subfpLive[ii] || repeated[ii])
+            continue;
+        auto it = positions.find(m_subfp[ii]);
+        if (it == positions.end() || it->second.size() > kMaxOccurrences)
+            continue;
+
+        for (int jj : it->second)
+        {
+            if (jj > ii - minGap)
+                break;
+            if (errors(ii, jj, block) > maxErrors)
+                continue;
+
+            int len = block;
+            while (ii + len + step <= nn &&
+                   errors(ii + len, jj + len, step) <= maxErrors / 4)
+            {
+                len += step;
+            }
+            if (len >= kMinRepeatLength * kFingerprintRate)
+            {
+                std::fill_n(repeated.begin() + jj, len, 1);
+                std::fill_n(repeated.begin() + ii, len, 1);
+                ii += len - kProbeStep;
+            }
+            break;
+        }
+    }
+
+    for (int ii = 0; ii < nn; )
+    {
+        if (!repeated[ii])
+        {
+            ii++;
+            continue;
+        }
+        int jj = ii;
+        while (jj < nn && repeated[jj])
+            jj++;
+        m_repeats.push_back({ fingerprintTime(ii), fingerprintTime(jj) });
+        ii = jj;
+    }
+}
+
+double AudioAnalyzer::fingerprintTime(int index) const
+{
+    if (m_sampleRate <= 0)
+        return m_startOffset;
+    /* Each sub-fingerprint describes the middle of its window. */
+    return m_startOffset +
+        ((static_cast<double>(index) * m_hop + (m_windowLength / 2.0)) /
+         m_sampleRate);
+}
+
+int AudioAnalyzer::fingerprintIndex(double secs) const
+{
+    if (m_sampleRate <= 0 || m_hop <= 0)
+        return -1;
+    return static_cast<int>(lround(
+        (((secs - m_startOffset) * m_sampleRate) - (m_windowLength / 2.0)) /
+        m_hop));
+}
+
+bool AudioAnalyzer::videoHash(double secs, uint64_t *hash) const
+{
+    auto it = std::lower_bound(m_keyframes.cbegin(), m_keyframes.cend(), secs,
+                               [](const Keyframe &kf, double time)
+                               { return kf.m_time < time; });
+    auto nearest = m_keyframes.cend();
+    if (it != m_keyframes.cend())
+        nearest = it;
+    if (it != m_keyframes.cbegin() &&
+        (nearest == m_keyframes.cend() ||
+         secs - (it - 1)->m_time < nearest->m_time - secs))
+        nearest = it - 1;
+
+    if (nearest == m_keyframes.cend() ||
+        fabs(nearest->m_time - secs) > kMaxKeyframeDistance)
+        return false;
+    *hash = nearest->m_hash;
+    return true;
+}
+
+int AudioAnalyzer::finished(void)
+{
+    if (m_failed || m_power.empty())
+        return -1;
+
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    std::sort(m_keyframes.begin(), m_keyframes.end(),
+              [](const Keyframe &a, const Keyframe &b)
+              { return a.m_time < b.m_time; });
+    findSilences();
+    findRepeats();
+    m_analyzeTime += nowAsDuration<std::chrono::microseconds>() - start;
+
+    double repeated = 0.0;
+    for (const auto & interval : m_repeats)
+        repeated += interval.m_end - interval.m_start;
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("%1s of audio, %2 silences, %3s repeated, loudness %4 LUFS")
+            .arg(duration(), 0, 'f', 1).arg(m_silences.size())
+            .arg(repeated, 0, 'f', 1).arg(m_referenceLoudness, 0, 'f', 1));
+    if (m_videoIndex >= 0)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("%1 video keyframes hashed")
+            .arg(m_keyframes.size()));
+    }
+    return 0;
+}
+
+int AudioAnalyzer::reportTime(void) const
+{
+    LOG(VB_COMMFLAG, LOG_INFO, QString("AA Time: analyze=%1s")
+            .arg(strftimeval(m_analyzeTime)));
+    return 0;
+}
+
+int AudioAnalyzer::percentDone(void) const
+{
+    if (!m_fmt || !m_fmt->pb || m_fileSize <= 0)
+        return 0;
+    return static_cast<int>(std::clamp(avio_tell(m_fmt->pb) * 100 / m_fileSize,
+                                       int64_t(0), int64_t(100)));
+}
+
+double AudioAnalyzer::duration(void) const
+{
+    return m_startOffset + (static_cast<double>(m_power.size()) / kBlocksPerSecond);
+}
+
+int AudioAnalyzer::computeBreaks(FrameAnalyzer::FrameMap *breaks, float fps,
+                                 const std::vector<Interval> &known,
+                                 std::vector<Interval> *confirmed) const
+{
+    breaks->clear();
+    if (confirmed)
+        confirmed->clear();
+    if (m_power.empty() || fps <= 0.0F)
+        return -1;
+
+    /*
+     * Segments are delimited by the middle of each silence, and by the ends
+     * of known commercials unless those are next to a silence anyway.
+     */
+    std::vector<double> bounds { 0.0 };
+    for (const auto & silence : m_silences)
+        bounds.push_back((silence.m_start + silence.m_end) / 2);
+    bounds.push_back(duration());
+    for (const auto & comm : known)
+    {
+        for (double edge : { comm.m_start, comm.m_end })
+        {
+            if (edge > 0.0 && edge < duration() &&
+                std::none_of(bounds.cbegin(), bounds.cend(),
+                             [edge](double bound)
+                             { return fabs(bound - edge) < kKnownSnap; }))
+                bounds.push_back(edge);
+        }
+    }
+    std::sort(bounds.begin(), bounds.end());
+
+    auto blockOf = [this](double secs)
+    {
+        return static_cast<size_t>(std::max(0.0, (secs - m_startOffset) *
+                                                 kBlocksPerSecond));
+    };
+
+    auto overlap = [](const std::vector<Interval> &intervals,
+                      double start, double end)
+    {
+        double total = 0.0;
+        for (const auto & interval : intervals)
+        {
+            total += std::max(0.0, std::min(end, interval.m_end) -
+                                   std::max(start, interval.m_start));
+        }
+        return total;
+    };
+
+    std::vector<Interval> comms;
+    std::vector<Interval> repeatedComms;
+    for (size_t ii = 0; ii + 1 < bounds.size(); ii++)
+    {
+        const double start = bounds[ii];
+        const double end = bounds[ii + 1];
+        const double len = end - start;
+        if (len < kMinCommLength || len > kMaxCommLength)
+            continue;
+
+        const bool isKnown = overlap(known, start, end) * 2 >= len;
+        const bool isRepeat = overlap(m_repeats, start, end) * 2 >= len;
+
+        int score = 0;
+        if (isKnown)
+            score += kMinCommScore;
+        if (isRepeat)
+            score += 2;
+        if (std::any_of(kCommLengths.cbegin(), kCommLengths.cend(),
+                        [len](double comm){ return fabs(len - comm) <= kLengthSlop; }))
+            score += 1;
+        if (loudness(blockOf(start), blockOf(end)) >= m_referenceLoudness + kLouderLU)
+            score += 1;
+
+        if (score < kMinCommScore)
+            continue;
+
+        if (isRepeat && !isKnown)
+            repeatedComms.push_back({ start, end });
+
+        if (!comms.empty() && comms.back().m_end == start)
+            comms.back().m_end = end;
+        else
+            comms.push_back({ start, end });
+    }
+
+    for (const auto & comm : comms)
+    {
+        const double len = comm.m_end - comm.m_start;
+        if (len < m_minBreakLength || len > m_maxBreakLength)
+        {
+            LOG(VB_COMMFLAG, LOG_DEBUG, LOC +
+                QString("Ignoring %1s break at %2s").arg(len, 0, 'f', 1)
+                    .arg(comm.m_start, 0, 'f', 1));
+            continue;
+        }
+        long long first = llround(comm.m_start * fps);
+        long long last = llround(comm.m_end * fps);
+        (*breaks)[first] = last - first;
+
+        if (confirmed)
+        {
+            for (const auto & repeat : repeatedComms)
+            {
+                if (repeat.m_start >= comm.m_start && repeat.m_end <= comm.m_end)
+                    confirmed->push_back(repeat);
+            }
+        }
+    }
+    return 0;
+}
+
+FrameAnalyzer::FrameMap AudioAnalyzer::GetMap(unsigned int index, float fps) const
+{
+    FrameAnalyzer::FrameMap map;
+    const std::vector<Interval> &intervals = index ? m_repeats : m_silences;
+    for (const auto & interval : intervals)
+    {
+        long long first = llround(interval.m_start * fps);
+        map[first] = std::max(1LL, llround(interval.m_end * fps) - first);
+    }
+    return map;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,184 @@
+/*
+ * AudioAnalyzer
+ *
+ * Look for commercial breaks in the audio of a recording: silence gaps,
+ * loudness changes and stretches of audio that occur more than once.
+ */
+
+#ifndef AUDIOANALYZER_H
+#define AUDIOANALYZER_H
+
+// C++ headers
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Qt headers
+#include <QString>
+
+// Commercial Flagging headers
+#include "FrameAnalyzer.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavutil/tx.h"
+}
+
+class MythAVFormatBuffer;
+class MythMediaBuffer;
+
+class AudioAnalyzer
+{
+  public:
+    explicit AudioAnalyzer(QString filename);
+    ~AudioAnalyzer();
+
+    static const char *name(void) { return "AudioAnalyzer"; }
+
+    struct Interval
+    {
+        double m_start {0.0};   /* seconds */
+        double m_end   {0.0};
+    };
+
+    /*
+     * Also decode the video keyframes and hash them, for the commercial
+     * fingerprint database. Must be set before the first analyzeSome().
+     */
+    void setVideoHashing(bool enable) { m_videoHashing = enable; }
+
+    enum analyzeResult : std::uint8_t {
+        ANALYZE_OK,         /* More audio to come */
+        ANALYZE_FINISHED,   /* End of file reached */
+        ANALYZE_FATAL,      /* No usable audio */
+    };
+
+    /* Decode and analyze up to "npackets" audio packets. */
+    analyzeResult analyzeSome(int npackets);
+    int finished(void);
+    int reportTime(void) const;
+
+    /* Progress through the file, 0-100. */
+    int percentDone(void) const;
+
+    /* Seconds of audio analyzed so far. */
+    double duration(void) const;
+
+    /* Frame rate of the video stream, 0 if unknown. */
+    float frameRate(void) const { return m_frameRate; }
+
+    /*
+     * 0-based frameno => nframes, for a video frame rate of "fps". Audio
+     * in "known" intervals counts as commercial regardless of the other
+     * evidence. Commercials that also repeat within the recording are
+     * returned in "confirmed".
+     */
+    int computeBreaks(FrameAnalyzer::FrameMap *breaks, float fps,
+                      const std::vector<Interval> &known = {},
+                      std::vector<Interval> *confirmed = nullptr) const;
+    FrameAnalyzer::FrameMap GetMap(unsigned int index, float fps) const;
+
+    /* 32-bit spectral sub-fingerprints, kFingerprintRate per second. */
+    static constexpr int kFingerprintRate { 64 };
+    const std::vector<uint32_t> &fingerprints(void) const { return m_subfp; }
+    const std::vector<uint8_t> &fingerprintsLive(void) const { return m_subfpLive; }
+
+    /* Sub-fingerprint index of the time "secs" (may be out of range). */
+    int fingerprintIndex(double secs) const;
+    double fingerprintTime(int index) const;
+
+    /* Hash of the video keyframe within half a second of "secs". */
+    bool videoHash(double secs, uint64_t *hash) const;
+
+  private:
+    Q_DISABLE_COPY(AudioAnalyzer)
+
+    struct Keyframe
+    {
+        double   m_time {0.0};  /* seconds */
+        uint64_t m_hash {0};
+    };
+
+    /* One section of the BS.1770 K-weighting filter. */
+    struct Biquad
+    {
+        std::array<double,3> m_b {};
+        std::array<double,3> m_a {};
+        std::array<double,2> m_z {};
+        double process(double in);
+    };
+
+    bool open(void);
+    void close(void);
+    void configure(const AVFrame *frame);
+    void decodePacket(const AVPacket *pkt);
+    void decodeVideoPacket(const AVPacket *pkt);
+    void processFrame(const AVFrame *frame);
+    void hashVideoFrame(const AVFrame *frame);
+    void addFingerprintFrame(void);
+    void findSilences(void);
+    void findRepeats(void);
+    double loudness(size_t first, size_t last) const;
+
+    QString                 m_filename;
+    MythMediaBuffer        *m_buffer          {nullptr};
+    MythAVFormatBuffer     *m_avfBuffer       {nullptr};
+    AVFormatContext        *m_fmt             {nullptr};
+    AVCodecContext         *m_ctx             {nullptr};
+    AVPacket               *m_packet          {nullptr};
+    AVFrame                *m_frame           {nullptr};
+    int                     m_streamIndex     {-1};
+    bool                    m_videoHashing    {false};
+    int                     m_videoIndex      {-1};
+    AVCodecContext         *m_videoCtx        {nullptr};
+    std::vector<Keyframe>   m_keyframes;
+    bool                    m_opened          {false};
+    bool                    m_failed          {false};
+    bool                    m_finished        {false};
+    int64_t                 m_fileSize        {0};
+    float                   m_frameRate       {0.0F};
+    int                     m_sampleRate      {0};
+    int                     m_channels        {0};
+    bool                    m_haveStart       {false};
+    double                  m_startOffset     {0.0};  /* seconds */
+    int                     m_minBreakLength  {60};
+    int                     m_maxBreakLength  {395};
+
+                            /* Loudness, one value per 100ms block */
+    std::vector<std::array<Biquad,2>> m_filters;
+    std::vector<double>     m_weights;
+    int                     m_blockLength     {0};
+    int                     m_blockSamples    {0};
+    double                  m_blockPower      {0.0};
+    std::vector<float>      m_power;
+
+                            /* Fingerprints */
+    AVTXContext            *m_tx              {nullptr};
+    av_tx_fn                m_txFn            {nullptr};
+    int                     m_windowLength    {0};
+    int                     m_hop             {0};
+    int                     m_sinceHop        {0};
+    int                     m_windowPos       {0};
+    int                     m_windowFill      {0};
+    std::vector<float>      m_window;
+    std::vector<float>      m_hann;
+    float                  *m_txIn            {nullptr};
+    AVComplexFloat         *m_txOut           {nullptr};
+    std::vector<int>        m_bandEdges;
+    std::vector<double>     m_prevBands;
+    std::vector<uint32_t>   m_subfp;
+    std::vector<uint8_t>    m_subfpLive;
+
+                            /* Results */
+    std::vector<Interval>   m_silences;
+    std::vector<Interval>   m_repeats;
+    double                  m_referenceLoudness {0.0};
+
+    std::chrono::microseconds m_analyzeTime   {0};
+};
+
+#endif  /* !AUDIOANALYZER_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
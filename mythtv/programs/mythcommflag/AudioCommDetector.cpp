@@ -0,0 +1,250 @@
+// C++ headers
+#include <iostream>
+#include <thread> // for sleep_for
+#include <utility>
+
+// Qt headers
+#include <QCoreApplication>
+
+// MythTV headers
+#include "libmythbase/mythchrono.h"
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythlogging.h"
+
+// Commercial Flagging headers
+#include "AudioCommDetector.h"
+#include "CommFingerprintDB.h"
+
+#define LOC QString("AudioCommDetector: ")
+
+/// Audio packets analyzed between checks for stop, pause and progress.
+static constexpr int kPacketsPerStep { 200 };
+
+AudioCommDetector::AudioCommDetector(QString filename, bool showProgress,
+                                     const QDateTime &recendts,
+                                     CommDetectorBase *fallback,
+                                     bool useFingerprints)
+  : m_audio(std::move(filename)),
+    m_showProgress(showProgress),
+    m_isRecording(MythDate::current() < recendts),
+    m_fallback(fallback),
+    m_useFingerprints(useFingerprints)
+{
+    m_audio.setVideoHashing(m_useFingerprints);
+
+    if (!m_fallback)
+        return;
+
+    // Owned by this detector from here on
+    m_fallback->setParent(this);
+    connect(m_fallback, &CommDetectorBase::statusUpdate,
+            this,       &CommDetectorBase::statusUpdate);
+    connect(m_fallback, &CommDetectorBase::gotNewCommercialBreakList,
+            this,       &CommDetectorBase::gotNewCommercialBreakList);
+    connect(m_fallback, &CommDetectorBase::breathe,
+            this,       &CommDetectorBase::breathe);
+}
+
+bool AudioCommDetector::go(void)
+{
+    if (m_isRecording && m_fallback)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC +
+            "Still recording, using video detection");
+        return runFallback();
+    }
+
+    if (runAudio())
+        return true;
+
+    if (m_bStop || !m_fallback)
+        return false;
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        "Audio gave no breaks, falling back to video detection");
+    return runFallback();
+}
+
+bool AudioCommDetector::runAudio(void)
+{
+    emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+        "Analyzing Audio"));
+
+    int lastPercent = -1;
+    AudioAnalyzer::analyzeResult result = AudioAnalyzer::ANALYZE_OK;
+    while (result == AudioAnalyzer::ANALYZE_OK)
+    {
+        result = m_audio.analyzeSome(kPacketsPerStep);
+
+        emit breathe();
+        if (m_bStop)
+            return false;
+        while (m_bPaused)
+        {
+            emit breathe();
+            std::this_thread::sleep_for(1s);
+        }
+
+        int percent = m_audio.percentDone();
+        if (percent != lastPercent)
+        {
+            lastPercent = percent;
+            if (m_showProgress)
+            {
+                QString tmp = QString("\r%1%/ audio").arg(percent, 3);
+                std::cerr << qPrintable(tmp) << "          \r";
+                std::cerr.flush();
+            }
+            emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+                "%1% Completed (audio).").arg(percent));
+        }
+    }
+
+    if (result == AudioAnalyzer::ANALYZE_FATAL || m_audio.finished())
+        return false;
+    m_audio.reportTime();
+
+    m_fps = m_audio.frameRate();
+    if (m_fps <= 0.0F)
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC + "Unknown frame rate, assuming 29.97");
+        m_fps = 29.97F;
+    }
+
+    FrameAnalyzer::FrameMap breaks;
+    if (!computeBreaks(&breaks))
+        return false;
+
+    m_marks.clear();
+    for (auto it = breaks.cbegin(); it != breaks.cend(); ++it)
+    {
+        m_marks[it.key()] = MARK_COMM_START;
+        m_marks[it.key() + *it - 1] = MARK_COMM_END;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("Found %1 break(s) in the audio")
+        .arg(breaks.size()));
+    return !breaks.isEmpty() || !m_fallback;
+}
+
+bool AudioCommDetector::computeBreaks(FrameAnalyzer::FrameMap *breaks)
+{
+    if (!m_useFingerprints)
+        return m_audio.computeBreaks(breaks, m_fps) == 0;
+
+    CommFingerprintDB db;
+    if (!db.load())
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+            "Unable to read the known commercials");
+        return m_audio.computeBreaks(breaks, m_fps) == 0;
+    }
+
+    std::vector<CommFingerprintDB::Match> matches = db.match(m_audio);
+    std::vector<AudioAnalyzer::Interval> known;
+    known.reserve(matches.size());
+    for (const auto & match : matches)
+        known.push_back(match.m_interval);
+
+    std::vector<AudioAnalyzer::Interval> confirmed;
+    if (m_audio.computeBreaks(breaks, m_fps, known, &confirmed))
+        return false;
+
+    db.confirm(matches);
+    int learned = 0;
+    for (const auto & comm : confirmed)
+    {
+        if (db.add(m_audio, comm))
+            learned++;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("Matched %1 of %2 known commercials, learned %3")
+            .arg(matches.size()).arg(db.size() - learned).arg(learned));
+    return true;
+}
+
+bool AudioCommDetector::runFallback(void)
+{
+    m_useFallback = true;
+    return m_fallback->go();
+}
+
+void AudioCommDetector::stop(void)
+{
+    CommDetectorBase::stop();
+    if (m_fallback)
+        m_fallback->stop();
+}
+
+void AudioCommDetector::pause(void)
+{
+    CommDetectorBase::pause();
+    if (m_fallback)
+        m_fallback->pause();
+}
+
+void AudioCommDetector::resume(void)
+{
+    CommDetectorBase::resume();
+    if (m_fallback)
+        m_fallback->resume();
+}
+
+void AudioCommDetector::GetCommercialBreakList(frm_dir_map_t &marks)
+{
+    if (m_useFallback)
+    {
+        m_fallback->GetCommercialBreakList(marks);
+        return;
+    }
+    marks = m_marks;
+}
+
+void AudioCommDetector::recordingFinished(long long totalFileSize)
+{
+    if (m_fallback)
+        m_fallback->recordingFinished(totalFileSize);
+}
+
+void AudioCommDetector::requestCommBreakMapUpdate(void)
+{
+    if (m_useFallback)
+        m_fallback->requestCommBreakMapUpdate();
+}
+
+void AudioCommDetector::SetSegments(uint segments,
+                                    const PlayerContextFactory &factory)
+{
+    if (m_fallback)
+        m_fallback->SetSegments(segments, factory);
+}
+
+static void PrintReportMap(std::ostream &out,
+                           const FrameAnalyzer::FrameMap &frameMap)
+{
+    for (auto it = frameMap.cbegin(); it != frameMap.cend(); ++it)
+    {
+        long long bb = it.key() + 1;
+        long long ee = bb + *it;
+        out << qPrintable(QString("%1: %2").arg(bb, 10).arg(ee - 1, 10)) << "\n";
+    }
+    out << std::flush;
+}
+
+void AudioCommDetector::PrintFullMap(
+    std::ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const
+{
+    if (m_useFallback)
+    {
+        m_fallback->PrintFullMap(out, comm_breaks, verbose);
+        return;
+    }
+
+    out << "Silence Map" << std::endl;
+    PrintReportMap(out, m_audio.GetMap(0, m_fps));
+    out << "Repeated Audio Map" << std::endl;
+    PrintReportMap(out, m_audio.GetMap(1, m_fps));
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,64 @@
+#ifndef AUDIOCOMMDETECTOR_H
+#define AUDIOCOMMDETECTOR_H
+
+// Qt headers
+#include <QDateTime>
+#include <QString>
+
+// Commercial Flagging headers
+#include "AudioAnalyzer.h"
+#include "CommDetectorBase.h"
+
+/** \class AudioCommDetector
+ *  \brief Flags commercials from the audio track alone, falling back to a
+ *         video detector when the audio gives no usable answer.
+ *
+ *   Only the audio stream is demuxed and decoded, which takes a fraction of
+ *   the time of any video analysis. If the audio yields breaks, the video
+ *   pass is skipped altogether. Otherwise, or while the recording is still
+ *   in progress, the fallback detector for the remaining detection methods
+ *   (if any were selected) runs as usual.
+ *
+ *   With fingerprints enabled, the audio (and video keyframes) are also
+ *   matched against the commercials already known from other recordings,
+ *   which count as breaks outright. Commercials that repeat within this
+ *   recording are added to those known ones for later jobs.
+ */
+class AudioCommDetector : public CommDetectorBase
+{
+  public:
+    AudioCommDetector(QString filename, bool showProgress,
+                      const QDateTime &recendts, CommDetectorBase *fallback,
+                      bool useFingerprints = false);
+
+    bool go(void) override; // CommDetectorBase
+    void stop(void) override; // CommDetectorBase
+    void pause(void) override; // CommDetectorBase
+    void resume(void) override; // CommDetectorBase
+    void GetCommercialBreakList(frm_dir_map_t &marks) override; // CommDetectorBase
+    void recordingFinished(long long totalFileSize) override; // CommDetectorBase
+    void requestCommBreakMapUpdate(void) override; // CommDetectorBase
+    void SetSegments(uint segments, const PlayerContextFactory &factory) override; // CommDetectorBase
+    void PrintFullMap(std::ostream &out, const frm_dir_map_t *comm_breaks,
+                      bool verbose) const override; // CommDetectorBase
+
+  private:
+    ~AudioCommDetector() override = default;
+
+    bool runAudio(void);
+    bool runFallback(void);
+    bool computeBreaks(FrameAnalyzer::FrameMap *breaks);
+
+    AudioAnalyzer       m_audio;
+    bool                m_showProgress  {false};
+    bool                m_isRecording   {false};
+    CommDetectorBase   *m_fallback      {nullptr};
+    bool                m_useFallback   {false};
+    bool                m_useFingerprints {false};
+    float               m_fps           {0.0F};
+    frm_dir_map_t       m_marks;
+};
+
+#endif // AUDIOCOMMDETECTOR_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
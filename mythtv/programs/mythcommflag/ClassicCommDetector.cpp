@@ -2,6 +2,7 @@
 #include <algorithm> // for min/max, clamp
 #include <cmath>
 #include <iostream> // for cerr
+#include <limits>
 #include <thread> // for sleep_for
 
 // Qt headers
@@ -15,12 +16,16 @@
 #include "libmythbase/programinfo.h"
 #include "libmythbase/sizetliteral.h"
 #include "libmythtv/mythcommflagplayer.h"
+#include "libmythtv/playercontext.h"
 
 // Commercial Flagging headers
 #include "ClassicCommDetector.h"
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
 
+// Segments shorter than this are not worth a player of their own
+static constexpr int kMinSegmentSeconds { 120 };
+
 enum frameAspects : std::uint8_t {
     COMM_ASPECT_NORMAL = 0,
     COMM_ASPECT_WIDE
@@ -249,7 +254,8 @@ void ClassicCommDetector::Init()
          m_sceneChangeDetector,
          &SceneChangeDetectorBase::haveNewInformation,
          this,
-         &ClassicCommDetector::sceneChangeDetectorHasNewInformation
+         &ClassicCommDetector::sceneChangeDetectorHasNewInformation,
+         Qt::DirectConnection
     );
 
     m_frameIsBlank = false;
@@ -414,7 +420,12 @@ bool ClassicCommDetector::go()
 
     m_player->ResetTotalDuration();
 
-    while (m_player->GetEof() == kEofStateNone)
+    bool flagged = (m_segmentCount > 1) && !m_stillRecording &&
+                   FlagSegments(aspect);
+    if (flagged && m_bStop)
+        return false;
+
+    while (!flagged && m_player->GetEof() == kEofStateNone)
     {
         std::chrono::microseconds startTime {0us};
         if (m_stillRecording)
@@ -606,9 +617,406 @@ bool ClassicCommDetector::go()
     return true;
 }
 
+void ClassicCommSegmentThread::run(void)
+{
+    RunProlog();
+    m_detector->FlagSegment();
+    RunEpilog();
+}
+
+/** \brief Returns the first frame of each segment after the first one.
+ *
+ *   Segments start on a keyframe from the seek table so that every segment
+ *   player can begin decoding without reading back into the previous one.
+ */
+QList<long long> ClassicCommDetector::GetSegmentStarts(
+    PlayerContext *ctx, uint count) const
+{
+    auto total = static_cast<long long>(m_player->GetTotalFrameCount());
+
+    frm_pos_map_t keyframes;
+    ctx->LockPlayingInfo(__FILE__, __LINE__);
+    if (ctx->m_playingInfo)
+        ctx->m_playingInfo->QueryPositionMap(keyframes, MARK_GOP_BYFRAME);
+    ctx->UnlockPlayingInfo(__FILE__, __LINE__);
+
+    QList<long long> starts;
+    for (uint i = 1; i < count; i++)
+    {
+        long long start = total * i / count;
+        if (!keyframes.isEmpty())
+        {
+            auto it = keyframes.lowerBound(start);
+            if (it == keyframes.end())
+                break;
+            start = it.key();
+        }
+
+        if ((start <= 0) || (start >= total) ||
+            (!starts.isEmpty() && (start <= starts.last())))
+            continue;
+        starts.append(start);
+    }
+
+    return starts;
+}
+
+/** \brief Flags the rest of the recording in parallel segments.
+ *
+ *   This player carries on with the first segment while each further
+ *   segment is decoded by its own player and detector on its own thread.
+ *   A segment stops after decoding the first frame of the next segment so
+ *   that the scene change of every boundary frame is measured against the
+ *   frame before it. The frame maps are then merged and the state that
+ *   carries over from frame to frame, aspect changes and consecutive
+ *   scene changes, is replayed in frame order so the result matches
+ *   flagging the recording serially.
+ *
+ *  \return false if the segments could not be set up, in which case
+ *          nothing has been decoded and the caller should flag serially.
+ */
+bool ClassicCommDetector::FlagSegments(float aspect)
+{
+    if (!m_segmentFactory)
+        return false;
+
+    m_segmentTotalFrames = m_player->GetTotalFrameCount();
+    auto minFrames = static_cast<long long>(kMinSegmentSeconds * m_fps);
+    uint count = m_segmentCount;
+    if (minFrames > 0)
+    {
+        count = static_cast<uint>(std::clamp<long long>(
+            m_segmentTotalFrames / minFrames, 1, m_segmentCount));
+    }
+    if (count < 2)
+        return false;
+
+    auto deleteSegment = [](ClassicCommDetector *segment)
+    {
+        // The logo detector belongs to this detector
+        segment->m_logoDetector = nullptr;
+        delete segment->m_segmentContext;
+        segment->m_segmentContext = nullptr;
+        segment->deleteLater();
+    };
+
+    for (uint i = 1; i < count; i++)
+    {
+        PlayerContext *ctx = m_segmentFactory();
+        auto *player = ctx ? dynamic_cast<MythCommFlagPlayer*>(ctx->m_player)
+                           : nullptr;
+        if (!player || (player->OpenFile() < 0))
+        {
+            delete ctx;
+            break;
+        }
+
+        auto *segment = new ClassicCommDetector(
+            m_commDetectMethod, false, m_fullSpeed, player, m_startedAt,
+            m_stopsAt, m_recordingStartedAt, m_recordingStopsAt);
+        segment->m_segmentContext = ctx;
+        segment->Init();
+        if (!player->InitVideo())
+        {
+            deleteSegment(segment);
+            break;
+        }
+        m_segments.append(segment);
+    }
+
+    QList<long long> starts;
+    if (!m_segments.isEmpty())
+    {
+        starts = GetSegmentStarts(m_segments.first()->m_segmentContext,
+                                  static_cast<uint>(m_segments.size()) + 1);
+    }
+    while (m_segments.size() > starts.size())
+        deleteSegment(m_segments.takeLast());
+
+    if (m_segments.isEmpty())
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING,
+            "Unable to split recording into segments, flagging serially");
+        return false;
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, QString("Flagging %1 frames in %2 segments")
+        .arg(m_segmentTotalFrames).arg(m_segments.size() + 1));
+
+    m_segmentMode = true;
+    m_segmentEnd = starts.first();
+    for (int i = 0; i < m_segments.size(); i++)
+    {
+        ClassicCommDetector *segment = m_segments[i];
+        segment->m_segmentMode = true;
+        segment->m_segmentStart = starts[i];
+        segment->m_segmentEnd = (i + 1 < starts.size()) ? starts[i + 1] : -1;
+        segment->m_lastFrameNumber = starts[i] - 1;
+        segment->m_logoDetector = m_logoDetector;
+        segment->m_logoInfoAvailable = m_logoInfoAvailable;
+        segment->m_aggressiveDetection = m_aggressiveDetection;
+    }
+
+    m_segmentTimer.start();
+
+    QList<ClassicCommSegmentThread*> threads;
+    for (auto *segment : std::as_const(m_segments))
+        threads.append(new ClassicCommSegmentThread(segment));
+
+    FlagSegment();
+
+    while (std::any_of(threads.cbegin(), threads.cend(),
+                       [](ClassicCommSegmentThread *thread)
+                       { return !thread->isFinished(); }))
+    {
+        SegmentProgress();
+        std::this_thread::sleep_for(100ms);
+    }
+    qDeleteAll(threads);
+
+    float elapsed = m_segmentTimer.elapsed() / 1000.0F;
+
+    // Each segment owns the frames after its first frame up to and
+    // including the first frame of the next segment.
+    auto trim = [](auto &map, long long last)
+    {
+        auto it = map.upperBound(last);
+        while (it != map.end())
+            it = map.erase(it);
+    };
+    trim(m_frameInfo, m_segmentEnd);
+    trim(m_blankFrameMap, m_segmentEnd);
+    trim(m_segmentAspects, m_segmentEnd);
+    trim(m_segmentSimilarity, m_segmentEnd);
+
+    for (int i = 0; i < m_segments.size(); i++)
+    {
+        ClassicCommDetector *segment = m_segments[i];
+        long long last = (i + 1 < starts.size()) ? starts[i + 1]
+            : std::numeric_limits<long long>::max();
+        MergeSegment(segment, starts[i] + 1, last);
+        deleteSegment(segment);
+    }
+    m_segments.clear();
+    m_segmentMode = false;
+
+    ReplaySegmentState(aspect);
+
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Flagged %1 frames in %2 segments in %3 seconds (%4 fps)")
+            .arg(m_framesProcessed).arg(starts.size() + 1)
+            .arg(elapsed, 0, 'f', 1)
+            .arg((elapsed > 0.0F) ? m_framesProcessed / elapsed : 0.0F,
+                 0, 'f', 1));
+
+    return true;
+}
+
+/// Decodes and analyzes the frames of one segment.
+void ClassicCommDetector::FlagSegment(void)
+{
+    MythVideoFrame *frame = nullptr;
+    if (m_segmentStart >= 0)
+        frame = m_player->GetRawVideoFrame(m_segmentStart);
+
+    float aspect = -1.0F;
+    while (!m_segmentAbort)
+    {
+        if (!frame)
+        {
+            if (m_player->GetEof() != kEofStateNone)
+                break;
+            frame = m_player->GetRawVideoFrame();
+        }
+
+        long long frameNumber = frame->m_frameNumber;
+        if (frameNumber >= m_segmentStart)
+        {
+            if (m_segmentAspects.isEmpty() && (m_segmentStart >= 0) &&
+                (frameNumber != m_segmentStart))
+            {
+                LOG(VB_COMMFLAG, LOG_WARNING,
+                    QString("Segment starting at frame %1 began decoding at "
+                            "frame %2, result may differ from serial flagging")
+                        .arg(m_segmentStart).arg(frameNumber));
+            }
+
+            // Aspect changes are applied in frame order after merging
+            if (frame->m_aspect != aspect)
+            {
+                aspect = frame->m_aspect;
+                m_segmentAspects[frameNumber] = aspect;
+            }
+
+            ProcessFrame(frame, frameNumber);
+            m_segmentFramesDone++;
+        }
+
+        m_player->DiscardVideoFrame(frame);
+        frame = nullptr;
+
+        if ((m_segmentEnd >= 0) && (frameNumber >= m_segmentEnd))
+            break;
+
+        if (!m_segments.isEmpty() && ((frameNumber % 500) == 0) &&
+            !SegmentProgress())
+            break;
+
+        if (!m_fullSpeed)
+            std::this_thread::sleep_for(10ms);
+    }
+}
+
+/// Reports progress over all segments, returns false if flagging was stopped.
+bool ClassicCommDetector::SegmentProgress(void)
+{
+    emit breathe();
+    if (m_bStop)
+    {
+        m_segmentAbort = true;
+        for (auto *segment : std::as_const(m_segments))
+            segment->m_segmentAbort = true;
+        return false;
+    }
+
+    uint64_t done = m_segmentFramesDone;
+    for (auto *segment : std::as_const(m_segments))
+        done += segment->m_segmentFramesDone;
+
+    float elapsed = m_segmentTimer.elapsed() / 1000.0F;
+    float flagFPS = (elapsed != 0.0F) ? done / elapsed : 0.0F;
+
+    int percentage = 0;
+    if (m_segmentTotalFrames)
+        percentage = std::min<int>(done * 100 / m_segmentTotalFrames, 100);
+
+    if (m_showProgress)
+    {
+        QString tmp = QString("\r%1%/%2fps  \r")
+            .arg(percentage, 3).arg((int)flagFPS, 4);
+        std::cerr << qPrintable(tmp) << std::flush;
+    }
+
+    emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+        "%1% Completed @ %2 fps.").arg(percentage).arg(flagFPS));
+
+    return true;
+}
+
+/// Copies the results for frames first to last from a segment detector.
+void ClassicCommDetector::MergeSegment(const ClassicCommDetector *segment,
+                                       long long first, long long last)
+{
+    auto merge = [first, last](auto &to, const auto &from)
+    {
+        for (auto it = from.lowerBound(first);
+             (it != from.cend()) && (static_cast<long long>(it.key()) <= last);
+             ++it)
+            to.insert(it.key(), it.value());
+    };
+    merge(m_frameInfo, segment->m_frameInfo);
+    merge(m_blankFrameMap, segment->m_blankFrameMap);
+    merge(m_segmentAspects, segment->m_segmentAspects);
+    merge(m_segmentSimilarity, segment->m_segmentSimilarity);
+
+    m_commDetectDimAverage = segment->m_commDetectDimAverage;
+}
+
+/** \brief Rebuilds the per frame state that depends on earlier frames
+ *         once all segments have been merged.
+ *
+ *   This repeats what go() and ProcessFrame() do for aspect changes and
+ *   skipped frames, and what the scene change detector does for
+ *   consecutive scene changes, in the order the frames were decoded.
+ */
+void ClassicCommDetector::ReplaySegmentState(float aspect)
+{
+    QList<long long> decoded;
+    for (auto it = m_frameInfo.cbegin(); it != m_frameInfo.cend(); ++it)
+        if (!(it->flagMask & COMM_FRAME_SKIPPED))
+            decoded.append(it.key());
+
+    m_lastFrameNumber = -2;
+    m_curFrameNumber = -1;
+    m_totalMinBrightness = 0;
+
+    float frameAspect = aspect;
+    auto nextAspect = m_segmentAspects.cbegin();
+    for (long long frame : std::as_const(decoded))
+    {
+        while ((nextAspect != m_segmentAspects.cend()) &&
+               (nextAspect.key() <= frame))
+        {
+            frameAspect = nextAspect.value();
+            ++nextAspect;
+        }
+
+        if (frameAspect != aspect)
+        {
+            SetVideoParams(aspect);
+            aspect = frameAspect;
+        }
+
+        int entryAspect = m_currentAspect;
+        int entryFormat = COMM_FORMAT_NORMAL;
+        if (m_lastFrameNumber != (frame - 1))
+        {
+            if (m_lastFrameNumber > 0)
+            {
+                entryAspect = m_frameInfo[m_lastFrameNumber].aspect;
+                entryFormat = m_frameInfo[m_lastFrameNumber].format;
+            }
+
+            FrameInfoEntry skipped { -1, -1, -1, -1, entryAspect, entryFormat,
+                                     COMM_FRAME_SKIPPED };
+            for (long long f = m_lastFrameNumber + 1; f < frame; f++)
+                m_frameInfo[f] = skipped;
+        }
+
+        FrameInfoEntry &info = m_frameInfo[frame];
+        info.aspect = entryAspect;
+        if (info.minBrightness < 0)
+            info.format = entryFormat;
+        else
+            m_totalMinBrightness += info.minBrightness;
+
+        m_lastFrameNumber = frame;
+        m_curFrameNumber = frame;
+    }
+
+    if (m_commDetectMethod & COMM_DETECT_SCENE)
+    {
+        // The scene change detector numbers frames in the order it sees them
+        bool previousWasSceneChange = false;
+        unsigned int framenum = 0;
+        for (float similar : std::as_const(m_segmentSimilarity))
+        {
+            bool isSceneChange = ClassicSceneChangeDetector::isSceneChange(
+                similar, previousWasSceneChange);
+            sceneChangeDetectorHasNewInformation(framenum++, isSceneChange,
+                                                 similar);
+            previousWasSceneChange = isSceneChange;
+        }
+    }
+
+    m_framesProcessed = static_cast<uint64_t>(decoded.size());
+    m_blankFrameCount = static_cast<int>(m_blankFrameMap.size());
+
+    m_segmentAspects.clear();
+    m_segmentSimilarity.clear();
+}
+
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
     unsigned int framenum,bool isSceneChange,float debugValue)
 {
+    // Whether this is a scene change depends on the frames before this
+    // segment, ReplaySegmentState() works it out once they are known.
+    if (m_segmentMode)
+    {
+        m_segmentSimilarity[m_curFrameNumber] = debugValue;
+        return;
+    }
+
     if (isSceneChange)
     {
         m_frameInfo[framenum].flagMask |= COMM_FRAME_SCENE_CHANGE;
@@ -706,6 +1114,13 @@ void ClassicCommDetector::requestCommBreakMapUpdate(void)
     m_sendCommBreakMapUpdates = true;
 }
 
+void ClassicCommDetector::SetSegments(uint segments,
+                                      const PlayerContextFactory &factory)
+{
+    m_segmentCount = std::max(segments, 1U);
+    m_segmentFactory = factory;
+}
+
 void ClassicCommDetector::SetVideoParams(float aspect)
 {
     int newAspect = COMM_ASPECT_WIDE;
@@ -2,15 +2,18 @@
 #define CLASSIC_COMMDETECTOR_H
 
 // C++ headers
+#include <atomic>
 #include <cstdint>
 
 // Qt headers
 #include <QObject>
+#include <QList>
 #include <QMap>
 #include <QDateTime>
 #include <QElapsedTimer>
 
 // MythTV headers
+#include "libmythbase/mthread.h"
 #include "libmythbase/programinfo.h"
 #include "libmythtv/mythframe.h"
 
@@ -20,6 +23,7 @@
 class MythCommFlagPlayer;
 class LogoDetectorBase;
 class SceneChangeDetectorBase;
+class ClassicCommDetector;
 
 enum frameMaskValues : std::uint8_t {
     COMM_FRAME_SKIPPED       = 0x0001,
@@ -44,9 +48,25 @@ class FrameInfoEntry
     QString toString(uint64_t frame, bool verbose) const;
 };
 
+/** \class ClassicCommSegmentThread
+ *  \brief Runs ClassicCommDetector::FlagSegment() for one segment of a
+ *         recording when flagging in parallel.
+ */
+class ClassicCommSegmentThread : public MThread
+{
+  public:
+    explicit ClassicCommSegmentThread(ClassicCommDetector *detector) :
+        MThread("CommFlagSegment"), m_detector(detector) { start(); }
+    ~ClassicCommSegmentThread() override { wait(); m_detector = nullptr; }
+    void run(void) override; // MThread
+  private:
+    ClassicCommDetector *m_detector;
+};
+
 class ClassicCommDetector : public CommDetectorBase
 {
     Q_OBJECT
+    friend class ClassicCommSegmentThread;
 
     public:
         ClassicCommDetector(SkipType commDetectMethod, bool showProgress,
@@ -61,6 +81,8 @@ class ClassicCommDetector : public CommDetectorBase
         void GetCommercialBreakList(frm_dir_map_t &marks) override; // CommDetectorBase
         void recordingFinished(long long totalFileSize) override; // CommDetectorBase
         void requestCommBreakMapUpdate(void) override; // CommDetectorBase
+        void SetSegments(uint segments,
+                         const PlayerContextFactory &factory) override; // CommDetectorBase
 
         void PrintFullMap(
             std::ostream &out, const frm_dir_map_t *comm_breaks,
@@ -132,6 +154,13 @@ class ClassicCommDetector : public CommDetectorBase
             frm_dir_map_t &out, const show_map_t &in);
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
+        QList<long long> GetSegmentStarts(PlayerContext *ctx, uint count) const;
+        bool FlagSegments(float aspect);
+        void FlagSegment(void);
+        bool SegmentProgress(void);
+        void MergeSegment(const ClassicCommDetector *segment, long long first,
+                          long long last);
+        void ReplaySegmentState(float aspect);
 
         SkipType m_commDetectMethod;
         frm_dir_map_t m_lastSentCommBreakMap;
@@ -184,6 +213,21 @@ class ClassicCommDetector : public CommDetectorBase
 
         SceneChangeDetectorBase* m_sceneChangeDetector {nullptr};
 
+        // Parallel flagging, see FlagSegments()
+        uint m_segmentCount                {1};
+        PlayerContextFactory m_segmentFactory;
+        QList<ClassicCommDetector*> m_segments;
+        bool m_segmentMode                 {false};
+        long long m_segmentStart           {-1};
+        long long m_segmentEnd             {-1};
+        long long m_segmentTotalFrames     {0};
+        QElapsedTimer m_segmentTimer;
+        std::atomic<bool> m_segmentAbort   {false};
+        std::atomic<uint64_t> m_segmentFramesDone {0};
+        PlayerContext *m_segmentContext    {nullptr};
+        QMap<long long, float> m_segmentAspects;
+        QMap<long long, float> m_segmentSimilarity;
+
 protected:
         MythCommFlagPlayer *m_player       {nullptr};
         QDateTime m_startedAt;
@@ -422,7 +422,6 @@ bool ClassicLogoDetector::doesThisFrameContainTheFoundLogo(
         }
     }
 
-    m_frameNumber++;
     double goodEdgeRatio = (testEdges) ?
         (double)goodEdges / (double)testEdges : 0.0;
     double badEdgeRatio = (testNotEdges) ?
@@ -33,7 +33,8 @@ void ClassicSceneChangeDetector::processFrame(MythVideoFrame* frame)
                                  m_height-m_commdetectborder, m_xspacing, m_yspacing);
     float similar = m_histogram->calculateSimilarityWith(*m_previousHistogram);
 
-    bool isSceneChange = (similar < .85F && !m_previousFrameWasSceneChange);
+    bool isSceneChange =
+        ClassicSceneChangeDetector::isSceneChange(similar, m_previousFrameWasSceneChange);
 
     emit haveNewInformation(m_frameNumber,isSceneChange,similar);
     m_previousFrameWasSceneChange = isSceneChange;
@@ -1,6 +1,7 @@
 #ifndef COMMDETECTOR_BASE_H
 #define COMMDETECTOR_BASE_H
 
+#include <functional>
 #include <iostream>
 
 #include <QObject>
@@ -18,6 +19,10 @@ enum CommMapValue : std::uint8_t {
 
 using show_map_t = QMap<uint64_t, CommMapValue>;
 
+class PlayerContext;
+/// Opens another player on the recording being flagged, see SetSegments()
+using PlayerContextFactory = std::function<PlayerContext*(void)>;
+
 /** \class CommDetectorBase
  *  \brief Abstract base class for all CommDetectors.
  *   Please use the CommDetectFactory to make actual instances.
@@ -31,13 +36,16 @@ public:
     CommDetectorBase() = default;
 
     virtual bool go() = 0;
-    void stop();
-    void pause();
-    void resume();
+    virtual void stop();
+    virtual void pause();
+    virtual void resume();
 
     virtual void GetCommercialBreakList(frm_dir_map_t &comms) = 0;
     virtual void recordingFinished([[maybe_unused]] long long totalFileSize) {};
     virtual void requestCommBreakMapUpdate(void) {};
+    /// Flag in this many segments in parallel, each with its own player.
+    virtual void SetSegments([[maybe_unused]] uint segments,
+                             [[maybe_unused]] const PlayerContextFactory &factory) {};
 
     virtual void PrintFullMap(
         std::ostream &out, const frm_dir_map_t *comm_breaks, bool verbose) const = 0;
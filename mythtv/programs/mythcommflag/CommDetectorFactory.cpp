@@ -1,4 +1,5 @@
 #include "CommDetectorFactory.h"
+#include "AudioCommDetector.h"
 #include "ClassicCommDetector.h"
 #include "CommDetector2.h"
 #include "PrePostRollFlagger.h"
@@ -11,6 +12,7 @@ CommDetectorFactory::makeCommDetector(
     SkipType commDetectMethod,
     bool showProgress, bool fullSpeed,
     MythCommFlagPlayer* player,
+    const QString& filename,
     int chanid,
     const QDateTime& startedAt,
     const QDateTime& stopsAt,
@@ -18,6 +20,28 @@ CommDetectorFactory::makeCommDetector(
     const QDateTime& recordingStopsAt,
     bool useDB)
 {
+    if (commDetectMethod & COMM_DETECT_AUDIO_FINGERPRINT)
+    {
+        /*
+         * Audio analysis runs first; the video methods selected alongside it
+         * are only used if it finds nothing.
+         */
+        auto videoMethod = static_cast<SkipType>(
+            commDetectMethod & ~COMM_DETECT_AUDIO_FINGERPRINT);
+        CommDetectorBase *fallback = nullptr;
+        if (videoMethod & COMM_DETECT_ALL)
+        {
+            fallback = makeCommDetector(videoMethod, showProgress, fullSpeed,
+                                        player, filename, chanid,
+                                        startedAt, stopsAt,
+                                        recordingStartedAt, recordingStopsAt,
+                                        useDB);
+        }
+        return new AudioCommDetector(filename, showProgress,
+                                     recordingStopsAt, fallback,
+                                     (commDetectMethod & COMM_DETECT_FINGERPRINT) != 0);
+    }
+
     if(commDetectMethod & COMM_DETECT_PREPOSTROLL)
     {
         return new PrePostRollFlagger(commDetectMethod, showProgress, fullSpeed,
@@ -18,6 +18,7 @@ class CommDetectorFactory
         SkipType commDetectMethod,
         bool showProgress,
         bool fullSpeed, MythCommFlagPlayer* player,
+        const QString& filename,
         int chanid,
         const QDateTime& startedAt,
         const QDateTime& stopsAt,
@@ -0,0 +1,346 @@
+// C++ headers
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+// Qt headers
+#include <QStringList>
+#include <QtAlgorithms>
+
+// MythTV headers
+#include "libmythbase/mythcorecontext.h"
+#include "libmythbase/mythdb.h"
+#include "libmythbase/mythlogging.h"
+
+// Commercial Flagging headers
+#include "CommFingerprintDB.h"
+
+#define LOC QString("CommFingerprintDB: ")
+
+namespace {
+
+/*
+ * TUNABLE:
+ *
+ * One sub-fingerprint is stored for the middle of each second of a
+ * commercial (kSampleOffset), skipping silent ones. Commercials with fewer
+ * than kMinSeconds of them are not stored.
+ *
+ * Every sub-fingerprint of a recording is looked up, as is and with each
+ * bit flipped. A hit is a match if at least kMinCoverage of the stored
+ * seconds fall within the recording, fewer than kMaxBitErrorRate of their
+ * bits differ, and at least half of the video hashes that can be compared
+ * are within kMaxVideoDistance bits of each other.
+ */
+constexpr double    kSampleOffset       = 0.5;
+constexpr size_t    kMinSeconds         = 5;
+constexpr double    kMinCoverage        = 0.75;
+constexpr double    kMaxBitErrorRate    = 0.25;
+constexpr int       kMaxVideoDistance   = 12;
+constexpr int       kSubFingerprintBits = 32;
+
+};  /* namespace */
+
+CommFingerprintDB::CommFingerprintDB(void)
+{
+    m_maxSegments = gCoreContext->GetNumSetting("CommFingerprintMaxSegments", 5000);
+}
+
+bool CommFingerprintDB::load(void)
+{
+    m_segments.clear();
+    m_index.clear();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT s.segmentid, s.duration, f.second, f.audiohash, "
+                  "       f.videohash "
+                  "FROM commsegment s "
+                  "JOIN commfingerprint f ON f.segmentid = s.segmentid "
+                  "ORDER BY s.segmentid, f.second");
+    if (!query.exec())
+    {
+        MythDB::DBError("CommFingerprintDB::load", query);
+        return false;
+    }
+
+    Segment segment;
+    while (query.next())
+    {
+        uint id = query.value(0).toUInt();
+        if (id != segment.m_id)
+        {
+            if (segment.m_id)
+                insert(std::move(segment));
+            segment = Segment();
+            segment.m_id = id;
+            segment.m_duration = query.value(1).toDouble();
+        }
+
+        Second second;
+        second.m_second = static_cast<uint16_t>(query.value(2).toUInt());
+        second.m_audio = query.value(3).toUInt();
+        second.m_hasVideo = !query.value(4).isNull();
+        if (second.m_hasVideo)
+            second.m_video = query.value(4).toULongLong();
+        segment.m_seconds.push_back(second);
+    }
+    if (segment.m_id)
+        insert(std::move(segment));
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("%1 known commercials")
+        .arg(m_segments.size()));
+    return true;
+}
+
+void CommFingerprintDB::insert(Segment segment)
+{
+    const size_t index = m_segments.size();
+    for (size_t ii = 0; ii < segment.m_seconds.size(); ii++)
+        m_index.emplace(segment.m_seconds[ii].m_audio, std::make_pair(index, ii));
+    m_segments.push_back(std::move(segment));
+}
+
+bool CommFingerprintDB::verify(const AudioAnalyzer &audio,
+                               const Segment &segment, double start) const
+{
+    const std::vector<uint32_t> &subfp = audio.fingerprints();
+    const int nn = static_cast<int>(subfp.size());
+
+    size_t compared = 0;
+    int errors = 0;
+    int videoCompared = 0;
+    int videoAgreed = 0;
+    for (const auto & second : segment.m_seconds)
+    {
+        const double time = start + second.m_second + kSampleOffset;
+        const int idx = audio.fingerprintIndex(time);
+        if (idx < 0 || idx >= nn)
+            continue;
+        compared++;
+        errors += static_cast<int>(qPopulationCount(subfp[idx] ^ second.m_audio));
+
+        uint64_t video = 0;
+        if (second.m_hasVideo && audio.videoHash(time, &video))
+        {
+            videoCompared++;
+            if (static_cast<int>(qPopulationCount(quint64(video ^ second.m_video))) <=
+                kMaxVideoDistance)
+                videoAgreed++;
+        }
+    }
+
+    if (compared < kMinSeconds ||
+        compared < kMinCoverage * segment.m_seconds.size())
+        return false;
+    if (errors > kMaxBitErrorRate * kSubFingerprintBits * compared)
+        return false;
+    if (videoCompared >= static_cast<int>(kMinSeconds) &&
+        videoAgreed * 2 < videoCompared)
+        return false;
+    return true;
+}
+
+void CommFingerprintDB::probe(const AudioAnalyzer &audio, int first, int last,
+                              std::vector<Match> *matches) const
+{
+    const std::vector<uint32_t> &subfp = audio.fingerprints();
+    const std::vector<uint8_t> &live = audio.fingerprintsLive();
+    first = std::max(first, 0);
+    last = std::min(last, static_cast<int>(subfp.size()));
+
+    /* (segment, start) pairs already verified */
+    std::set<std::pair<size_t,int>> tried;
+
+    for (int ii = first; ii < last; ii++)
+    {
+        if (!live[ii])
+            continue;
+
+        bool found = false;
+        for (int bit = -1; bit < kSubFingerprintBits && !found; bit++)
+        {
+            const uint32_t hash = bit < 0 ? subfp[ii] : subfp[ii] ^ (1U << bit);
+            auto range = m_index.equal_range(hash);
+            for (auto it = range.first; it != range.second && !found; ++it)
+            {
+                const Segment &segment = m_segments[it->second.first];
+                const Second &second = segment.m_seconds[it->second.second];
+                const double start = audio.fingerprintTime(ii) -
+                                     second.m_second - kSampleOffset;
+                if (!tried.emplace(it->second.first,
+                                   audio.fingerprintIndex(start)).second)
+                    continue;
+                if (!verify(audio, segment, start))
+                    continue;
+
+                const double end = start + segment.m_duration;
+                LOG(VB_COMMFLAG, LOG_DEBUG, LOC +
+                    QString("Known commercial %1 at %2-%3s")
+                        .arg(segment.m_id).arg(start, 0, 'f', 1)
+                        .arg(end, 0, 'f', 1));
+                matches->push_back({ segment.m_id, { start, end } });
+
+                /* Continue looking after this commercial. */
+                ii = std::max(ii, audio.fingerprintIndex(end));
+                found = true;
+            }
+        }
+    }
+}
+
+std::vector<CommFingerprintDB::Match>
+CommFingerprintDB::match(const AudioAnalyzer &audio) const
+{
+    std::vector<Match> matches;
+    if (!m_index.empty())
+        probe(audio, 0, static_cast<int>(audio.fingerprints().size()), &matches);
+    return matches;
+}
+
+void CommFingerprintDB::confirm(const std::vector<Match> &matches)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("UPDATE commsegment "
+                  "SET hits = hits + 1, lastseen = NOW() "
+                  "WHERE segmentid = :SEGMENTID");
+    for (const auto & match : matches)
+    {
+        query.bindValue(":SEGMENTID", match.m_segmentId);
+        if (!query.exec())
+        {
+            MythDB::DBError("CommFingerprintDB::confirm", query);
+            return;
+        }
+    }
+}
+
+bool CommFingerprintDB::add(const AudioAnalyzer &audio,
+                            const AudioAnalyzer::Interval &interval)
+{
+    std::vector<Match> known;
+    probe(audio, audio.fingerprintIndex(interval.m_start),
+          audio.fingerprintIndex(interval.m_end), &known);
+    if (!known.empty())
+        return false;
+
+    const std::vector<uint32_t> &subfp = audio.fingerprints();
+    const std::vector<uint8_t> &live = audio.fingerprintsLive();
+    const int nn = static_cast<int>(subfp.size());
+    const double duration = interval.m_end - interval.m_start;
+
+    Segment segment;
+    segment.m_duration = duration;
+    for (int sec = 0; sec + kSampleOffset < duration; sec++)
+    {
+        const double time = interval.m_start + sec + kSampleOffset;
+        const int idx = audio.fingerprintIndex(time);
+        if (idx < 0 || idx >= nn || !live[idx])
+            continue;
+
+        Second second;
+        second.m_second = static_cast<uint16_t>(sec);
+        second.m_audio = subfp[idx];
+        second.m_hasVideo = audio.videoHash(time, &second.m_video);
+        segment.m_seconds.push_back(second);
+    }
+    if (segment.m_seconds.size() < kMinSeconds)
+        return false;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("INSERT INTO commsegment "
+                  "       (duration, hits, created, lastseen) "
+                  "VALUES (:DURATION, 1, NOW(), NOW())");
+    query.bindValue(":DURATION", duration);
+    if (!query.exec())
+    {
+        MythDB::DBError("CommFingerprintDB::add segment", query);
+        return false;
+    }
+    segment.m_id = query.lastInsertId().toUInt();
+
+    query.prepare("INSERT INTO commfingerprint "
+                  "       (segmentid, second, audiohash, videohash) "
+                  "VALUES (:SEGMENTID, :SECOND, :AUDIOHASH, :VIDEOHASH)");
+    for (const auto & second : segment.m_seconds)
+    {
+        query.bindValue(":SEGMENTID", segment.m_id);
+        query.bindValue(":SECOND", second.m_second);
+        query.bindValue(":AUDIOHASH", second.m_audio);
+        query.bindValue(":VIDEOHASH", second.m_hasVideo ?
+                        QVariant(quint64(second.m_video)) : QVariant());
+        if (!query.exec())
+        {
+            MythDB::DBError("CommFingerprintDB::add fingerprint", query);
+            // A commercial with only some of its fingerprints would match
+            // less than it should, forever
+            remove(QStringList(QString::number(segment.m_id)));
+            return false;
+        }
+    }
+
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("Learned commercial %1, %2s at %3s")
+            .arg(segment.m_id).arg(duration, 0, 'f', 1)
+            .arg(interval.m_start, 0, 'f', 1));
+    insert(std::move(segment));
+    expire();
+    return true;
+}
+
+void CommFingerprintDB::expire(void)
+{
+    if (m_maxSegments <= 0)
+        return;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.exec("SELECT COUNT(*) FROM commsegment") || !query.next())
+    {
+        MythDB::DBError("CommFingerprintDB::expire count", query);
+        return;
+    }
+    const int excess = query.value(0).toInt() - m_maxSegments;
+    if (excess <= 0)
+        return;
+
+    /*
+     * Forget the commercials that have not been seen for the longest time.
+     * Only the database is trimmed; the ones already loaded are kept until
+     * this job finishes.
+     */
+    if (!query.exec(QString("SELECT segmentid FROM commsegment "
+                            "ORDER BY lastseen, hits LIMIT %1").arg(excess)))
+    {
+        MythDB::DBError("CommFingerprintDB::expire", query);
+        return;
+    }
+
+    QStringList ids;
+    while (query.next())
+        ids << query.value(0).toString();
+    if (ids.isEmpty())
+        return;
+
+    if (remove(ids))
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC + QString("Forgot %1 commercials")
+            .arg(ids.size()));
+    }
+}
+
+/* Delete the commercials "ids" and their fingerprints from the database. */
+bool CommFingerprintDB::remove(const QStringList &ids)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    for (const char *table : { "commfingerprint", "commsegment" })
+    {
+        if (!query.exec(QString("DELETE FROM %1 WHERE segmentid IN (%2)")
+                            .arg(QString(table), ids.join(","))))
+        {
+            MythDB::DBError("CommFingerprintDB::remove", query);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,85 @@
+/*
+ * CommFingerprintDB
+ *
+ * Fingerprints of commercials seen before, shared by all flagging jobs
+ * through the database. Each known commercial is stored as one audio
+ * sub-fingerprint and (optionally) one video keyframe hash per second.
+ */
+
+#ifndef COMMFINGERPRINTDB_H
+#define COMMFINGERPRINTDB_H
+
+// C++ headers
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Qt headers
+#include <QStringList>
+
+// Commercial Flagging headers
+#include "AudioAnalyzer.h"
+
+class CommFingerprintDB
+{
+  public:
+    CommFingerprintDB(void);
+
+    struct Match
+    {
+        uint                    m_segmentId {0};
+        AudioAnalyzer::Interval m_interval;
+    };
+
+    /* Read all known commercials from the database. */
+    bool load(void);
+    size_t size(void) const { return m_segments.size(); }
+
+    /* Known commercials in the analyzed recording. */
+    std::vector<Match> match(const AudioAnalyzer &audio) const;
+
+    /* Note that the matched commercials have been seen again. */
+    void confirm(const std::vector<Match> &matches);
+
+    /*
+     * Add the commercial at "interval" of the analyzed recording, unless it
+     * is already known. Returns true if it was added.
+     */
+    bool add(const AudioAnalyzer &audio, const AudioAnalyzer::Interval &interval);
+
+  private:
+    Q_DISABLE_COPY(CommFingerprintDB)
+
+    struct Second
+    {
+        uint16_t    m_second    {0};    /* from the start of the commercial */
+        uint32_t    m_audio     {0};
+        uint64_t    m_video     {0};
+        bool        m_hasVideo  {false};
+    };
+
+    struct Segment
+    {
+        uint                m_id        {0};
+        double              m_duration  {0.0};  /* seconds */
+        std::vector<Second> m_seconds;
+    };
+
+    void probe(const AudioAnalyzer &audio, int first, int last,
+               std::vector<Match> *matches) const;
+    bool verify(const AudioAnalyzer &audio, const Segment &segment,
+                double start) const;
+    void insert(Segment segment);
+    void expire(void);
+    static bool remove(const QStringList &ids);
+
+    int                     m_maxSegments   {5000};
+    std::vector<Segment>    m_segments;
+                            /* audio hash => (segment, second) */
+    std::unordered_multimap<uint32_t,std::pair<size_t,size_t>> m_index;
+};
+
+#endif  /* !COMMFINGERPRINTDB_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -16,6 +16,7 @@ extern "C" {
 // Commercial Flagging headers
 #include "EdgeDetector.h"
 #include "FrameAnalyzer.h"
+#include "pgmsimd.h"
 
 namespace edgeDetector {
 
@@ -39,18 +40,15 @@ sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
     int cc2 = srcwidth - 1;
     for (int rr = 0; rr < rr2; rr++)
     {
-        for (int cc = 0; cc < cc2; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                uchar *rr0 = &src->data[0][(rr * srcwidth) + cc];
-                uchar *rr1 = &src->data[0][((rr + 1) * srcwidth) + cc];
-                int dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                int dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[(rr * srcwidth) + cc] = dx * dx + dy * dy;
-            }
-        }
+        const uchar *rr0 = &src->data[0][rr * srcwidth];
+        const uchar *rr1 = &src->data[0][(rr + 1) * srcwidth];
+        unsigned int *sgmrow = &sgm[rr * srcwidth];
+        int ex1 = 0;
+        int ex2 = 0;
+        rrinrect(rr, excluderow, excludecol, excludewidth, excludeheight,
+                cc2, &ex1, &ex2);
+        pgm_sgm_row(sgmrow, rr0, rr1, ex1);
+        pgm_sgm_row(sgmrow + ex2, rr0 + ex2, rr1 + ex2, cc2 - ex2);
     }
     return sgm;
 }
@@ -63,11 +61,6 @@ sgm_init(unsigned int *sgm, const AVFrame *src, int srcheight)
 }
 #endif /* LATER */
 
-static int sort_ascending(const void *aa, const void *bb)
-{
-    return *(unsigned int*)aa - *(unsigned int*)bb;
-}
-
 static int
 edge_mark(AVFrame *dst, int dstheight,
         int extratop, int extraright,
@@ -95,19 +88,19 @@ edge_mark(AVFrame *dst, int dstheight,
      * sgmsorted: sorted SGM values of unexcluded areas of unpadded image (same
      * dimensions as "dst").
      */
-    int nn = 0;
+    unsigned int *sorted = sgmsorted;
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                sgmsorted[nn++] = sgm[((extratop + rr) * padded_width) +
-                    extraleft + cc];
-            }
-        }
+        const unsigned int *sgmrow = &sgm[((extratop + rr) * padded_width) +
+            extraleft];
+        int ex1 = 0;
+        int ex2 = 0;
+        rrinrect(rr, excluderow, excludecol, excludewidth, excludeheight,
+                dstwidth, &ex1, &ex2);
+        sorted = std::copy(sgmrow, sgmrow + ex1, sorted);
+        sorted = std::copy(sgmrow + ex2, sgmrow + dstwidth, sorted);
     }
+    int nn = sorted - sgmsorted;
 
     int dstnn = dstwidth * dstheight;
 #if 0
@@ -125,29 +118,33 @@ edge_mark(AVFrame *dst, int dstheight,
             return 0;
     }
 
-    qsort(sgmsorted, nn, sizeof(*sgmsorted), sort_ascending);
-
+    /*
+     * Only the selected value and its neighbourhood in sorted order matter,
+     * so partition around it instead of sorting every frame.
+     */
     int ii = percentile * nn / 100;
+    std::nth_element(sgmsorted, sgmsorted + ii, sgmsorted + nn);
     uint thresholdval = sgmsorted[ii];
 
     /*
      * Try not to pick up too many edges, and eliminate degenerate edge-less
      * cases.
+     *
+     * "first" is the sorted position of the first occurrence of thresholdval.
      */
-    int first = ii;
-    for ( ; first > 0 && sgmsorted[first] == thresholdval; first--) ;
-    if (sgmsorted[first] != thresholdval)
-        first++;
+    int first = std::count_if(sgmsorted, sgmsorted + ii,
+            [thresholdval](uint val){ return val < thresholdval; });
     if (first * 100 / nn < kMinThresholdPct)
     {
-        int last = ii;
-        int last2 = nn - 1;
-        for ( ; last < last2 && sgmsorted[last] == thresholdval;
-                last++) ;
-        if (sgmsorted[last] != thresholdval)
-            last--;
-
-        uint newthresholdval = sgmsorted[std::min(last + 1, nn - 1)];
+        /* The next unique intensity, if any. */
+        uint newthresholdval = thresholdval;
+        for (int jj = ii + 1; jj < nn; jj++)
+        {
+            if (sgmsorted[jj] > thresholdval &&
+                    (newthresholdval == thresholdval ||
+                        sgmsorted[jj] < newthresholdval))
+                newthresholdval = sgmsorted[jj];
+        }
         if (thresholdval == newthresholdval)
         {
             /* Degenerate case; no edges (e.g., blank frame). */
@@ -160,14 +157,16 @@ edge_mark(AVFrame *dst, int dstheight,
     /* sgm is a padded matrix; dst is the unpadded matrix. */
     for (int rr = 0; rr < dstheight; rr++)
     {
-        for (int cc = 0; cc < dstwidth; cc++)
-        {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight) &&
-                    sgm[((extratop + rr) * padded_width) + extraleft + cc] >=
-                        thresholdval)
-                dst->data[0][(rr * dstwidth) + cc] = UCHAR_MAX;
-        }
+        const unsigned int *sgmrow = &sgm[((extratop + rr) * padded_width) +
+            extraleft];
+        uchar *dstrow = &dst->data[0][rr * dstwidth];
+        int ex1 = 0;
+        int ex2 = 0;
+        rrinrect(rr, excluderow, excludecol, excludewidth, excludeheight,
+                dstwidth, &ex1, &ex2);
+        pgm_threshold_row(dstrow, sgmrow, ex1, thresholdval);
+        pgm_threshold_row(dstrow + ex2, sgmrow + ex2, dstwidth - ex2,
+                thresholdval);
     }
     return 0;
 }
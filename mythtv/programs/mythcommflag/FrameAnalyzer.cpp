@@ -1,3 +1,6 @@
+// C++ headers
+#include <algorithm>
+
 #include "libmythbase/mythlogging.h"
 #include "CommDetector2.h"
 #include "FrameAnalyzer.h"
@@ -13,6 +16,24 @@ rrccinrect(int rr, int cc, int rrow, int rcol, int rwidth, int rheight)
         rr < rrow + rheight && cc < rcol + rwidth;
 }
 
+void
+rrinrect(int rr, int rrow, int rcol, int rwidth, int rheight, int ncols,
+        int *cc1, int *cc2)
+{
+    /*
+     * Columns [*cc1, *cc2) of row "rr" that lie inside the rectangle, clipped
+     * to [0, ncols). An empty span is returned as [ncols, ncols), so that
+     * callers can always process [0, *cc1) and [*cc2, ncols).
+     */
+    if (rr < rrow || rr >= rrow + rheight || rwidth <= 0)
+    {
+        *cc1 = *cc2 = ncols;
+        return;
+    }
+    *cc1 = std::clamp(rcol, 0, ncols);
+    *cc2 = std::clamp(rcol + rwidth, *cc1, ncols);
+}
+
 void
 frameAnalyzerReportMap(const FrameAnalyzer::FrameMap *frameMap, float fps,
         const char *comment)
@@ -73,6 +73,8 @@ public:
 namespace frameAnalyzer {
 
 bool rrccinrect(int rr, int cc, int rrow, int rcol, int rwidth, int rheight);
+void rrinrect(int rr, int rrow, int rcol, int rwidth, int rheight, int ncols,
+        int *cc1, int *cc2);
 
 void frameAnalyzerReportMap(const FrameAnalyzer::FrameMap *frameMap,
         float fps, const char *comment);
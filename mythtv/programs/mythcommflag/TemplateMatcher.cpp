@@ -22,6 +22,7 @@
 #include "TemplateFinder.h"
 #include "TemplateMatcher.h"
 #include "pgm.h"
+#include "pgmsimd.h"
 
 extern "C" {
 #include "libavutil/imgutils.h"
@@ -37,11 +38,7 @@ int pgm_set(const AVFrame *pict, int height)
     const int   width = pict->linesize[0];
     const int   size = height * width;
 
-    int score = 0;
-    for (int ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
-            score++;
-    return score;
+    return pgm_count_nonzero(pict->data[0], size);
 }
 
 int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
@@ -58,6 +55,14 @@ int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
         return -1;
     }
 
+    if (radius == 0)
+    {
+        /* No jitter: count the pixels that are edges in both images. */
+        *pscore = pgm_count_both_nonzero(tmpl->data[0], test->data[0],
+                height * width);
+        return 0;
+    }
+
     int score = 0;
     for (int rr = 0; rr < height; rr++)
     {
@@ -578,8 +583,8 @@ TemplateMatcher::reportTime(void) const
     if (m_pgmConverter->reportTime())
         return -1;
 
-    LOG(VB_COMMFLAG, LOG_INFO, QString("TM Time: analyze=%1s")
-            .arg(strftimeval(m_analyzeTime)));
+    LOG(VB_COMMFLAG, LOG_INFO, QString("TM Time: analyze=%1s (%2 kernels)")
+            .arg(strftimeval(m_analyzeTime), pgm_simd_name()));
     return 0;
 }
 
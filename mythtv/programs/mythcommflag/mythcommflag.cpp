@@ -9,6 +9,8 @@
 #include <unistd.h>
 
 // C++ headers
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -20,6 +22,7 @@
 // Qt headers
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QString>
 #include <QtGlobal>
@@ -92,6 +95,8 @@ static QMap<QString,SkipType> *init_skip_types(void)
     (*tmp)["d2_blank"]    = COMM_DETECT_2_BLANK;
     (*tmp)["d2_scene"]    = COMM_DETECT_2_SCENE;
     (*tmp)["d2_all"]      = COMM_DETECT_2_ALL;
+    (*tmp)["audio"]       = COMM_DETECT_AUDIO;
+    (*tmp)["fingerprint"] = COMM_DETECT_AUDIO_FINGERPRINT;
     return tmp;
 }
 
@@ -121,6 +126,23 @@ static QString get_filename(ProgramInfo *program_info)
     return filename;
 }
 
+/// Opens another player on the recording for segmented flagging.
+static PlayerContext *make_segment_context(ProgramInfo *program_info,
+                                           PlayerFlags flags)
+{
+    MythMediaBuffer *buffer =
+        MythMediaBuffer::Create(get_filename(program_info), false);
+    if (!buffer)
+        return nullptr;
+
+    auto *ctx = new PlayerContext(kFlaggerInUseID);
+    auto *cfp = new MythCommFlagPlayer(ctx, flags);
+    ctx->SetPlayingInfo(program_info);
+    ctx->SetRingBuffer(buffer);
+    ctx->SetPlayer(cfp);
+    return ctx;
+}
+
 static int QueueCommFlagJob(uint chanid, const QDateTime& starttime, bool rebuild)
 {
     QString startstring = MythDate::toString(starttime, MythDate::kFilename);
@@ -377,16 +399,18 @@ static int DoFlagCommercials(
     ProgramInfo *program_info,
     bool showPercentage, bool fullSpeed, int jobid,
     MythCommFlagPlayer* cfp, SkipType commDetectMethod,
-    const QString &outputfilename, bool useDB)
+    const QString &outputfilename, bool useDB,
+    uint segments, const PlayerContextFactory &segmentFactory)
 {
     commDetector = CommDetectorFactory::makeCommDetector(
         commDetectMethod, showPercentage,
-        fullSpeed, cfp,
+        fullSpeed, cfp, get_filename(program_info),
         program_info->GetChanID(),
         program_info->GetScheduledStartTime(),
         program_info->GetScheduledEndTime(),
         program_info->GetRecordingStartTime(),
         program_info->GetRecordingEndTime(), useDB);
+    commDetector->SetSegments(segments, segmentFactory);
 
     if (jobid > 0)
         LOG(VB_COMMFLAG, LOG_INFO,
@@ -564,6 +588,68 @@ static bool IsMarked(uint chanid, const QDateTime& starttime)
     return true;
 }
 
+/** \brief Flags the recording serially and then in segments, without
+ *         saving anything, and reports the speed of each and whether
+ *         they found the same breaks.
+ */
+static int BenchmarkCommercials(ProgramInfo *program_info,
+                                SkipType commDetectMethod, PlayerFlags flags,
+                                uint segments)
+{
+    auto factory = [program_info, flags]()
+        { return make_segment_context(program_info, flags); };
+
+    std::array<uint,2> passes { 1, std::max(segments, 2U) };
+    std::array<frm_dir_map_t,2> breaks;
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        PlayerContext *ctx = factory();
+        if (!ctx)
+            return GENERIC_EXIT_PERMISSIONS_ERROR;
+        auto *cfp = dynamic_cast<MythCommFlagPlayer*>(ctx->m_player);
+
+        CommDetectorBase *detector = CommDetectorFactory::makeCommDetector(
+            commDetectMethod, false, true, cfp, get_filename(program_info),
+            program_info->GetChanID(),
+            program_info->GetScheduledStartTime(),
+            program_info->GetScheduledEndTime(),
+            program_info->GetRecordingStartTime(),
+            program_info->GetRecordingEndTime(), false);
+        detector->SetSegments(passes[i], factory);
+
+        QElapsedTimer timer;
+        timer.start();
+        bool result = detector->go();
+        float elapsed = timer.elapsed() / 1000.0F;
+        if (result)
+            detector->GetCommercialBreakList(breaks[i]);
+        uint64_t frames = cfp->GetTotalFrameCount();
+
+        detector->deleteLater();
+        delete ctx;
+
+        if (!result)
+            return GENERIC_EXIT_NOT_OK;
+
+        QString tmp = QString("%1 segment(s): %2 break(s), %3 frames in "
+                              "%4 seconds, %5 fps")
+            .arg(passes[i]).arg(breaks[i].size() / 2).arg(frames)
+            .arg(elapsed, 0, 'f', 1)
+            .arg((elapsed > 0.0F) ? frames / elapsed : 0.0F, 0, 'f', 1);
+        std::cout << qPrintable(tmp) << std::endl;
+    }
+
+    if (breaks[0] != breaks[1])
+    {
+        std::cout << "Segmented flagging differs from serial flagging"
+                  << std::endl;
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    std::cout << "Segmented flagging matches serial flagging" << std::endl;
+    return GENERIC_EXIT_OK;
+}
+
 static int FlagCommercials(ProgramInfo *program_info, int jobid,
             const QString &outputfilename, bool useDB, bool fullSpeed)
 {
@@ -726,7 +812,8 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         // single threaded decoding - which surely slows everything down? Though
         // there is probably no profile to enable multi-threaded decoding anyway.
         LOG(VB_GENERAL, LOG_INFO, "Enabling experimental flagging speedup (low resolution)");
-        flags = static_cast<PlayerFlags>(flags | kDecodeLowRes | kDecodeSingleThreaded | kDecodeNoLoopFilter);
+        flags = static_cast<PlayerFlags>(flags | kDecodeLowRes | kDecodeSingleThreaded |
+                                         kDecodeNoLoopFilter | kDecodeLumaOnly);
     }
 
     // blank detector needs to be only sample center for this optimization.
@@ -736,6 +823,18 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         flags = static_cast<PlayerFlags>(flags | kDecodeFewBlocks);
     }
 
+    uint segments = cmdline.toBool("segments") ? cmdline.toUInt("segments")
+        : gCoreContext->GetNumSetting("CommFlagSegments", 1);
+
+    if (cmdline.toBool("benchmark"))
+    {
+        delete tmprbuf;
+        int result = BenchmarkCommercials(program_info, commDetectMethod,
+                                          flags, segments);
+        global_program_info = nullptr;
+        return result;
+    }
+
     auto *ctx = new PlayerContext(kFlaggerInUseID);
     auto *cfp = new MythCommFlagPlayer(ctx, flags);
     ctx->SetPlayingInfo(program_info);
@@ -775,9 +874,13 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
 
     // TODO: Add back insertion of job if not in jobqueue
 
+    auto segmentFactory = [program_info, flags]()
+        { return make_segment_context(program_info, flags); };
+
     breaksFound = DoFlagCommercials(
         program_info, progress, fullSpeed, jobid,
-        cfp, commDetectMethod, outputfilename, useDB);
+        cfp, commDetectMethod, outputfilename, useDB,
+        watchingRecording ? 1 : segments, segmentFactory);
 
     if (progress)
         std::cerr << breaksFound << "\n";
@@ -20,6 +20,7 @@ HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
 HEADERS += pgm.h
+HEADERS += pgmsimd.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
 HEADERS += FrameAnalyzer.h
@@ -28,6 +29,7 @@ HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
 HEADERS += SceneChangeDetector.h
 HEADERS += PrePostRollFlagger.h
+HEADERS += AudioAnalyzer.h AudioCommDetector.h CommFingerprintDB.h
 
 HEADERS += LogoDetectorBase.h SceneChangeDetectorBase.h
 HEADERS += SlotRelayer.h CustomEventRelayer.h
@@ -41,6 +43,7 @@ SOURCES += Histogram.cpp
 SOURCES += quickselect.cpp
 SOURCES += CommDetector2.cpp
 SOURCES += pgm.cpp
+SOURCES += pgmsimd.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
 SOURCES += FrameAnalyzer.cpp
@@ -49,6 +52,7 @@ SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
 SOURCES += SceneChangeDetector.cpp
 SOURCES += PrePostRollFlagger.cpp
+SOURCES += AudioAnalyzer.cpp AudioCommDetector.cpp CommFingerprintDB.cpp
 
 SOURCES += mythcommflag.cpp mythcommflag_commandlineparser.cpp
 
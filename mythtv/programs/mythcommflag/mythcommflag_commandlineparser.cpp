@@ -66,11 +66,20 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
     add("--method", "commmethod", "",
         "Commercial flagging method[s] to employ:\n"
         "off, blank, scene, blankscene, logo, all, "
-        "d2, d2_logo, d2_blank, d2_scene, d2_all", "")
+        "d2, d2_logo, d2_blank, d2_scene, d2_all, audio, fingerprint", "")
             ->SetGroup("Commflagging");
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
             ->SetGroup("Commflagging");
+    add("--segments", "segments", 0,
+        "Split the recording into this many segments and flag "
+        "them in parallel, each with its own decoder.", "")
+            ->SetGroup("Commflagging");
+    add("--benchmark", "benchmark", false,
+        "Flag serially and then in segments, report the speed of "
+        "each and whether they found the same breaks. Nothing is saved.", "")
+            ->SetGroup("Commflagging")
+            ->SetBlocks("queue");
     add("--queue", "queue", false,
         "Insert flagging job into the JobQueue, rather than "
         "running flagging in the foreground.", "");
@@ -0,0 +1,289 @@
+// C++ headers
+#include <array>
+#include <climits>
+#include <cmath>
+
+// Qt headers
+#include <QtAlgorithms>
+#include <QtGlobal>
+
+// MythTV headers
+#include "libmythbase/mythconfig.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+// Commercial Flagging headers
+#include "pgmsimd.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#   include <emmintrin.h>
+static const bool s_haveSIMD = true;
+#elif HAVE_INTRINSICS_NEON
+#   include <arm_neon.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_NEON;
+#endif
+
+#if HAVE_INTRINSICS_NEON && !defined(Q_PROCESSOR_X86_64)
+/* Number of 0xFF bytes in a comparison result. */
+static inline int count_set(uint8x16_t mask)
+{
+    uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vshrq_n_u8(mask, 7))));
+    return static_cast<int>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+}
+#endif
+
+const char *pgm_simd_name(void)
+{
+#if defined(Q_PROCESSOR_X86_64)
+    return "SSE2";
+#elif HAVE_INTRINSICS_NEON
+    return s_haveSIMD ? "NEON" : "C";
+#else
+    return "C";
+#endif
+}
+
+void pgm_convolve_row(uint8_t *dst, const uint8_t *src, int count,
+        const double *mask, int mask_radius, ptrdiff_t step)
+{
+    /*
+     * dst[ii] = sum(mask[kk] * src[ii + (kk - mask_radius) * step])
+     *
+     * With step == 1 this convolves a row with a row vector; with step equal
+     * to the image width it convolves a row with a column vector.
+     */
+    int ii = 0;
+
+#if defined(Q_PROCESSOR_X86_64) || HAVE_INTRINSICS_NEON
+    static constexpr int kMaxTaps = 16;
+    const int taps = (2 * mask_radius) + 1;
+    if (s_haveSIMD && taps <= kMaxTaps)
+    {
+        std::array<float,kMaxTaps> weights {};
+        for (int kk = 0; kk < taps; kk++)
+            weights[kk] = static_cast<float>(mask[kk]);
+
+        for ( ; ii + 8 <= count; ii += 8)
+        {
+            const uint8_t *tap = src + ii - (mask_radius * step);
+#ifdef Q_PROCESSOR_X86_64
+            const __m128i zero = _mm_setzero_si128();
+            __m128 lo = _mm_setzero_ps();
+            __m128 hi = _mm_setzero_ps();
+            for (int kk = 0; kk < taps; kk++, tap += step)
+            {
+                __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(tap)), zero);
+                __m128 weight = _mm_set1_ps(weights[kk]);
+                lo = _mm_add_ps(lo, _mm_mul_ps(weight,
+                        _mm_cvtepi32_ps(_mm_unpacklo_epi16(px, zero))));
+                hi = _mm_add_ps(hi, _mm_mul_ps(weight,
+                        _mm_cvtepi32_ps(_mm_unpackhi_epi16(px, zero))));
+            }
+            /* Round half up, as lround() does for non-negative sums. */
+            const __m128 half = _mm_set1_ps(0.5F);
+            __m128i out = _mm_packs_epi32(
+                    _mm_cvttps_epi32(_mm_add_ps(lo, half)),
+                    _mm_cvttps_epi32(_mm_add_ps(hi, half)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + ii),
+                    _mm_packus_epi16(out, out));
+#else
+            float32x4_t lo = vdupq_n_f32(0.0F);
+            float32x4_t hi = vdupq_n_f32(0.0F);
+            for (int kk = 0; kk < taps; kk++, tap += step)
+            {
+                uint16x8_t px = vmovl_u8(vld1_u8(tap));
+                lo = vmlaq_n_f32(lo, vcvtq_f32_u32(vmovl_u16(vget_low_u16(px))),
+                        weights[kk]);
+                hi = vmlaq_n_f32(hi, vcvtq_f32_u32(vmovl_u16(vget_high_u16(px))),
+                        weights[kk]);
+            }
+            const float32x4_t half = vdupq_n_f32(0.5F);
+            uint16x8_t out = vcombine_u16(
+                    vqmovn_u32(vcvtq_u32_f32(vaddq_f32(lo, half))),
+                    vqmovn_u32(vcvtq_u32_f32(vaddq_f32(hi, half))));
+            vst1_u8(dst + ii, vqmovn_u16(out));
+#endif
+        }
+    }
+#endif
+
+    for ( ; ii < count; ii++)
+    {
+        double sum = 0;
+        for (int kk = -mask_radius; kk <= mask_radius; kk++)
+            sum += mask[kk + mask_radius] * src[ii + (kk * step)];
+        dst[ii] = lround(sum);
+    }
+}
+
+void pgm_sgm_row(unsigned int *sgm, const uint8_t *row0, const uint8_t *row1,
+        int count)
+{
+    /*
+     * Squared gradient magnitude along 45-degree rotated axes. "row0" and
+     * "row1" must be readable up to and including index "count".
+     */
+    int ii = 0;
+
+#if defined(Q_PROCESSOR_X86_64) || HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        for ( ; ii + 8 <= count; ii += 8)
+        {
+#ifdef Q_PROCESSOR_X86_64
+            const __m128i zero = _mm_setzero_si128();
+            __m128i nw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row0 + ii)), zero);
+            __m128i ne = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row0 + ii + 1)), zero);
+            __m128i sw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row1 + ii)), zero);
+            __m128i se = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(row1 + ii + 1)), zero);
+            __m128i dx = _mm_sub_epi16(se, nw);
+            __m128i dy = _mm_sub_epi16(sw, ne);
+            /* Interleave dx and dy so that madd yields dx*dx + dy*dy. */
+            __m128i lo = _mm_unpacklo_epi16(dx, dy);
+            __m128i hi = _mm_unpackhi_epi16(dx, dy);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sgm + ii),
+                    _mm_madd_epi16(lo, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sgm + ii + 4),
+                    _mm_madd_epi16(hi, hi));
+#else
+            int16x8_t dx = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(row1 + ii + 1), vld1_u8(row0 + ii)));
+            int16x8_t dy = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(row1 + ii), vld1_u8(row0 + ii + 1)));
+            int32x4_t lo = vmlal_s16(
+                    vmull_s16(vget_low_s16(dx), vget_low_s16(dx)),
+                    vget_low_s16(dy), vget_low_s16(dy));
+            int32x4_t hi = vmlal_s16(
+                    vmull_s16(vget_high_s16(dx), vget_high_s16(dx)),
+                    vget_high_s16(dy), vget_high_s16(dy));
+            vst1q_u32(sgm + ii, vreinterpretq_u32_s32(lo));
+            vst1q_u32(sgm + ii + 4, vreinterpretq_u32_s32(hi));
+#endif
+        }
+    }
+#endif
+
+    for ( ; ii < count; ii++)
+    {
+        int dx = row1[ii + 1] - row0[ii];   /* southeast - northwest */
+        int dy = row1[ii] - row0[ii + 1];   /* southwest - northeast */
+        sgm[ii] = (dx * dx) + (dy * dy);
+    }
+}
+
+void pgm_threshold_row(uint8_t *dst, const unsigned int *sgm, int count,
+        unsigned int threshold)
+{
+    /* dst[ii] = UCHAR_MAX where sgm[ii] >= threshold, else 0. */
+    int ii = 0;
+
+#if defined(Q_PROCESSOR_X86_64)
+    /* SGM values are at most 2 * 255 * 255, so signed compares are safe. */
+    const __m128i limit = _mm_set1_epi32(static_cast<int>(threshold) - 1);
+    for ( ; ii + 16 <= count; ii += 16)
+    {
+        const auto *in = reinterpret_cast<const __m128i*>(sgm + ii);
+        __m128i m0 = _mm_cmpgt_epi32(_mm_loadu_si128(in + 0), limit);
+        __m128i m1 = _mm_cmpgt_epi32(_mm_loadu_si128(in + 1), limit);
+        __m128i m2 = _mm_cmpgt_epi32(_mm_loadu_si128(in + 2), limit);
+        __m128i m3 = _mm_cmpgt_epi32(_mm_loadu_si128(in + 3), limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+                _mm_packs_epi16(_mm_packs_epi32(m0, m1),
+                        _mm_packs_epi32(m2, m3)));
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        const uint32x4_t limit = vdupq_n_u32(threshold);
+        for ( ; ii + 8 <= count; ii += 8)
+        {
+            uint16x8_t mask = vcombine_u16(
+                    vmovn_u32(vcgeq_u32(vld1q_u32(sgm + ii), limit)),
+                    vmovn_u32(vcgeq_u32(vld1q_u32(sgm + ii + 4), limit)));
+            vst1_u8(dst + ii, vmovn_u16(mask));
+        }
+    }
+#endif
+
+    for ( ; ii < count; ii++)
+        dst[ii] = sgm[ii] >= threshold ? UCHAR_MAX : 0;
+}
+
+int pgm_count_nonzero(const uint8_t *buf, int count)
+{
+    int result = 0;
+    int ii = 0;
+
+#if defined(Q_PROCESSOR_X86_64)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; ii + 16 <= count; ii += 16)
+    {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + ii));
+        auto zeros = static_cast<quint32>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(px, zero)));
+        result += 16 - static_cast<int>(qPopulationCount(zeros));
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        for ( ; ii + 16 <= count; ii += 16)
+        {
+            uint8x16_t px = vld1q_u8(buf + ii);
+            result += count_set(vtstq_u8(px, px));
+        }
+    }
+#endif
+
+    for ( ; ii < count; ii++)
+    {
+        if (buf[ii])
+            result++;
+    }
+    return result;
+}
+
+int pgm_count_both_nonzero(const uint8_t *buf1, const uint8_t *buf2,
+        int count)
+{
+    int result = 0;
+    int ii = 0;
+
+#if defined(Q_PROCESSOR_X86_64)
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; ii + 16 <= count; ii += 16)
+    {
+        __m128i px1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf1 + ii));
+        __m128i px2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf2 + ii));
+        auto zeros = static_cast<quint32>(_mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(px1, zero), _mm_cmpeq_epi8(px2, zero))));
+        result += 16 - static_cast<int>(qPopulationCount(zeros));
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        for ( ; ii + 16 <= count; ii += 16)
+        {
+            uint8x16_t px1 = vld1q_u8(buf1 + ii);
+            uint8x16_t px2 = vld1q_u8(buf2 + ii);
+            result += count_set(vandq_u8(vtstq_u8(px1, px1),
+                    vtstq_u8(px2, px2)));
+        }
+    }
+#endif
+
+    for ( ; ii < count; ii++)
+    {
+        if (buf1[ii] && buf2[ii])
+            result++;
+    }
+    return result;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
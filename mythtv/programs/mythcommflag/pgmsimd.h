@@ -0,0 +1,29 @@
+/*
+ * pgmsimd.h
+ *
+ * Row kernels shared by the PGM-based frame analyzers. Each kernel has an
+ * SSE2 (x86_64) or NEON implementation, used when the CPU supports it, and a
+ * scalar fallback for other CPUs and for the tail of each row.
+ */
+
+#ifndef PGMSIMD_H
+#define PGMSIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+const char *pgm_simd_name(void);
+
+void pgm_convolve_row(uint8_t *dst, const uint8_t *src, int count,
+        const double *mask, int mask_radius, ptrdiff_t step);
+void pgm_sgm_row(unsigned int *sgm, const uint8_t *row0, const uint8_t *row1,
+        int count);
+void pgm_threshold_row(uint8_t *dst, const unsigned int *sgm, int count,
+        unsigned int threshold);
+int pgm_count_nonzero(const uint8_t *buf, int count);
+int pgm_count_both_nonzero(const uint8_t *buf1, const uint8_t *buf2,
+        int count);
+
+#endif  /* !PGMSIMD_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -298,6 +298,40 @@ static GlobalCheckBoxSetting *CommFlagFast()
     return gc;
 }
 
+static GlobalSpinBoxSetting *CommFlagNonRefSampling()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommFlagNonRefSampling", 1, 8, 1);
+
+    gs->setLabel(GeneralSettings::tr("Non-reference frame sampling"));
+
+    gs->setValue(1);
+
+    gs->setHelpText(GeneralSettings::tr("With the experimental speedup "
+                                        "enabled, decode only one in this "
+                                        "many non-reference frames. Higher "
+                                        "values are faster but may miss "
+                                        "short blank frames between "
+                                        "commercials."));
+    return gs;
+}
+
+static GlobalSpinBoxSetting *CommFlagSegments()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommFlagSegments", 1, 16, 1);
+
+    gs->setLabel(GeneralSettings::tr("Commercial detection segments"));
+
+    gs->setHelpText(GeneralSettings::tr("Finished recordings are split into "
+                                        "this many segments which are "
+                                        "flagged in parallel. Set to the "
+                                        "number of CPU cores to spare for "
+                                        "commercial detection."));
+
+    gs->setValue(1);
+
+    return gs;
+}
+
 static HostComboBoxSetting *AutoCommercialSkip()
 {
     auto *gc = new HostComboBoxSetting("AutoCommercialSkip");
@@ -1491,6 +1525,24 @@ static HostSpinBoxSetting *FFRewReposTime()
     return gs;
 }
 
+static HostSpinBoxSetting *EditFrameCacheSize()
+{
+    auto *gs = new HostSpinBoxSetting("EditFrameCacheSize", 0, 4096, 32);
+
+    gs->setLabel(PlaybackSettings::tr("Edit mode frame cache (MB)"));
+
+    gs->setValue(256);
+
+    gs->setHelpText(PlaybackSettings::tr("Amount of memory used to keep "
+                                         "recently decoded frames while "
+                                         "editing a cut list, so that frame "
+                                         "stepping and short rewinds do not "
+                                         "need to decode again from the "
+                                         "previous keyframe. Set to 0 to "
+                                         "disable."));
+    return gs;
+}
+
 static HostCheckBoxSetting *FFRewReverse()
 {
     auto *gc = new HostCheckBoxSetting("FFRewReverse");
@@ -4547,6 +4599,7 @@ void PlaybackSettings::Load(void)
     seek->addChild(SmartForward());
     seek->addChild(FFRewReposTime());
     seek->addChild(FFRewReverse());
+    seek->addChild(EditFrameCacheSize());
 
     addChild(seek);
 
@@ -4648,6 +4701,8 @@ GeneralSettings::GeneralSettings()
 
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
+    jobs->addChild(CommFlagNonRefSampling());
+    jobs->addChild(CommFlagSegments());
     jobs->addChild(AggressiveCommDetect());
     jobs->addChild(DeferAutoTranscodeDays());
 
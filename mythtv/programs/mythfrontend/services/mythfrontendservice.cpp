@@ -89,9 +89,19 @@ class FrontendActions
 //NOLINTNEXTLINE(readability-redundant-member-init)
 Q_GLOBAL_STATIC(FrontendActions, s_actions)
 
+// Remote controls poll the status and send actions at a high rate
+static HTTPInvokers FrontendInvokers()
+{
+    return {
+        { "GetStatus",  MythHTTPMetaMethod::Invoker(&MythFrontendService::GetStatus)  },
+        { "SendAction", MythHTTPMetaMethod::Invoker(&MythFrontendService::SendAction) },
+        { "SendKey",    MythHTTPMetaMethod::Invoker(&MythFrontendService::SendKey)    },
+    };
+}
+
 // This will be initialised in a thread safe manner on first use
 Q_GLOBAL_STATIC_WITH_ARGS(MythHTTPMetaService, s_service,
-    (FRONTEND_HANDLE, MythFrontendService::staticMetaObject, &MythFrontendService::RegisterCustomTypes))
+    (FRONTEND_HANDLE, MythFrontendService::staticMetaObject, &MythFrontendService::RegisterCustomTypes, {}, FrontendInvokers()))
 
 void MythFrontendService::RegisterCustomTypes()
 {
@@ -22,6 +22,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QMap>
+#include <QTextStream>
 
 // MythTV
 #include "libmyth/mythcontext.h"
@@ -36,6 +37,7 @@
 #include "libmythtv/dbcheck.h"
 #include "libmythtv/mythsystemevent.h"
 #include "libmythtv/previewgenerator.h"
+#include "libmythtv/trickplaygenerator.h"
 
 //MythPreviewGen
 #include "mythpreviewgen_commandlineparser.h"
@@ -54,7 +56,8 @@ static constexpr long UNUSED_FILENO { 3 };
 int preview_helper(uint chanid, QDateTime starttime,
                    long long previewFrameNumber, std::chrono::seconds previewSeconds,
                    const QSize previewSize,
-                   const QString &infile, const QString &outfile)
+                   const QString &infile, const QString &outfile,
+                   const QString &batchfile)
 {
     // Lower scheduling priority, to avoid problems with recordings.
     if (setpriority(PRIO_PROCESS, 0, 9))
@@ -107,6 +110,25 @@ int preview_helper(uint chanid, QDateTime starttime,
 
     previewgen->SetOutputSize(previewSize);
     previewgen->SetOutputFilename(outfile);
+
+    // Other images of the same recording, taken with the same decoder
+    QFile batch(batchfile);
+    if (!batchfile.isEmpty() && batch.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream stream(&batch);
+        while (!stream.atEnd())
+        {
+            QStringList fields = stream.readLine().split('\t');
+            if (fields.size() < 4)
+                continue;
+            PreviewGenerator::BatchItem item;
+            item.m_time        = std::chrono::seconds(fields[0].toLongLong());
+            item.m_outSize     = QSize(fields[1].toInt(), fields[2].toInt());
+            item.m_outFileName = fields.mid(3).join('\t');
+            previewgen->AddToBatch(item);
+        }
+    }
+
     bool ok = previewgen->RunReal();
     previewgen->deleteLater();
 
@@ -115,6 +137,25 @@ int preview_helper(uint chanid, QDateTime starttime,
     return (ok) ? GENERIC_EXIT_OK : GENERIC_EXIT_NOT_OK;
 }
 
+static int trickplay_helper(uint chanid, const QDateTime &starttime)
+{
+    if (setpriority(PRIO_PROCESS, 0, 9))
+        LOG(VB_GENERAL, LOG_ERR, "Setting priority failed." + ENO);
+
+    ProgramInfo pginfo(chanid, starttime);
+    if (!pginfo.GetChanID())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Cannot locate recording made on '%1' at '%2'")
+            .arg(chanid).arg(starttime.toString(Qt::ISODate)));
+        return GENERIC_EXIT_NO_RECORDING_DATA;
+    }
+    pginfo.SetPathname(pginfo.GetPlaybackURL(false, true));
+
+    TrickplayGenerator trickplay(pginfo);
+    return trickplay.Run() ? GENERIC_EXIT_OK : GENERIC_EXIT_NOT_OK;
+}
+
 int main(int argc, char **argv)
 {
     MythPreviewGeneratorCommandLineParser cmdline;
@@ -164,6 +205,13 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_INVALID_CMDLINE;
     }
 
+    if (cmdline.toBool("trickplay") &&
+        (!cmdline.toBool("chanid") || !cmdline.toBool("starttime")))
+    {
+        std::cerr << "--trickplay requires both --chanid and --starttime." << std::endl;
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+
     ///////////////////////////////////////////////////////////////////////
 
     // Don't listen to console input
@@ -179,11 +227,18 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_NO_MYTHCONTEXT;
     }
 
+    if (cmdline.toBool("trickplay"))
+    {
+        return trickplay_helper(cmdline.toUInt("chanid"),
+                                cmdline.toDateTime("starttime"));
+    }
+
     int ret = preview_helper(
         cmdline.toUInt("chanid"), cmdline.toDateTime("starttime"),
         cmdline.toLongLong("frame"), std::chrono::seconds(cmdline.toLongLong("seconds")),
         cmdline.toSize("size"),
-        cmdline.toString("inputfile"), cmdline.toString("outputfile"));
+        cmdline.toString("inputfile"), cmdline.toString("outputfile"),
+        cmdline.toString("batchfile"));
     return ret;
 }
 
@@ -20,6 +20,11 @@ void MythPreviewGeneratorCommandLineParser::LoadArguments(void)
     add("--size", "size", QSize(0,0), "Dimensions of preview image.", "");
     add("--infile", "inputfile", "", "Input video for preview generation.", "");
     add("--outfile", "outputfile", "", "Optional output file for preview generation.", "");
+    add("--batchfile", "batchfile", "", "File listing more previews of the same "
+        "recording, one per line: seconds, width, height and output file, "
+        "separated by tabs.", "");
+    add("--trickplay", "trickplay", false, "Create the seek bar thumbnails of "
+        "the whole recording instead of a preview image.", "");
 }
 
 
@@ -30,6 +30,7 @@
 // MythTranscode
 #include "mpeg2fix.h"
 #include "mythtranscode_commandlineparser.h"
+#include "smartcutter.h"
 #include "transcode.h"
 
 static void CompleteJob(int jobID, ProgramInfo *pginfo, bool useCutlist,
@@ -151,6 +152,7 @@ int main(int argc, char *argv[])
     bool build_index = false;
     bool fifosync = false;
     bool mpeg2 = false;
+    bool smartcut = false;
     bool fifo_info = false;
     bool cleanCut = false;
     frm_dir_map_t deleteMap;
@@ -340,6 +342,8 @@ int main(int argc, char *argv[])
         recorderOptions = cmdline.toString("recopt");
     if (cmdline.toBool("mpeg2"))
         mpeg2 = true;
+    if (cmdline.toBool("smartcut"))
+        smartcut = mpeg2 = true;
     if (cmdline.toBool("ostream"))
     {
         if (cmdline.toString("ostream") == "dvd")
@@ -630,61 +634,94 @@ int main(int argc, char *argv[])
            check_func = &CheckJobQueue;
         }
 
-        auto *m2f = new MPEG2fixup(infile, outfile,
-                                         &deleteMap, nullptr, false, false, 20,
-                                         showprogress, otype, update_func,
-                                         check_func);
-
-        if (cmdline.toBool("allaudio"))
+        // H.264 and HEVC can't be fixed up, cut them on GOP boundaries.
+        // The output is always a transport stream, so only when asked to.
+        bool cut = !build_index && smartcut && SmartCutter::CanCut(infile);
+        if (!build_index && smartcut && !cut)
         {
-            m2f->SetAllAudio(true);
+            LOG(VB_GENERAL, LOG_WARNING,
+                "Smart cutting is not possible, using a lossless transcode");
         }
-
-        if (build_index)
+        if (cut)
         {
-            int err = BuildKeyframeIndex(m2f, infile, posMap, durMap, jobID);
-            if (err)
+            frm_pos_map_t inDurMap;
+            pginfo->QueryPositionMap(inDurMap, MARK_DURATION_MS);
+            SmartCutter cutter(infile, outfile, deleteMap, inDurMap,
+                               showprogress, update_func, check_func);
+            result = cutter.Start();
+            if (result == REENCODE_OK)
             {
-                delete m2f;
-                m2f = nullptr;
-                return err;
+                posMap = cutter.GetPositionMap();
+                durMap = cutter.GetDurationMap();
+                if (update_index)
+                    UpdatePositionMap(posMap, durMap, nullptr, pginfo);
+                else
+                    UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                      pginfo);
+                RecordingInfo recInfo(*pginfo);
+                RecordingFile *recFile = recInfo.GetRecordingFile();
+                recFile->m_containerFormat = formatMPEG2_TS;
+                recFile->Save();
             }
-            if (update_index)
-                UpdatePositionMap(posMap, durMap, nullptr, pginfo);
-            else
-                UpdatePositionMap(posMap, durMap, outfile + QString(".map"), pginfo);
         }
         else
         {
-            result = m2f->Start();
-            if (result == REENCODE_OK)
+            auto *m2f = new MPEG2fixup(infile, outfile,
+                                             &deleteMap, nullptr, false, false, 20,
+                                             showprogress, otype, update_func,
+                                             check_func);
+
+            if (cmdline.toBool("allaudio"))
             {
-                result = BuildKeyframeIndex(m2f, outfile, posMap, durMap, jobID);
-                if (result == REENCODE_OK)
-                {
-                    if (update_index)
-                        UpdatePositionMap(posMap, durMap, nullptr, pginfo);
-                    else
-                        UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
-                                          pginfo);
-                }
-                RecordingInfo recInfo(*pginfo);
-                RecordingFile *recFile = recInfo.GetRecordingFile();
-                if (otype == REPLEX_DVD || otype == REPLEX_MPEG2 ||
-                    otype == REPLEX_HDTV)
+                m2f->SetAllAudio(true);
+            }
+
+            if (build_index)
+            {
+                int err = BuildKeyframeIndex(m2f, infile, posMap, durMap, jobID);
+                if (err)
                 {
-                    recFile->m_containerFormat = formatMPEG2_PS;
-                    JobQueue::ChangeJobArgs(jobID, "RENAME_TO_MPG");
+                    delete m2f;
+                    m2f = nullptr;
+                    return err;
                 }
+                if (update_index)
+                    UpdatePositionMap(posMap, durMap, nullptr, pginfo);
                 else
+                    UpdatePositionMap(posMap, durMap, outfile + QString(".map"), pginfo);
+            }
+            else
+            {
+                result = m2f->Start();
+                if (result == REENCODE_OK)
                 {
-                    recFile->m_containerFormat = formatMPEG2_TS;
+                    result = BuildKeyframeIndex(m2f, outfile, posMap, durMap, jobID);
+                    if (result == REENCODE_OK)
+                    {
+                        if (update_index)
+                            UpdatePositionMap(posMap, durMap, nullptr, pginfo);
+                        else
+                            UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                              pginfo);
+                    }
+                    RecordingInfo recInfo(*pginfo);
+                    RecordingFile *recFile = recInfo.GetRecordingFile();
+                    if (otype == REPLEX_DVD || otype == REPLEX_MPEG2 ||
+                        otype == REPLEX_HDTV)
+                    {
+                        recFile->m_containerFormat = formatMPEG2_PS;
+                        JobQueue::ChangeJobArgs(jobID, "RENAME_TO_MPG");
+                    }
+                    else
+                    {
+                        recFile->m_containerFormat = formatMPEG2_TS;
+                    }
+                    recFile->Save();
                 }
-                recFile->Save();
             }
+            delete m2f;
+            m2f = nullptr;
         }
-        delete m2f;
-        m2f = nullptr;
     }
 
     if (result == REENCODE_OK)
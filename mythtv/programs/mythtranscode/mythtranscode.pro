@@ -16,20 +16,21 @@ QMAKE_CFLAGS += -w
 macx: QMAKE_CFLAGS -= -O3 -O2 -O1 -Os
 
 # Input
-SOURCES += mythtranscode.cpp transcode.cpp mpeg2fix.cpp
+SOURCES += mythtranscode.cpp transcode.cpp mpeg2fix.cpp transcodepipeline.cpp
 SOURCES += audioreencodebuffer.cpp cutter.cpp videodecodebuffer.cpp
 SOURCES += mythtranscode_commandlineparser.cpp
 SOURCES += external/replex/element.cpp external/replex/mpg_common.cpp
 SOURCES += external/replex/multiplex.cpp external/replex/pes.cpp
 SOURCES += external/replex/ringbuffer.cpp external/replex/ts.cpp
-SOURCES += mythtranscodeplayer.cpp
+SOURCES += mythtranscodeplayer.cpp smartcutter.cpp
 
 HEADERS += mpeg2fix.h transcodedefs.h mythtranscode_commandlineparser.h
+HEADERS += transcodepipeline.h
 HEADERS += audioreencodebuffer.h cutter.h videodecodebuffer.h
 HEADERS += external/replex/element.h external/replex/mpg_common.h
 HEADERS += external/replex/multiplex.h external/replex/pes.h
 HEADERS += external/replex/ringbuffer.h external/replex/ts.h
-HEADERS += mythtranscodeplayer.h
+HEADERS += mythtranscodeplayer.h smartcutter.h
 
 DEPENDPATH += external/replex
 
@@ -37,6 +37,13 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
     add(QStringList{"-m", "--mpeg2"}, "mpeg2", false,
             "Specifies that a lossless transcode should be used.", "")
         ->SetGroup("Encoding");
+    add("--smartcut", "smartcut", false,
+            "Apply the cutlist to H.264/HEVC video by copying whole GOPs "
+            "and re-encoding only the GOPs at the cut points.",
+            "Implies --mpeg2. The output is always an MPEG-TS, whatever "
+            "--ostream says, and all audio streams are kept. Other video "
+            "is transcoded losslessly as with --mpeg2.")
+        ->SetGroup("Encoding");
     add(QStringList{"-e", "--ostream"}, "ostream", "",
             "Output stream type: ps, dvd, ts (Default: ps)", "")
         ->SetGroup("Encoding");
@@ -0,0 +1,868 @@
+// C++
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// MythTV
+#include "libmythbase/mythdate.h"
+#include "libmythbase/mythlogging.h"
+
+// MythTranscode
+#include "smartcutter.h"
+#include "transcodedefs.h"
+
+extern "C"
+{
+#include "libavutil/opt.h"
+}
+
+#define LOC QString("SmartCutter: ")
+
+namespace
+{
+/// Quality of the re-encoded frames around the cuts (x264/x265 CRF).
+constexpr const char *kRenderCRF    = "18";
+constexpr const char *kRenderPreset = "fast";
+/// Longest GOP expected; the re-encoded part of a GOP never needs another IDR.
+constexpr int kRenderGopSize = 600;
+/// Timestamp jumps beyond these are wraps or discontinuities, not gaps
+constexpr int64_t kMaxBackwardMs = 1000;
+constexpr int64_t kMaxForwardMs  = 10000;
+
+const AVCodec *find_encoder(AVCodecID id)
+{
+    const AVCodec *codec = avcodec_find_encoder_by_name(
+        id == AV_CODEC_ID_HEVC ? "libx265" : "libx264");
+    return codec ? codec : avcodec_find_encoder(id);
+}
+
+bool is_cuttable(AVCodecID id)
+{
+    return id == AV_CODEC_ID_H264 || id == AV_CODEC_ID_HEVC;
+}
+}
+
+SmartCutter::SmartCutter(QString inputFile, QString outputFile,
+                         frm_dir_map_t deleteMap, frm_pos_map_t durationMap,
+                         bool showProgress,
+                         void (*update_func)(float), int (*check_func)())
+  : m_inputFile(std::move(inputFile)),
+    m_outputFile(std::move(outputFile)),
+    m_deleteMap(std::move(deleteMap)),
+    m_inDurMap(std::move(durationMap)),
+    m_showProgress(showProgress),
+    m_updateStatus(update_func),
+    m_checkAbort(check_func)
+{
+}
+
+SmartCutter::~SmartCutter()
+{
+    Close();
+}
+
+bool SmartCutter::CanCut(const QString &inputFile)
+{
+    QByteArray fname = inputFile.toLocal8Bit();
+    AVFormatContext *ctx = nullptr;
+    if (avformat_open_input(&ctx, fname.constData(), nullptr, nullptr) < 0)
+        return false;
+
+    bool ok = false;
+    if (avformat_find_stream_info(ctx, nullptr) >= 0)
+    {
+        int index = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                        nullptr, 0);
+        if (index >= 0)
+        {
+            AVCodecID id = ctx->streams[index]->codecpar->codec_id;
+            ok = is_cuttable(id) && avcodec_find_decoder(id) &&
+                 find_encoder(id);
+            if (is_cuttable(id) && !ok)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("No %1 encoder available, can't smart cut")
+                        .arg(avcodec_get_name(id)));
+            }
+        }
+    }
+    avformat_close_input(&ctx);
+    return ok;
+}
+
+bool SmartCutter::OpenInput(void)
+{
+    QByteArray fname = m_inputFile.toLocal8Bit();
+    int ret = avformat_open_input(&m_inputFC, fname.constData(), nullptr, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open input file, error #%1").arg(ret));
+        return false;
+    }
+    ret = avformat_find_stream_info(m_inputFC, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info, error #%1").arg(ret));
+        return false;
+    }
+
+    m_videoIndex = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                       nullptr, 0);
+    if (m_videoIndex < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream");
+        return false;
+    }
+    const AVStream *vst = m_inputFC->streams[m_videoIndex];
+    if (!is_cuttable(vst->codecpar->codec_id))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Can't cut %1 video")
+            .arg(avcodec_get_name(vst->codecpar->codec_id)));
+        return false;
+    }
+
+    m_videoTB = vst->time_base;
+    m_frameRate = vst->avg_frame_rate.num ? vst->avg_frame_rate
+                                          : vst->r_frame_rate;
+    if (!m_frameRate.num || !m_frameRate.den)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unknown video frame rate");
+        return false;
+    }
+    m_frameTicks = std::max<int64_t>(
+        1, av_rescale_q(1, av_inv_q(m_frameRate), m_videoTB));
+
+    const AVCodec *codec = avcodec_find_decoder(vst->codecpar->codec_id);
+    m_decoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!m_decoder ||
+        avcodec_parameters_to_context(m_decoder, vst->codecpar) < 0)
+        return false;
+    // Frames after a non-IDR keyframe are fine, we never start elsewhere
+    m_decoder->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
+    m_decoder->pkt_timebase = m_videoTB;
+    if (avcodec_open2(m_decoder, codec, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the video decoder");
+        return false;
+    }
+
+    // Matroska stores length prefixed NAL units, MPEG-TS needs start codes
+    const AVCodecParameters *par = vst->codecpar;
+    if (par->extradata_size > 0 && par->extradata[0] == 1)
+    {
+        const AVBitStreamFilter *bsf = av_bsf_get_by_name(
+            par->codec_id == AV_CODEC_ID_HEVC ? "hevc_mp4toannexb"
+                                              : "h264_mp4toannexb");
+        if (!bsf || av_bsf_alloc(bsf, &m_annexB) < 0 ||
+            avcodec_parameters_copy(m_annexB->par_in, par) < 0)
+            return false;
+        m_annexB->time_base_in = m_videoTB;
+        if (av_bsf_init(m_annexB) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't set up Annex B conversion");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SmartCutter::OpenOutput(void)
+{
+    QByteArray fname = m_outputFile.toLocal8Bit();
+    if (avformat_alloc_output_context2(&m_outputFC, nullptr, "mpegts",
+                                       fname.constData()) < 0)
+        return false;
+
+    m_streamMap.assign(m_inputFC->nb_streams, -1);
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        const AVStream *ist = m_inputFC->streams[i];
+        const AVCodecParameters *par = ist->codecpar;
+        const bool video = static_cast<int>(i) == m_videoIndex;
+        if (!video && par->codec_type != AVMEDIA_TYPE_AUDIO &&
+            par->codec_type != AVMEDIA_TYPE_SUBTITLE)
+            continue;
+        if (!video && avformat_query_codec(m_outputFC->oformat, par->codec_id,
+                                           FF_COMPLIANCE_NORMAL) != 1)
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC + QString("Dropping %1 stream %2")
+                .arg(avcodec_get_name(par->codec_id)).arg(i));
+            continue;
+        }
+
+        AVStream *ost = avformat_new_stream(m_outputFC, nullptr);
+        if (!ost ||
+            avcodec_parameters_copy(ost->codecpar,
+                                    (video && m_annexB) ? m_annexB->par_out : par) < 0)
+            return false;
+        ost->codecpar->codec_tag = 0;
+        ost->time_base = ist->time_base;
+        ost->disposition = ist->disposition;
+        av_dict_copy(&ost->metadata, ist->metadata, 0);
+        m_streamMap[i] = ost->index;
+    }
+    m_lastDts.assign(m_outputFC->nb_streams, AV_NOPTS_VALUE);
+    m_timelines.assign(m_inputFC->nb_streams, {});
+
+    int ret = avio_open(&m_outputFC->pb, fname.constData(), AVIO_FLAG_WRITE);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open output file, error #%1").arg(ret));
+        return false;
+    }
+    ret = avformat_write_header(m_outputFC, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't write output header, error #%1").arg(ret));
+        return false;
+    }
+    return true;
+}
+
+void SmartCutter::Close(void)
+{
+    for (auto & gop : m_gops)
+    {
+        for (AVPacket *pkt : gop.m_packets)
+            av_packet_free(&pkt);
+    }
+    m_gops.clear();
+
+    av_packet_free(&m_packet);
+    av_frame_free(&m_frame);
+    avcodec_free_context(&m_encoder);
+    avcodec_free_context(&m_decoder);
+    av_bsf_free(&m_annexB);
+    if (m_outputFC)
+    {
+        if (m_outputFC->pb)
+            avio_closep(&m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+        m_outputFC = nullptr;
+    }
+    avformat_close_input(&m_inputFC);
+}
+
+/**
+ *  Shift the timestamps of a packet so that its stream's timeline carries
+ *  on across a timestamp wrap or discontinuity, as if it had not happened.
+ */
+void SmartCutter::Unwrap(AVPacket *pkt)
+{
+    const AVStream *st = m_inputFC->streams[pkt->stream_index];
+    Timeline &line = m_timelines[pkt->stream_index];
+    int64_t ts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+    if (ts == AV_NOPTS_VALUE)
+        return;
+
+    ts += line.m_offset;
+    if (line.m_last != AV_NOPTS_VALUE)
+    {
+        int64_t jump = av_rescale_q(ts - line.m_last, st->time_base, {1, 1000});
+        if (jump < -kMaxBackwardMs || jump > kMaxForwardMs)
+        {
+            int64_t step = pkt->duration > 0 ? pkt->duration :
+                (pkt->stream_index == m_videoIndex) ? m_frameTicks : 1;
+            int64_t shift = line.m_last + step - ts;
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Stream %1 timestamps jump by %2 ms, closing the gap")
+                    .arg(pkt->stream_index).arg(jump));
+            line.m_offset += shift;
+            ts += shift;
+        }
+    }
+    line.m_last = ts;
+
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts += line.m_offset;
+    if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts += line.m_offset;
+}
+
+/**
+ *  The video timestamp of a frame of the recording, from the duration map
+ *  of the recording where possible. Frame 0 is the first keyframe, which
+ *  is where playback of the recording starts.
+ */
+int64_t SmartCutter::FrameToPts(long long frame) const
+{
+    // Interpolate from the last keyframe at or before the frame
+    auto it = m_inDurMap.upperBound(frame);
+    long long base = 0;
+    int64_t baseMs = 0;
+    if (it != m_inDurMap.cbegin())
+    {
+        --it;
+        base = it.key();
+        baseMs = *it;
+    }
+    int64_t offset = av_rescale_q(static_cast<int64_t>(frame - base),
+                                  av_inv_q(m_frameRate), m_videoTB);
+    return m_firstPts + av_rescale_q(baseMs, {1, 1000}, m_videoTB) + offset;
+}
+
+/// Convert the cutlist from frame numbers to video timestamps.
+void SmartCutter::BuildCutList(void)
+{
+    m_cuts.clear();
+    bool inCut = false;
+    int64_t cutStart = m_firstPts;
+    for (auto it = m_deleteMap.cbegin(); it != m_deleteMap.cend(); ++it)
+    {
+        int64_t pts = FrameToPts(static_cast<long long>(it.key()));
+        if (*it == MARK_CUT_START && !inCut)
+        {
+            cutStart = pts;
+            inCut = true;
+        }
+        else if (*it == MARK_CUT_END)
+        {
+            // A cut without a start runs from the beginning
+            if (pts > cutStart)
+                m_cuts.emplace_back(cutStart, pts);
+            inCut = false;
+        }
+    }
+    if (inCut)
+        m_cuts.emplace_back(cutStart, INT64_MAX);
+
+    for (const auto & cut : m_cuts)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Cutting %1 - %2")
+            .arg((cut.first - m_firstPts) * av_q2d(m_videoTB), 0, 'f', 2)
+            .arg(cut.second == INT64_MAX ? QString("end") :
+                 QString::number((cut.second - m_firstPts) * av_q2d(m_videoTB),
+                                 'f', 2)));
+    }
+}
+
+bool SmartCutter::IsKept(int64_t pts) const
+{
+    if (pts == AV_NOPTS_VALUE || pts < m_firstPts)
+        return false;
+    return std::none_of(m_cuts.cbegin(), m_cuts.cend(),
+                        [pts](const auto & cut)
+                        { return pts >= cut.first && pts < cut.second; });
+}
+
+/// Total length of the cuts before \p pts, in video timestamp units.
+int64_t SmartCutter::Removed(int64_t pts) const
+{
+    int64_t removed = 0;
+    for (const auto & cut : m_cuts)
+    {
+        if (pts <= cut.first)
+            break;
+        removed += std::min(pts, cut.second) - cut.first;
+    }
+    return removed;
+}
+
+SmartCutter::Action SmartCutter::Classify(int64_t start, int64_t end) const
+{
+    int64_t cut = 0;
+    for (const auto & range : m_cuts)
+        cut += std::max<int64_t>(0, std::min(end, range.second) -
+                                    std::max(start, range.first));
+    if (cut == 0)
+        return kCopy;
+    if (cut >= end - start)
+        return kDrop;
+    return kRender;
+}
+
+int SmartCutter::Start(void)
+{
+    if (!OpenInput() || !OpenOutput())
+    {
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+    if (!m_packet || !m_frame)
+    {
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Cutting %1 video from %2")
+        .arg(QString(avcodec_get_name(m_decoder->codec_id)), m_inputFile));
+
+    const int64_t fileSize = avio_size(m_inputFC->pb);
+    const int updateSecs = m_updateStatus ? 20 : 5;
+    m_statusTime = MythDate::current().addSecs(updateSecs);
+    if (m_updateStatus)
+        m_updateStatus(0);
+
+    int result = REENCODE_OK;
+    while (result == REENCODE_OK && av_read_frame(m_inputFC, m_packet) >= 0)
+    {
+        const int index = m_packet->stream_index;
+        if (index < 0 || index >= static_cast<int>(m_streamMap.size()) ||
+            m_streamMap[index] < 0)
+        {
+            av_packet_unref(m_packet);
+            continue;
+        }
+
+        Unwrap(m_packet);
+
+        if (index == m_videoIndex)
+        {
+            const int64_t pts = m_packet->pts;
+            if (pts != AV_NOPTS_VALUE && m_packet->dts != AV_NOPTS_VALUE)
+                m_videoDelay = std::max(m_videoDelay, pts - m_packet->dts);
+            if (pts != AV_NOPTS_VALUE &&
+                (m_lastPts == AV_NOPTS_VALUE || pts > m_lastPts))
+                m_lastPts = pts;
+
+            if ((m_packet->flags & AV_PKT_FLAG_KEY) && pts != AV_NOPTS_VALUE)
+            {
+                if (m_firstPts == AV_NOPTS_VALUE)
+                {
+                    m_firstPts = pts;
+                    BuildCutList();
+                }
+                // The oldest GOP can be written once the one after it is complete
+                if (m_gops.size() >= 2 && !ProcessGop())
+                    result = REENCODE_ERROR;
+                m_gops.emplace_back();
+                m_gops.back().m_keyPts = pts;
+            }
+            else if (m_gops.empty())
+            {
+                // Nothing before the first keyframe can be decoded
+                av_packet_unref(m_packet);
+                continue;
+            }
+            else if (pts != AV_NOPTS_VALUE && pts < m_gops.back().m_keyPts)
+            {
+                m_gops.back().m_open = true;
+            }
+        }
+        else if (m_gops.empty())
+        {
+            av_packet_unref(m_packet);
+            continue;
+        }
+
+        AVPacket *pkt = av_packet_alloc();
+        if (!pkt)
+        {
+            result = REENCODE_ERROR;
+            break;
+        }
+        av_packet_move_ref(pkt, m_packet);
+        m_gops.back().m_packets.push_back(pkt);
+
+        if ((m_showProgress || m_updateStatus) &&
+            MythDate::current() > m_statusTime)
+        {
+            float percent_done = fileSize > 0 ?
+                100.0F * avio_tell(m_inputFC->pb) / fileSize : 0.0F;
+            if (m_updateStatus)
+                m_updateStatus(percent_done);
+            if (m_showProgress)
+                LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                        .arg(percent_done, 0, 'f', 1));
+            if (m_checkAbort && m_checkAbort())
+                result = REENCODE_STOPPED;
+            m_statusTime = MythDate::current().addSecs(updateSecs);
+        }
+    }
+
+    while (result == REENCODE_OK && !m_gops.empty())
+    {
+        if (!ProcessGop())
+            result = REENCODE_ERROR;
+    }
+
+    if (result == REENCODE_OK)
+    {
+        if (m_videoCount == 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "No video was written");
+            result = REENCODE_ERROR;
+        }
+        else if (av_write_trailer(m_outputFC) < 0)
+        {
+            result = REENCODE_ERROR;
+        }
+        else
+        {
+            BuildIndex();
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Copied %1 GOPs, re-encoded %2 frames in %3 GOPs")
+                    .arg(m_copiedGops).arg(m_encodedFrames).arg(m_renderedGops));
+        }
+    }
+
+    Close();
+    return result;
+}
+
+/**
+ *  Build the seek table and duration map of the output. Keyframes are
+ *  numbered by their place among the frames written in display order, the
+ *  way a player counts them, not by the order they were written in.
+ */
+void SmartCutter::BuildIndex(void)
+{
+    m_posMap.clear();
+    m_durMap.clear();
+    if (m_writtenPts.empty())
+        return;
+
+    std::sort(m_writtenPts.begin(), m_writtenPts.end());
+    const int64_t start = m_writtenPts.front();
+    for (const auto & [pts, pos] : m_keyframes)
+    {
+        auto frame = std::distance(m_writtenPts.cbegin(),
+            std::lower_bound(m_writtenPts.cbegin(), m_writtenPts.cend(), pts));
+        m_posMap[frame] = pos;
+        m_durMap[frame] = av_rescale_q(pts - start, m_videoTB, {1, 1000});
+    }
+}
+
+/**
+ *  Write out the oldest buffered GOP.
+ *
+ *  The frames displayed between this keyframe and the next one are "its"
+ *  frames, so it includes the leading pictures of the next GOP (which come
+ *  after the next keyframe in decode order, and refer to it), but not its
+ *  own. Those belong to the previous GOP, and are copied if it was.
+ */
+bool SmartCutter::ProcessGop(void)
+{
+    Gop &gop = m_gops.front();
+    const Gop *next = m_gops.size() > 1 ? &m_gops[1] : nullptr;
+    const int64_t end = next ? next->m_keyPts : m_lastPts + m_frameTicks;
+
+    gop.m_action = Classify(gop.m_keyPts, end);
+    // Copied leading pictures of the next GOP need its keyframe too
+    if (gop.m_action == kCopy && next && next->m_open &&
+        !IsKept(next->m_keyPts))
+        gop.m_action = kRender;
+    const bool keyCopied = gop.m_action == kCopy ||
+        (gop.m_action == kRender && IsKept(gop.m_keyPts));
+
+    bool ok = true;
+    bool first = true;
+    for (const AVPacket *pkt : gop.m_packets)
+    {
+        if (!ok)
+            break;
+        if (pkt->stream_index != m_videoIndex)
+        {
+            const AVStream *st = m_inputFC->streams[pkt->stream_index];
+            int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            if (pts != AV_NOPTS_VALUE &&
+                IsKept(av_rescale_q(pts, st->time_base, m_videoTB)))
+                ok = WriteOther(pkt);
+            continue;
+        }
+
+        bool copy = false;
+        if (first)
+            copy = keyCopied;
+        else if (pkt->pts != AV_NOPTS_VALUE && pkt->pts < gop.m_keyPts)
+            copy = m_prevAction == kCopy;
+        else
+            copy = gop.m_action == kCopy;
+        first = false;
+        if (copy)
+            ok = WriteVideo(pkt, false);
+    }
+
+    if (ok && gop.m_action == kRender)
+        ok = RenderGop(gop, next, end, keyCopied);
+
+    if (gop.m_action == kCopy)
+        m_copiedGops++;
+    else if (gop.m_action == kRender)
+        m_renderedGops++;
+    m_prevAction = gop.m_action;
+
+    for (AVPacket *pkt : gop.m_packets)
+        av_packet_free(&pkt);
+    m_gops.pop_front();
+    return ok;
+}
+
+/**
+ *  Decode the GOP and re-encode the frames that are kept, up to \p end.
+ *  Decoding starts at the keyframe, and continues with the keyframe and
+ *  leading pictures of the next GOP, which are displayed before \p end.
+ */
+bool SmartCutter::RenderGop(const Gop &gop, const Gop *next, int64_t end,
+                            bool keyCopied)
+{
+    std::vector<const AVPacket*> feed;
+    bool first = true;
+    for (const AVPacket *pkt : gop.m_packets)
+    {
+        if (pkt->stream_index != m_videoIndex)
+            continue;
+        if (first || pkt->pts == AV_NOPTS_VALUE || pkt->pts >= gop.m_keyPts)
+            feed.push_back(pkt);
+        first = false;
+    }
+    if (next)
+    {
+        first = true;
+        for (const AVPacket *pkt : next->m_packets)
+        {
+            if (pkt->stream_index != m_videoIndex)
+                continue;
+            if (!first && (pkt->pts == AV_NOPTS_VALUE || pkt->pts >= next->m_keyPts))
+                break;
+            feed.push_back(pkt);
+            first = false;
+        }
+    }
+
+    auto receive = [&]()
+    {
+        while (avcodec_receive_frame(m_decoder, m_frame) == 0)
+        {
+            int64_t pts = m_frame->best_effort_timestamp;
+            bool wanted = pts != AV_NOPTS_VALUE && pts >= gop.m_keyPts &&
+                pts < end && !(keyCopied && pts == gop.m_keyPts) && IsKept(pts);
+            if (wanted)
+            {
+                m_frame->pts = pts;
+                m_frame->pict_type = AV_PICTURE_TYPE_NONE;
+                if ((!m_encoder && !OpenEncoder(m_frame)) || !Encode(m_frame))
+                {
+                    av_frame_unref(m_frame);
+                    return false;
+                }
+            }
+            av_frame_unref(m_frame);
+        }
+        return true;
+    };
+
+    bool ok = true;
+    for (const AVPacket *pkt : feed)
+    {
+        if (avcodec_send_packet(m_decoder, pkt) < 0)
+            LOG(VB_GENERAL, LOG_WARNING, LOC + "Error decoding a frame");
+        if (!receive())
+        {
+            ok = false;
+            break;
+        }
+    }
+    if (ok)
+    {
+        avcodec_send_packet(m_decoder, nullptr);
+        ok = receive();
+    }
+    avcodec_flush_buffers(m_decoder);
+
+    if (m_encoder)
+    {
+        if (ok)
+            ok = Encode(nullptr);
+        avcodec_free_context(&m_encoder);
+    }
+    return ok;
+}
+
+bool SmartCutter::OpenEncoder(const AVFrame *frame)
+{
+    const AVCodec *codec = find_encoder(m_decoder->codec_id);
+    m_encoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!m_encoder)
+        return false;
+
+    m_encoder->width = frame->width;
+    m_encoder->height = frame->height;
+    m_encoder->pix_fmt = static_cast<AVPixelFormat>(frame->format);
+    m_encoder->sample_aspect_ratio = frame->sample_aspect_ratio;
+    m_encoder->color_range = frame->color_range;
+    m_encoder->color_primaries = frame->color_primaries;
+    m_encoder->color_trc = frame->color_trc;
+    m_encoder->colorspace = frame->colorspace;
+    m_encoder->chroma_sample_location = frame->chroma_location;
+    m_encoder->time_base = m_videoTB;
+    m_encoder->framerate = m_frameRate;
+    m_encoder->profile = m_decoder->profile;
+    // No reordering, so the timestamps of the copied GOPs can be kept
+    m_encoder->max_b_frames = 0;
+    m_encoder->gop_size = kRenderGopSize;
+    if (frame->flags & AV_FRAME_FLAG_INTERLACED)
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_INTERLACED_DCT |
+                            AV_CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = (frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST)
+            ? AV_FIELD_TT : AV_FIELD_BB;
+    }
+
+    AVDictionary *opts = nullptr;
+    av_dict_set(&opts, "preset", kRenderPreset, 0);
+    av_dict_set(&opts, "crf", kRenderCRF, 0);
+    int ret = avcodec_open2(m_encoder, codec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+    {
+        // The profile of the source may not be one the encoder can do
+        m_encoder->profile = AV_PROFILE_UNKNOWN;
+        ret = avcodec_open2(m_encoder, codec, nullptr);
+    }
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the %1 encoder, error #%2")
+                .arg(codec->name).arg(ret));
+        avcodec_free_context(&m_encoder);
+        return false;
+    }
+    return true;
+}
+
+bool SmartCutter::Encode(const AVFrame *frame)
+{
+    if (avcodec_send_frame(m_encoder, frame) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Error encoding a frame");
+        return false;
+    }
+    if (frame)
+        m_encodedFrames++;
+
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt)
+        return false;
+    bool ok = true;
+    while (ok && avcodec_receive_packet(m_encoder, pkt) == 0)
+    {
+        ok = WriteVideo(pkt, true);
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    return ok;
+}
+
+/**
+ *  Write a copied or re-encoded video packet, with the cuts taken out of
+ *  its timestamps, and note it in the seek table if it is a keyframe.
+ */
+bool SmartCutter::WriteVideo(const AVPacket *in, bool encoded)
+{
+    AVPacket *pkt = av_packet_clone(in);
+    if (!pkt)
+        return false;
+
+    if (!encoded && m_annexB)
+    {
+        if (av_bsf_send_packet(m_annexB, pkt) < 0 ||
+            av_bsf_receive_packet(m_annexB, pkt) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Annex B conversion failed");
+            av_packet_free(&pkt);
+            return false;
+        }
+    }
+
+    const int64_t ref = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (ref == AV_NOPTS_VALUE)
+    {
+        av_packet_free(&pkt);
+        return true;
+    }
+    const int64_t removed = Removed(ref);
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts -= removed;
+    // Re-encoded frames are in display order, give them the source's delay
+    if (encoded || pkt->dts == AV_NOPTS_VALUE)
+        pkt->dts = ref - removed - m_videoDelay;
+    else
+        pkt->dts -= removed;
+
+    const int out = m_streamMap[m_videoIndex];
+    int64_t &lastDts = m_lastDts[out];
+    if (lastDts != AV_NOPTS_VALUE && pkt->dts <= lastDts)
+        pkt->dts = lastDts + 1;
+    if (pkt->pts != AV_NOPTS_VALUE && pkt->dts > pkt->pts)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Dropping video frame at %1, no room for it")
+                .arg(pkt->pts * av_q2d(m_videoTB), 0, 'f', 3));
+        av_packet_free(&pkt);
+        return true;
+    }
+    lastDts = pkt->dts;
+
+    // Second fields carry no pts of their own, they are part of a frame.
+    // The interleaver may still be holding packets that go out before this
+    // one, so the position of a keyframe is where it starts at the earliest.
+    if (pkt->pts != AV_NOPTS_VALUE)
+    {
+        if (pkt->flags & AV_PKT_FLAG_KEY)
+            m_keyframes.emplace_back(pkt->pts, avio_tell(m_outputFC->pb));
+        m_writtenPts.push_back(pkt->pts);
+    }
+    m_videoCount++;
+
+    pkt->stream_index = out;
+    av_packet_rescale_ts(pkt, m_videoTB, m_outputFC->streams[out]->time_base);
+    int ret = av_interleaved_write_frame(m_outputFC, pkt);
+    av_packet_free(&pkt);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Error writing video, error #%1").arg(ret));
+        return false;
+    }
+    return true;
+}
+
+bool SmartCutter::WriteOther(const AVPacket *in)
+{
+    const AVRational tb = m_inputFC->streams[in->stream_index]->time_base;
+    const int out = m_streamMap[in->stream_index];
+    AVPacket *pkt = av_packet_clone(in);
+    if (!pkt)
+        return false;
+
+    const int64_t ref = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    const int64_t removed = av_rescale_q(
+        Removed(av_rescale_q(ref, tb, m_videoTB)), m_videoTB, tb);
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts -= removed;
+    if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts -= removed;
+
+    // Audio either side of a cut may overlap by part of a frame
+    int64_t &lastDts = m_lastDts[out];
+    if (pkt->dts != AV_NOPTS_VALUE)
+    {
+        if (lastDts != AV_NOPTS_VALUE && pkt->dts <= lastDts)
+        {
+            av_packet_free(&pkt);
+            return true;
+        }
+        lastDts = pkt->dts;
+    }
+
+    pkt->stream_index = out;
+    av_packet_rescale_ts(pkt, tb, m_outputFC->streams[out]->time_base);
+    int ret = av_interleaved_write_frame(m_outputFC, pkt);
+    av_packet_free(&pkt);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Error writing stream %1, error #%2")
+                .arg(in->stream_index).arg(ret));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,144 @@
+#ifndef SMARTCUTTER_H
+#define SMARTCUTTER_H
+
+// C++
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QDateTime>
+#include <QString>
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+#include "libavcodec/bsf.h"
+#include "libavformat/avformat.h"
+}
+
+// MythTV
+#include "libmythbase/programtypes.h"
+
+/** \class SmartCutter
+ *  \brief Applies a cutlist to an H.264 or HEVC recording (MPEG-TS or
+ *         Matroska) without re-encoding all of it.
+ *
+ *  The video is handled one GOP at a time. A GOP whose frames are all kept
+ *  is copied as is, one whose frames are all cut is dropped, and only the
+ *  GOPs that a cut starts or ends in are decoded and re-encoded, starting
+ *  with an IDR frame. Audio and subtitle packets are copied if they fall
+ *  between the cuts. The output is always an MPEG-TS, and its seek table
+ *  is collected while it is written.
+ *
+ *  The cutlist is in frames as the recorder counted them, so it is turned
+ *  into times with the recording's duration map. Each stream's timestamps
+ *  are made continuous across wraps and discontinuities as they are read,
+ *  so those times can be compared with them.
+ */
+class SmartCutter
+{
+  public:
+    SmartCutter(QString inputFile, QString outputFile,
+                frm_dir_map_t deleteMap, frm_pos_map_t durationMap,
+                bool showProgress,
+                void (*update_func)(float) = nullptr,
+                int (*check_func)() = nullptr);
+    ~SmartCutter();
+
+    /// True if the video of \p inputFile can be cut by this class.
+    static bool CanCut(const QString &inputFile);
+
+    int Start(void);
+
+    const frm_pos_map_t &GetPositionMap(void) const { return m_posMap; }
+    const frm_pos_map_t &GetDurationMap(void) const { return m_durMap; }
+
+  private:
+    Q_DISABLE_COPY(SmartCutter)
+
+    enum Action : std::uint8_t
+    {
+        kCopy,      ///< all frames kept, copy the packets
+        kRender,    ///< some frames kept, re-encode them
+        kDrop,      ///< no frames kept
+    };
+
+    struct Timeline
+    {
+        int64_t                 m_offset  {0};
+        int64_t                 m_last    {AV_NOPTS_VALUE};
+    };
+
+    struct Gop
+    {
+        int64_t                 m_keyPts  {AV_NOPTS_VALUE};
+        bool                    m_open    {false};  ///< has leading pictures
+        Action                  m_action  {kCopy};
+        std::vector<AVPacket*>  m_packets;          ///< all streams
+    };
+
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    void Close(void);
+
+    void Unwrap(AVPacket *pkt);
+    int64_t FrameToPts(long long frame) const;
+    void BuildCutList(void);
+    void BuildIndex(void);
+    bool IsKept(int64_t pts) const;
+    int64_t Removed(int64_t pts) const;
+    Action Classify(int64_t start, int64_t end) const;
+
+    bool ProcessGop(void);
+    bool RenderGop(const Gop &gop, const Gop *next, int64_t end, bool keyCopied);
+    bool OpenEncoder(const AVFrame *frame);
+    bool Encode(const AVFrame *frame);
+    bool WriteVideo(const AVPacket *in, bool encoded);
+    bool WriteOther(const AVPacket *in);
+
+    QString                 m_inputFile;
+    QString                 m_outputFile;
+    frm_dir_map_t           m_deleteMap;
+    frm_pos_map_t           m_inDurMap;     ///< frame => ms of the input
+    bool                    m_showProgress  {false};
+    void                  (*m_updateStatus)(float) {nullptr};
+    int                   (*m_checkAbort)()        {nullptr};
+    QDateTime               m_statusTime;
+
+    AVFormatContext        *m_inputFC       {nullptr};
+    AVFormatContext        *m_outputFC      {nullptr};
+    std::vector<int>        m_streamMap;    ///< input => output stream
+    std::vector<Timeline>   m_timelines;    ///< per input stream
+    std::vector<int64_t>    m_lastDts;      ///< per output stream
+    int                     m_videoIndex    {-1};
+    AVRational              m_videoTB       {1, 90000};
+    AVRational              m_frameRate     {0, 1};
+    int64_t                 m_frameTicks    {0};
+    int64_t                 m_videoDelay    {0};
+    int64_t                 m_firstPts      {AV_NOPTS_VALUE};
+    int64_t                 m_lastPts       {AV_NOPTS_VALUE};
+    AVBSFContext           *m_annexB        {nullptr};
+    AVCodecContext         *m_decoder       {nullptr};
+    AVCodecContext         *m_encoder       {nullptr};
+    AVPacket               *m_packet        {nullptr};
+    AVFrame                *m_frame         {nullptr};
+
+                            /// cut ranges of video pts, [start, end)
+    std::vector<std::pair<int64_t,int64_t>> m_cuts;
+    std::deque<Gop>         m_gops;
+    Action                  m_prevAction    {kDrop};
+
+    frm_pos_map_t           m_posMap;
+    frm_pos_map_t           m_durMap;
+    std::vector<int64_t>    m_writtenPts;   ///< of every video frame written
+                            /// output pts and position of each keyframe
+    std::vector<std::pair<int64_t,int64_t>> m_keyframes;
+    long long               m_videoCount    {0};
+    long long               m_copiedGops    {0};
+    long long               m_renderedGops  {0};
+    long long               m_encodedFrames {0};
+};
+
+#endif // SMARTCUTTER_H
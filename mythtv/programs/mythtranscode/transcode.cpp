@@ -38,6 +38,7 @@
 #include "cutter.h"
 #include "mythtranscodeplayer.h"
 #include "transcode.h"
+#include "transcodepipeline.h"
 #include "videodecodebuffer.h"
 
 extern "C" {
@@ -143,13 +144,11 @@ int Transcode::TranscodeFile(const QString &inputname,
 {
     QDateTime curtime = MythDate::current();
     QDateTime statustime = curtime;
-    int audioFrame = 0;
     std::unique_ptr<Cutter> cutter = nullptr;
     std::unique_ptr<MythAVFormatWriter> avfw = nullptr;
     std::unique_ptr<MythAVFormatWriter> avfw2 = nullptr;
     std::unique_ptr<HTTPLiveStream> hls = nullptr;
     int hlsSegmentSize = 0;
-    int hlsSegmentFrames = 0;
 
     if (jobID >= 0)
         JobQueue::ChangeJobComment(jobID, "0% " + QObject::tr("Completed"));
@@ -709,6 +708,20 @@ int Transcode::TranscodeFile(const QString &inputname,
         new VideoDecodeBuffer(player, videoOutput, honorCutList);
     MThreadPool::globalInstance()->start(videoBuffer, "VideoDecodeBuffer");
 
+    // Scaling stays on this thread, encoding and muxing get their own
+    std::unique_ptr<TranscodePipeline> pipeline = nullptr;
+    if (m_avfMode)
+    {
+        pipeline = std::make_unique<TranscodePipeline>(
+            avfw.get(), avfw2.get(), hls.get(), hlsSegmentSize);
+        if (!pipeline->Start(newWidth, newHeight))
+        {
+            videoBuffer->stop();
+            SetPlayerContext(nullptr);
+            return REENCODE_ERROR;
+        }
+    }
+
     QElapsedTimer flagTime;
     flagTime.start();
 
@@ -885,51 +898,17 @@ int Transcode::TranscodeFile(const QString &inputname,
                         .arg(newWidth).arg(newHeight));
             }
 
-            if (rescale)
-            {
-                MythAVUtil::FillAVFrame(&imageIn, lastDecode);
-                MythAVUtil::FillAVFrame(&imageOut, &frame);
-
-                int bottomBand = (lastDecode->m_height == 1088) ? 8 : 0;
-                scontext = sws_getCachedContext(scontext,
-                               lastDecode->m_width, lastDecode->m_height, MythAVUtil::FrameTypeToPixelFormat(lastDecode->m_type),
-                               frame.m_width, frame.m_height, MythAVUtil::FrameTypeToPixelFormat(frame.m_type),
-                               SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-
-                sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
-                          lastDecode->m_height - bottomBand,
-                          imageOut.data, imageOut.linesize);
-            }
-
-            // audio is fully decoded, so we need to reencode it
+            // audio is fully decoded, so we need to reencode it, up to
+            // the last video frame the encoder has written
+            if (pipeline)
+                lastWrittenTime = pipeline->GetLastWrittenTime();
             AudioBuffer *ab = nullptr;
             while ((ab = arb->GetData(lastWrittenTime)) != nullptr)
             {
-                auto *buf = (unsigned char *)ab->data();
-                if (m_avfMode)
-                {
-                    if (did_ff != 1)
-                    {
-                        std::chrono::milliseconds tc = ab->m_time - timecodeOffset;
-                        avfw->WriteAudioFrame(buf, audioFrame, tc);
-
-                        if (avfw2)
-                        {
-                            if ((avfw2->GetTimecodeOffset() == -1ms) &&
-                                (avfw->GetTimecodeOffset() != -1ms))
-                            {
-                                avfw2->SetTimecodeOffset(
-                                    avfw->GetTimecodeOffset());
-                            }
-
-                            tc = ab->m_time - timecodeOffset;
-                            avfw2->WriteAudioFrame(buf, audioFrame, tc);
-                        }
-
-                        ++audioFrame;
-                    }
-                }
-                delete ab;
+                if (pipeline && did_ff != 1)
+                    pipeline->QueueAudio(ab, ab->m_time - timecodeOffset);
+                else
+                    delete ab;
             }
 
             if (!m_avfMode)
@@ -951,27 +930,33 @@ int Transcode::TranscodeFile(const QString &inputname,
                 {
                     skippedLastFrame = false;
 
-                    if ((hls) &&
-                        (avfw->GetFramesWritten()) &&
-                        (hlsSegmentFrames > hlsSegmentSize) &&
-                        (avfw->NextFrameIsKeyFrame()))
-                    {
-                        hls->AddSegment();
-                        avfw->ReOpen(hls->GetCurrentFilename());
-
-                        if (avfw2)
-                            avfw2->ReOpen(hls->GetCurrentFilename(true));
-
-                        hlsSegmentFrames = 0;
-                    }
-
-                    if (avfw->WriteVideoFrame(rescale ? &frame : lastDecode) > 0)
-                    {
-                        lastWrittenTime = frame.m_timecode + timecodeOffset;
-                        if (hls)
-                            ++hlsSegmentFrames;
-                    }
-
+                    // Waits for the video encoder to hand a frame back
+                    MythVideoFrame *out = pipeline->GetFreeFrame();
+                    if (!out)
+                        break;
+
+                    QElapsedTimer scaleTime;
+                    scaleTime.start();
+                    MythAVUtil::FillAVFrame(&imageIn, lastDecode);
+                    MythAVUtil::FillAVFrame(&imageOut, out);
+
+                    // Without rescaling this just copies the picture, so
+                    // the decoder can have its frame back straight away
+                    int bottomBand = (rescale && lastDecode->m_height == 1088) ? 8 : 0;
+                    scontext = sws_getCachedContext(scontext,
+                                   lastDecode->m_width, lastDecode->m_height, MythAVUtil::FrameTypeToPixelFormat(lastDecode->m_type),
+                                   out->m_width, out->m_height, MythAVUtil::FrameTypeToPixelFormat(out->m_type),
+                                   SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+                    sws_scale(scontext, imageIn.data, imageIn.linesize, 0,
+                              lastDecode->m_height - bottomBand,
+                              imageOut.data, imageOut.linesize);
+                    out->m_timecode = frame.m_timecode;
+                    out->m_frameNumber = frame.m_frameNumber;
+                    pipeline->FilterStats().Add(
+                        std::chrono::nanoseconds(scaleTime.nsecsElapsed()));
+
+                    pipeline->QueueVideo(out, frame.m_timecode + timecodeOffset);
                 }
             }
         }
@@ -1038,17 +1023,21 @@ int Transcode::TranscodeFile(const QString &inputname,
                 if (hls)
                     hls->UpdatePercentComplete(percentage);
 
+                QString stages;
+                if (pipeline)
+                    stages = " " + pipeline->StatsText(videoBuffer->GetStats());
+
                 if (jobID >= 0)
                 {
                     JobQueue::ChangeJobComment(jobID,
                               QObject::tr("%1% Completed @ %2 fps.")
-                                          .arg(percentage).arg(flagFPS));
+                                          .arg(percentage).arg(flagFPS) + stages);
                 }
                 else
                 {
                     LOG(VB_GENERAL, LOG_INFO,
                         QString("mythtranscode: %1% Completed @ %2 fps.")
-                            .arg(percentage).arg(flagFPS));
+                            .arg(percentage).arg(flagFPS) + stages);
                 }
 
             }
@@ -1065,6 +1054,9 @@ int Transcode::TranscodeFile(const QString &inputname,
 
     if (!m_fifow)
     {
+        if (pipeline)
+            pipeline->Finish();
+
         if (avfw)
             avfw->CloseFile();
 
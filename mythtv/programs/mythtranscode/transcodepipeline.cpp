@@ -0,0 +1,245 @@
+// C++
+#include <functional>
+
+// Qt
+#include <QElapsedTimer>
+#include <QObject>
+
+// MythTV
+#include "libmythbase/mythlogging.h"
+#include "libmythtv/HLS/httplivestream.h"
+#include "libmythtv/io/mythavformatwriter.h"
+
+// MythTranscode
+#include "audioreencodebuffer.h"
+#include "transcodepipeline.h"
+
+#define LOC QString("TranscodePipeline: ")
+
+/// Frames between the scaler and the video encoder
+static constexpr size_t kVideoFrames { 8 };
+/// Audio frames between the audio decoder and encoder
+static constexpr size_t kAudioFrames { 64 };
+
+namespace
+{
+class TranscodeStageThread : public MThread
+{
+  public:
+    TranscodeStageThread(const QString &Name, std::function<void()> Work)
+      : MThread(Name), m_work(std::move(Work)) {}
+
+  protected:
+    void run(void) override
+    {
+        RunProlog();
+        m_work();
+        RunEpilog();
+    }
+
+  private:
+    std::function<void()> m_work;
+};
+}
+
+void TranscodeStageStats::Add(std::chrono::nanoseconds Busy)
+{
+    m_items++;
+    m_busyNs += Busy.count();
+}
+
+double TranscodeStageStats::Rate(void) const
+{
+    long long busy = m_busyNs;
+    return busy > 0 ? m_items * 1e9 / busy : 0.0;
+}
+
+TranscodePipeline::TranscodePipeline(MythAVFormatWriter *Writer,
+                                     MythAVFormatWriter *AudioWriter,
+                                     HTTPLiveStream *HLS, int HLSSegmentSize)
+  : m_writer(Writer), m_audioWriter(AudioWriter),
+    m_hls(HLS), m_hlsSegmentSize(HLSSegmentSize),
+    m_freeFrames(kVideoFrames), m_videoQueue(kVideoFrames),
+    m_audioQueue(kAudioFrames)
+{
+}
+
+TranscodePipeline::~TranscodePipeline()
+{
+    Abort();
+}
+
+bool TranscodePipeline::Start(int Width, int Height)
+{
+    for (size_t i = 0; i < kVideoFrames; i++)
+    {
+        auto frame = std::make_unique<MythVideoFrame>(FMT_YV12, Width, Height);
+        if (!frame->m_buffer)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to allocate video frames");
+            return false;
+        }
+        m_freeFrames.Push(frame.get());
+        m_frames.push_back(std::move(frame));
+    }
+
+    m_videoThread = std::make_unique<TranscodeStageThread>(
+        "TranscodeVideo", [this]() { EncodeVideo(); });
+    m_audioThread = std::make_unique<TranscodeStageThread>(
+        "TranscodeAudio", [this]() { EncodeAudio(); });
+    m_videoThread->start();
+    m_audioThread->start();
+    return true;
+}
+
+MythVideoFrame *TranscodePipeline::GetFreeFrame(void)
+{
+    MythVideoFrame *frame = nullptr;
+    return m_freeFrames.Pop(frame) ? frame : nullptr;
+}
+
+bool TranscodePipeline::QueueVideo(MythVideoFrame *Frame,
+                                   std::chrono::milliseconds SourceTime)
+{
+    return m_videoQueue.Push({ Frame, SourceTime });
+}
+
+bool TranscodePipeline::QueueAudio(AudioBuffer *Buffer,
+                                   std::chrono::milliseconds Timecode)
+{
+    {
+        QMutexLocker locker(&m_audioLock);
+        ++m_audioPending;
+    }
+    if (m_audioQueue.Push({ Buffer, Timecode }))
+        return true;
+
+    QMutexLocker locker(&m_audioLock);
+    --m_audioPending;
+    m_audioDone.wakeAll();
+    delete Buffer;
+    return false;
+}
+
+/// Wait until the audio thread has written everything queued so far
+bool TranscodePipeline::WaitForAudio(void)
+{
+    QMutexLocker locker(&m_audioLock);
+    while (!m_aborted && m_audioPending > 0)
+        m_audioDone.wait(&m_audioLock);
+    return !m_aborted;
+}
+
+void TranscodePipeline::Finish(void)
+{
+    m_videoQueue.Close();
+    m_audioQueue.Close();
+    if (m_videoThread)
+        m_videoThread->wait();
+    if (m_audioThread)
+        m_audioThread->wait();
+}
+
+void TranscodePipeline::Abort(void)
+{
+    {
+        QMutexLocker locker(&m_audioLock);
+        m_aborted = true;
+        m_audioDone.wakeAll();
+    }
+    m_freeFrames.Abort();
+    m_videoQueue.Abort();
+    m_audioQueue.Abort();
+    if (m_videoThread)
+        m_videoThread->wait();
+    if (m_audioThread)
+        m_audioThread->wait();
+    for (const auto & item : m_audioQueue.Take())
+        delete item.m_buffer;
+}
+
+QString TranscodePipeline::StatsText(const TranscodeStageStats &Decode) const
+{
+    return QObject::tr("Stage rates: decode %1 fps, scale %2 fps, "
+                       "video %3 fps, audio %4 fps.")
+        .arg(Decode.Rate(), 0, 'f', 0)
+        .arg(m_filterStats.Rate(), 0, 'f', 0)
+        .arg(m_videoStats.Rate(), 0, 'f', 0)
+        .arg(m_audioStats.Rate(), 0, 'f', 0);
+}
+
+void TranscodePipeline::EncodeVideo(void)
+{
+    VideoItem item;
+    while (m_videoQueue.Pop(item))
+    {
+        MythVideoFrame *frame = item.m_frame;
+        QElapsedTimer timer;
+        timer.start();
+
+        // Start a new segment with the next keyframe out of the encoder.
+        // The audio released so far is all from before this frame, and
+        // belongs in the segment being closed.
+        if (m_hls && m_writer->GetFramesWritten() &&
+            (m_hlsSegmentFrames > m_hlsSegmentSize) &&
+            m_writer->NextFrameIsKeyFrame())
+        {
+            if (!WaitForAudio())
+            {
+                m_freeFrames.Push(frame);
+                break;
+            }
+            m_hls->AddSegment();
+            m_writer->ReOpen(m_hls->GetCurrentFilename());
+            if (m_audioWriter)
+                m_audioWriter->ReOpen(m_hls->GetCurrentFilename(true));
+            m_hlsSegmentFrames = 0;
+        }
+
+        if (m_writer->WriteVideoFrame(frame) > 0)
+        {
+            m_lastWrittenTime = item.m_sourceTime;
+            if (m_hls)
+                ++m_hlsSegmentFrames;
+        }
+
+        m_videoStats.Add(std::chrono::nanoseconds(timer.nsecsElapsed()));
+        m_freeFrames.Push(frame);
+    }
+}
+
+void TranscodePipeline::EncodeAudio(void)
+{
+    AudioItem item;
+    while (m_audioQueue.Pop(item))
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto *buf = reinterpret_cast<unsigned char *>(item.m_buffer->data());
+        std::chrono::milliseconds tc = item.m_timecode;
+        m_writer->WriteAudioFrame(buf, m_audioFrame, tc);
+
+        if (m_audioWriter)
+        {
+            if ((m_audioWriter->GetTimecodeOffset() == -1ms) &&
+                (m_writer->GetTimecodeOffset() != -1ms))
+            {
+                m_audioWriter->SetTimecodeOffset(m_writer->GetTimecodeOffset());
+            }
+
+            tc = item.m_timecode;
+            m_audioWriter->WriteAudioFrame(buf, m_audioFrame, tc);
+        }
+
+        ++m_audioFrame;
+        delete item.m_buffer;
+        m_audioStats.Add(std::chrono::nanoseconds(timer.nsecsElapsed()));
+
+        QMutexLocker locker(&m_audioLock);
+        if (--m_audioPending == 0)
+            m_audioDone.wakeAll();
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,189 @@
+#ifndef TRANSCODEPIPELINE_H
+#define TRANSCODEPIPELINE_H
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV
+#include "libmythbase/mthread.h"
+#include "libmythtv/mythframe.h"
+
+class AudioBuffer;
+class HTTPLiveStream;
+class MythAVFormatWriter;
+
+/// Work done by one stage of the transcoding pipeline.
+class TranscodeStageStats
+{
+  public:
+    void    Add(std::chrono::nanoseconds Busy);
+    /// Items per second of busy time, i.e. how fast the stage could go alone
+    double  Rate(void) const;
+
+  private:
+    std::atomic<long long> m_items  { 0 };
+    std::atomic<long long> m_busyNs { 0 };
+};
+
+/** \class TranscodeQueue
+ *  \brief Bounded FIFO between two stages of the transcoding pipeline.
+ *
+ *  Push() blocks while the queue is full, which holds back the producer
+ *  until the consumer catches up. Pop() blocks while it is empty, and
+ *  fails once the queue is closed and drained, or aborted.
+ */
+template <typename T>
+class TranscodeQueue
+{
+  public:
+    explicit TranscodeQueue(size_t Size) : m_maxItems(Size) {}
+
+    bool Push(T Item)
+    {
+        QMutexLocker locker(&m_lock);
+        while (!m_aborted && m_items.size() >= m_maxItems)
+            m_notFull.wait(&m_lock);
+        if (m_aborted)
+            return false;
+        m_items.push_back(Item);
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    bool Pop(T &Item)
+    {
+        QMutexLocker locker(&m_lock);
+        while (!m_aborted && !m_closed && m_items.empty())
+            m_notEmpty.wait(&m_lock);
+        if (m_aborted || m_items.empty())
+            return false;
+        Item = m_items.front();
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    /// No more items will be pushed
+    void Close(void)
+    {
+        QMutexLocker locker(&m_lock);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+    }
+
+    void Abort(void)
+    {
+        QMutexLocker locker(&m_lock);
+        m_aborted = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    /// Remove whatever is left, once both ends have stopped
+    std::deque<T> Take(void)
+    {
+        QMutexLocker locker(&m_lock);
+        return std::exchange(m_items, {});
+    }
+
+  private:
+    const size_t    m_maxItems;
+    QMutex          m_lock;         // Guards the following...
+    QWaitCondition  m_notEmpty;
+    QWaitCondition  m_notFull;
+    std::deque<T>   m_items;
+    bool            m_closed  { false };
+    bool            m_aborted { false };
+};
+
+/** \class TranscodePipeline
+ *  \brief Encodes and muxes video and audio on their own threads.
+ *
+ *  The caller gets an empty frame with GetFreeFrame(), scales the decoded
+ *  picture into it and hands it to QueueVideo(). The video encoder returns
+ *  the frame to the free list once it has been encoded, so the number of
+ *  frames bounds how far the caller can run ahead. Audio is queued with
+ *  QueueAudio() and encoded on a second thread. Both encoders write to the
+ *  same MythAVFormatWriter, which interleaves the packets.
+ *
+ *  The caller should only queue audio up to GetLastWrittenTime(), the
+ *  source time of the last video frame the encoder has written. Before
+ *  an HLS segment switch the video thread waits for the audio thread to
+ *  write everything queued, so no audio lands in the wrong segment.
+ */
+class TranscodePipeline
+{
+  public:
+    TranscodePipeline(MythAVFormatWriter *Writer, MythAVFormatWriter *AudioWriter,
+                      HTTPLiveStream *HLS, int HLSSegmentSize);
+    ~TranscodePipeline();
+
+    bool Start(int Width, int Height);
+    MythVideoFrame *GetFreeFrame(void);
+    bool QueueVideo(MythVideoFrame *Frame, std::chrono::milliseconds SourceTime);
+    std::chrono::milliseconds GetLastWrittenTime(void) const { return m_lastWrittenTime; }
+    bool QueueAudio(AudioBuffer *Buffer, std::chrono::milliseconds Timecode);
+    /// Encode whatever is queued and stop
+    void Finish(void);
+    void Abort(void);
+
+    TranscodeStageStats &FilterStats(void) { return m_filterStats; }
+    QString StatsText(const TranscodeStageStats &Decode) const;
+
+  private:
+    Q_DISABLE_COPY(TranscodePipeline)
+
+    struct VideoItem
+    {
+        MythVideoFrame           *m_frame { nullptr };
+        std::chrono::milliseconds m_sourceTime {};
+    };
+
+    struct AudioItem
+    {
+        AudioBuffer              *m_buffer { nullptr };
+        std::chrono::milliseconds m_timecode {};
+    };
+
+    void EncodeVideo(void);
+    void EncodeAudio(void);
+    bool WaitForAudio(void);
+
+    MythAVFormatWriter     *m_writer           { nullptr };
+    MythAVFormatWriter     *m_audioWriter      { nullptr };  ///< HLS audio only
+    HTTPLiveStream         *m_hls              { nullptr };
+    int                     m_hlsSegmentSize   { 0 };
+    int                     m_hlsSegmentFrames { 0 };
+    int                     m_audioFrame       { 0 };
+
+    std::vector<std::unique_ptr<MythVideoFrame>> m_frames;
+    TranscodeQueue<MythVideoFrame*> m_freeFrames;
+    TranscodeQueue<VideoItem>       m_videoQueue;
+    TranscodeQueue<AudioItem>       m_audioQueue;
+    std::atomic<std::chrono::milliseconds> m_lastWrittenTime { 0ms };
+
+    QMutex                  m_audioLock;        // Guards the following...
+    QWaitCondition          m_audioDone;
+    int                     m_audioPending     { 0 };  ///< queued, not yet written
+    bool                    m_aborted          { false };
+    std::unique_ptr<MThread>        m_videoThread;
+    std::unique_ptr<MThread>        m_audioThread;
+
+    TranscodeStageStats     m_filterStats;
+    TranscodeStageStats     m_videoStats;
+    TranscodeStageStats     m_audioStats;
+};
+
+#endif // TRANSCODEPIPELINE_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -2,6 +2,9 @@
 #include <chrono>
 #include <thread>
 
+// Qt
+#include <QElapsedTimer>
+
 // MythTV
 #include "mythtranscodeplayer.h"
 #include "videodecodebuffer.h"
@@ -45,8 +48,11 @@ void VideoDecodeBuffer::run()
             frameinfo.didFF = 0;
             frameinfo.isKey = false;
 
+            QElapsedTimer timer;
+            timer.start();
             if (m_player->TranscodeGetNextFrame(frameinfo.didFF, frameinfo.isKey, m_honorCutlist))
             {
+                m_stats.Add(std::chrono::nanoseconds(timer.nsecsElapsed()));
                 frameinfo.frame = m_videoOutput->GetLastDecodedFrame();
                 locker.relock();
                 m_frameList.append(frameinfo);
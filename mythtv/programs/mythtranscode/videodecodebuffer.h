@@ -10,6 +10,9 @@
 // MythTV
 #include "libmythtv/mythvideoout.h"
 
+// MythTranscode
+#include "transcodepipeline.h"
+
 class MythTranscodePlayer;
 class MythVideoOutput;
 
@@ -23,6 +26,7 @@ class VideoDecodeBuffer : public QRunnable
     void       stop     ();
     void       run      () override;
     MythVideoFrame *GetFrame(int &DidFF, bool &Key);
+    const TranscodeStageStats &GetStats() const { return m_stats; }
 
   private:
     struct DecodedFrameInfo
@@ -42,6 +46,7 @@ class VideoDecodeBuffer : public QRunnable
     bool                    m_eof         { false };
     QList<DecodedFrameInfo> m_frameList;
     QWaitCondition          m_frameWaitCond;
+    TranscodeStageStats     m_stats;
 };
 
 #endif
@@ -697,6 +697,19 @@ static GlobalCheckBoxSetting *AutoTranscodeBeforeAutoCommflag()
     return gc;
 };
 
+static GlobalCheckBoxSetting *AutoTrickplay()
+{
+    auto *gc = new GlobalCheckBoxSetting("AutoTrickplay");
+    gc->setLabel(QObject::tr("Generate seek bar thumbnails after recording"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, a thumbnail generation job is "
+                                "queued for every finished recording. It "
+                                "saves a small picture every few seconds "
+                                "next to the recording, for clients to show "
+                                "while seeking."));
+    return gc;
+};
+
 static GlobalCheckBoxSetting *AutoCommflagWhileRecording()
 {
     auto *gc = new GlobalCheckBoxSetting("AutoCommflagWhileRecording");
@@ -710,6 +723,23 @@ static GlobalCheckBoxSetting *AutoCommflagWhileRecording()
     return gc;
 };
 
+static GlobalCheckBoxSetting *CommFlagInRecorder()
+{
+    auto *gc = new GlobalCheckBoxSetting("CommFlagInRecorder");
+    gc->setLabel(QObject::tr("Detect commercials in the recorder"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, and Auto Commercial Detection is "
+                                "ON for a recording, digital recorders look "
+                                "for commercial breaks in the stream as it is "
+                                "recorded, so they are marked when the "
+                                "recording ends. Only blank frames are used "
+                                "to find breaks. A commercial detection job "
+                                "is still run unless the detection method is "
+                                "Blank Frame Detection, or if the recorder "
+                                "could not flag the recording."));
+    return gc;
+};
+
 static GlobalTextEditSetting *UserJob(uint job_num)
 {
     auto *gc = new GlobalTextEditSetting(QString("UserJob%1").arg(job_num));
@@ -770,6 +800,16 @@ static HostCheckBoxSetting *JobAllowPreview()
     return gc;
 };
 
+static HostCheckBoxSetting *JobAllowTrickplay()
+{
+    auto *gc = new HostCheckBoxSetting("JobAllowTrickplay");
+    gc->setLabel(QObject::tr("Allow seek bar thumbnail jobs"));
+    gc->setValue(true);
+    gc->setHelpText(QObject::tr("If enabled, allow jobs of this type to "
+                                "run on this backend."));
+    return gc;
+};
+
 static GlobalTextEditSetting *JobQueueTranscodeCommand()
 {
     auto *gc = new GlobalTextEditSetting("JobQueueTranscodeCommand");
@@ -1048,6 +1088,7 @@ BackendSettings::BackendSettings()
     group5->addChild(JobAllowCommFlag());
     group5->addChild(JobAllowTranscode());
     group5->addChild(JobAllowPreview());
+    group5->addChild(JobAllowTrickplay());
     group5->addChild(JobAllowUserJob(1));
     group5->addChild(JobAllowUserJob(2));
     group5->addChild(JobAllowUserJob(3));
@@ -1058,9 +1099,11 @@ BackendSettings::BackendSettings()
     group6->setLabel(QObject::tr("Job Queue (Global)"));
     group6->addChild(JobsRunOnRecordHost());
     group6->addChild(AutoCommflagWhileRecording());
+    group6->addChild(CommFlagInRecorder());
     group6->addChild(JobQueueCommFlagCommand());
     group6->addChild(JobQueueTranscodeCommand());
     group6->addChild(AutoTranscodeBeforeAutoCommflag());
+    group6->addChild(AutoTrickplay());
     group6->addChild(SaveTranscoding());
     addChild(group6);
 
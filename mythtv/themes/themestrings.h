@@ -21,7 +21,7 @@ void strings_null() {
     ThemeUI::tr("%1 total");
     ThemeUI::tr("%1:");
     ThemeUI::tr("%ASPECT% (%RESOLUTION%)");
-    ThemeUI::tr("%BUFFERAVAIL% of %BUFFERSIZE%Mb");
+    ThemeUI::tr("%BUFFERAVAIL% of %BUFFERSIZE%Mb (%READAHEAD%)");
     ThemeUI::tr("%CALLSIGN%");
     ThemeUI::tr("%CALLSIGN% : %STARTTIME% - %ENDTIME% (%LENMINS%)");
     ThemeUI::tr("%CALLSIGN| %%: |YEAR| %%~ |STARTTIME| %%- |ENDTIME% (%LENMINS%)");